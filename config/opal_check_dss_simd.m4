@@ -0,0 +1,54 @@
+dnl -*- shell-script -*-
+dnl
+dnl Copyright (c) 2015      Intel, Inc. All rights reserved.
+dnl $COPYRIGHT$
+dnl
+dnl Additional copyrights may follow
+dnl
+dnl $HEADER$
+dnl
+
+# OPAL_CHECK_DSS_SIMD
+# --------------------------------------------------------
+# The DSS byte-swaps integer arrays with SSSE3 and AVX2 kernels
+# that are built with per-function target attributes and picked at
+# run time with __builtin_cpu_supports, so the rest of libopen-pal
+# needs no special flags. Not every compiler that defines __GNUC__
+# accepts all of that - check that one does before using it. The
+# test is linked, as __builtin_cpu_supports needs the compiler's
+# runtime support.
+AC_DEFUN([OPAL_CHECK_DSS_SIMD],[
+    AC_MSG_CHECKING([whether the compiler supports runtime-selected SIMD byte swaps])
+    AC_LINK_IFELSE([AC_LANG_PROGRAM([[
+#include <immintrin.h>
+__attribute__((target("ssse3")))
+static void swap_ssse3(char *d, const char *s, const char *m)
+{
+    _mm_storeu_si128((__m128i*)d,
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)s),
+                         _mm_loadu_si128((const __m128i*)m)));
+}
+__attribute__((target("avx2")))
+static void swap_avx2(char *d, const char *s, const char *m)
+{
+    _mm256_storeu_si256((__m256i*)d,
+        _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)s),
+                            _mm256_loadu_si256((const __m256i*)m)));
+}
+]], [[
+    char d[32], s[32] = {0}, m[32] = {0};
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        swap_avx2(d, s, m);
+    } else if (__builtin_cpu_supports("ssse3")) {
+        swap_ssse3(d, s, m);
+    }
+    return d[0];
+]])],
+                   [opal_check_dss_simd_happy=1
+                    AC_MSG_RESULT([yes])],
+                   [opal_check_dss_simd_happy=0
+                    AC_MSG_RESULT([no])])
+    AC_DEFINE_UNQUOTED([OPAL_HAVE_DSS_SIMD], [$opal_check_dss_simd_happy],
+                       [Whether the DSS can use its SSSE3/AVX2 byte swap kernels])
+])dnl
@@ -202,6 +202,29 @@ typedef int (*opal_dss_unpack_fn_t)(opal_buffer_t *buffer, void *dest,
                                     int32_t *max_num_values,
                                     opal_data_type_t type);
 
+/**
+ * Unpack a buffer without copying its contents.
+ *
+ * Unpacks the next item, which must be a single OPAL_BUFFER, as a new
+ * buffer that points into the storage of the one being unpacked - the
+ * storage is shared, and freed once both buffers have been released,
+ * in either order. The view can be unpacked, and packed into, like any
+ * other buffer; it takes a private copy of its data the first time it
+ * has to grow. Use it where a nested buffer is unpacked only to be
+ * read, or forwarded, without being held onto.
+ *
+ * @param buffer A pointer to the buffer to be unpacked from.
+ *
+ * @param dest Where to return the new buffer, which the caller
+ * releases with OBJ_RELEASE.
+ *
+ * @retval OPAL_SUCCESS The next item was unpacked as a view.
+ *
+ * @retval OPAL_ERROR(s) An appropriate error code - as for unpack.
+ */
+typedef int (*opal_dss_unpack_view_fn_t)(opal_buffer_t *buffer,
+                                         opal_buffer_t **dest);
+
 /**
  * Get the type and number of values of the next item in the buffer.
  *
@@ -492,6 +515,7 @@ struct opal_dss_t {
     opal_dss_lookup_data_type_fn_t  lookup_data_type;
     opal_dss_dump_data_types_fn_t   dump_data_types;
     opal_dss_dump_fn_t              dump;
+    opal_dss_unpack_view_fn_t       unpack_view;
 };
 typedef struct opal_dss_t opal_dss_t;
 
@@ -209,6 +209,44 @@ extern int opal_dss_initial_size;
 extern int opal_dss_threshold_size;
 extern opal_pointer_array_t opal_dss_types;
 extern opal_data_type_t opal_dss_num_reg_types;
+extern bool opal_dss_homogeneous;
+
+/*
+ * Bulk byte order conversion of n 16/32/64-bit values, chosen when
+ * the DSS opens - see dss_swap.c
+ */
+typedef void (*opal_dss_swap_fn_t)(void *dst, const void *src, int32_t n);
+extern opal_dss_swap_fn_t opal_dss_swap16;
+extern opal_dss_swap_fn_t opal_dss_swap32;
+extern opal_dss_swap_fn_t opal_dss_swap64;
+extern const char *opal_dss_swap_kernel;
+/* select a kernel by name ("avx2", "ssse3", "scalar", "copy"),
+ * or the best available for NULL or "auto" */
+OPAL_DECLSPEC int opal_dss_swap_select(const char *kernel);
+
+/*
+ * Buffer storage pool and shared segments - see dss_pool.c
+ */
+#define OPAL_DSS_POOL_MAX_SIZE  (64 * 1024)
+
+typedef struct opal_dss_segment_t {
+    opal_object_t super;
+    char *base;
+    size_t size;
+} opal_dss_segment_t;
+OPAL_DECLSPEC OBJ_CLASS_DECLARATION(opal_dss_segment_t);
+
+extern int opal_dss_pool_depth;
+int opal_dss_pool_init(void);
+void opal_dss_pool_finalize(void);
+/* rounds *size up to the block size handed out */
+char* opal_dss_pool_alloc(size_t *size);
+void opal_dss_pool_free(char *block, size_t size);
+/* drop a buffer's storage, leaving it empty */
+void opal_dss_buffer_release_storage(opal_buffer_t *buffer);
+/* point view at the next nbytes of buffer and step over them */
+int opal_dss_buffer_share(opal_buffer_t *buffer, opal_buffer_t *view,
+                          size_t nbytes);
 
 /*
  * Implementations of API functions
@@ -220,6 +258,7 @@ int opal_dss_pack(opal_buffer_t *buffer, const void *src,
 int opal_dss_unpack(opal_buffer_t *buffer, void *dest,
                     int32_t *max_num_vals,
                     opal_data_type_t type);
+int opal_dss_unpack_view(opal_buffer_t *buffer, opal_buffer_t **dest);
 
 int opal_dss_copy(void **dest, void *src, opal_data_type_t type);
 
@@ -19,6 +19,7 @@
 #include "opal_config.h"
 
 #include <stdio.h>
+#include <string.h>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
@@ -33,8 +34,9 @@
  */
 char* opal_dss_buffer_extend(opal_buffer_t *buffer, size_t bytes_to_add)
 {
-    size_t required, to_alloc;
+    size_t required, to_alloc, used;
     size_t pack_offset, unpack_offset;
+    char *base;
 
     /* Check to see if we have enough space already */
 
@@ -56,7 +58,22 @@ char* opal_dss_buffer_extend(opal_buffer_t *buffer, size_t bytes_to_add)
         } 
     }
 
-    if (NULL != buffer->base_ptr) {
+    if (NULL != buffer->base_ptr &&
+        (NULL != buffer->segment || to_alloc <= OPAL_DSS_POOL_MAX_SIZE)) {
+        /* take a fresh block from the pool - the old storage may be
+         * shared with other buffers, so it cannot be realloc'd */
+        pack_offset = ((char*) buffer->pack_ptr) - ((char*) buffer->base_ptr);
+        unpack_offset = ((char*) buffer->unpack_ptr) -
+            ((char*) buffer->base_ptr);
+        used = buffer->bytes_used;
+        if (NULL == (base = opal_dss_pool_alloc(&to_alloc))) {
+            return NULL;
+        }
+        memcpy(base, buffer->base_ptr, used);
+        opal_dss_buffer_release_storage(buffer);
+        buffer->base_ptr = base;
+        buffer->bytes_used = used;
+    } else if (NULL != buffer->base_ptr) {
         pack_offset = ((char*) buffer->pack_ptr) - ((char*) buffer->base_ptr);
         unpack_offset = ((char*) buffer->unpack_ptr) -
             ((char*) buffer->base_ptr);
@@ -65,7 +82,7 @@ char* opal_dss_buffer_extend(opal_buffer_t *buffer, size_t bytes_to_add)
         pack_offset = 0;
         unpack_offset = 0;
         buffer->bytes_used = 0;
-        buffer->base_ptr = (char*)malloc(to_alloc);
+        buffer->base_ptr = opal_dss_pool_alloc(&to_alloc);
     }
     
     if (NULL == buffer->base_ptr) { 
@@ -49,6 +49,17 @@ int opal_dss_unload(opal_buffer_t *buffer, void **payload,
         return OPAL_SUCCESS;
     }
 
+    /* if the storage is shared, the caller gets a copy of our part */
+    if (NULL != buffer->segment) {
+        if (NULL == (*payload = malloc(buffer->bytes_used))) {
+            return OPAL_ERR_OUT_OF_RESOURCE;
+        }
+        memcpy(*payload, buffer->base_ptr, buffer->bytes_used);
+        *bytes_used = buffer->bytes_used;
+        opal_dss_buffer_release_storage(buffer);
+        return OPAL_SUCCESS;
+    }
+
     /* okay, we have something to provide - pass it back */
     *payload = buffer->base_ptr;
     *bytes_used = buffer->bytes_used;
@@ -73,9 +84,7 @@ int opal_dss_load(opal_buffer_t *buffer, void *payload,
     }
     
     /* check if buffer already has payload - free it if so */
-    if (NULL != buffer->base_ptr) {
-        free(buffer->base_ptr);
-    }
+    opal_dss_buffer_release_storage(buffer);
 
     /* if it's a NULL payload, just set things and return */
     if (NULL == payload) {
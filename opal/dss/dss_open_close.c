@@ -36,6 +36,7 @@ bool opal_dss_initialized = false;
 int opal_dss_verbose = -1;  /* by default disabled */
 int opal_dss_initial_size = -1;
 int opal_dss_threshold_size = -1;
+bool opal_dss_homogeneous = false;
 opal_pointer_array_t opal_dss_types = {{0}};
 opal_data_type_t opal_dss_num_reg_types = {0};
 opal_dss_buffer_type_t default_buf_type = OPAL_DSS_BUFFER_NON_DESC;
@@ -63,7 +64,8 @@ opal_dss_t opal_dss = {
     opal_dss_register,
     opal_dss_lookup_data_type,
     opal_dss_dump_data_types,
-    opal_dss_dump
+    opal_dss_dump,
+    opal_dss_unpack_view
 };
 
 /**
@@ -105,13 +107,12 @@ static void opal_buffer_construct (opal_buffer_t* buffer)
 
     buffer->base_ptr = buffer->pack_ptr = buffer->unpack_ptr = NULL;
     buffer->bytes_allocated = buffer->bytes_used = 0;
+    buffer->segment = NULL;
 }
 
 static void opal_buffer_destruct (opal_buffer_t* buffer)
 {
-    if (NULL != buffer->base_ptr) {
-        free (buffer->base_ptr);
-    }
+    opal_dss_buffer_release_storage(buffer);
 }
 
 OBJ_CLASS_INSTANCE(opal_buffer_t,
@@ -286,6 +287,29 @@ int opal_dss_register_vars (void)
                                  MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
                                  OPAL_INFO_LVL_8, MCA_BASE_VAR_SCOPE_ALL_EQ,
                                  &opal_dss_threshold_size);
+    if (0 > ret) {
+        return ret;
+    }
+
+    /* every process shares the host byte order, so integers can go
+     * on the wire as they are - must be set the same everywhere */
+    opal_dss_homogeneous = false;
+    ret = mca_base_var_register ("opal", "dss", NULL, "homogeneous",
+                                 "Pack integers in host byte order instead of network byte order - only valid if every process has the same byte order",
+                                 MCA_BASE_VAR_TYPE_BOOL, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                 OPAL_INFO_LVL_8, MCA_BASE_VAR_SCOPE_ALL_EQ,
+                                 &opal_dss_homogeneous);
+    if (0 > ret) {
+        return ret;
+    }
+
+    /* how many free blocks of each size a thread keeps for reuse */
+    opal_dss_pool_depth = 16;
+    ret = mca_base_var_register ("opal", "dss", NULL, "buffer_pool_depth",
+                                 "Number of free buffer storage blocks of each size kept by each thread for reuse (0 = no pooling)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                 OPAL_INFO_LVL_8, MCA_BASE_VAR_SCOPE_LOCAL,
+                                 &opal_dss_pool_depth);
 
     return (0 > ret) ? ret : OPAL_SUCCESS;
 }
@@ -312,6 +336,12 @@ int opal_dss_open(void)
     }
     opal_dss_num_reg_types = 0;
 
+    /* pick the byte order conversion kernels */
+    opal_dss_swap_select(NULL);
+
+    /* setup the buffer storage pool */
+    opal_dss_pool_init();
+
     /* Register all the intrinsic types */
 
     tmp = OPAL_NULL;
@@ -637,6 +667,8 @@ int opal_dss_close(void)
 
     OBJ_DESTRUCT(&opal_dss_types);
 
+    opal_dss_pool_finalize();
+
     return OPAL_SUCCESS;
 }
 
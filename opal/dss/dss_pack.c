@@ -222,7 +222,6 @@ int opal_dss_pack_byte(opal_buffer_t *buffer, const void *src,
 int opal_dss_pack_int16(opal_buffer_t *buffer, const void *src,
                         int32_t num_vals, opal_data_type_t type)
 {
-    int32_t i;
     uint16_t tmp, *srctmp = (uint16_t*) src;
     char *dst;
 
@@ -232,11 +231,7 @@ int opal_dss_pack_int16(opal_buffer_t *buffer, const void *src,
         return OPAL_ERR_OUT_OF_RESOURCE;
     }
 
-    for (i = 0; i < num_vals; ++i) {
-        tmp = htons(srctmp[i]);
-        memcpy(dst, &tmp, sizeof(tmp));
-        dst += sizeof(tmp);
-    }
+    opal_dss_swap16(dst, srctmp, num_vals);
     buffer->pack_ptr += num_vals * sizeof(tmp);
     buffer->bytes_used += num_vals * sizeof(tmp);
 
@@ -249,7 +244,6 @@ int opal_dss_pack_int16(opal_buffer_t *buffer, const void *src,
 int opal_dss_pack_int32(opal_buffer_t *buffer, const void *src,
                         int32_t num_vals, opal_data_type_t type)
 {
-    int32_t i;
     uint32_t tmp, *srctmp = (uint32_t*) src;
     char *dst;
 
@@ -259,11 +253,7 @@ int opal_dss_pack_int32(opal_buffer_t *buffer, const void *src,
         return OPAL_ERR_OUT_OF_RESOURCE;
     }
 
-    for (i = 0; i < num_vals; ++i) {
-        tmp = htonl(srctmp[i]);
-        memcpy(dst, &tmp, sizeof(tmp));
-        dst += sizeof(tmp);
-    }
+    opal_dss_swap32(dst, srctmp, num_vals);
     buffer->pack_ptr += num_vals * sizeof(tmp);
     buffer->bytes_used += num_vals * sizeof(tmp);
 
@@ -276,7 +266,6 @@ int opal_dss_pack_int32(opal_buffer_t *buffer, const void *src,
 int opal_dss_pack_int64(opal_buffer_t *buffer, const void *src,
                         int32_t num_vals, opal_data_type_t type)
 {
-    int32_t i;
     uint64_t tmp, *srctmp = (uint64_t*) src;
     char *dst;
     size_t bytes_packed = num_vals * sizeof(tmp);
@@ -287,11 +276,7 @@ int opal_dss_pack_int64(opal_buffer_t *buffer, const void *src,
         return OPAL_ERR_OUT_OF_RESOURCE;
     }
 
-    for (i = 0; i < num_vals; ++i) {
-        tmp = hton64(srctmp[i]);
-        memcpy(dst, &tmp, sizeof(tmp));
-        dst += sizeof(tmp);
-    }
+    opal_dss_swap64(dst, srctmp, num_vals);
     buffer->pack_ptr += bytes_packed;
     buffer->bytes_used += bytes_packed;
 
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Buffer storage pool and shared segments.
+ *
+ * Buffer storage up to OPAL_DSS_POOL_MAX_SIZE is allocated in power
+ * of two sizes, and storage a buffer lets go of is kept on a per
+ * thread free list of its size, up to dss_buffer_pool_depth blocks,
+ * for the next buffer that thread grows. Every pooled block is an
+ * ordinary malloc'd block, so storage handed out by opal_dss.unload
+ * may still be released with free().
+ *
+ * A segment owns storage that several buffers point into. It is
+ * created when a buffer is unpacked from another as a view, and the
+ * storage goes back to the pool when the last buffer using it is
+ * released - whichever order they go in.
+ */
+
+#include "opal_config.h"
+
+#include <string.h>
+
+#include "opal/threads/tsd.h"
+#include "opal/dss/dss_internal.h"
+
+#define OPAL_DSS_POOL_CLASSES   32
+
+typedef struct {
+    int count[OPAL_DSS_POOL_CLASSES];
+    char **blocks[OPAL_DSS_POOL_CLASSES];
+} dss_pool_t;
+
+int opal_dss_pool_depth = -1;
+static bool pool_initialized = false;
+static bool key_created = false;
+static opal_tsd_key_t pool_key;
+
+static void pool_release(void *value)
+{
+    dss_pool_t *pool = (dss_pool_t*)value;
+    int c, i;
+
+    if (NULL == pool) {
+        return;
+    }
+    for (c=0; c < OPAL_DSS_POOL_CLASSES; c++) {
+        for (i=0; i < pool->count[c]; i++) {
+            free(pool->blocks[c][i]);
+        }
+        free(pool->blocks[c]);
+    }
+    free(pool);
+}
+
+static dss_pool_t* my_pool(void)
+{
+    dss_pool_t *pool;
+
+    if (!pool_initialized ||
+        OPAL_SUCCESS != opal_tsd_getspecific(pool_key, (void**)&pool)) {
+        return NULL;
+    }
+    if (NULL == pool) {
+        if (NULL == (pool = (dss_pool_t*)calloc(1, sizeof(dss_pool_t)))) {
+            return NULL;
+        }
+        if (OPAL_SUCCESS != opal_tsd_setspecific(pool_key, pool)) {
+            free(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+/* the class of a power of two size in the pooled range, else -1 */
+static int size_class(size_t size)
+{
+    int c = 0;
+
+    if (size < (size_t)opal_dss_initial_size || OPAL_DSS_POOL_MAX_SIZE < size ||
+        0 != (size & (size - 1))) {
+        return -1;
+    }
+    while ((size_t)opal_dss_initial_size << c < size) {
+        c++;
+    }
+    return ((size_t)opal_dss_initial_size << c == size && c < OPAL_DSS_POOL_CLASSES) ? c : -1;
+}
+
+int opal_dss_pool_init(void)
+{
+    if (pool_initialized || opal_dss_pool_depth <= 0 ||
+        opal_dss_initial_size <= 0 ||
+        0 != (opal_dss_initial_size & (opal_dss_initial_size - 1))) {
+        /* pooling needs power of two sizes */
+        return OPAL_SUCCESS;
+    }
+    /* the key outlives a close, as other threads may still hold pools */
+    if (!key_created) {
+        if (OPAL_SUCCESS != opal_tsd_key_create(&pool_key, pool_release)) {
+            return OPAL_SUCCESS;
+        }
+        key_created = true;
+    }
+    pool_initialized = true;
+    return OPAL_SUCCESS;
+}
+
+void opal_dss_pool_finalize(void)
+{
+    dss_pool_t *pool;
+
+    if (!pool_initialized) {
+        return;
+    }
+    /* other threads have released theirs on exit */
+    if (OPAL_SUCCESS == opal_tsd_getspecific(pool_key, (void**)&pool)) {
+        pool_release(pool);
+        opal_tsd_setspecific(pool_key, NULL);
+    }
+    pool_initialized = false;
+}
+
+char* opal_dss_pool_alloc(size_t *size)
+{
+    dss_pool_t *pool;
+    size_t s = (size_t)opal_dss_initial_size;
+    int c;
+
+    if (!pool_initialized || OPAL_DSS_POOL_MAX_SIZE < *size) {
+        return (char*)malloc(*size);
+    }
+    while (s < *size) {
+        s <<= 1;
+    }
+    *size = s;
+    if (0 <= (c = size_class(s)) && NULL != (pool = my_pool()) && 0 < pool->count[c]) {
+        return pool->blocks[c][--pool->count[c]];
+    }
+    return (char*)malloc(s);
+}
+
+void opal_dss_pool_free(char *block, size_t size)
+{
+    dss_pool_t *pool;
+    int c;
+
+    if (NULL == block) {
+        return;
+    }
+    if (!pool_initialized || 0 > (c = size_class(size)) || NULL == (pool = my_pool())) {
+        free(block);
+        return;
+    }
+    if (NULL == pool->blocks[c] &&
+        NULL == (pool->blocks[c] = (char**)malloc(opal_dss_pool_depth * sizeof(char*)))) {
+        free(block);
+        return;
+    }
+    if (pool->count[c] < opal_dss_pool_depth) {
+        pool->blocks[c][pool->count[c]++] = block;
+    } else {
+        free(block);
+    }
+}
+
+static void segment_construct(opal_dss_segment_t *seg)
+{
+    seg->base = NULL;
+    seg->size = 0;
+}
+
+static void segment_destruct(opal_dss_segment_t *seg)
+{
+    opal_dss_pool_free(seg->base, seg->size);
+}
+
+OBJ_CLASS_INSTANCE(opal_dss_segment_t,
+                   opal_object_t,
+                   segment_construct,
+                   segment_destruct);
+
+void opal_dss_buffer_release_storage(opal_buffer_t *buffer)
+{
+    if (NULL != buffer->segment) {
+        OBJ_RELEASE(buffer->segment);
+        buffer->segment = NULL;
+    } else if (NULL != buffer->base_ptr) {
+        opal_dss_pool_free(buffer->base_ptr, buffer->bytes_allocated);
+    }
+    buffer->base_ptr = buffer->pack_ptr = buffer->unpack_ptr = NULL;
+    buffer->bytes_allocated = buffer->bytes_used = 0;
+}
+
+int opal_dss_buffer_share(opal_buffer_t *buffer, opal_buffer_t *view,
+                          size_t nbytes)
+{
+    opal_dss_segment_t *seg;
+
+    if (NULL == (seg = buffer->segment)) {
+        /* hand our storage to a segment so it outlives us if need be */
+        if (NULL == (seg = OBJ_NEW(opal_dss_segment_t))) {
+            return OPAL_ERR_OUT_OF_RESOURCE;
+        }
+        seg->base = buffer->base_ptr;
+        seg->size = buffer->bytes_allocated;
+        buffer->segment = seg;
+    }
+    OBJ_RETAIN(seg);
+    view->segment = seg;
+    view->base_ptr = buffer->unpack_ptr;
+    view->pack_ptr = view->base_ptr + nbytes;
+    view->unpack_ptr = view->base_ptr;
+    view->bytes_allocated = view->bytes_used = nbytes;
+    buffer->unpack_ptr += nbytes;
+    return OPAL_SUCCESS;
+}
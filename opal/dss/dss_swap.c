@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Bulk conversion of 16/32/64-bit integer arrays between host and
+ * network byte order for the pack and unpack functions. The kernel
+ * for each width is picked once when the DSS opens: AVX2 or SSSE3
+ * byte shuffles where the CPU has them, otherwise a scalar loop.
+ * Conversion is its own inverse, so the same kernel serves pack and
+ * unpack. Where the host is big-endian, or every process runs with
+ * dss_homogeneous set, the kernels are plain copies. Source and
+ * destination need not be aligned.
+ */
+
+#include "opal_config.h"
+
+#include <string.h>
+
+#include "opal/types.h"
+#include "opal/util/output.h"
+#include "opal/dss/dss_internal.h"
+
+/* configure checked that the compiler takes the target attributes,
+ * the intrinsics and __builtin_cpu_supports */
+#if !defined(WORDS_BIGENDIAN) && OPAL_HAVE_DSS_SIMD
+#define DSS_SWAP_X86 1
+#include <immintrin.h>
+#endif
+
+static void swap16_scalar(void *dst, const void *src, int32_t n);
+static void swap32_scalar(void *dst, const void *src, int32_t n);
+static void swap64_scalar(void *dst, const void *src, int32_t n);
+
+opal_dss_swap_fn_t opal_dss_swap16 = swap16_scalar;
+opal_dss_swap_fn_t opal_dss_swap32 = swap32_scalar;
+opal_dss_swap_fn_t opal_dss_swap64 = swap64_scalar;
+const char *opal_dss_swap_kernel = "scalar";
+
+static void copy16(void *dst, const void *src, int32_t n)
+{
+    memcpy(dst, src, n * sizeof(uint16_t));
+}
+
+static void copy32(void *dst, const void *src, int32_t n)
+{
+    memcpy(dst, src, n * sizeof(uint32_t));
+}
+
+static void copy64(void *dst, const void *src, int32_t n)
+{
+    memcpy(dst, src, n * sizeof(uint64_t));
+}
+
+static void swap16_scalar(void *dst, const void *src, int32_t n)
+{
+    const char *s = (const char*)src;
+    char *d = (char*)dst;
+    uint16_t tmp;
+    int32_t i;
+
+    for (i = 0; i < n; ++i) {
+        memcpy(&tmp, s + i * sizeof(tmp), sizeof(tmp));
+        tmp = htons(tmp);
+        memcpy(d + i * sizeof(tmp), &tmp, sizeof(tmp));
+    }
+}
+
+static void swap32_scalar(void *dst, const void *src, int32_t n)
+{
+    const char *s = (const char*)src;
+    char *d = (char*)dst;
+    uint32_t tmp;
+    int32_t i;
+
+    for (i = 0; i < n; ++i) {
+        memcpy(&tmp, s + i * sizeof(tmp), sizeof(tmp));
+        tmp = htonl(tmp);
+        memcpy(d + i * sizeof(tmp), &tmp, sizeof(tmp));
+    }
+}
+
+static void swap64_scalar(void *dst, const void *src, int32_t n)
+{
+    const char *s = (const char*)src;
+    char *d = (char*)dst;
+    uint64_t tmp;
+    int32_t i;
+
+    for (i = 0; i < n; ++i) {
+        memcpy(&tmp, s + i * sizeof(tmp), sizeof(tmp));
+        tmp = hton64(tmp);
+        memcpy(d + i * sizeof(tmp), &tmp, sizeof(tmp));
+    }
+}
+
+#ifdef DSS_SWAP_X86
+
+/* byte shuffles reversing each 2, 4 or 8 byte element - the AVX2
+ * shuffle works within 16-byte lanes, so both lanes are the same */
+static uint8_t mask16[32], mask32[32], mask64[32];
+
+static void build_masks(void)
+{
+    int j;
+
+    for (j = 0; j < 32; j++) {
+        mask16[j] = (uint8_t)((j & 15) ^ 1);
+        mask32[j] = (uint8_t)((j & 15) ^ 3);
+        mask64[j] = (uint8_t)((j & 15) ^ 7);
+    }
+}
+
+#define DSS_SWAP_SSSE3(name, width, mask, tail)                             \
+__attribute__((target("ssse3")))                                            \
+static void name(void *dst, const void *src, int32_t n)                     \
+{                                                                           \
+    const char *s = (const char*)src;                                       \
+    char *d = (char*)dst;                                                   \
+    __m128i m = _mm_loadu_si128((const __m128i*)mask);                      \
+    size_t i, bytes = (size_t)n * (width);                                  \
+                                                                            \
+    for (i = 0; i + 16 <= bytes; i += 16) {                                 \
+        _mm_storeu_si128((__m128i*)(d + i),                                 \
+            _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(s + i)), m)); \
+    }                                                                       \
+    tail(d + i, s + i, (int32_t)((bytes - i) / (width)));                   \
+}
+
+#define DSS_SWAP_AVX2(name, width, mask, tail)                                  \
+__attribute__((target("avx2")))                                                \
+static void name(void *dst, const void *src, int32_t n)                         \
+{                                                                               \
+    const char *s = (const char*)src;                                           \
+    char *d = (char*)dst;                                                       \
+    __m256i m = _mm256_loadu_si256((const __m256i*)mask);                       \
+    size_t i, bytes = (size_t)n * (width);                                      \
+                                                                                \
+    for (i = 0; i + 64 <= bytes; i += 64) {                                     \
+        __m256i a = _mm256_loadu_si256((const __m256i*)(s + i));                \
+        __m256i b = _mm256_loadu_si256((const __m256i*)(s + i + 32));           \
+        _mm256_storeu_si256((__m256i*)(d + i), _mm256_shuffle_epi8(a, m));      \
+        _mm256_storeu_si256((__m256i*)(d + i + 32), _mm256_shuffle_epi8(b, m)); \
+    }                                                                           \
+    for (; i + 32 <= bytes; i += 32) {                                          \
+        _mm256_storeu_si256((__m256i*)(d + i),                                  \
+            _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(s + i)), m)); \
+    }                                                                           \
+    tail(d + i, s + i, (int32_t)((bytes - i) / (width)));                       \
+}
+
+DSS_SWAP_SSSE3(swap16_ssse3, 2, mask16, swap16_scalar)
+DSS_SWAP_SSSE3(swap32_ssse3, 4, mask32, swap32_scalar)
+DSS_SWAP_SSSE3(swap64_ssse3, 8, mask64, swap64_scalar)
+DSS_SWAP_AVX2(swap16_avx2, 2, mask16, swap16_scalar)
+DSS_SWAP_AVX2(swap32_avx2, 4, mask32, swap32_scalar)
+DSS_SWAP_AVX2(swap64_avx2, 8, mask64, swap64_scalar)
+
+#endif  /* DSS_SWAP_X86 */
+
+int opal_dss_swap_select(const char *kernel)
+{
+    bool any = (NULL == kernel || 0 == strcmp(kernel, "auto"));
+
+#ifdef WORDS_BIGENDIAN
+    /* network order is host order */
+    any = true;
+    kernel = "copy";
+#endif
+    if (opal_dss_homogeneous || (NULL != kernel && 0 == strcmp(kernel, "copy"))) {
+        opal_dss_swap16 = copy16;
+        opal_dss_swap32 = copy32;
+        opal_dss_swap64 = copy64;
+        opal_dss_swap_kernel = "copy";
+        return OPAL_SUCCESS;
+    }
+
+#ifdef DSS_SWAP_X86
+    __builtin_cpu_init();
+    build_masks();
+    if ((any || 0 == strcmp(kernel, "avx2")) && __builtin_cpu_supports("avx2")) {
+        opal_dss_swap16 = swap16_avx2;
+        opal_dss_swap32 = swap32_avx2;
+        opal_dss_swap64 = swap64_avx2;
+        opal_dss_swap_kernel = "avx2";
+        return OPAL_SUCCESS;
+    }
+    if ((any || 0 == strcmp(kernel, "ssse3")) && __builtin_cpu_supports("ssse3")) {
+        opal_dss_swap16 = swap16_ssse3;
+        opal_dss_swap32 = swap32_ssse3;
+        opal_dss_swap64 = swap64_ssse3;
+        opal_dss_swap_kernel = "ssse3";
+        return OPAL_SUCCESS;
+    }
+#endif
+
+    if (!any && 0 != strcmp(kernel, "scalar")) {
+        return OPAL_ERR_NOT_SUPPORTED;
+    }
+    opal_dss_swap16 = swap16_scalar;
+    opal_dss_swap32 = swap32_scalar;
+    opal_dss_swap64 = swap64_scalar;
+    opal_dss_swap_kernel = "scalar";
+    return OPAL_SUCCESS;
+}
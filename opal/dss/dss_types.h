@@ -361,6 +361,8 @@ typedef enum opal_dss_buffer_type_t opal_dss_buffer_type_t;
 #define OPAL_DSS_BUFFER_TYPE_HTON(h);
 #define OPAL_DSS_BUFFER_TYPE_NTOH(h);
 
+struct opal_dss_segment_t;
+
 /**
  * Structure for holding a buffer to be used with the RML or OOB
  * subsystems.
@@ -384,6 +386,10 @@ struct opal_buffer_t {
     /** Number of bytes used by the buffer (i.e., amount of data --
         including overhead -- packed in the buffer) */
     size_t bytes_used;
+    /** Shared storage base_ptr points into when this buffer, or one
+        unpacked from it, is a view - NULL if the buffer owns its
+        storage outright */
+    struct opal_dss_segment_t *segment;
 };
 /**
  * Convenience typedef
@@ -98,6 +98,70 @@ int opal_dss_unpack(opal_buffer_t *buffer, void *dst, int32_t *num_vals,
     return ret;
 }
 
+int opal_dss_unpack_view(opal_buffer_t *buffer, opal_buffer_t **dest)
+{
+    int rc;
+    int32_t local_num, n=1;
+    opal_data_type_t local_type;
+    opal_buffer_t *view;
+    size_t nbytes;
+
+    /* check for error */
+    if (NULL == buffer || NULL == dest) {
+        return OPAL_ERR_BAD_PARAM;
+    }
+    *dest = NULL;
+
+    /* the number of values, as in opal_dss_unpack */
+    if (OPAL_DSS_BUFFER_FULLY_DESC == buffer->type) {
+        if (OPAL_SUCCESS != (rc = opal_dss_get_data_type(buffer, &local_type))) {
+            return rc;
+        }
+        if (OPAL_INT32 != local_type) {
+            return OPAL_ERR_UNPACK_FAILURE;
+        }
+    }
+    if (OPAL_SUCCESS != (rc = opal_dss_unpack_int32(buffer, &local_num, &n, OPAL_INT32))) {
+        return rc;
+    }
+    if (local_num < 1) {
+        return OPAL_ERR_UNPACK_FAILURE;
+    }
+
+    if (OPAL_DSS_BUFFER_FULLY_DESC == buffer->type) {
+        if (OPAL_SUCCESS != (rc = opal_dss_get_data_type(buffer, &local_type))) {
+            return rc;
+        }
+        if (OPAL_BUFFER != local_type) {
+            opal_output(0, "OPAL dss:unpack_view: got type %d when expecting type %d",
+                        local_type, OPAL_BUFFER);
+            return OPAL_ERR_PACK_MISMATCH;
+        }
+    }
+
+    /* the size of the contents, which must all be there */
+    n=1;
+    if (OPAL_SUCCESS != (rc = opal_dss_unpack_sizet(buffer, &nbytes, &n, OPAL_SIZE))) {
+        return rc;
+    }
+    if (opal_dss_too_small(buffer, nbytes)) {
+        return OPAL_ERR_UNPACK_READ_PAST_END_OF_BUFFER;
+    }
+
+    if (NULL == (view = OBJ_NEW(opal_buffer_t))) {
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+    if (0 < nbytes &&
+        OPAL_SUCCESS != (rc = opal_dss_buffer_share(buffer, view, nbytes))) {
+        OBJ_RELEASE(view);
+        return rc;
+    }
+    *dest = view;
+
+    /* as for opal_dss_unpack with too little storage */
+    return (1 < local_num) ? OPAL_ERR_UNPACK_INADEQUATE_SPACE : OPAL_SUCCESS;
+}
+
 int opal_dss_unpack_buffer(opal_buffer_t *buffer, void *dst, int32_t *num_vals,
                     opal_data_type_t type)
 {
@@ -311,7 +375,6 @@ int opal_dss_unpack_byte(opal_buffer_t *buffer, void *dest,
 int opal_dss_unpack_int16(opal_buffer_t *buffer, void *dest,
                           int32_t *num_vals, opal_data_type_t type)
 {
-    int32_t i;
     uint16_t tmp, *desttmp = (uint16_t*) dest;
 
    OPAL_OUTPUT( ( opal_dss_verbose, "opal_dss_unpack_int16 * %d\n", (int)*num_vals ) );
@@ -321,12 +384,8 @@ int opal_dss_unpack_int16(opal_buffer_t *buffer, void *dest,
     }
 
     /* unpack the data */
-    for (i = 0; i < (*num_vals); ++i) {
-        memcpy( &(tmp), buffer->unpack_ptr, sizeof(tmp) );
-        tmp = ntohs(tmp);
-        memcpy(&desttmp[i], &tmp, sizeof(tmp));
-        buffer->unpack_ptr += sizeof(tmp);
-    }
+    opal_dss_swap16(desttmp, buffer->unpack_ptr, *num_vals);
+    buffer->unpack_ptr += (*num_vals) * sizeof(tmp);
 
     return OPAL_SUCCESS;
 }
@@ -334,7 +393,6 @@ int opal_dss_unpack_int16(opal_buffer_t *buffer, void *dest,
 int opal_dss_unpack_int32(opal_buffer_t *buffer, void *dest,
                           int32_t *num_vals, opal_data_type_t type)
 {
-    int32_t i;
     uint32_t tmp, *desttmp = (uint32_t*) dest;
 
    OPAL_OUTPUT( ( opal_dss_verbose, "opal_dss_unpack_int32 * %d\n", (int)*num_vals ) );
@@ -344,12 +402,8 @@ int opal_dss_unpack_int32(opal_buffer_t *buffer, void *dest,
     }
 
     /* unpack the data */
-    for (i = 0; i < (*num_vals); ++i) {
-        memcpy( &(tmp), buffer->unpack_ptr, sizeof(tmp) );
-        tmp = ntohl(tmp);
-        memcpy(&desttmp[i], &tmp, sizeof(tmp));
-        buffer->unpack_ptr += sizeof(tmp);
-    }
+    opal_dss_swap32(desttmp, buffer->unpack_ptr, *num_vals);
+    buffer->unpack_ptr += (*num_vals) * sizeof(tmp);
 
     return OPAL_SUCCESS;
 }
@@ -357,7 +411,6 @@ int opal_dss_unpack_int32(opal_buffer_t *buffer, void *dest,
 int opal_dss_unpack_int64(opal_buffer_t *buffer, void *dest,
                           int32_t *num_vals, opal_data_type_t type)
 {
-    int32_t i;
     uint64_t tmp, *desttmp = (uint64_t*) dest;
 
    OPAL_OUTPUT( ( opal_dss_verbose, "opal_dss_unpack_int64 * %d\n", (int)*num_vals ) );
@@ -367,12 +420,8 @@ int opal_dss_unpack_int64(opal_buffer_t *buffer, void *dest,
     }
 
     /* unpack the data */
-    for (i = 0; i < (*num_vals); ++i) {
-        memcpy( &(tmp), buffer->unpack_ptr, sizeof(tmp) );
-        tmp = ntoh64(tmp);
-        memcpy(&desttmp[i], &tmp, sizeof(tmp));
-        buffer->unpack_ptr += sizeof(tmp);
-    }
+    opal_dss_swap64(desttmp, buffer->unpack_ptr, *num_vals);
+    buffer->unpack_ptr += (*num_vals) * sizeof(tmp);
 
     return OPAL_SUCCESS;
 }
@@ -1388,7 +1437,7 @@ int opal_dss_unpack_buffer_contents(opal_buffer_t *buffer, void *dest,
     opal_buffer_t **ptr;
     int32_t i, n, m;
     int ret;
-    size_t nbytes;
+    size_t nbytes, to_alloc;
 
     ptr = (opal_buffer_t **) dest;
     n = *num_vals;
@@ -1406,8 +1455,11 @@ int opal_dss_unpack_buffer_contents(opal_buffer_t *buffer, void *dest,
         }
         m = nbytes;
         /* setup the buffer's data region */
+        to_alloc = nbytes;
         if (0 < nbytes) {
-            ptr[i]->base_ptr = (char*)malloc(nbytes);
+            if (NULL == (ptr[i]->base_ptr = opal_dss_pool_alloc(&to_alloc))) {
+                return OPAL_ERR_OUT_OF_RESOURCE;
+            }
             /* unpack the bytes */
             if (OPAL_SUCCESS != (ret = opal_dss_unpack_byte(buffer, ptr[i]->base_ptr, &m, OPAL_BYTE))) {
                 return ret;
@@ -1415,7 +1467,7 @@ int opal_dss_unpack_buffer_contents(opal_buffer_t *buffer, void *dest,
         }
         ptr[i]->pack_ptr = ptr[i]->base_ptr + m;
         ptr[i]->unpack_ptr = ptr[i]->base_ptr;
-        ptr[i]->bytes_allocated = nbytes;
+        ptr[i]->bytes_allocated = to_alloc;
         ptr[i]->bytes_used = m;
     }
     return OPAL_SUCCESS;
@@ -70,6 +70,15 @@ extern "C" {
     OPAL_DECLSPEC int opal_compress_base_tar_create(char ** target);
     OPAL_DECLSPEC int opal_compress_base_tar_extract(char ** target);
 
+    /**
+     * Default block interface used when the selected component
+     * cannot compress memory blocks - always declines
+     */
+    OPAL_DECLSPEC bool opal_compress_base_compress_block(uint8_t *inbytes, size_t inlen,
+                                                         uint8_t **outbytes, size_t *olen);
+    OPAL_DECLSPEC bool opal_compress_base_decompress_block(uint8_t **outbytes, size_t olen,
+                                                           uint8_t *inbytes, size_t len);
+
 #if defined(c_plusplus) || defined(__cplusplus)
 }
 #endif
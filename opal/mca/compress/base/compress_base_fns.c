@@ -130,6 +130,18 @@ int opal_compress_base_tar_extract(char ** target)
     return exit_status;
 }
 
+bool opal_compress_base_compress_block(uint8_t *inbytes, size_t inlen,
+                                       uint8_t **outbytes, size_t *olen)
+{
+    return false;
+}
+
+bool opal_compress_base_decompress_block(uint8_t **outbytes, size_t olen,
+                                         uint8_t *inbytes, size_t len)
+{
+    return false;
+}
+
 /******************
  * Local Functions
  ******************/
@@ -29,7 +29,9 @@ opal_compress_base_module_t opal_compress = {
     NULL, /* compress         */
     NULL, /* compress_nb      */
     NULL, /* decompress       */
-    NULL  /* decompress_nb    */
+    NULL, /* decompress_nb    */
+    opal_compress_base_compress_block,  /* compress_block   */
+    opal_compress_base_decompress_block /* decompress_block */
 };
 
 opal_compress_base_component_t opal_compress_base_selected_component = {{0}};
@@ -51,13 +53,7 @@ static int opal_compress_base_register(mca_base_register_flag_t flags)
  */
 int opal_compress_base_open(mca_base_open_flag_t flags)
 {
-    /* Compression currently only used with C/R */
-    if(!opal_cr_is_enabled) {
-        opal_output_verbose(10, opal_compress_base_framework.framework_output,
-                            "compress:open: FT is not enabled, skipping!");
-        return OPAL_SUCCESS;
-    }
-
-    /* Open up all available components */
+    /* Open up all available components - the block interface is
+     * used with or without C/R */
     return mca_base_framework_components_open(&opal_compress_base_framework, flags);
 }
@@ -30,22 +30,22 @@ int opal_compress_base_select(void)
     opal_compress_base_component_t *best_component = NULL;
     opal_compress_base_module_t *best_module = NULL;
 
-    /* Compression currently only used with C/R */
-    if( !opal_cr_is_enabled ) {
-        opal_output_verbose(10, opal_compress_base_framework.framework_output,
-                            "compress:open: FT is not enabled, skipping!");
-        return OPAL_SUCCESS;
-    }
-
     /*
-     * Select the best component
+     * Select the best component. File compression is only used
+     * with C/R, but the block interface is available to everyone,
+     * so without C/R support the lack of a component is not an error
      */
     if( OPAL_SUCCESS != mca_base_select("compress", opal_compress_base_framework.framework_output,
                                         &opal_compress_base_framework.framework_components,
                                         (mca_base_module_t **) &best_module,
                                         (mca_base_component_t **) &best_component) ) {
         /* This will only happen if no component was selected */
+#if OPAL_ENABLE_FT_CR == 1
         exit_status = OPAL_ERROR;
+#else
+        opal_output_verbose(10, opal_compress_base_framework.framework_output,
+                            "compress:select: no component available, block compression disabled");
+#endif
         goto cleanup;
     }
 
@@ -59,6 +59,12 @@ int opal_compress_base_select(void)
             goto cleanup;
         }
         opal_compress = *best_module;
+        if (NULL == opal_compress.compress_block) {
+            opal_compress.compress_block = opal_compress_base_compress_block;
+        }
+        if (NULL == opal_compress.decompress_block) {
+            opal_compress.decompress_block = opal_compress_base_decompress_block;
+        }
     }
 
  cleanup:
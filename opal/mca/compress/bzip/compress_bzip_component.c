@@ -80,7 +80,11 @@ static opal_compress_base_module_t loc_module = {
 
     /** Decompress Function */
     opal_compress_bzip_decompress,
-    opal_compress_bzip_decompress_nb
+    opal_compress_bzip_decompress_nb,
+
+    /** Block Functions - not supported */
+    NULL,
+    NULL
 };
 
 static int compress_bzip_register (void)
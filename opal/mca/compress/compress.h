@@ -82,6 +82,33 @@ typedef int (*opal_compress_base_module_decompress_fn_t)
 typedef int (*opal_compress_base_module_decompress_nb_fn_t)
     (char * cname, char **fname, pid_t *child_pid);
 
+/**
+ * Compress a block of memory
+ * Arguments:
+ *   inbytes  = bytes to compress
+ *   inlen    = number of bytes to compress
+ *   outbytes = malloc'd compressed block (caller frees)
+ *   olen     = length of the compressed block
+ * Returns:
+ *   true if the block was compressed, false if compression is
+ *   unavailable or would not shrink the block
+ */
+typedef bool (*opal_compress_base_module_compress_block_fn_t)
+    (uint8_t *inbytes, size_t inlen, uint8_t **outbytes, size_t *olen);
+
+/**
+ * Decompress a block of memory
+ * Arguments:
+ *   outbytes = malloc'd decompressed block (caller frees)
+ *   olen     = length of the original, uncompressed block
+ *   inbytes  = compressed block
+ *   len      = length of the compressed block
+ * Returns:
+ *   true on success, ow false
+ */
+typedef bool (*opal_compress_base_module_decompress_block_fn_t)
+    (uint8_t **outbytes, size_t olen, uint8_t *inbytes, size_t len);
+
 /**
  * Structure for COMPRESS components.
  */
@@ -117,6 +144,10 @@ struct opal_compress_base_module_1_0_0_t {
     /** Decompress Interface */
     opal_compress_base_module_decompress_fn_t     decompress;
     opal_compress_base_module_decompress_nb_fn_t  decompress_nb;
+
+    /** In-memory block interface */
+    opal_compress_base_module_compress_block_fn_t   compress_block;
+    opal_compress_base_module_decompress_block_fn_t decompress_block;
 };
 typedef struct opal_compress_base_module_1_0_0_t opal_compress_base_module_1_0_0_t;
 typedef struct opal_compress_base_module_1_0_0_t opal_compress_base_module_t;
@@ -35,6 +35,7 @@ extern "C" {
      */
     struct opal_compress_gzip_component_t {
         opal_compress_base_component_t super;  /** Base COMPRESS component */
+        int level;                             /** zlib level for block compression */
 
     };
     typedef struct opal_compress_gzip_component_t opal_compress_gzip_component_t;
@@ -55,6 +56,12 @@ extern "C" {
     int opal_compress_gzip_compress_nb(char *fname, char **cname, char **postfix, pid_t *child_pid);
     int opal_compress_gzip_decompress(char *cname, char **fname);
     int opal_compress_gzip_decompress_nb(char *cname, char **fname, pid_t *child_pid);
+#if OPAL_COMPRESS_GZIP_HAVE_ZLIB
+    bool opal_compress_gzip_compress_block(uint8_t *inbytes, size_t inlen,
+                                           uint8_t **outbytes, size_t *olen);
+    bool opal_compress_gzip_decompress_block(uint8_t **outbytes, size_t olen,
+                                             uint8_t *inbytes, size_t len);
+#endif
 
 #if defined(c_plusplus) || defined(__cplusplus)
 }
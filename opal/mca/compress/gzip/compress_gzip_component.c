@@ -80,7 +80,16 @@ static opal_compress_base_module_t loc_module = {
 
     /** Decompress Function */
     opal_compress_gzip_decompress,
-    opal_compress_gzip_decompress_nb
+    opal_compress_gzip_decompress_nb,
+
+    /** Block Functions */
+#if OPAL_COMPRESS_GZIP_HAVE_ZLIB
+    opal_compress_gzip_compress_block,
+    opal_compress_gzip_decompress_block
+#else
+    NULL,
+    NULL
+#endif
 };
 
 static int compress_gzip_register (void)
@@ -105,6 +114,17 @@ static int compress_gzip_register (void)
                                            MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
                                            OPAL_INFO_LVL_9, MCA_BASE_VAR_SCOPE_LOCAL,
                                            &mca_compress_gzip_component.super.verbose);
+    if (0 > ret) {
+        return ret;
+    }
+
+    mca_compress_gzip_component.level = 6;
+    ret = mca_base_component_var_register (&mca_compress_gzip_component.super.base_version,
+                                           "level",
+                                           "Compression level (1-9) used for in-memory blocks",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                           OPAL_INFO_LVL_9, MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &mca_compress_gzip_component.level);
     return (0 > ret) ? ret : OPAL_SUCCESS;
 }
 
@@ -22,6 +22,9 @@
 #if HAVE_UNISTD_H
 #include <unistd.h>
 #endif  /* HAVE_UNISTD_H */
+#if OPAL_COMPRESS_GZIP_HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 #include "opal/util/opal_environ.h"
 #include "opal/util/output.h"
@@ -49,6 +52,74 @@ int opal_compress_gzip_module_finalize(void)
     return OPAL_SUCCESS;
 }
 
+#if OPAL_COMPRESS_GZIP_HAVE_ZLIB
+bool opal_compress_gzip_compress_block(uint8_t *inbytes, size_t inlen,
+                                       uint8_t **outbytes, size_t *olen)
+{
+    z_stream strm;
+    uint8_t *tmp;
+    size_t len;
+    int rc;
+
+    memset(&strm, 0, sizeof(strm));
+    if (Z_OK != deflateInit(&strm, mca_compress_gzip_component.level)) {
+        return false;
+    }
+    len = deflateBound(&strm, inlen);
+    if (NULL == (tmp = (uint8_t*)malloc(len))) {
+        deflateEnd(&strm);
+        return false;
+    }
+    strm.next_in = inbytes;
+    strm.avail_in = inlen;
+    strm.next_out = tmp;
+    strm.avail_out = len;
+    rc = deflate(&strm, Z_FINISH);
+    deflateEnd(&strm);
+
+    /* don't bother if it didn't get any smaller */
+    if (Z_STREAM_END != rc || inlen <= strm.total_out) {
+        free(tmp);
+        return false;
+    }
+    opal_output_verbose(20, mca_compress_gzip_component.super.output_handle,
+                        "compress:gzip: compress_block %lu -> %lu bytes",
+                        (unsigned long)inlen, (unsigned long)strm.total_out);
+    *outbytes = tmp;
+    *olen = strm.total_out;
+    return true;
+}
+
+bool opal_compress_gzip_decompress_block(uint8_t **outbytes, size_t olen,
+                                         uint8_t *inbytes, size_t len)
+{
+    z_stream strm;
+    uint8_t *dest;
+    int rc;
+
+    if (NULL == (dest = (uint8_t*)malloc(olen))) {
+        return false;
+    }
+    memset(&strm, 0, sizeof(strm));
+    if (Z_OK != inflateInit(&strm)) {
+        free(dest);
+        return false;
+    }
+    strm.next_in = inbytes;
+    strm.avail_in = len;
+    strm.next_out = dest;
+    strm.avail_out = olen;
+    rc = inflate(&strm, Z_FINISH);
+    inflateEnd(&strm);
+    if (Z_STREAM_END != rc || olen != strm.total_out) {
+        free(dest);
+        return false;
+    }
+    *outbytes = dest;
+    return true;
+}
+#endif
+
 int opal_compress_gzip_compress(char * fname, char **cname, char **postfix)
 {
     pid_t child_pid = 0;
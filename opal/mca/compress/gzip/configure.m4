@@ -0,0 +1,39 @@
+# -*- shell-script -*-
+#
+# Copyright (c) 2015      Intel, Inc. All rights reserved.
+#
+# $COPYRIGHT$
+#
+# Additional copyrights may follow
+#
+# $HEADER$
+#
+
+# MCA_compress_gzip_CONFIG([action-if-can-compile],
+#                          [action-if-cant-compile])
+# ------------------------------------------------
+# The file interface forks gzip and always builds; zlib is
+# only needed for the in-memory block interface.
+AC_DEFUN([MCA_opal_compress_gzip_CONFIG],[
+    AC_CONFIG_FILES([opal/mca/compress/gzip/Makefile])
+
+    OPAL_CHECK_PACKAGE([compress_gzip],
+                       [zlib.h],
+                       [z],
+                       [deflateBound],
+                       [],
+                       [],
+                       [],
+                       [compress_gzip_have_zlib=1],
+                       [compress_gzip_have_zlib=0])
+
+    AC_DEFINE_UNQUOTED([OPAL_COMPRESS_GZIP_HAVE_ZLIB],
+                       [$compress_gzip_have_zlib],
+                       [Whether the gzip compress component can compress memory blocks with zlib])
+
+    AC_SUBST([compress_gzip_CPPFLAGS])
+    AC_SUBST([compress_gzip_LDFLAGS])
+    AC_SUBST([compress_gzip_LIBS])
+
+    $1
+])dnl
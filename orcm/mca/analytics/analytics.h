@@ -79,6 +79,11 @@ BEGIN_C_DECLS
 /* initialize the module */
 typedef int (*orcm_analytics_base_module_init_fn_t)(struct orcm_analytics_base_module_t *mod);
 
+/* configure the module from the attributes of its workflow step -
+ * called once, when the workflow is created */
+typedef int (*orcm_analytics_base_module_configure_fn_t)(struct orcm_analytics_base_module_t *mod,
+                                                          orcm_workflow_step_t *wf_step);
+
 /* finalize the selected module */
 typedef void (*orcm_analytics_base_module_finalize_fn_t)(struct orcm_analytics_base_module_t *mod);
 
@@ -92,6 +97,7 @@ typedef struct {
     orcm_analytics_base_module_init_fn_t        init;
     orcm_analytics_base_module_finalize_fn_t    finalize;
     orcm_analytics_base_module_analyze_fn_t     analyze;
+    orcm_analytics_base_module_configure_fn_t   configure;
 } orcm_analytics_base_module_t;
 
 /*
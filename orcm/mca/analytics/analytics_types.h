@@ -18,14 +18,30 @@
 #include "orcm/constants.h"
 
 #include "opal/class/opal_object.h"
+#include "opal/class/opal_hash_table.h"
 #include "opal/class/opal_value_array.h"
 #include "opal/class/opal_list.h"
-#include "opal/mca/event/event.h"
+#include "opal/threads/mutex.h"
+
+#include "orte/types.h"
+#include "orte/mca/rml/rml_types.h"
+
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
 
 BEGIN_C_DECLS
 
 struct orcm_analytics_base_module_t;
 
+/* the step attributes the base acts on at every activation,
+ * compiled once when the workflow is created */
+typedef struct {
+    orte_rml_tag_t taptag;          /* 0 if the step is not tapped */
+    int ntaps;
+    orte_process_name_t *taps;      /* processes the input is copied to */
+} orcm_workflow_step_config_t;
+
 /* define a workflow "step" object - this object
  * specifies what operation is to be performed
  * on the input */
@@ -34,24 +50,42 @@ typedef struct {
     opal_list_t attributes;
     char *analytic;
     struct orcm_analytics_base_module_t *mod;
+    orcm_workflow_step_config_t config;
 } orcm_workflow_step_t;
 OBJ_CLASS_DECLARATION(orcm_workflow_step_t);
 
-/* define a workflow object */
+/* queueing statistics of a workflow */
+typedef struct {
+    uint64_t processed;         /* steps run */
+    uint32_t depth;             /* steps waiting to run */
+    uint32_t max_depth;
+    uint64_t latency_total;     /* usec from activation to start, summed */
+    uint64_t latency_max;       /* usec */
+} orcm_workflow_stats_t;
+
+/* define a workflow object - its steps are run by the shared
+ * analytics executor, one at a time and in activation order */
 typedef struct {
     opal_list_item_t super;
     char *name;
     int workflow_id;
     opal_list_t steps;
-    opal_event_base_t *ev_base;
-    bool ev_active;
+    opal_mutex_t lock;          /* protects queue, stats and the flags */
+    opal_list_t queue;          /* activated steps (caddies) waiting to run */
+    bool scheduled;             /* on a worker's run queue or running */
+    bool deleting;
+    orcm_workflow_stats_t stats;
+    int subscription;           /* sensor ingest subscription, -1 if none */
+    char *metric_pattern;       /* metrics of the subscribed sensors to take */
+    opal_hash_table_t *matches; /* interned key -> metric_pattern match */
 } orcm_workflow_t;
 OBJ_CLASS_DECLARATION(orcm_workflow_t);
 
 /* define a workflow caddy object */
 typedef struct {
-    opal_object_t super;
-    opal_event_t ev;
+    opal_list_item_t super;
+    struct timeval queued;
+    orcm_workflow_t *wf;
     orcm_workflow_step_t *wf_step;
     opal_value_array_t *data;
     struct orcm_analytics_base_module_t *imod;
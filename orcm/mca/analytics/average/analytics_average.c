@@ -12,9 +12,13 @@
 
 #include <stdio.h>
 #include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "opal/util/output.h"
 
+#include "orte/mca/errmgr/errmgr.h"
 #include "orte/util/name_fns.h"
 #include "orte/runtime/orte_globals.h"
 
@@ -29,39 +33,101 @@ mca_analytics_average_module_t orcm_analytics_average_module = {
     {
         init,
         finalize,
-        analyze
+        analyze,
+        NULL
     }
 };
 
+typedef struct {
+    uint64_t count;
+    double mean;
+} average_stream_t;
+
 static int init(struct orcm_analytics_base_module_t *imod)
 {
-#if 0
-    mca_analytics_average_module_t *mod;
-    mod = (mca_analytics_average_module_t *)imod;
-#endif
+    mca_analytics_average_module_t *mod = (mca_analytics_average_module_t *)imod;
 
+    OBJ_CONSTRUCT(&mod->streams, opal_hash_table_t);
+    opal_hash_table_init(&mod->streams, 256);
     return ORCM_SUCCESS;
 }
 
 static void finalize(struct orcm_analytics_base_module_t *imod)
 {
-#if 0
-    mca_analytics_average_module_t *mod;
-    mod = (mca_analytics_average_module_t *)imod;
-#endif
+    mca_analytics_average_module_t *mod = (mca_analytics_average_module_t *)imod;
+    average_stream_t *as;
+    void *key, *node, *next;
+    size_t keylen;
+    int rc;
 
     OPAL_OUTPUT_VERBOSE((5, orcm_analytics_base_framework.framework_output,
                          "%s analytics:average:finalize",
                          ORTE_NAME_PRINT(ORTE_PROC_MY_NAME)));
+
+    rc = opal_hash_table_get_first_key_ptr(&mod->streams, &key, &keylen,
+                                           (void**)&as, &node);
+    while (OPAL_SUCCESS == rc) {
+        free(as);
+        rc = opal_hash_table_get_next_key_ptr(&mod->streams, &key, &keylen,
+                                              (void**)&as, node, &next);
+        node = next;
+    }
+    OBJ_DESTRUCT(&mod->streams);
 }
 
 static void analyze(int sd, short args, void *cbdata)
 {
     orcm_workflow_caddy_t *caddy = (orcm_workflow_caddy_t *)cbdata;
-#if 0
-    mca_analytics_average_module_t *mod;
-    mod = (mca_analytics_average_module_t *)caddy->imod;
-#endif
+    mca_analytics_average_module_t *mod = (mca_analytics_average_module_t *)caddy->imod;
+    opal_value_array_t *out;
+    opal_value_t *kv, result;
+    average_stream_t *as;
+    double *vals;
+    size_t i, n;
+    int rc;
+
+    n = opal_value_array_get_size(caddy->data);
+    if (0 == n) {
+        OBJ_RELEASE(caddy);
+        return;
+    }
+    if (NULL == (vals = (double*)malloc(n * sizeof(double))) ||
+        NULL == (out = orcm_analytics_base_data_create(n))) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+        free(vals);
+        OBJ_RELEASE(caddy);
+        return;
+    }
+    orcm_analytics_base_data_numeric(caddy->data, vals);
+    kv = OPAL_VALUE_ARRAY_GET_BASE(caddy->data, opal_value_t);
+
+    for (i=0; i < n; i++) {
+        if (isnan(vals[i]) || NULL == kv[i].key) {
+            continue;
+        }
+        /* keys are interned, so the pointer identifies the stream */
+        if (OPAL_SUCCESS != opal_hash_table_get_value_ptr(&mod->streams, &kv[i].key,
+                                                          sizeof(char*), (void**)&as)) {
+            if (NULL == (as = (average_stream_t*)calloc(1, sizeof(average_stream_t)))) {
+                ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+                continue;
+            }
+            opal_hash_table_set_value_ptr(&mod->streams, &kv[i].key, sizeof(char*), as);
+        }
+        /* incremental mean - no running sum to overflow or drift */
+        as->count++;
+        as->mean += (vals[i] - as->mean) / (double)as->count;
+
+        memset(&result, 0, sizeof(result));
+        result.key = kv[i].key;
+        result.type = OPAL_DOUBLE;
+        result.data.dval = as->mean;
+        if (OPAL_SUCCESS != (rc = opal_value_array_append_item(out, &result))) {
+            ORTE_ERROR_LOG(rc);
+        }
+    }
+    free(vals);
 
+    orcm_analytics_base_activate_next_step(caddy, out);
     OBJ_RELEASE(caddy);
 }
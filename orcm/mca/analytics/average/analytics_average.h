@@ -18,6 +18,8 @@
 
 #include "orcm_config.h"
 
+#include "opal/class/opal_hash_table.h"
+
 #include "orcm/mca/analytics/analytics.h"
 
 BEGIN_C_DECLS
@@ -28,8 +30,11 @@ BEGIN_C_DECLS
 
 ORCM_MODULE_DECLSPEC extern orcm_analytics_base_component_t mca_analytics_average_component;
 
+/* Every sample emits the running mean of its stream since the
+ * workflow started, under the stream's key */
 typedef struct {
     orcm_analytics_base_module_t api;
+    opal_hash_table_t streams;      /* interned key -> average_stream_t */
 } mca_analytics_average_module_t;
 ORCM_DECLSPEC extern mca_analytics_average_module_t orcm_analytics_average_module;
 
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Helpers for the data that flows through a workflow. A batch is an
+ * opal_value_array_t of opal_value_t items. Item keys are interned
+ * here and live until the framework closes, so a step can copy or
+ * forward items without duplicating or freeing their keys, and can
+ * use the key pointer itself to look up per-stream state.
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "opal/class/opal_hash_table.h"
+#include "opal/threads/mutex.h"
+#include "opal/util/output.h"
+
+#include "orte/mca/errmgr/errmgr.h"
+#include "orte/util/name_fns.h"
+#include "orte/runtime/orte_globals.h"
+
+#include "orcm/mca/analytics/base/base.h"
+#include "orcm/mca/analytics/base/analytics_private.h"
+
+static opal_hash_table_t keys;
+static opal_mutex_t keys_lock;
+static bool keys_initialized = false;
+
+int orcm_analytics_base_data_init(void)
+{
+    if (keys_initialized) {
+        return ORCM_SUCCESS;
+    }
+    OBJ_CONSTRUCT(&keys_lock, opal_mutex_t);
+    OBJ_CONSTRUCT(&keys, opal_hash_table_t);
+    opal_hash_table_init(&keys, 1024);
+    keys_initialized = true;
+    return ORCM_SUCCESS;
+}
+
+void orcm_analytics_base_data_finalize(void)
+{
+    char *key;
+    void *k, *node, *next;
+    size_t keylen;
+    int rc;
+
+    if (!keys_initialized) {
+        return;
+    }
+    rc = opal_hash_table_get_first_key_ptr(&keys, &k, &keylen,
+                                           (void**)&key, &node);
+    while (OPAL_SUCCESS == rc) {
+        free(key);
+        rc = opal_hash_table_get_next_key_ptr(&keys, &k, &keylen,
+                                              (void**)&key, node, &next);
+        node = next;
+    }
+    OBJ_DESTRUCT(&keys);
+    OBJ_DESTRUCT(&keys_lock);
+    keys_initialized = false;
+}
+
+char* orcm_analytics_base_intern_key(const char *key)
+{
+    char *ikey;
+    size_t len;
+
+    if (NULL == key) {
+        return NULL;
+    }
+    len = strlen(key);
+    OPAL_THREAD_LOCK(&keys_lock);
+    if (OPAL_SUCCESS != opal_hash_table_get_value_ptr(&keys, key, len, (void**)&ikey)) {
+        if (NULL != (ikey = strdup(key))) {
+            opal_hash_table_set_value_ptr(&keys, ikey, len, ikey);
+        }
+    }
+    OPAL_THREAD_UNLOCK(&keys_lock);
+    return ikey;
+}
+
+char* orcm_analytics_base_step_attr(orcm_workflow_step_t *wf_step, const char *key)
+{
+    opal_value_t *attr;
+
+    OPAL_LIST_FOREACH(attr, &wf_step->attributes, opal_value_t) {
+        if (0 == strcmp(key, attr->key)) {
+            return attr->data.string;
+        }
+    }
+    return NULL;
+}
+
+opal_value_array_t* orcm_analytics_base_data_create(size_t nitems)
+{
+    opal_value_array_t *data;
+
+    data = OBJ_NEW(opal_value_array_t);
+    if (OPAL_SUCCESS != opal_value_array_init(data, sizeof(opal_value_t)) ||
+        (0 < nitems && OPAL_SUCCESS != opal_value_array_reserve(data, nitems))) {
+        OBJ_RELEASE(data);
+        return NULL;
+    }
+    return data;
+}
+
+int orcm_analytics_base_data_append(opal_value_array_t *data,
+                                    const char *key, double value)
+{
+    opal_value_t kv;
+
+    memset(&kv, 0, sizeof(kv));
+    if (NULL == (kv.key = orcm_analytics_base_intern_key(key))) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    kv.type = OPAL_DOUBLE;
+    kv.data.dval = value;
+    return opal_value_array_append_item(data, &kv);
+}
+
+size_t orcm_analytics_base_data_numeric(opal_value_array_t *data, double *values)
+{
+    opal_value_t *kv = OPAL_VALUE_ARRAY_GET_BASE(data, opal_value_t);
+    size_t i, n = opal_value_array_get_size(data);
+
+    for (i=0; i < n; i++) {
+        switch (kv[i].type) {
+        case OPAL_DOUBLE:
+            values[i] = kv[i].data.dval;
+            break;
+        case OPAL_FLOAT:
+            values[i] = kv[i].data.fval;
+            break;
+        case OPAL_INT:
+            values[i] = kv[i].data.integer;
+            break;
+        case OPAL_INT8:
+            values[i] = kv[i].data.int8;
+            break;
+        case OPAL_INT16:
+            values[i] = kv[i].data.int16;
+            break;
+        case OPAL_INT32:
+            values[i] = kv[i].data.int32;
+            break;
+        case OPAL_INT64:
+            values[i] = kv[i].data.int64;
+            break;
+        case OPAL_UINT:
+            values[i] = kv[i].data.uint;
+            break;
+        case OPAL_UINT8:
+            values[i] = kv[i].data.uint8;
+            break;
+        case OPAL_UINT16:
+            values[i] = kv[i].data.uint16;
+            break;
+        case OPAL_UINT32:
+            values[i] = kv[i].data.uint32;
+            break;
+        case OPAL_UINT64:
+            values[i] = kv[i].data.uint64;
+            break;
+        default:
+            /* NaN fails every comparison, so non-numeric
+             * items never pass a numeric test */
+            values[i] = NAN;
+            break;
+        }
+    }
+    return n;
+}
+
+int orcm_analytics_base_data_scratch(size_t n, size_t *nalloc,
+                                     double **values, unsigned char **mask)
+{
+    double *v;
+    unsigned char *m;
+
+    if (n <= *nalloc) {
+        return ORCM_SUCCESS;
+    }
+    if (NULL == (v = (double*)realloc(*values, n * sizeof(double)))) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    *values = v;
+    if (NULL == (m = (unsigned char*)realloc(*mask, n))) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    *mask = m;
+    *nalloc = n;
+    return ORCM_SUCCESS;
+}
+
+opal_value_array_t* orcm_analytics_base_data_select(opal_value_array_t *data,
+                                                    const unsigned char *mask)
+{
+    opal_value_array_t *out;
+    opal_value_t *src = OPAL_VALUE_ARRAY_GET_BASE(data, opal_value_t);
+    opal_value_t *dst;
+    size_t i, n = opal_value_array_get_size(data), nsel = 0;
+
+    for (i=0; i < n; i++) {
+        nsel += mask[i];
+    }
+    if (NULL == (out = orcm_analytics_base_data_create(nsel))) {
+        return NULL;
+    }
+    if (0 == nsel) {
+        return out;
+    }
+    opal_value_array_set_size(out, nsel);
+    dst = OPAL_VALUE_ARRAY_GET_BASE(out, opal_value_t);
+    for (i=0; i < n; i++) {
+        /* write unconditionally, advance only on a match */
+        memcpy(dst, &src[i], sizeof(opal_value_t));
+        dst += mask[i];
+        if (dst == OPAL_VALUE_ARRAY_GET_BASE(out, opal_value_t) + nsel) {
+            break;
+        }
+    }
+    return out;
+}
+
+void orcm_analytics_base_activate_next_step(orcm_workflow_caddy_t *caddy,
+                                            opal_value_array_t *data)
+{
+    opal_list_item_t *item;
+    orcm_workflow_t *wf = caddy->wf;
+
+    if (NULL == data) {
+        return;
+    }
+    if (NULL == wf || 0 == opal_value_array_get_size(data)) {
+        OBJ_RELEASE(data);
+        return;
+    }
+    item = opal_list_get_next(&caddy->wf_step->super);
+    if (item == opal_list_get_end(&wf->steps)) {
+        opal_output_verbose(1, orcm_analytics_base_framework.framework_output,
+                            "%s END OF WORKFLOW %d",
+                            ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), wf->workflow_id);
+        OBJ_RELEASE(data);
+        return;
+    }
+    orcm_analytics.activate_analytics_workflow_step(wf, (orcm_workflow_step_t*)item, data);
+}
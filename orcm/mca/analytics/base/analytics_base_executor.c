@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* The analytics executor. All workflows share a fixed pool of worker
+ * threads instead of each running its own progress thread. Activated
+ * steps are queued on their workflow, and a workflow with queued steps
+ * is "scheduled" - placed on the run queue of exactly one worker.
+ * Because a workflow is never on more than one run queue, or running
+ * on more than one worker, its steps run one at a time in the order
+ * they were activated. A worker takes workflows from the head of its
+ * own run queue and, when that is empty, steals from the tail of the
+ * others, so a few busy workflows do not leave threads idle.
+ *
+ * Idle workers sleep on a pthread condition - opal_condition_wait
+ * spins on opal_progress when threads are enabled.
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#include <pthread.h>
+#include <string.h>
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+#include "opal/dss/dss.h"
+#include "opal/threads/mutex.h"
+#include "opal/threads/threads.h"
+#include "opal/util/output.h"
+
+#include "orte/mca/errmgr/errmgr.h"
+#include "orte/util/name_fns.h"
+#include "orte/runtime/orte_globals.h"
+
+#include "orcm/mca/analytics/base/base.h"
+#include "orcm/mca/analytics/base/analytics_private.h"
+
+/* steps of one workflow run before it goes back on a run queue */
+#define EXECUTOR_BATCH 8
+
+typedef struct {
+    opal_thread_t thread;
+    int index;
+    opal_mutex_t lock;          /* protects the run queue */
+    orcm_workflow_t **ring;     /* run queue, size is a power of 2 */
+    size_t size;
+    size_t head, tail;          /* head <= tail, slot is index & (size-1) */
+} executor_worker_t;
+
+static executor_worker_t *workers = NULL;
+static int nworkers = 0;
+static int nstarted = 0;
+static bool running = false;
+
+/* nready is the number of workflows on all run queues; a worker
+ * claims one under the gate before it goes looking for it */
+static pthread_mutex_t gate = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+static size_t nready = 0;
+
+static int push(executor_worker_t *w, orcm_workflow_t *wf)
+{
+    orcm_workflow_t **ring;
+    size_t i, n;
+
+    opal_mutex_lock(&w->lock);
+    n = w->tail - w->head;
+    if (n == w->size) {
+        if (NULL == (ring = (orcm_workflow_t**)malloc(2 * w->size * sizeof(orcm_workflow_t*)))) {
+            opal_mutex_unlock(&w->lock);
+            return ORCM_ERR_OUT_OF_RESOURCE;
+        }
+        for (i=0; i < n; i++) {
+            ring[i] = w->ring[(w->head + i) & (w->size - 1)];
+        }
+        free(w->ring);
+        w->ring = ring;
+        w->size *= 2;
+        w->head = 0;
+        w->tail = n;
+    }
+    w->ring[w->tail++ & (w->size - 1)] = wf;
+    opal_mutex_unlock(&w->lock);
+
+    pthread_mutex_lock(&gate);
+    nready++;
+    pthread_cond_signal(&work_cond);
+    pthread_mutex_unlock(&gate);
+    return ORCM_SUCCESS;
+}
+
+static orcm_workflow_t* pop_head(executor_worker_t *w)
+{
+    orcm_workflow_t *wf = NULL;
+
+    opal_mutex_lock(&w->lock);
+    if (w->head < w->tail) {
+        wf = w->ring[w->head++ & (w->size - 1)];
+    }
+    opal_mutex_unlock(&w->lock);
+    return wf;
+}
+
+static orcm_workflow_t* steal_tail(executor_worker_t *w)
+{
+    orcm_workflow_t *wf = NULL;
+
+    opal_mutex_lock(&w->lock);
+    if (w->head < w->tail) {
+        wf = w->ring[--w->tail & (w->size - 1)];
+    }
+    opal_mutex_unlock(&w->lock);
+    return wf;
+}
+
+/* find the workflow this worker has claimed - there is at least one
+ * on some run queue for every claim, so this always ends */
+static orcm_workflow_t* take(executor_worker_t *self)
+{
+    orcm_workflow_t *wf;
+    int i;
+
+    while (1) {
+        if (NULL != (wf = pop_head(self))) {
+            return wf;
+        }
+        for (i=1; i < nworkers; i++) {
+            if (NULL != (wf = steal_tail(&workers[(self->index + i) % nworkers]))) {
+                return wf;
+            }
+        }
+    }
+}
+
+static inline uint64_t usec_since(struct timeval *then, struct timeval *now)
+{
+    int64_t d = (int64_t)(now->tv_sec - then->tv_sec) * 1000000 +
+        (now->tv_usec - then->tv_usec);
+
+    return (0 < d) ? (uint64_t)d : 0;
+}
+
+static void run(executor_worker_t *self, orcm_workflow_t *wf)
+{
+    orcm_workflow_caddy_t *batch[EXECUTOR_BATCH];
+    orcm_analytics_base_module_t *module;
+    struct timeval now;
+    uint64_t lat;
+    bool requeue, deleting;
+    int i, n = 0;
+
+    gettimeofday(&now, NULL);
+    opal_mutex_lock(&wf->lock);
+    while (!wf->deleting && n < EXECUTOR_BATCH &&
+           NULL != (batch[n] = (orcm_workflow_caddy_t*)opal_list_remove_first(&wf->queue))) {
+        lat = usec_since(&batch[n]->queued, &now);
+        wf->stats.latency_total += lat;
+        if (lat > wf->stats.latency_max) {
+            wf->stats.latency_max = lat;
+        }
+        n++;
+    }
+    wf->stats.depth -= n;
+    wf->stats.processed += n;
+    opal_mutex_unlock(&wf->lock);
+
+    for (i=0; i < n; i++) {
+        module = (orcm_analytics_base_module_t*)batch[i]->imod;
+        /* the module releases the caddy */
+        module->analyze(-1, 0, batch[i]);
+    }
+
+    opal_mutex_lock(&wf->lock);
+    deleting = wf->deleting;
+    requeue = !deleting && !opal_list_is_empty(&wf->queue);
+    if (!requeue) {
+        wf->scheduled = false;
+    }
+    opal_mutex_unlock(&wf->lock);
+
+    if (requeue) {
+        /* behind the workflows already waiting on this worker */
+        if (ORCM_SUCCESS != push(self, wf)) {
+            ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+            opal_mutex_lock(&wf->lock);
+            wf->scheduled = false;
+            opal_mutex_unlock(&wf->lock);
+        }
+    } else if (deleting) {
+        pthread_mutex_lock(&gate);
+        pthread_cond_broadcast(&done_cond);
+        pthread_mutex_unlock(&gate);
+    }
+}
+
+static void* worker_engine(opal_object_t *obj)
+{
+    opal_thread_t *thread = (opal_thread_t*)obj;
+    executor_worker_t *self = (executor_worker_t*)thread->t_arg;
+
+    while (1) {
+        pthread_mutex_lock(&gate);
+        while (running && 0 == nready) {
+            pthread_cond_wait(&work_cond, &gate);
+        }
+        if (!running) {
+            pthread_mutex_unlock(&gate);
+            break;
+        }
+        nready--;
+        pthread_mutex_unlock(&gate);
+
+        run(self, take(self));
+    }
+    return OPAL_THREAD_CANCELLED;
+}
+
+int orcm_analytics_base_executor_init(void)
+{
+    int i, rc;
+
+    if (running) {
+        return ORCM_SUCCESS;
+    }
+    nworkers = (0 < orcm_analytics_base.nthreads) ? orcm_analytics_base.nthreads : 1;
+    if (NULL == (workers = (executor_worker_t*)calloc(nworkers, sizeof(executor_worker_t)))) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    for (i=0; i < nworkers; i++) {
+        OBJ_CONSTRUCT(&workers[i].thread, opal_thread_t);
+        OBJ_CONSTRUCT(&workers[i].lock, opal_mutex_t);
+        workers[i].index = i;
+        workers[i].size = 64;
+        if (NULL == (workers[i].ring = (orcm_workflow_t**)malloc(workers[i].size *
+                                                                 sizeof(orcm_workflow_t*)))) {
+            nworkers = i + 1;
+            nstarted = 0;
+            orcm_analytics_base_executor_finalize();
+            return ORCM_ERR_OUT_OF_RESOURCE;
+        }
+    }
+
+    nready = 0;
+    running = true;
+    for (i=0; i < nworkers; i++) {
+        workers[i].thread.t_run = worker_engine;
+        workers[i].thread.t_arg = &workers[i];
+        if (OPAL_SUCCESS != (rc = opal_thread_start(&workers[i].thread))) {
+            ORTE_ERROR_LOG(rc);
+            nstarted = i;
+            orcm_analytics_base_executor_finalize();
+            return rc;
+        }
+    }
+    nstarted = nworkers;
+    opal_output_verbose(2, orcm_analytics_base_framework.framework_output,
+                        "%s analytics:base: executor running %d threads",
+                        ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), nworkers);
+    return ORCM_SUCCESS;
+}
+
+void orcm_analytics_base_executor_finalize(void)
+{
+    int i;
+
+    if (NULL == workers) {
+        return;
+    }
+    pthread_mutex_lock(&gate);
+    running = false;
+    pthread_cond_broadcast(&work_cond);
+    pthread_mutex_unlock(&gate);
+
+    for (i=0; i < nworkers; i++) {
+        if (i < nstarted) {
+            opal_thread_join(&workers[i].thread, NULL);
+        }
+        free(workers[i].ring);
+        OBJ_DESTRUCT(&workers[i].lock);
+        OBJ_DESTRUCT(&workers[i].thread);
+    }
+    free(workers);
+    workers = NULL;
+    nworkers = 0;
+    nstarted = 0;
+    nready = 0;
+}
+
+void orcm_analytics_base_executor_submit(orcm_workflow_t *wf,
+                                         orcm_workflow_caddy_t *caddy)
+{
+    orcm_analytics_base_module_t *module;
+    bool schedule = false;
+
+    if (!running) {
+        /* nothing to hand it to - run it in place */
+        module = (orcm_analytics_base_module_t*)caddy->imod;
+        module->analyze(-1, 0, caddy);
+        return;
+    }
+
+    gettimeofday(&caddy->queued, NULL);
+    opal_mutex_lock(&wf->lock);
+    if (wf->deleting) {
+        opal_mutex_unlock(&wf->lock);
+        OBJ_RELEASE(caddy);
+        return;
+    }
+    opal_list_append(&wf->queue, &caddy->super);
+    if (++wf->stats.depth > wf->stats.max_depth) {
+        wf->stats.max_depth = wf->stats.depth;
+    }
+    if (!wf->scheduled) {
+        wf->scheduled = schedule = true;
+    }
+    opal_mutex_unlock(&wf->lock);
+
+    if (schedule &&
+        ORCM_SUCCESS != push(&workers[wf->workflow_id % nworkers], wf)) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+        opal_mutex_lock(&wf->lock);
+        wf->scheduled = false;
+        opal_mutex_unlock(&wf->lock);
+    }
+}
+
+void orcm_analytics_base_executor_drain(orcm_workflow_t *wf)
+{
+    opal_list_item_t *item;
+    bool scheduled;
+
+    opal_mutex_lock(&wf->lock);
+    wf->deleting = true;
+    while (NULL != (item = opal_list_remove_first(&wf->queue))) {
+        OBJ_RELEASE(item);
+    }
+    wf->stats.depth = 0;
+    opal_mutex_unlock(&wf->lock);
+
+    if (!running) {
+        return;
+    }
+    /* wait for the worker holding it, if any, to let it go */
+    pthread_mutex_lock(&gate);
+    while (1) {
+        opal_mutex_lock(&wf->lock);
+        scheduled = wf->scheduled;
+        opal_mutex_unlock(&wf->lock);
+        if (!scheduled) {
+            break;
+        }
+        pthread_cond_wait(&done_cond, &gate);
+    }
+    pthread_mutex_unlock(&gate);
+}
+
+int orcm_analytics_base_pack_workflow_stats(opal_buffer_t *buffer)
+{
+    orcm_workflow_t *wf;
+    orcm_workflow_stats_t stats;
+    uint64_t avg;
+    int32_t n;
+    int rc;
+
+    n = (int32_t)opal_list_get_size(&orcm_analytics_base.workflows);
+    if (OPAL_SUCCESS != (rc = opal_dss.pack(buffer, &n, 1, OPAL_INT32))) {
+        return rc;
+    }
+    OPAL_LIST_FOREACH(wf, &orcm_analytics_base.workflows, orcm_workflow_t) {
+        opal_mutex_lock(&wf->lock);
+        stats = wf->stats;
+        opal_mutex_unlock(&wf->lock);
+        avg = (0 < stats.processed) ? stats.latency_total / stats.processed : 0;
+        if (OPAL_SUCCESS != (rc = opal_dss.pack(buffer, &wf->workflow_id, 1, OPAL_INT)) ||
+            OPAL_SUCCESS != (rc = opal_dss.pack(buffer, &stats.depth, 1, OPAL_UINT32)) ||
+            OPAL_SUCCESS != (rc = opal_dss.pack(buffer, &stats.max_depth, 1, OPAL_UINT32)) ||
+            OPAL_SUCCESS != (rc = opal_dss.pack(buffer, &stats.processed, 1, OPAL_UINT64)) ||
+            OPAL_SUCCESS != (rc = opal_dss.pack(buffer, &avg, 1, OPAL_UINT64)) ||
+            OPAL_SUCCESS != (rc = opal_dss.pack(buffer, &stats.latency_max, 1, OPAL_UINT64))) {
+            return rc;
+        }
+    }
+    return ORCM_SUCCESS;
+}
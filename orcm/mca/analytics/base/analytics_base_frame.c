@@ -12,9 +12,10 @@
 #include "orcm/constants.h"
 #include "orcm/types.h"
 
+#include <string.h>
+
 #include "opal/mca/mca.h"
 #include "opal/mca/base/base.h"
-#include "opal/mca/event/event.h"
 #include "opal/dss/dss.h"
 #include "opal/util/output.h"
 
@@ -23,8 +24,6 @@
 #include "orcm/mca/analytics/base/base.h"
 #include "orcm/mca/analytics/base/analytics_private.h"
 
-#include "orcm/runtime/orcm_progress.h"
-
 /*
  * The following file was created by configure.  It contains extern
  * statements and the definition of an array of pointers to each
@@ -41,12 +40,27 @@ orcm_analytics_API_module_t orcm_analytics = {
 };
 orcm_analytics_base_t orcm_analytics_base;
 
+static int orcm_analytics_base_register(mca_base_register_flag_t flags)
+{
+    orcm_analytics_base.nthreads = 4;
+    (void)mca_base_var_register("orcm", "analytics", "base", "threads",
+                                "Number of threads shared by all workflows to run their steps",
+                                MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                OPAL_INFO_LVL_9,
+                                MCA_BASE_VAR_SCOPE_READONLY,
+                                &orcm_analytics_base.nthreads);
+    return ORCM_SUCCESS;
+}
+
 static int orcm_analytics_base_close(void)
 {
     orcm_analytics_base_comm_stop();
+    orcm_analytics_base_executor_finalize();
 
     /* destruct the base objects */
     OPAL_LIST_DESTRUCT(&orcm_analytics_base.workflows);
+    orcm_analytics_base_ingest_finalize();
+    orcm_analytics_base_data_finalize();
 
     return mca_base_framework_components_close(&orcm_analytics_base_framework,
                                                NULL);
@@ -62,6 +76,13 @@ static int orcm_analytics_base_open(mca_base_open_flag_t flags)
     
     /* setup the base objects */
     OBJ_CONSTRUCT(&orcm_analytics_base.workflows, opal_list_t);
+    if (ORCM_SUCCESS != (rc = orcm_analytics_base_data_init())) {
+        return rc;
+    }
+    if (ORCM_SUCCESS != (rc = orcm_analytics_base_executor_init())) {
+        ORTE_ERROR_LOG(rc);
+        return rc;
+    }
 
     if (OPAL_SUCCESS !=
         (rc = mca_base_framework_components_open(&orcm_analytics_base_framework,
@@ -78,7 +99,7 @@ static int orcm_analytics_base_open(mca_base_open_flag_t flags)
     return rc;
 }
 
-MCA_BASE_FRAMEWORK_DECLARE(orcm, analytics, NULL, NULL,
+MCA_BASE_FRAMEWORK_DECLARE(orcm, analytics, NULL, orcm_analytics_base_register,
                            orcm_analytics_base_open, orcm_analytics_base_close,
                            mca_analytics_base_static_components, 0);
 
@@ -88,6 +109,7 @@ static void wkstep_con(orcm_workflow_step_t *p)
     OBJ_CONSTRUCT(&p->attributes, opal_list_t);
     p->analytic = NULL;
     p->mod = NULL;
+    memset(&p->config, 0, sizeof(p->config));
 }
 static void wkstep_des(orcm_workflow_step_t *p)
 {
@@ -95,6 +117,9 @@ static void wkstep_des(orcm_workflow_step_t *p)
     if (NULL != p->analytic) {
         free(p->analytic);
     }
+    if (NULL != p->config.taps) {
+        free(p->config.taps);
+    }
 }
 OBJ_CLASS_INSTANCE(orcm_workflow_step_t,
                    opal_list_item_t,
@@ -104,17 +129,24 @@ static void wk_con(orcm_workflow_t *p)
 {
     p->name = NULL;
     OBJ_CONSTRUCT(&p->steps, opal_list_t);
-    p->ev_base = NULL;
+    OBJ_CONSTRUCT(&p->lock, opal_mutex_t);
+    OBJ_CONSTRUCT(&p->queue, opal_list_t);
+    p->scheduled = false;
+    p->deleting = false;
+    memset(&p->stats, 0, sizeof(p->stats));
+    p->subscription = -1;
+    p->metric_pattern = NULL;
+    p->matches = NULL;
 }
 static void wk_des(orcm_workflow_t *p)
 {
-    if (NULL != p->ev_base) {
-        orcm_stop_progress_thread(p->name, true);
-    }
+    orcm_analytics_base_workflow_unsubscribe(p);
     if (NULL != p->name) {
         free(p->name);
     }
     OPAL_LIST_DESTRUCT(&p->steps);
+    OPAL_LIST_DESTRUCT(&p->queue);
+    OBJ_DESTRUCT(&p->lock);
 }
 OBJ_CLASS_INSTANCE(orcm_workflow_t,
                    opal_list_item_t,
@@ -122,6 +154,7 @@ OBJ_CLASS_INSTANCE(orcm_workflow_t,
 
 static void wkcaddy_con(orcm_workflow_caddy_t *p)
 {
+    p->wf = NULL;
     p->wf_step = NULL;
     p->data = NULL;
     p->imod = NULL;
@@ -132,5 +165,5 @@ static void wkcaddy_des(orcm_workflow_caddy_t *p)
     OBJ_RELEASE(p->data);
 }
 OBJ_CLASS_INSTANCE(orcm_workflow_caddy_t,
-                   opal_object_t,
+                   opal_list_item_t,
                    wkcaddy_con, wkcaddy_des);
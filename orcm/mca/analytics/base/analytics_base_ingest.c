@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Live sensor data for workflows. A workflow whose first step has a
+ * sensor=COMPONENT[:METRIC] attribute subscribes to the sensor ingest
+ * path, so samples reach it as they are logged at the aggregator -
+ * before they are stored. Each logged sample is converted once into
+ * a batch keyed "host:component:metric"; every workflow that takes
+ * all of its metrics gets a reference to that same batch, and the
+ * others a compacted copy of the items matching their pattern.
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#include <fnmatch.h>
+#include <string.h>
+
+#include "opal/class/opal_hash_table.h"
+#include "opal/util/output.h"
+
+#include "orte/mca/errmgr/errmgr.h"
+#include "orte/util/name_fns.h"
+#include "orte/runtime/orte_globals.h"
+
+#include "orcm/mca/sensor/base/sensor_private.h"
+
+#include "orcm/mca/analytics/base/base.h"
+#include "orcm/mca/analytics/base/analytics_private.h"
+
+/* the batch of the last published sample - subscriptions are
+ * called back serially, so this needs no lock */
+static uint64_t batch_seq = 0;
+static opal_value_array_t *batch = NULL;
+static size_t batch_hostlen = 0;
+static size_t nalloc = 0;
+static double *scratch = NULL;
+static unsigned char *mask = NULL;
+
+static bool is_numeric(opal_data_type_t type)
+{
+    switch (type) {
+    case OPAL_DOUBLE:
+    case OPAL_FLOAT:
+    case OPAL_INT:
+    case OPAL_INT8:
+    case OPAL_INT16:
+    case OPAL_INT32:
+    case OPAL_INT64:
+    case OPAL_UINT:
+    case OPAL_UINT8:
+    case OPAL_UINT16:
+    case OPAL_UINT32:
+    case OPAL_UINT64:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static opal_value_array_t* shared_batch(uint64_t seq, const char *component,
+                                        opal_list_t *vals)
+{
+    opal_value_t *kv, item;
+    const char *host = "";
+    char key[512];
+
+    if (NULL != batch && seq == batch_seq) {
+        return batch;
+    }
+    if (NULL != batch) {
+        OBJ_RELEASE(batch);
+    }
+
+    OPAL_LIST_FOREACH(kv, vals, opal_value_t) {
+        if (OPAL_STRING == kv->type && NULL != kv->key &&
+            0 == strcmp(kv->key, "hostname") && NULL != kv->data.string) {
+            host = kv->data.string;
+            break;
+        }
+    }
+    if (NULL == (batch = orcm_analytics_base_data_create(opal_list_get_size(vals)))) {
+        return NULL;
+    }
+    batch_seq = seq;
+    batch_hostlen = strlen(host) + 1;
+
+    OPAL_LIST_FOREACH(kv, vals, opal_value_t) {
+        if (NULL == kv->key || !is_numeric(kv->type)) {
+            continue;
+        }
+        memset(&item, 0, sizeof(item));
+        snprintf(key, sizeof(key), "%s:%s:%s", host, component, kv->key);
+        if (NULL == (item.key = orcm_analytics_base_intern_key(key))) {
+            continue;
+        }
+        item.type = kv->type;
+        memcpy(&item.data, &kv->data, sizeof(item.data));
+        opal_value_array_append_item(batch, &item);
+    }
+    return batch;
+}
+
+static void ingest(uint64_t seq, const char *component,
+                   opal_list_t *vals, void *cbdata)
+{
+    orcm_workflow_t *wf = (orcm_workflow_t*)cbdata;
+    opal_value_array_t *data, *out;
+    opal_value_t *kv;
+    void *res;
+    size_t i, n;
+
+    if (opal_list_is_empty(&wf->steps) ||
+        NULL == (data = shared_batch(seq, component, vals)) ||
+        0 == (n = opal_value_array_get_size(data))) {
+        return;
+    }
+
+    if (NULL == wf->metric_pattern) {
+        /* the whole sample - share it */
+        OBJ_RETAIN(data);
+        ORCM_ACTIVATE_WORKFLOW_STEP(wf, data);
+        return;
+    }
+
+    if (ORCM_SUCCESS != orcm_analytics_base_data_scratch(n, &nalloc, &scratch, &mask)) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+        return;
+    }
+    kv = OPAL_VALUE_ARRAY_GET_BASE(data, opal_value_t);
+    for (i=0; i < n; i++) {
+        /* keys are interned - match each one against the pattern once */
+        if (OPAL_SUCCESS != opal_hash_table_get_value_ptr(wf->matches, &kv[i].key,
+                                                          sizeof(char*), &res)) {
+            res = (0 == fnmatch(wf->metric_pattern, kv[i].key + batch_hostlen, 0)) ? (void*)2 : (void*)1;
+            opal_hash_table_set_value_ptr(wf->matches, &kv[i].key, sizeof(char*), res);
+        }
+        mask[i] = (unsigned char)((uintptr_t)res >> 1);
+    }
+    if (NULL == (out = orcm_analytics_base_data_select(data, mask))) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+        return;
+    }
+    if (0 == opal_value_array_get_size(out)) {
+        OBJ_RELEASE(out);
+        return;
+    }
+    ORCM_ACTIVATE_WORKFLOW_STEP(wf, out);
+}
+
+int orcm_analytics_base_workflow_subscribe(orcm_workflow_t *wf)
+{
+    orcm_workflow_step_t *first;
+    char *pattern, *metric, *sensor;
+    int rc;
+
+    if (opal_list_is_empty(&wf->steps)) {
+        return ORCM_SUCCESS;
+    }
+    first = (orcm_workflow_step_t*)opal_list_get_first(&wf->steps);
+    if (NULL == (pattern = orcm_analytics_base_step_attr(first, "sensor"))) {
+        return ORCM_SUCCESS;
+    }
+
+    sensor = strdup(pattern);
+    if (NULL != (metric = strchr(sensor, ':'))) {
+        *metric++ = '\0';
+        /* "component:*" takes the whole sample */
+        if (0 != strcmp(metric, "*")) {
+            wf->metric_pattern = strdup(metric);
+            wf->matches = OBJ_NEW(opal_hash_table_t);
+            opal_hash_table_init(wf->matches, 256);
+        }
+    }
+    rc = orcm_sensor_base_subscribe(sensor, ingest, wf, &wf->subscription);
+    free(sensor);
+    if (ORCM_SUCCESS != rc) {
+        wf->subscription = -1;
+        return rc;
+    }
+    opal_output_verbose(5, orcm_analytics_base_framework.framework_output,
+                        "%s analytics:base: workflow %d subscribed to %s",
+                        ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), wf->workflow_id, pattern);
+    return ORCM_SUCCESS;
+}
+
+void orcm_analytics_base_workflow_unsubscribe(orcm_workflow_t *wf)
+{
+    if (0 <= wf->subscription) {
+        orcm_sensor_base_unsubscribe(wf->subscription);
+        wf->subscription = -1;
+    }
+    if (NULL != wf->metric_pattern) {
+        free(wf->metric_pattern);
+        wf->metric_pattern = NULL;
+    }
+    if (NULL != wf->matches) {
+        OBJ_RELEASE(wf->matches);
+        wf->matches = NULL;
+    }
+}
+
+void orcm_analytics_base_ingest_finalize(void)
+{
+    if (NULL != batch) {
+        OBJ_RELEASE(batch);
+        batch = NULL;
+    }
+    free(scratch);
+    free(mask);
+    scratch = NULL;
+    mask = NULL;
+    nalloc = 0;
+}
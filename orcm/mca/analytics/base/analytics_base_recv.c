@@ -121,6 +121,12 @@ static void orcm_analytics_base_recv(int status, orte_process_name_t* sender,
             }
             rc = orcm_analytics_base_workflow_delete(id);
             break;
+        case ORCM_ANALYTICS_WORKFLOW_LIST:
+            /* queue depth and latency of each workflow */
+            if (OPAL_SUCCESS != (rc = orcm_analytics_base_pack_workflow_stats(ans))) {
+                ORTE_ERROR_LOG(rc);
+            }
+            break;
         default:
             OPAL_OUTPUT_VERBOSE((5, orcm_analytics_base_framework.framework_output,
                                  "%s analytics:base:receive got unknown command from %s",
@@ -37,6 +37,8 @@ int orcm_analytics_base_select_workflow_step(orcm_workflow_step_t *workstep)
     mca_base_component_list_item_t *cli = NULL;
     orcm_analytics_base_component_t *component = NULL;
     mca_base_component_t *basecomp = NULL;
+    orcm_analytics_base_module_t *mod;
+    int rc;
 
     /* Find requested component, and ask if it is available */
     OPAL_LIST_FOREACH(cli,
@@ -65,6 +67,18 @@ int orcm_analytics_base_select_workflow_step(orcm_workflow_step_t *workstep)
                 ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
                 return ORCM_ERR_OUT_OF_RESOURCE;
             }
+            /* configure it now so no step ever runs unconfigured */
+            mod = (orcm_analytics_base_module_t*)workstep->mod;
+            if (NULL != mod->configure &&
+                ORCM_SUCCESS != (rc = mod->configure(workstep->mod, workstep))) {
+                ORTE_ERROR_LOG(rc);
+                if (NULL != mod->finalize) {
+                    mod->finalize(workstep->mod);
+                }
+                free(mod);
+                workstep->mod = NULL;
+                return rc;
+            }
         }
     }
     
@@ -13,93 +13,115 @@
 #include "orcm/types.h"
 
 #include "opal/dss/dss.h"
-#include "opal/threads/threads.h"
+#include "opal/util/argv.h"
 #include "opal/util/output.h"
 
 #include "orte/mca/errmgr/errmgr.h"
 #include "orte/mca/rml/rml.h"
 #include "orte/util/name_fns.h"
 
-#include "orcm/runtime/orcm_progress.h"
-
 #include "orcm/mca/analytics/base/base.h"
 #include "orcm/mca/analytics/base/analytics_private.h"
 
 static int parse_attributes(opal_list_t *attr_list, char *attr_string);
-static void* progress_thread_engine(opal_object_t *obj);
 
 static int workflow_id = 0;
 
+/* copy a step's input to its taps - the data is packed once and the
+ * same buffer is handed to every send */
+static void tap(orcm_workflow_step_config_t *config, opal_value_array_t *data)
+{
+    opal_buffer_t *buf;
+    opal_value_t *kv = OPAL_VALUE_ARRAY_GET_BASE(data, opal_value_t), *ptr;
+    size_t i, n = opal_value_array_get_size(data);
+    int rc;
+
+    buf = OBJ_NEW(opal_buffer_t);
+    if (OPAL_SUCCESS != (rc = opal_dss.pack(buf, &n, 1, OPAL_SIZE))) {
+        ORTE_ERROR_LOG(rc);
+        OBJ_RELEASE(buf);
+        return;
+    }
+    for (i=0; i < n; i++) {
+        ptr = &kv[i];
+        if (OPAL_SUCCESS != (rc = opal_dss.pack(buf, &ptr, 1, OPAL_VALUE))) {
+            ORTE_ERROR_LOG(rc);
+            OBJ_RELEASE(buf);
+            return;
+        }
+    }
+
+    for (i=0; i < (size_t)config->ntaps; i++) {
+        OPAL_OUTPUT_VERBOSE((5, orcm_analytics_base_framework.framework_output,
+                             "%s analytics:base:stubs sending tap to %s",
+                             ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                             ORTE_NAME_PRINT(&config->taps[i])));
+        /* each send releases its reference when it completes */
+        OBJ_RETAIN(buf);
+        if (ORTE_SUCCESS !=
+            (rc = orte_rml.send_buffer_nb(&config->taps[i], buf, config->taptag,
+                                          orte_rml_send_callback, NULL))) {
+            ORTE_ERROR_LOG(rc);
+            OBJ_RELEASE(buf);
+        }
+    }
+    OBJ_RELEASE(buf);
+}
+
 void orcm_analytics_base_activate_analytics_workflow_step(orcm_workflow_t *wf,
                                                           orcm_workflow_step_t *wf_step,
                                                           opal_value_array_t *data) {
     orcm_workflow_caddy_t *caddy;
-    orcm_analytics_base_module_t *module = (orcm_analytics_base_module_t *)wf_step->mod;
-    opal_value_t *attr;
-    char *taphost = NULL;
-    orte_rml_tag_t taptag = 0;
-    orte_process_name_t tapproc;
-    int rc;
-    opal_buffer_t *buf;
-    
+
     caddy = OBJ_NEW(orcm_workflow_caddy_t);
     
     OBJ_RETAIN(wf_step);
+    caddy->wf = wf;
     caddy->wf_step = wf_step;
     /* data was retain'd before it got here */
     caddy->data = data;
     caddy->imod = wf_step->mod;
     
-    OPAL_LIST_FOREACH(attr, &wf_step->attributes, opal_value_t) {
-        if ((0 == strncmp("taphost", attr->key, 10)) && (!taphost)) {
-            taphost = strdup(attr->data.string);
-        }
-        if (0 == strncmp("taptag", attr->key, 10)) {
-            taptag = (orte_rml_tag_t)strtol(attr->data.string, NULL, 10);
-        }
+    if (0 < wf_step->config.ntaps) {
+        tap(&wf_step->config, data);
     }
     
-    if (taptag && taphost) {
-        /* pack data */
-        buf = OBJ_NEW(opal_buffer_t);
-        /* size */
-        if (OPAL_SUCCESS != (rc = opal_dss.pack(buf, &data->array_size,1, OPAL_SIZE))) {
-            ORTE_ERROR_LOG(rc);
-        }
-        /* data */
-        if ((OPAL_SUCCESS == rc) &&
-            (OPAL_SUCCESS !=
-             (rc = opal_dss.pack(buf, &data->array_items,
-                                 data->array_size, OPAL_VALUE)))) {
+    orcm_analytics_base_executor_submit(wf, caddy);
+}
+
+/* compile the attributes the base needs at every activation. taphost
+ * is a ';'-separated list of process names, all sent to taptag */
+static int compile_step(orcm_workflow_step_t *wf_step)
+{
+    orcm_workflow_step_config_t *config = &wf_step->config;
+    char *taphost, *tagstr, **hosts;
+    int i, n, rc;
+
+    taphost = orcm_analytics_base_step_attr(wf_step, "taphost");
+    tagstr = orcm_analytics_base_step_attr(wf_step, "taptag");
+    if (NULL == taphost || NULL == tagstr ||
+        0 == (config->taptag = (orte_rml_tag_t)strtol(tagstr, NULL, 10))) {
+        config->taptag = 0;
+        return ORCM_SUCCESS;
+    }
+
+    hosts = opal_argv_split(taphost, ';');
+    n = opal_argv_count(hosts);
+    if (NULL == (config->taps = (orte_process_name_t*)malloc(n * sizeof(orte_process_name_t)))) {
+        opal_argv_free(hosts);
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    for (i=0; i < n; i++) {
+        if (ORTE_SUCCESS !=
+            (rc = orte_util_convert_string_to_process_name(&config->taps[config->ntaps],
+                                                           hosts[i]))) {
             ORTE_ERROR_LOG(rc);
+            continue;
         }
-        
-        if (OPAL_SUCCESS == rc) {
-            if (OPAL_SUCCESS == (rc = orte_util_convert_string_to_process_name(&tapproc, taphost))) {
-                OPAL_OUTPUT_VERBOSE((5, orcm_analytics_base_framework.framework_output,
-                                     "%s analytics:base:stubs sending tap to %s",
-                                     ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                     ORTE_NAME_PRINT(&tapproc)));
-                if (ORTE_SUCCESS !=
-                    (rc = orte_rml.send_buffer_nb(&tapproc, buf, taptag,
-                                                  orte_rml_send_callback, NULL))) {
-                    ORTE_ERROR_LOG(rc);
-                }
-            } else {
-                ORTE_ERROR_LOG(rc);
-            }
-        }
-        OBJ_RELEASE(buf);
-        free(taphost);
-    } else {
-        if (taphost) {
-            free(taphost);
-        }
+        config->ntaps++;
     }
-    
-    opal_event_set(wf->ev_base, &caddy->ev, -1,
-                   OPAL_EV_WRITE, module->analyze, caddy);
-    opal_event_active(&caddy->ev, OPAL_EV_WRITE, 1);
+    opal_argv_free(hosts);
+    return ORCM_SUCCESS;
 }
 
 static int parse_attributes(opal_list_t *attr_list, char *attr_string) {
@@ -135,17 +157,6 @@ static int parse_attributes(opal_list_t *attr_list, char *attr_string) {
     return ORCM_SUCCESS;
 }
 
-static void* progress_thread_engine(opal_object_t *obj)
-{
-    opal_thread_t *thread = (opal_thread_t *)obj;
-    orcm_workflow_t *wf = (orcm_workflow_t *)thread->t_arg;
-    
-    while (wf->ev_active) {
-        opal_event_loop(wf->ev_base, OPAL_EVLOOP_ONCE);
-    }
-    return OPAL_THREAD_CANCELLED;
-}
-
 int orcm_analytics_base_workflow_create(opal_buffer_t* buffer, int *wfid)
 {
     int num_steps, i, cnt, rc;
@@ -155,7 +166,6 @@ int orcm_analytics_base_workflow_create(opal_buffer_t* buffer, int *wfid)
     opal_value_t module_name;
     opal_value_t module_attr;
     opal_value_t **values;
-    char *threadname = NULL;
     
     /* unpack the number of steps */
     cnt = 1;
@@ -169,19 +179,6 @@ int orcm_analytics_base_workflow_create(opal_buffer_t* buffer, int *wfid)
     workflow_id++;
     *wfid = wf->workflow_id;
     
-    /* create new event base for workflow */
-    asprintf(&threadname, "wfid%i", wf->workflow_id);
-    wf->ev_active = true;
-    if (NULL ==
-        (wf->ev_base = orcm_start_progress_thread(threadname,
-                                                  progress_thread_engine,
-                                                  (void *)wf))) {
-        wf->ev_active = false;
-        free(threadname);
-        return ORCM_ERR_OUT_OF_RESOURCE;
-    }
-    free(threadname);
-    
     OBJ_CONSTRUCT(&module_name, opal_value_t);
     OBJ_CONSTRUCT(&module_attr, opal_value_t);
     
@@ -204,7 +201,8 @@ int orcm_analytics_base_workflow_create(opal_buffer_t* buffer, int *wfid)
         wf_step->analytic = strdup(values[0]->data.string);
         
         if (ORCM_SUCCESS !=
-            (rc = parse_attributes(&wf_step->attributes, values[1]->data.string))) {
+            (rc = parse_attributes(&wf_step->attributes, values[1]->data.string)) ||
+            ORCM_SUCCESS != (rc = compile_step(wf_step))) {
             ORTE_ERROR_LOG(rc);
             OBJ_RELEASE(wf_step);
             goto error;
@@ -233,6 +231,11 @@ int orcm_analytics_base_workflow_create(opal_buffer_t* buffer, int *wfid)
     
     /* add workflow to the master list of workflows */
     opal_list_append(&orcm_analytics_base.workflows, &wf->super);
+
+    /* hook it up to live sensor data if it asked for any */
+    if (ORCM_SUCCESS != (rc = orcm_analytics_base_workflow_subscribe(wf))) {
+        ORTE_ERROR_LOG(rc);
+    }
     
     return ORCM_SUCCESS;
 
@@ -253,22 +256,16 @@ int orcm_analytics_base_workflow_delete(int workflow_id)
 {
     orcm_workflow_t *wf;
     orcm_workflow_t *next;
-    char *threadname = NULL;
     
     OPAL_LIST_FOREACH_SAFE(wf, next, &orcm_analytics_base.workflows, orcm_workflow_t) {
         if (workflow_id == wf->workflow_id) {
-            /* stop the event thread */
-            asprintf(&threadname, "wfid%i", wf->workflow_id);
-            if (wf->ev_active) {
-                wf->ev_active = false;
-                orcm_stop_progress_thread(threadname, true);
-            }
+            /* stop feeding it sensor data */
+            orcm_analytics_base_workflow_unsubscribe(wf);
+            /* drop its queued steps and let a running one finish */
+            orcm_analytics_base_executor_drain(wf);
             /* remove workflow from the master list */
             opal_list_remove_item(&orcm_analytics_base.workflows, &wf->super);
             OBJ_RELEASE(wf);
-            if (threadname) {
-                free(threadname);
-            }
         }
     }
     return ORCM_SUCCESS;
@@ -20,6 +20,22 @@ ORCM_DECLSPEC int orcm_analytics_base_workflow_delete(int workflow_id);
 ORCM_DECLSPEC int orcm_analytics_base_comm_start(void);
 ORCM_DECLSPEC int orcm_analytics_base_comm_stop(void);
 ORCM_DECLSPEC int orcm_analytics_base_select_workflow_step(orcm_workflow_step_t *workflow);
+ORCM_DECLSPEC int orcm_analytics_base_data_init(void);
+ORCM_DECLSPEC void orcm_analytics_base_data_finalize(void);
+/* feed a workflow from the sensor ingest path if its first step has a
+ * sensor=COMPONENT[:METRIC] attribute (shell globs) */
+ORCM_DECLSPEC int orcm_analytics_base_workflow_subscribe(orcm_workflow_t *wf);
+ORCM_DECLSPEC void orcm_analytics_base_workflow_unsubscribe(orcm_workflow_t *wf);
+ORCM_DECLSPEC void orcm_analytics_base_ingest_finalize(void);
+/* the shared worker threads that run the workflow steps */
+ORCM_DECLSPEC int orcm_analytics_base_executor_init(void);
+ORCM_DECLSPEC void orcm_analytics_base_executor_finalize(void);
+ORCM_DECLSPEC void orcm_analytics_base_executor_submit(orcm_workflow_t *wf,
+                                                       orcm_workflow_caddy_t *caddy);
+/* drop the queued steps of a workflow being deleted and wait for any
+ * step of it that is running */
+ORCM_DECLSPEC void orcm_analytics_base_executor_drain(orcm_workflow_t *wf);
+ORCM_DECLSPEC int orcm_analytics_base_pack_workflow_stats(opal_buffer_t *buffer);
 
 END_C_DECLS
 #endif
@@ -38,6 +38,8 @@ ORCM_DECLSPEC int orcm_analytics_base_send_data(opal_value_array_t *data);
 typedef struct {
     /* list of active workflows */
     opal_list_t workflows;
+    /* number of threads running the workflows */
+    int nthreads;
 } orcm_analytics_base_t;
 ORCM_DECLSPEC extern orcm_analytics_base_t orcm_analytics_base;
 
@@ -45,6 +47,32 @@ ORCM_DECLSPEC void orcm_analytics_base_activate_analytics_workflow_step(orcm_wor
                                                                         orcm_workflow_step_t *wf_step,
                                                                         opal_value_array_t *data);
 
+/* workflow data is an opal_value_array_t of opal_value_t items whose
+ * keys come from orcm_analytics_base_intern_key - they are shared
+ * and must never be freed by the holder of the data */
+ORCM_DECLSPEC char* orcm_analytics_base_intern_key(const char *key);
+/* value of a step attribute, or NULL if it was not given */
+ORCM_DECLSPEC char* orcm_analytics_base_step_attr(orcm_workflow_step_t *wf_step,
+                                                  const char *key);
+ORCM_DECLSPEC opal_value_array_t* orcm_analytics_base_data_create(size_t nitems);
+/* append a double-valued item */
+ORCM_DECLSPEC int orcm_analytics_base_data_append(opal_value_array_t *data,
+                                                  const char *key, double value);
+/* convert every item to a double into values (NaN if not numeric),
+ * returning the number of items */
+ORCM_DECLSPEC size_t orcm_analytics_base_data_numeric(opal_value_array_t *data, double *values);
+/* grow a step's reusable value and mask arrays to hold n items */
+ORCM_DECLSPEC int orcm_analytics_base_data_scratch(size_t n, size_t *nalloc,
+                                                   double **values,
+                                                   unsigned char **mask);
+/* new array of the items whose mask byte is 1 */
+ORCM_DECLSPEC opal_value_array_t* orcm_analytics_base_data_select(opal_value_array_t *data,
+                                                                  const unsigned char *mask);
+/* pass data (consumed) to the step after the one in caddy, or
+ * release it at the end of the workflow or if it is empty */
+ORCM_DECLSPEC void orcm_analytics_base_activate_next_step(orcm_workflow_caddy_t *caddy,
+                                                          opal_value_array_t *data);
+
 /* base code stubs */
 
 END_C_DECLS
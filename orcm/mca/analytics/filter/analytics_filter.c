@@ -12,9 +12,14 @@
 
 #include <stdio.h>
 #include <ctype.h>
+#include <fnmatch.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "opal/util/output.h"
 
+#include "orte/mca/errmgr/errmgr.h"
 #include "orte/util/name_fns.h"
 #include "orte/runtime/orte_globals.h"
 
@@ -24,41 +29,133 @@
 static int init(struct orcm_analytics_base_module_t *imod);
 static void finalize(struct orcm_analytics_base_module_t *imod);
 static void analyze(int sd, short args, void *cbdata);
+static int configure(struct orcm_analytics_base_module_t *imod,
+                     orcm_workflow_step_t *wf_step);
 
 mca_analytics_filter_module_t orcm_analytics_filter_module = {
     {
         init,
         finalize,
-        analyze
+        analyze,
+        configure
     }
 };
 
 static int init(struct orcm_analytics_base_module_t *imod)
 {
-#if 0
-    mca_analytics_filter_module_t *mod;
-    mod = (mca_analytics_filter_module_t *)imod;
-#endif
+    mca_analytics_filter_module_t *mod = (mca_analytics_filter_module_t *)imod;
+
+    mod->pattern = NULL;
+    mod->ranged = false;
+    mod->min = -INFINITY;
+    mod->max = INFINITY;
+    OBJ_CONSTRUCT(&mod->matches, opal_hash_table_t);
+    opal_hash_table_init(&mod->matches, 256);
+    mod->nalloc = 0;
+    mod->vals = NULL;
+    mod->mask = NULL;
     return ORCM_SUCCESS;
 }
 
 static void finalize(struct orcm_analytics_base_module_t *imod)
 {
-#if 0
-    mca_analytics_filter_module_t *mod;
-    mod = (mca_analytics_filter_module_t *)imod;
-#endif
+    mca_analytics_filter_module_t *mod = (mca_analytics_filter_module_t *)imod;
+
     OPAL_OUTPUT_VERBOSE((5, orcm_analytics_base_framework.framework_output,
                          "%s analytics:filter:finalize",
                          ORTE_NAME_PRINT(ORTE_PROC_MY_NAME)));
+    if (NULL != mod->pattern) {
+        free(mod->pattern);
+    }
+    OBJ_DESTRUCT(&mod->matches);
+    free(mod->vals);
+    free(mod->mask);
+}
+
+static int configure(struct orcm_analytics_base_module_t *imod,
+                     orcm_workflow_step_t *wf_step)
+{
+    mca_analytics_filter_module_t *mod = (mca_analytics_filter_module_t *)imod;
+    char *val;
+
+    if (NULL != (val = orcm_analytics_base_step_attr(wf_step, "key")) &&
+        NULL == (mod->pattern = strdup(val))) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    if (NULL != (val = orcm_analytics_base_step_attr(wf_step, "min"))) {
+        mod->min = strtod(val, NULL);
+        mod->ranged = true;
+    }
+    if (NULL != (val = orcm_analytics_base_step_attr(wf_step, "max"))) {
+        mod->max = strtod(val, NULL);
+        mod->ranged = true;
+    }
+    return ORCM_SUCCESS;
+}
+
+/* keys are interned, so each distinct key is matched against the
+ * pattern once and the result is cached by its address */
+static unsigned char key_matches(mca_analytics_filter_module_t *mod, char *key)
+{
+    void *res;
+
+    if (NULL == key) {
+        return 0;
+    }
+    if (OPAL_SUCCESS != opal_hash_table_get_value_ptr(&mod->matches, &key,
+                                                      sizeof(char*), &res)) {
+        res = (0 == fnmatch(mod->pattern, key, 0)) ? (void*)2 : (void*)1;
+        opal_hash_table_set_value_ptr(&mod->matches, &key, sizeof(char*), res);
+    }
+    return (unsigned char)((uintptr_t)res >> 1);
 }
 
 static void analyze(int sd, short args, void *cbdata)
 {
     orcm_workflow_caddy_t *caddy = (orcm_workflow_caddy_t *)cbdata;
-#if 0
-    mca_analytics_filter_module_t *mod;
-    mod = (mca_analytics_filter_module_t *)caddy->imod;
-#endif
+    mca_analytics_filter_module_t *mod = (mca_analytics_filter_module_t *)caddy->imod;
+    opal_value_array_t *out;
+    opal_value_t *kv;
+    double min, max, *vals;
+    unsigned char *mask;
+    size_t i, n;
+    int rc;
+
+    n = opal_value_array_get_size(caddy->data);
+    if (0 == n) {
+        OBJ_RELEASE(caddy);
+        return;
+    }
+    if (ORCM_SUCCESS != (rc = orcm_analytics_base_data_scratch(n, &mod->nalloc,
+                                                               &mod->vals, &mod->mask))) {
+        ORTE_ERROR_LOG(rc);
+        OBJ_RELEASE(caddy);
+        return;
+    }
+    vals = mod->vals;
+    mask = mod->mask;
+
+    if (mod->ranged) {
+        orcm_analytics_base_data_numeric(caddy->data, vals);
+        min = mod->min;
+        max = mod->max;
+        /* branch-free so the compiler can vectorize it - NaN fails */
+        for (i=0; i < n; i++) {
+            mask[i] = (vals[i] >= min) & (vals[i] <= max);
+        }
+    } else {
+        memset(mask, 1, n);
+    }
+    if (NULL != mod->pattern) {
+        kv = OPAL_VALUE_ARRAY_GET_BASE(caddy->data, opal_value_t);
+        for (i=0; i < n; i++) {
+            mask[i] &= key_matches(mod, kv[i].key);
+        }
+    }
+
+    if (NULL == (out = orcm_analytics_base_data_select(caddy->data, mask))) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+    }
+    orcm_analytics_base_activate_next_step(caddy, out);
     OBJ_RELEASE(caddy);
 }
@@ -18,6 +18,8 @@
 
 #include "orcm_config.h"
 
+#include "opal/class/opal_hash_table.h"
+
 #include "orcm/mca/analytics/analytics.h"
 
 BEGIN_C_DECLS
@@ -28,8 +30,19 @@ BEGIN_C_DECLS
 
 ORCM_MODULE_DECLSPEC extern orcm_analytics_base_component_t mca_analytics_filter_component;
 
+/* Step attributes:
+ *   key=GLOB         pass items whose key matches the shell pattern
+ *   min=X, max=Y     pass numeric items within [X, Y]
+ * An item must satisfy every attribute given to pass */
 typedef struct {
     orcm_analytics_base_module_t api;
+    char *pattern;
+    bool ranged;
+    double min, max;
+    opal_hash_table_t matches;      /* interned key -> match result */
+    size_t nalloc;
+    double *vals;
+    unsigned char *mask;
 } mca_analytics_filter_module_t;
 ORCM_DECLSPEC extern mca_analytics_filter_module_t orcm_analytics_filter_module;
 
@@ -12,9 +12,12 @@
 
 #include <stdio.h>
 #include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
 
 #include "opal/util/output.h"
 
+#include "orte/mca/errmgr/errmgr.h"
 #include "orte/util/name_fns.h"
 #include "orte/runtime/orte_globals.h"
 
@@ -24,41 +27,92 @@
 static int init(struct orcm_analytics_base_module_t *imod);
 static void finalize(struct orcm_analytics_base_module_t *imod);
 static void analyze(int sd, short args, void *cbdata);
+static int configure(struct orcm_analytics_base_module_t *imod,
+                     orcm_workflow_step_t *wf_step);
 
 mca_analytics_threshold_module_t orcm_analytics_threshold_module = {
     {
         init,
         finalize,
-        analyze
+        analyze,
+        configure
     }
 };
 
 static int init(struct orcm_analytics_base_module_t *imod)
 {
-#if 0
-    mca_analytics_threshold_module_t *mod;
-    mod = (mca_analytics_threshold_module_t *)imod;
-#endif
+    mca_analytics_threshold_module_t *mod = (mca_analytics_threshold_module_t *)imod;
+
+    mod->hi = INFINITY;
+    mod->lo = -INFINITY;
+    mod->nalloc = 0;
+    mod->vals = NULL;
+    mod->mask = NULL;
     return ORCM_SUCCESS;
 }
 
 static void finalize(struct orcm_analytics_base_module_t *imod)
 {
-#if 0
-    mca_analytics_threshold_module_t *mod;
-    mod = (mca_analytics_threshold_module_t *)imod;
-#endif
+    mca_analytics_threshold_module_t *mod = (mca_analytics_threshold_module_t *)imod;
+
     OPAL_OUTPUT_VERBOSE((5, orcm_analytics_base_framework.framework_output,
                          "%s analytics:threshold:finalize",
                          ORTE_NAME_PRINT(ORTE_PROC_MY_NAME)));
+    free(mod->vals);
+    free(mod->mask);
+}
+
+static int configure(struct orcm_analytics_base_module_t *imod,
+                     orcm_workflow_step_t *wf_step)
+{
+    mca_analytics_threshold_module_t *mod = (mca_analytics_threshold_module_t *)imod;
+    char *val;
+
+    if (NULL != (val = orcm_analytics_base_step_attr(wf_step, "hi"))) {
+        mod->hi = strtod(val, NULL);
+    }
+    if (NULL != (val = orcm_analytics_base_step_attr(wf_step, "lo"))) {
+        mod->lo = strtod(val, NULL);
+    }
+    return ORCM_SUCCESS;
 }
 
 static void analyze(int sd, short args, void *cbdata)
 {
     orcm_workflow_caddy_t *caddy = (orcm_workflow_caddy_t *)cbdata;
-#if 0
-    mca_analytics_threshold_module_t *mod;
-    mod = (mca_analytics_threshold_module_t *)caddy->imod;
-#endif
+    mca_analytics_threshold_module_t *mod = (mca_analytics_threshold_module_t *)caddy->imod;
+    opal_value_array_t *out;
+    double hi, lo, *vals;
+    unsigned char *mask;
+    size_t i, n;
+    int rc;
+
+    /* locals, so the compiler knows the loop can't change them */
+    hi = mod->hi;
+    lo = mod->lo;
+    n = opal_value_array_get_size(caddy->data);
+    if (0 == n) {
+        OBJ_RELEASE(caddy);
+        return;
+    }
+    if (ORCM_SUCCESS != (rc = orcm_analytics_base_data_scratch(n, &mod->nalloc,
+                                                               &mod->vals, &mod->mask))) {
+        ORTE_ERROR_LOG(rc);
+        OBJ_RELEASE(caddy);
+        return;
+    }
+    vals = mod->vals;
+    mask = mod->mask;
+    orcm_analytics_base_data_numeric(caddy->data, vals);
+
+    /* branch-free so the compiler can vectorize it - NaN fails both tests */
+    for (i=0; i < n; i++) {
+        mask[i] = (vals[i] >= hi) | (vals[i] <= lo);
+    }
+
+    if (NULL == (out = orcm_analytics_base_data_select(caddy->data, mask))) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+    }
+    orcm_analytics_base_activate_next_step(caddy, out);
     OBJ_RELEASE(caddy);
 }
@@ -28,8 +28,16 @@ BEGIN_C_DECLS
 
 ORCM_MODULE_DECLSPEC extern orcm_analytics_base_component_t mca_analytics_threshold_component;
 
+/* Step attributes:
+ *   hi=X    pass samples >= X
+ *   lo=Y    pass samples <= Y
+ * Samples inside (lo, hi) and non-numeric items are dropped */
 typedef struct {
     orcm_analytics_base_module_t api;
+    double hi, lo;
+    size_t nalloc;
+    double *vals;
+    unsigned char *mask;
 } mca_analytics_threshold_module_t;
 ORCM_DECLSPEC extern mca_analytics_threshold_module_t orcm_analytics_threshold_module;
 
@@ -1,9 +1,9 @@
 /*
  * Copyright (c) 2014      Intel, Inc. All rights reserved.
  * $COPYRIGHT$
- * 
+ *
  * Additional copyrights may follow
- * 
+ *
  * $HEADER$
  */
 
@@ -12,9 +12,12 @@
 
 #include <stdio.h>
 #include <ctype.h>
+#include <math.h>
+#include <string.h>
 
 #include "opal/util/output.h"
 
+#include "orte/mca/errmgr/errmgr.h"
 #include "orte/util/name_fns.h"
 #include "orte/runtime/orte_globals.h"
 
@@ -24,41 +27,302 @@
 static int init(struct orcm_analytics_base_module_t *imod);
 static void finalize(struct orcm_analytics_base_module_t *imod);
 static void analyze(int sd, short args, void *cbdata);
+static int configure(struct orcm_analytics_base_module_t *imod,
+                     orcm_workflow_step_t *wf_step);
 
 mca_analytics_window_module_t orcm_analytics_window_module = {
     {
         init,
         finalize,
-        analyze
+        analyze,
+        configure
     }
 };
 
+/* The last size samples of one stream. Samples are numbered by seq
+ * and sample s lives in ring[s % size]. Only the state the module's
+ * operation needs is allocated:
+ *   min/max - a monotonic deque of sample numbers whose values are
+ *             increasing (min) or decreasing (max); its front is the
+ *             extreme of the window
+ *   mean/stddev - running sums, recomputed from the ring once per
+ *             lap to stop rounding drift
+ *   percentile - a fixed-range histogram of the window */
+typedef struct {
+    uint64_t seq;
+    double *ring;
+    double sum, sumsq;
+    uint64_t *dq;
+    uint64_t dq_head, dq_tail;
+    uint32_t *hist;
+} window_stream_t;
+
 static int init(struct orcm_analytics_base_module_t *imod)
 {
-#if 0
-    mca_analytics_window_module_t *mod;
-    mod = (mca_analytics_window_module_t*)imod;
-#endif
+    mca_analytics_window_module_t *mod = (mca_analytics_window_module_t*)imod;
+
+    mod->op = WINDOW_MEAN;
+    mod->size = 60;
+    mod->percentile = 50.0;
+    mod->hist_min = 0.0;
+    mod->hist_max = 100.0;
+    mod->nbins = 100;
+    OBJ_CONSTRUCT(&mod->streams, opal_hash_table_t);
+    opal_hash_table_init(&mod->streams, 256);
     return ORCM_SUCCESS;
 }
 
 static void finalize(struct orcm_analytics_base_module_t *imod)
 {
-#if 0
-    mca_analytics_window_module_t *mod;
-    mod = (mca_analytics_window_module_t*)imod;
-#endif
+    mca_analytics_window_module_t *mod = (mca_analytics_window_module_t*)imod;
+    window_stream_t *ws;
+    void *key, *node, *next;
+    size_t keylen;
+    int rc;
+
     OPAL_OUTPUT_VERBOSE((5, orcm_analytics_base_framework.framework_output,
                          "%s analytics:window:finalize",
                          ORTE_NAME_PRINT(ORTE_PROC_MY_NAME)));
+
+    rc = opal_hash_table_get_first_key_ptr(&mod->streams, &key, &keylen,
+                                           (void**)&ws, &node);
+    while (OPAL_SUCCESS == rc) {
+        free(ws->ring);
+        free(ws->dq);
+        free(ws->hist);
+        free(ws);
+        rc = opal_hash_table_get_next_key_ptr(&mod->streams, &key, &keylen,
+                                              (void**)&ws, node, &next);
+        node = next;
+    }
+    OBJ_DESTRUCT(&mod->streams);
+}
+
+static int configure(struct orcm_analytics_base_module_t *imod,
+                     orcm_workflow_step_t *wf_step)
+{
+    mca_analytics_window_module_t *mod = (mca_analytics_window_module_t *)imod;
+    char *val;
+
+    if (NULL != (val = orcm_analytics_base_step_attr(wf_step, "size")) &&
+        0 < strtol(val, NULL, 10)) {
+        mod->size = (int)strtol(val, NULL, 10);
+    }
+    if (NULL != (val = orcm_analytics_base_step_attr(wf_step, "compute"))) {
+        if (0 == strcasecmp(val, "min")) {
+            mod->op = WINDOW_MIN;
+        } else if (0 == strcasecmp(val, "max")) {
+            mod->op = WINDOW_MAX;
+        } else if (0 == strcasecmp(val, "mean") || 0 == strcasecmp(val, "average")) {
+            mod->op = WINDOW_MEAN;
+        } else if (0 == strcasecmp(val, "stddev")) {
+            mod->op = WINDOW_STDDEV;
+        } else if ('p' == tolower(val[0]) && isdigit(val[1])) {
+            mod->op = WINDOW_PERCENTILE;
+            mod->percentile = strtod(&val[1], NULL);
+        } else {
+            opal_output(0, "%s analytics:window: unknown operation %s - using mean",
+                        ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), val);
+        }
+    }
+    if (NULL != (val = orcm_analytics_base_step_attr(wf_step, "min"))) {
+        mod->hist_min = strtod(val, NULL);
+    }
+    if (NULL != (val = orcm_analytics_base_step_attr(wf_step, "max"))) {
+        mod->hist_max = strtod(val, NULL);
+    }
+    if (NULL != (val = orcm_analytics_base_step_attr(wf_step, "bins")) &&
+        0 < strtol(val, NULL, 10)) {
+        mod->nbins = (int)strtol(val, NULL, 10);
+    }
+    if (mod->hist_max <= mod->hist_min) {
+        mod->hist_max = mod->hist_min + 1.0;
+    }
+    return ORCM_SUCCESS;
+}
+
+static window_stream_t* stream_create(mca_analytics_window_module_t *mod)
+{
+    window_stream_t *ws;
+
+    if (NULL == (ws = (window_stream_t*)calloc(1, sizeof(window_stream_t)))) {
+        return NULL;
+    }
+    ws->ring = (double*)calloc(mod->size, sizeof(double));
+    if (WINDOW_MIN == mod->op || WINDOW_MAX == mod->op) {
+        ws->dq = (uint64_t*)malloc(mod->size * sizeof(uint64_t));
+    } else if (WINDOW_PERCENTILE == mod->op) {
+        ws->hist = (uint32_t*)calloc(mod->nbins, sizeof(uint32_t));
+    }
+    if (NULL == ws->ring ||
+        ((WINDOW_MIN == mod->op || WINDOW_MAX == mod->op) && NULL == ws->dq) ||
+        (WINDOW_PERCENTILE == mod->op && NULL == ws->hist)) {
+        free(ws->ring);
+        free(ws->dq);
+        free(ws->hist);
+        free(ws);
+        return NULL;
+    }
+    return ws;
+}
+
+static inline int hist_bin(mca_analytics_window_module_t *mod, double v)
+{
+    int b = (int)((v - mod->hist_min) * mod->nbins / (mod->hist_max - mod->hist_min));
+
+    return (b < 0) ? 0 : ((b >= mod->nbins) ? mod->nbins - 1 : b);
+}
+
+/* add one sample, evicting the one that falls out of the window */
+static void stream_push(mca_analytics_window_module_t *mod,
+                        window_stream_t *ws, double v)
+{
+    uint64_t s = ws->seq;
+    uint64_t size = (uint64_t)mod->size;
+    size_t slot = s % size;
+    double old = ws->ring[slot];
+    bool full = (s >= size);
+    uint64_t i;
+
+    switch (mod->op) {
+    case WINDOW_MIN:
+    case WINDOW_MAX:
+        /* drop the front if it just left the window - this has to
+         * happen before its slot in the ring is overwritten */
+        if (ws->dq_head < ws->dq_tail && ws->dq[ws->dq_head % size] + size <= s) {
+            ws->dq_head++;
+        }
+        ws->ring[slot] = v;
+        /* drop every sample the new one dominates */
+        while (ws->dq_head < ws->dq_tail) {
+            double back = ws->ring[ws->dq[(ws->dq_tail - 1) % size] % size];
+            if ((WINDOW_MIN == mod->op) ? (back < v) : (back > v)) {
+                break;
+            }
+            ws->dq_tail--;
+        }
+        ws->dq[ws->dq_tail++ % size] = s;
+        break;
+    case WINDOW_MEAN:
+    case WINDOW_STDDEV:
+        ws->ring[slot] = v;
+        if (full) {
+            ws->sum -= old;
+            ws->sumsq -= old * old;
+        }
+        ws->sum += v;
+        ws->sumsq += v * v;
+        if (full && 0 == slot) {
+            ws->sum = ws->sumsq = 0.0;
+            for (i=0; i < size; i++) {
+                ws->sum += ws->ring[i];
+                ws->sumsq += ws->ring[i] * ws->ring[i];
+            }
+        }
+        break;
+    case WINDOW_PERCENTILE:
+        if (full) {
+            ws->hist[hist_bin(mod, old)]--;
+        }
+        ws->ring[slot] = v;
+        ws->hist[hist_bin(mod, v)]++;
+        break;
+    }
+    ws->seq++;
+}
+
+static double stream_value(mca_analytics_window_module_t *mod, window_stream_t *ws)
+{
+    double n = (double)mod->size, var, width;
+    uint64_t target, cum = 0;
+    int b;
+
+    switch (mod->op) {
+    case WINDOW_MIN:
+    case WINDOW_MAX:
+        return ws->ring[ws->dq[ws->dq_head % mod->size] % mod->size];
+    case WINDOW_MEAN:
+        return ws->sum / n;
+    case WINDOW_STDDEV:
+        if (1 >= mod->size) {
+            return 0.0;
+        }
+        var = (ws->sumsq - ws->sum * ws->sum / n) / (n - 1.0);
+        return (0.0 < var) ? sqrt(var) : 0.0;
+    case WINDOW_PERCENTILE:
+        target = (uint64_t)ceil(mod->percentile / 100.0 * mod->size);
+        if (0 == target) {
+            target = 1;
+        }
+        width = (mod->hist_max - mod->hist_min) / mod->nbins;
+        for (b=0; b < mod->nbins; b++) {
+            cum += ws->hist[b];
+            if (cum >= target) {
+                break;
+            }
+        }
+        if (b == mod->nbins) {
+            b--;
+        }
+        /* report the middle of the bin */
+        return mod->hist_min + (b + 0.5) * width;
+    }
+    return 0.0;
 }
 
 static void analyze(int sd, short args, void *cbdata)
 {
     orcm_workflow_caddy_t *caddy = (orcm_workflow_caddy_t *)cbdata;
-#if 0
-    mca_analytics_window_module_t *mod;
-    mod = (mca_analytics_window_module_t*)caddy->imod;
-#endif
+    mca_analytics_window_module_t *mod = (mca_analytics_window_module_t*)caddy->imod;
+    opal_value_t *kv, result;
+    opal_value_array_t *out;
+    window_stream_t *ws;
+    double *vals;
+    size_t i, n;
+    int rc;
+
+    n = opal_value_array_get_size(caddy->data);
+    if (0 == n) {
+        OBJ_RELEASE(caddy);
+        return;
+    }
+    if (NULL == (vals = (double*)malloc(n * sizeof(double))) ||
+        NULL == (out = orcm_analytics_base_data_create(n))) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+        free(vals);
+        OBJ_RELEASE(caddy);
+        return;
+    }
+    orcm_analytics_base_data_numeric(caddy->data, vals);
+    kv = OPAL_VALUE_ARRAY_GET_BASE(caddy->data, opal_value_t);
+
+    for (i=0; i < n; i++) {
+        if (isnan(vals[i]) || NULL == kv[i].key) {
+            continue;
+        }
+        /* keys are interned, so the pointer identifies the stream */
+        if (OPAL_SUCCESS != opal_hash_table_get_value_ptr(&mod->streams, &kv[i].key,
+                                                          sizeof(char*), (void**)&ws)) {
+            if (NULL == (ws = stream_create(mod))) {
+                ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+                continue;
+            }
+            opal_hash_table_set_value_ptr(&mod->streams, &kv[i].key, sizeof(char*), ws);
+        }
+        stream_push(mod, ws, vals[i]);
+        if (ws->seq < (uint64_t)mod->size) {
+            continue;
+        }
+        memset(&result, 0, sizeof(result));
+        result.key = kv[i].key;
+        result.type = OPAL_DOUBLE;
+        result.data.dval = stream_value(mod, ws);
+        if (OPAL_SUCCESS != (rc = opal_value_array_append_item(out, &result))) {
+            ORTE_ERROR_LOG(rc);
+        }
+    }
+    free(vals);
+
+    orcm_analytics_base_activate_next_step(caddy, out);
     OBJ_RELEASE(caddy);
 }
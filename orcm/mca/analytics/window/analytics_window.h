@@ -18,6 +18,8 @@
 
 #include "orcm_config.h"
 
+#include "opal/class/opal_hash_table.h"
+
 #include "orcm/mca/analytics/analytics.h"
 
 BEGIN_C_DECLS
@@ -28,8 +30,29 @@ BEGIN_C_DECLS
 
 ORCM_MODULE_DECLSPEC extern orcm_analytics_base_component_t mca_analytics_window_component;
 
+typedef enum {
+    WINDOW_MIN,
+    WINDOW_MAX,
+    WINDOW_MEAN,
+    WINDOW_STDDEV,
+    WINDOW_PERCENTILE
+} window_op_t;
+
+/* Step attributes:
+ *   size=N         samples in the window (default 60)
+ *   compute=OP     min, max, mean, stddev or pNN (e.g. p95)
+ *   min=X, max=Y   value range of the percentile histogram
+ *   bins=N         percentile histogram resolution (default 100)
+ * Once a stream's window is full, every new sample emits the
+ * aggregate of the window under the stream's key */
 typedef struct {
     orcm_analytics_base_module_t api;
+    window_op_t op;
+    int size;
+    double percentile;
+    double hist_min, hist_max;
+    int nbins;
+    opal_hash_table_t streams;      /* interned key -> window_stream_t */
 } mca_analytics_window_module_t;
 ORCM_DECLSPEC extern mca_analytics_window_module_t orcm_analytics_window_module;
 
@@ -143,6 +143,12 @@ static void print_xml_structure( char ** in_items, unsigned long in_sz_hierarchy
                                  unsigned long * in_hier_row_length,
                                  long ** in_hierarchy);
 
+/* the XML as it was when we read it, and our node if we were
+ * defined from the compiled image instead */
+static struct stat xml_stat;
+static bool have_xml_stat = false;
+static orcm_node_t *image_node = NULL;
+
 static int file30_init(void)
 {
     char * text = NULL;  /* Owns the array */
@@ -163,6 +169,16 @@ static int file30_init(void)
             break;
         }
 
+        /* a daemon with a current compiled image needn't lex the XML */
+        if (ORTE_PROC_IS_DAEMON && NULL != mca_cfgi_file30_component.cache &&
+            ORCM_SUCCESS == orcm_cfgi_file30_cache_open(mca_cfgi_file30_component.cache,
+                                                        orcm_cfgi_base.config_file)) {
+            opal_output_verbose(V_LO, orcm_cfgi_base_framework.framework_output,
+                                "USING COMPILED CONFIG IMAGE %s",
+                                mca_cfgi_file30_component.cache);
+            return ORCM_SUCCESS;
+        }
+
         erri = lex_xml(orcm_cfgi_base.config_file,&text,&items,&sz_items);
         if (ORCM_SUCCESS != erri) {
             opal_output_verbose(V_LO, orcm_cfgi_base_framework.framework_output,
@@ -234,6 +250,11 @@ static int file30_init(void)
 
 static void file30_finalize(void)
 {
+    orcm_cfgi_file30_cache_close();
+    if (NULL != image_node) {
+        OBJ_RELEASE(image_node);
+        image_node = NULL;
+    }
 }
 
 static int parse_config(char ** in_items,
@@ -241,6 +262,7 @@ static int parse_config(char ** in_items,
                         opal_list_t *io_config);
 static bool check_me(orcm_config_t *config, char *node,
                      orte_vpid_t vpid, char *my_ip);
+static void set_me(orcm_config_t *config, orte_vpid_t vpid);
 
 static int read_config(opal_list_t *config)
 {
@@ -256,6 +278,11 @@ static int read_config(opal_list_t *config)
 
     int erri = ORCM_SUCCESS;
 
+    /* define_system takes it all from the image */
+    if (orcm_cfgi_file30_cache_mapped()) {
+        return ORCM_SUCCESS;
+    }
+
     /*Check if the file exist*/     /*TODO: Use something more robust than fopen */
     fp = fopen(orcm_cfgi_base.config_file, "r");
     if (NULL == fp) {
@@ -270,6 +297,9 @@ static int read_config(opal_list_t *config)
         fp = NULL;
     }
 
+    /* remember what we read for the compiled image */
+    have_xml_stat = (0 == stat(orcm_cfgi_base.config_file, &xml_stat));
+
     while (ORCM_SUCCESS == erri) {
         erri = lex_xml(orcm_cfgi_base.config_file, &text, &items, &sz_items);
         if (ORCM_SUCCESS != erri) {
@@ -377,6 +407,20 @@ static int define_system(opal_list_t *config,
         }
     }
 
+    if (orcm_cfgi_file30_cache_mapped()) {
+        rc = orcm_cfgi_file30_cache_define(my_ip, &image_node, num_procs, buf);
+        orcm_cfgi_file30_cache_close();
+        if (ORCM_SUCCESS != rc) {
+            ORTE_ERROR_LOG(rc);
+            return rc;
+        }
+        if (NULL != image_node) {
+            set_me(&image_node->config, image_node->daemon.vpid);
+            *mynode = image_node;
+        }
+        return ORCM_SUCCESS;
+    }
+
     OPAL_LIST_FOREACH(xx, config, orcm_cfgi_xml_parser_t) {
         if (0 == strcmp(xx->name, "configuration")) {
             OPAL_LIST_FOREACH(x, &xx->subvals, orcm_cfgi_xml_parser_t) {
@@ -567,6 +611,16 @@ static int define_system(opal_list_t *config,
     OBJ_DESTRUCT(&uribuf);
     OBJ_DESTRUCT(&clusterbuf);
 
+    /* compile what the daemons need into an image for them */
+    if (ORTE_PROC_IS_SCHEDULER && NULL != mca_cfgi_file30_component.cache && have_xml_stat &&
+        ORCM_SUCCESS != (rc = orcm_cfgi_file30_cache_write(mca_cfgi_file30_component.cache,
+                                                           &xml_stat, *num_procs, buf))) {
+        /* the daemons can still read the XML */
+        opal_output_verbose(V_LO, orcm_cfgi_base_framework.framework_output,
+                            "FAILED TO WRITE CONFIG IMAGE %s: %d",
+                            mca_cfgi_file30_component.cache, rc);
+    }
+
     return ORCM_SUCCESS;
 }
 
@@ -1040,41 +1094,38 @@ static int parse_config(char ** in_items,
     return erri;
 }
 
-static bool check_me(orcm_config_t *config, char *node,
-                     orte_vpid_t vpid, char *my_ip)
+/* take on the identity the config gives this node */
+static void set_me(orcm_config_t *config, orte_vpid_t vpid)
 {
     char *uri;
 
+    ORTE_PROC_MY_NAME->vpid = vpid;
+    if (config->aggregator) {
+        orte_process_info.proc_type = ORCM_AGGREGATOR;
+    }
+    setup_environ(config->mca_params);
+    /* load our port */
+    asprintf(&uri, OPAL_MCA_PREFIX"oob_tcp_static_ipv4_ports=%s", config->port);
+    putenv(uri);  // cannot free this value
+    opal_output_verbose(2, orcm_cfgi_base_framework.framework_output,
+                        "push our port %s", uri);
+}
+
+static bool check_me(orcm_config_t *config, char *node,
+                     orte_vpid_t vpid, char *my_ip)
+{
     if (NULL == node) {
         return false;
     }
 
     if (opal_net_isaddr(node)) {
         if (0 == strcmp(node, my_ip)) {
-            ORTE_PROC_MY_NAME->vpid = vpid;
-            setup_environ(config->mca_params);
-            if (config->aggregator) {
-                orte_process_info.proc_type = ORCM_AGGREGATOR;
-            }
-            /* load our port */
-            asprintf(&uri, OPAL_MCA_PREFIX"oob_tcp_static_ipv4_ports=%s", config->port);
-            putenv(uri);  // cannot free this value
-            opal_output_verbose(2, orcm_cfgi_base_framework.framework_output,
-                                "push our port %s", uri);
-           return true;
+            set_me(config, vpid);
+            return true;
         }
     } else {
         if (0 == strcmp(node, orte_process_info.nodename)) {
-            ORTE_PROC_MY_NAME->vpid = vpid;
-            if (config->aggregator) {
-                orte_process_info.proc_type = ORCM_AGGREGATOR;
-            }
-            setup_environ(config->mca_params);
-            /* load our port */
-            asprintf(&uri, OPAL_MCA_PREFIX"oob_tcp_static_ipv4_ports=%s", config->port);
-            putenv(uri);  // cannot free this value
-            opal_output_verbose(2, orcm_cfgi_base_framework.framework_output,
-                                "push our port %s", uri);
+            set_me(config, vpid);
             return true;
         }
     }
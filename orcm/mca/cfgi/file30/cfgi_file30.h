@@ -10,9 +10,33 @@
 #ifndef CFGI_FILE30_H
 #define CFGI_FILE30_H
 
+#include <sys/stat.h>
+
+#include "opal/dss/dss_types.h"
+
 #include "orcm/mca/cfgi/cfgi.h"
 
-ORCM_DECLSPEC extern orcm_cfgi_base_component_t mca_cfgi_file30_component;
+BEGIN_C_DECLS
+
+typedef struct {
+    orcm_cfgi_base_component_t super;
+    char *cache;     /* path of the compiled binary image of the config, if any */
+} orcm_cfgi_file30_component_t;
+
+ORCM_DECLSPEC extern orcm_cfgi_file30_component_t mca_cfgi_file30_component;
 ORCM_DECLSPEC extern orcm_cfgi_base_module_t orcm_cfgi_file30_module;
 
+/* compiled config image - see cfgi_file30_cache.c */
+int orcm_cfgi_file30_cache_open(const char *image, const char *xml);
+bool orcm_cfgi_file30_cache_mapped(void);
+int orcm_cfgi_file30_cache_define(const char *my_ip,
+                                  orcm_node_t **mynode,
+                                  orte_vpid_t *num_procs,
+                                  opal_buffer_t *buf);
+void orcm_cfgi_file30_cache_close(void);
+int orcm_cfgi_file30_cache_write(const char *image, const struct stat *xml,
+                                 orte_vpid_t num_procs, opal_buffer_t *buf);
+
+END_C_DECLS
+
 #endif /* CFGI_FILE30_H */
@@ -0,0 +1,525 @@
+/*
+ * Copyright (c) 2015      Intel, Inc.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Compiled configuration image.
+ *
+ * The scheduler parses the XML configuration anyway, so once it has
+ * defined the system it writes what every daemon would otherwise
+ * work out for itself into a binary image: the packed cluster
+ * definition and contact info define_system hands back, the
+ * scheduler names, and for each daemon its vpid and the settings
+ * check_me applies, found through a hash index on the node name.
+ * A daemon maps the image and looks itself up in O(1) instead of
+ * lexing and parsing the whole XML file.
+ *
+ * The image records the size, mtime and inode of the XML it was
+ * compiled from, and is only used while they still match - any
+ * other image, including one from another version of this code,
+ * is ignored and the daemon falls back to the XML. Values are in
+ * host byte order, so an image is only read by hosts of the same
+ * byte order as the one that wrote it - the magic fails to match
+ * on any other.
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif  /* HAVE_UNISTD_H */
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif  /* HAVE_STRING_H */
+
+#include "opal/dss/dss.h"
+#include "opal/util/argv.h"
+#include "opal/util/net.h"
+#include "opal/util/output.h"
+
+#include "orte/mca/errmgr/errmgr.h"
+#include "orte/runtime/orte_globals.h"
+
+#include "orcm/runtime/orcm_globals.h"
+
+#include "orcm/mca/cfgi/base/base.h"
+#include "orcm/mca/cfgi/file30/cfgi_file30.h"
+
+#define IMAGE_MAGIC       0x4f434647    /* "OCFG" */
+#define IMAGE_VERSION     1
+
+#define IMAGE_AGGREGATOR  0x01
+#define IMAGE_ADDR        0x02          /* the name is an IP address */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t xml_size;      /* the XML file the image was compiled from */
+    int64_t xml_mtime;
+    uint64_t xml_ino;
+    uint32_t buf_type;      /* DSS buffer type of the system definition */
+    uint32_t num_procs;
+    uint32_t nscheds;
+    uint32_t nentries;
+    uint32_t nslots;        /* a power of two */
+    uint32_t naddrs;        /* entries named by IP address */
+    uint64_t scheds;        /* offsets from the start of the image */
+    uint64_t entries;
+    uint64_t slots;
+    uint64_t strings;
+    uint64_t strings_size;
+    uint64_t system;
+    uint64_t system_size;
+    uint64_t size;
+} image_header_t;
+
+/* a daemon, in vpid order - the strings are offsets into the
+ * string table, where 0 is the empty string */
+typedef struct {
+    uint32_t name;
+    uint32_t port;
+    uint32_t params;        /* NUL separated, ending in an empty string */
+    uint32_t vpid;
+    uint32_t flags;
+} image_entry_t;
+
+static char *image = NULL;
+static size_t image_size = 0;
+
+static uint32_t hash_name(const char *name)
+{
+    uint32_t h = 2166136261u;
+
+    while ('\0' != *name) {
+        h = (h ^ (unsigned char)*name++) * 16777619u;
+    }
+    return h;
+}
+
+static bool in_image(uint64_t offset, uint64_t len, const image_header_t *hdr)
+{
+    return offset <= hdr->size && len <= hdr->size - offset;
+}
+
+int orcm_cfgi_file30_cache_open(const char *path, const char *xml)
+{
+    image_header_t *hdr;
+    struct stat st, xst;
+    opal_buffer_t tmp;
+    uint32_t buf_type;
+    void *ptr;
+    int fd;
+
+    orcm_cfgi_file30_cache_close();
+    if (NULL == path || NULL == xml || 0 != stat(xml, &xst)) {
+        return ORCM_ERR_NOT_FOUND;
+    }
+    if (0 > (fd = open(path, O_RDONLY))) {
+        return ORCM_ERR_NOT_FOUND;
+    }
+    if (0 != fstat(fd, &st) || (size_t)st.st_size < sizeof(image_header_t)) {
+        close(fd);
+        return ORCM_ERR_NOT_FOUND;
+    }
+    ptr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == ptr) {
+        return ORCM_ERR_NOT_FOUND;
+    }
+    image = (char*)ptr;
+    image_size = st.st_size;
+
+    OBJ_CONSTRUCT(&tmp, opal_buffer_t);
+    buf_type = tmp.type;
+    OBJ_DESTRUCT(&tmp);
+
+    hdr = (image_header_t*)image;
+    if (IMAGE_MAGIC != hdr->magic || IMAGE_VERSION != hdr->version ||
+        hdr->size != image_size || buf_type != hdr->buf_type ||
+        0 == hdr->nslots || 0 != (hdr->nslots & (hdr->nslots - 1)) ||
+        !in_image(hdr->scheds, (uint64_t)hdr->nscheds * sizeof(image_entry_t), hdr) ||
+        !in_image(hdr->entries, (uint64_t)hdr->nentries * sizeof(image_entry_t), hdr) ||
+        !in_image(hdr->slots, (uint64_t)hdr->nslots * sizeof(uint32_t), hdr) ||
+        !in_image(hdr->strings, hdr->strings_size, hdr) || 0 == hdr->strings_size ||
+        '\0' != image[hdr->strings + hdr->strings_size - 1] ||
+        !in_image(hdr->system, hdr->system_size, hdr)) {
+        opal_output_verbose(2, orcm_cfgi_base_framework.framework_output,
+                            "cfgi:file30 image %s is not usable", path);
+        orcm_cfgi_file30_cache_close();
+        return ORCM_ERR_NOT_FOUND;
+    }
+    if ((uint64_t)xst.st_size != hdr->xml_size || (int64_t)xst.st_mtime != hdr->xml_mtime ||
+        (uint64_t)xst.st_ino != hdr->xml_ino) {
+        opal_output_verbose(2, orcm_cfgi_base_framework.framework_output,
+                            "cfgi:file30 image %s is older than %s", path, xml);
+        orcm_cfgi_file30_cache_close();
+        return ORCM_ERR_NOT_FOUND;
+    }
+    return ORCM_SUCCESS;
+}
+
+bool orcm_cfgi_file30_cache_mapped(void)
+{
+    return NULL != image;
+}
+
+void orcm_cfgi_file30_cache_close(void)
+{
+    if (NULL != image) {
+        munmap(image, image_size);
+        image = NULL;
+        image_size = 0;
+    }
+}
+
+static const char* image_string(const image_header_t *hdr, uint32_t offset)
+{
+    if (offset >= hdr->strings_size) {
+        return "";
+    }
+    return image + hdr->strings + offset;
+}
+
+/* the first daemon of that name and kind, which is the one with
+ * the lowest vpid as they went into the index in vpid order */
+static const image_entry_t* lookup(const image_header_t *hdr, const char *name,
+                                   uint32_t addr)
+{
+    const image_entry_t *entries = (const image_entry_t*)(image + hdr->entries);
+    const uint32_t *slots = (const uint32_t*)(image + hdr->slots);
+    const image_entry_t *e;
+    uint32_t s, n;
+
+    s = hash_name(name) & (hdr->nslots - 1);
+    for (n=0; n < hdr->nslots && 0 != slots[s]; n++) {
+        if (slots[s] <= hdr->nentries) {
+            e = &entries[slots[s] - 1];
+            if (addr == (e->flags & IMAGE_ADDR) &&
+                0 == strcmp(image_string(hdr, e->name), name)) {
+                return e;
+            }
+        }
+        s = (s + 1) & (hdr->nslots - 1);
+    }
+    return NULL;
+}
+
+int orcm_cfgi_file30_cache_define(const char *my_ip,
+                                  orcm_node_t **mynode,
+                                  orte_vpid_t *num_procs,
+                                  opal_buffer_t *buf)
+{
+    const image_header_t *hdr = (const image_header_t*)image;
+    const image_entry_t *scheds, *e = NULL, *ip;
+    const char *p;
+    orcm_scheduler_t *scheduler;
+    orcm_node_t *node;
+    char *data;
+    uint32_t n;
+    int rc;
+
+    *mynode = NULL;
+    if (NULL == image) {
+        return ORCM_ERR_NOT_FOUND;
+    }
+
+    /* the schedulers lead the vpids */
+    scheds = (const image_entry_t*)(image + hdr->scheds);
+    for (n=0; n < hdr->nscheds; n++) {
+        scheduler = OBJ_NEW(orcm_scheduler_t);
+        scheduler->controller.name = strdup(image_string(hdr, scheds[n].name));
+        scheduler->controller.daemon.jobid = 0;
+        scheduler->controller.daemon.vpid = scheds[n].vpid;
+        opal_list_append(orcm_schedulers, &scheduler->super);
+    }
+
+    /* find ourselves - by name, or by address if the config names
+     * any daemons that way, whichever comes first */
+    if (ORTE_PROC_IS_DAEMON) {
+        e = lookup(hdr, orte_process_info.nodename, 0);
+        if (0 < hdr->naddrs && NULL != my_ip &&
+            NULL != (ip = lookup(hdr, my_ip, IMAGE_ADDR)) &&
+            (NULL == e || ip->vpid < e->vpid)) {
+            e = ip;
+        }
+    }
+    if (NULL != e) {
+        node = OBJ_NEW(orcm_node_t);
+        node->name = strdup(image_string(hdr, e->name));
+        node->daemon.jobid = 0;
+        node->daemon.vpid = e->vpid;
+        node->config.aggregator = (0 != (e->flags & IMAGE_AGGREGATOR));
+        if (0 != e->port) {
+            node->config.port = strdup(image_string(hdr, e->port));
+        }
+        if (0 != e->params) {
+            for (p = image_string(hdr, e->params); '\0' != *p; p += strlen(p) + 1) {
+                if (OPAL_SUCCESS != (rc = opal_argv_append_nosize(&node->config.mca_params, p))) {
+                    OBJ_RELEASE(node);
+                    return rc;
+                }
+            }
+        }
+        *mynode = node;
+    }
+
+    /* hand back the system definition as define_system packed it */
+    *num_procs = hdr->num_procs;
+    if (0 < hdr->system_size) {
+        if (NULL == (data = (char*)malloc(hdr->system_size))) {
+            if (NULL != *mynode) {
+                OBJ_RELEASE(*mynode);
+                *mynode = NULL;
+            }
+            return ORCM_ERR_OUT_OF_RESOURCE;
+        }
+        memcpy(data, image + hdr->system, hdr->system_size);
+        if (OPAL_SUCCESS != (rc = opal_dss.load(buf, data, hdr->system_size))) {
+            free(data);
+            return rc;
+        }
+    }
+    return ORCM_SUCCESS;
+}
+
+/* growable tables for compiling an image */
+typedef struct {
+    char *base;
+    size_t used;
+    size_t size;
+} image_area_t;
+
+static int area_add(image_area_t *a, const void *data, size_t len)
+{
+    char *tmp;
+    size_t n;
+
+    if (a->used + len > a->size) {
+        for (n = (0 == a->size) ? 4096 : a->size; n < a->used + len; n *= 2);
+        if (NULL == (tmp = (char*)realloc(a->base, n))) {
+            return ORCM_ERR_OUT_OF_RESOURCE;
+        }
+        a->base = tmp;
+        a->size = n;
+    }
+    memcpy(a->base + a->used, data, len);
+    a->used += len;
+    return ORCM_SUCCESS;
+}
+
+static int area_string(image_area_t *strings, const char *s, uint32_t *offset)
+{
+    if (NULL == s || '\0' == *s) {
+        *offset = 0;
+        return ORCM_SUCCESS;
+    }
+    *offset = (uint32_t)strings->used;
+    return area_add(strings, s, strlen(s) + 1);
+}
+
+/* naddrs counts the entries named by IP address, if not NULL */
+static int add_daemon(image_area_t *entries, image_area_t *strings,
+                      orcm_node_t *node, uint32_t *naddrs)
+{
+    image_entry_t e;
+    char nul = '\0';
+    int n, rc;
+
+    if (NULL == node->name) {
+        /* check_me can never match it */
+        return ORCM_SUCCESS;
+    }
+    memset(&e, 0, sizeof(e));
+    e.vpid = node->daemon.vpid;
+    if (node->config.aggregator) {
+        e.flags |= IMAGE_AGGREGATOR;
+    }
+    if (opal_net_isaddr(node->name)) {
+        e.flags |= IMAGE_ADDR;
+        if (NULL != naddrs) {
+            (*naddrs)++;
+        }
+    }
+    if (ORCM_SUCCESS != (rc = area_string(strings, node->name, &e.name)) ||
+        ORCM_SUCCESS != (rc = area_string(strings, node->config.port, &e.port))) {
+        return rc;
+    }
+    if (NULL != node->config.mca_params && NULL != node->config.mca_params[0]) {
+        e.params = (uint32_t)strings->used;
+        for (n=0; NULL != node->config.mca_params[n]; n++) {
+            if (ORCM_SUCCESS != (rc = area_add(strings, node->config.mca_params[n],
+                                               strlen(node->config.mca_params[n]) + 1))) {
+                return rc;
+            }
+        }
+        if (ORCM_SUCCESS != (rc = area_add(strings, &nul, 1))) {
+            return rc;
+        }
+    }
+    return area_add(entries, &e, sizeof(e));
+}
+
+static uint64_t align8(uint64_t n)
+{
+    return (n + 7) & ~(uint64_t)7;
+}
+
+int orcm_cfgi_file30_cache_write(const char *path, const struct stat *xml,
+                                 orte_vpid_t num_procs, opal_buffer_t *buf)
+{
+    image_area_t scheds, entries, strings;
+    image_header_t hdr;
+    image_entry_t *e;
+    orcm_scheduler_t *scheduler;
+    orcm_cluster_t *cluster;
+    orcm_row_t *row;
+    orcm_rack_t *rack;
+    orcm_node_t *node;
+    uint32_t *slots = NULL, s, n;
+    char *tmpfile = NULL, nul = '\0';
+    FILE *fp = NULL;
+    size_t pad;
+    int rc;
+
+    memset(&scheds, 0, sizeof(scheds));
+    memset(&entries, 0, sizeof(entries));
+    memset(&strings, 0, sizeof(strings));
+    memset(&hdr, 0, sizeof(hdr));
+
+    /* offset 0 is the empty string */
+    if (ORCM_SUCCESS != (rc = area_add(&strings, &nul, 1))) {
+        goto cleanup;
+    }
+    OPAL_LIST_FOREACH(scheduler, orcm_schedulers, orcm_scheduler_t) {
+        if (ORCM_SUCCESS != (rc = add_daemon(&scheds, &strings, &scheduler->controller,
+                                             NULL))) {
+            goto cleanup;
+        }
+    }
+    /* the daemons in the order define_system numbers them */
+    OPAL_LIST_FOREACH(cluster, orcm_clusters, orcm_cluster_t) {
+        if (ORTE_NODE_STATE_UNDEF != cluster->controller.state &&
+            ORCM_SUCCESS != (rc = add_daemon(&entries, &strings, &cluster->controller,
+                                             &hdr.naddrs))) {
+            goto cleanup;
+        }
+        OPAL_LIST_FOREACH(row, &cluster->rows, orcm_row_t) {
+            if (ORTE_NODE_STATE_UNDEF != row->controller.state &&
+                ORCM_SUCCESS != (rc = add_daemon(&entries, &strings, &row->controller,
+                                                 &hdr.naddrs))) {
+                goto cleanup;
+            }
+            OPAL_LIST_FOREACH(rack, &row->racks, orcm_rack_t) {
+                if (ORTE_NODE_STATE_UNDEF != rack->controller.state &&
+                    ORCM_SUCCESS != (rc = add_daemon(&entries, &strings, &rack->controller,
+                                                     &hdr.naddrs))) {
+                    goto cleanup;
+                }
+                OPAL_LIST_FOREACH(node, &rack->nodes, orcm_node_t) {
+                    if (ORCM_SUCCESS != (rc = add_daemon(&entries, &strings, node,
+                                                         &hdr.naddrs))) {
+                        goto cleanup;
+                    }
+                }
+            }
+        }
+    }
+    hdr.nscheds = scheds.used / sizeof(image_entry_t);
+    hdr.nentries = entries.used / sizeof(image_entry_t);
+
+    /* index them at no more than half full */
+    for (hdr.nslots = 16; hdr.nslots < 2 * hdr.nentries; hdr.nslots *= 2);
+    if (NULL == (slots = (uint32_t*)calloc(hdr.nslots, sizeof(uint32_t)))) {
+        rc = ORCM_ERR_OUT_OF_RESOURCE;
+        goto cleanup;
+    }
+    e = (image_entry_t*)entries.base;
+    for (n=0; n < hdr.nentries; n++) {
+        s = hash_name(strings.base + e[n].name) & (hdr.nslots - 1);
+        while (0 != slots[s]) {
+            s = (s + 1) & (hdr.nslots - 1);
+        }
+        slots[s] = n + 1;
+    }
+
+    hdr.magic = IMAGE_MAGIC;
+    hdr.version = IMAGE_VERSION;
+    hdr.xml_size = xml->st_size;
+    hdr.xml_mtime = xml->st_mtime;
+    hdr.xml_ino = xml->st_ino;
+    hdr.buf_type = buf->type;
+    hdr.num_procs = num_procs;
+    hdr.scheds = align8(sizeof(hdr));
+    hdr.entries = align8(hdr.scheds + scheds.used);
+    hdr.slots = align8(hdr.entries + entries.used);
+    hdr.strings = align8(hdr.slots + (uint64_t)hdr.nslots * sizeof(uint32_t));
+    hdr.strings_size = strings.used;
+    hdr.system = align8(hdr.strings + strings.used);
+    hdr.system_size = buf->bytes_used;
+    hdr.size = hdr.system + hdr.system_size;
+
+    /* write it aside and move it into place, so a daemon maps
+     * either the old image or the new one */
+    asprintf(&tmpfile, "%s.%lu", path, (unsigned long)getpid());
+    if (NULL == tmpfile || NULL == (fp = fopen(tmpfile, "w"))) {
+        rc = ORCM_ERR_FILE_OPEN_FAILURE;
+        goto cleanup;
+    }
+#define IMAGE_WRITE(at, data, len)                                          \
+    do {                                                                    \
+        for (pad = (at) - ftell(fp); 0 < pad; pad--) {                      \
+            fputc('\0', fp);                                                \
+        }                                                                   \
+        if (0 < (len) && 1 != fwrite((data), (len), 1, fp)) {               \
+            rc = ORCM_ERR_FILE_WRITE_FAILURE;                               \
+            goto cleanup;                                                   \
+        }                                                                   \
+    } while (0)
+    IMAGE_WRITE(0, &hdr, sizeof(hdr));
+    IMAGE_WRITE(hdr.scheds, scheds.base, scheds.used);
+    IMAGE_WRITE(hdr.entries, entries.base, entries.used);
+    IMAGE_WRITE(hdr.slots, slots, hdr.nslots * sizeof(uint32_t));
+    IMAGE_WRITE(hdr.strings, strings.base, strings.used);
+    IMAGE_WRITE(hdr.system, buf->base_ptr, hdr.system_size);
+#undef IMAGE_WRITE
+    if (0 != fclose(fp)) {
+        fp = NULL;
+        rc = ORCM_ERR_FILE_WRITE_FAILURE;
+        goto cleanup;
+    }
+    fp = NULL;
+    if (0 != rename(tmpfile, path)) {
+        rc = ORCM_ERR_FILE_WRITE_FAILURE;
+        goto cleanup;
+    }
+    opal_output_verbose(2, orcm_cfgi_base_framework.framework_output,
+                        "cfgi:file30 wrote image %s: %u daemons, %lu bytes",
+                        path, hdr.nentries, (unsigned long)hdr.size);
+    rc = ORCM_SUCCESS;
+
+cleanup:
+    if (NULL != fp) {
+        fclose(fp);
+    }
+    if (NULL != tmpfile) {
+        if (ORCM_SUCCESS != rc) {
+            unlink(tmpfile);
+        }
+        free(tmpfile);
+    }
+    free(slots);
+    free(scheds.base);
+    free(entries.base);
+    free(strings.base);
+    return rc;
+}
@@ -21,24 +21,27 @@
 static int component_open(void);
 static int component_close(void);
 static int component_query(mca_base_module_t **module, int *priority);
+static int component_register(void);
 
-orcm_cfgi_base_component_t mca_cfgi_file30_component = {
+orcm_cfgi_file30_component_t mca_cfgi_file30_component = {
     {
-        ORCM_CFGI_BASE_VERSION_1_0_0,
-        /* Component name and version */
-        .mca_component_name = "file30",
-        MCA_BASE_MAKE_VERSION(component, ORCM_MAJOR_VERSION, ORCM_MINOR_VERSION,
-                              ORCM_RELEASE_VERSION),
-        
-        /* Component open and close functions */
-        .mca_open_component = component_open,
-        .mca_close_component = component_close,
-        .mca_query_component = component_query,
-        NULL
-    },
-    .base_data = {
-        /* The component is checkpoint ready */
-        MCA_BASE_METADATA_PARAM_CHECKPOINT
+        {
+            ORCM_CFGI_BASE_VERSION_1_0_0,
+            /* Component name and version */
+            .mca_component_name = "file30",
+            MCA_BASE_MAKE_VERSION(component, ORCM_MAJOR_VERSION, ORCM_MINOR_VERSION,
+                                  ORCM_RELEASE_VERSION),
+
+            /* Component open and close functions */
+            .mca_open_component = component_open,
+            .mca_close_component = component_close,
+            .mca_query_component = component_query,
+            .mca_register_component_params = component_register
+        },
+        .base_data = {
+            /* The component is checkpoint ready */
+            MCA_BASE_METADATA_PARAM_CHECKPOINT
+        },
     },
 };
 
@@ -59,3 +62,17 @@ static int component_query(mca_base_module_t **module, int *priority)
     *priority = 10;
     return ORCM_SUCCESS;
 }
+
+static int component_register(void)
+{
+    mca_base_component_t *c = &mca_cfgi_file30_component.super.base_version;
+
+    mca_cfgi_file30_component.cache = NULL;
+    (void) mca_base_component_var_register(c, "cache",
+                                           "Path of a compiled binary image of the configuration file - written by the scheduler, mapped by daemons in place of parsing the XML while it is current [default: none]",
+                                           MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_cfgi_file30_component.cache);
+    return ORCM_SUCCESS;
+}
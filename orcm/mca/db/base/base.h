@@ -24,6 +24,7 @@
 #include "opal/mca/event/event.h"
 #include "opal/class/opal_list.h"
 #include "opal/class/opal_pointer_array.h"
+#include "opal/threads/mutex.h"
 #include "opal/dss/dss.h"
 
 #include "orcm/mca/db/db.h"
@@ -37,11 +38,35 @@ ORCM_DECLSPEC extern mca_base_framework_t orcm_db_base_framework;
  */
 ORCM_DECLSPEC int orcm_db_base_select(void);
 
+/*
+ * A db worker - each one has its own progress thread and event base.
+ * Handles are sharded across the workers so that a slow backend only
+ * stalls the handles that share its worker. All requests for a given
+ * handle go to the same worker, so they are processed in order and the
+ * modules never see concurrent calls.
+ */
+typedef struct {
+    char *name;                 /* progress thread name */
+    opal_event_base_t *ev_base;
+    volatile int32_t depth;     /* requests queued, not yet processed */
+    int32_t max_depth;          /* high-water mark of depth */
+    volatile int64_t processed; /* total requests processed */
+    volatile int64_t rejected;  /* requests refused due to backpressure */
+} orcm_db_base_worker_t;
+
 typedef struct {
     opal_list_t actives;
     opal_pointer_array_t handles;
+    /* guards handles - workers open, close and look them up concurrently */
+    opal_mutex_t handles_lock;
+    /* event base of the first worker - used for open/close-all */
     opal_event_base_t *ev_base;
     bool ev_base_active;
+    int num_workers;
+    orcm_db_base_worker_t *workers;
+    /* max requests queued on a worker before data requests are
+     * refused (0 = unbounded) */
+    int max_queue_depth;
 } orcm_db_base_t;
 
 typedef struct {
@@ -54,6 +79,8 @@ typedef struct {
     opal_object_t super;
     opal_event_t ev;
     int dbhandle;
+    orcm_db_base_worker_t *worker;
+    opal_event_cbfunc_t process;
 
     orcm_db_callback_fn_t cbfunc;
     void *cbdata;
@@ -81,6 +108,7 @@ typedef struct {
     opal_object_t super;
     orcm_db_base_component_t *component;
     orcm_db_base_module_t *module;
+    int worker;     /* index of the worker this handle is sharded to */
 } orcm_db_handle_t;
 OBJ_CLASS_DECLARATION(orcm_db_handle_t);
 
@@ -157,6 +185,12 @@ ORCM_DECLSPEC void orcm_db_base_remove_data(int dbhandle,
 ORCM_DECLSPEC int opal_value_to_orcm_db_item(const opal_value_t *kv,
                                              orcm_db_item_t *item);
 
+/* Return the event base that processes the requests of the given module.
+ * Modules that need their own events (e.g. flush timers) must use this
+ * base so those events are serialized with the module's requests */
+ORCM_DECLSPEC opal_event_base_t *orcm_db_base_module_evbase(
+        struct orcm_db_base_module_t *mod);
+
 END_C_DECLS
 
 #endif
@@ -13,6 +13,7 @@
 #include "orcm_config.h"
 #include "orcm/constants.h"
 
+#include "opal_stdint.h"
 #include "opal/mca/mca.h"
 #include "opal/util/output.h"
 #include "opal/mca/base/base.h"
@@ -56,6 +57,22 @@ static int orcm_db_base_register(mca_base_register_flag_t flags)
                           OPAL_INFO_LVL_9,
                           MCA_BASE_VAR_SCOPE_READONLY,
                           &orcm_db_base_create_evbase);
+
+    orcm_db_base.num_workers = 1;
+    mca_base_var_register("orcm", "db", "base", "num_workers",
+                          "Number of db worker threads - db handles are sharded across them (ignored if create_evbase is false)",
+                          MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                          OPAL_INFO_LVL_9,
+                          MCA_BASE_VAR_SCOPE_READONLY,
+                          &orcm_db_base.num_workers);
+
+    orcm_db_base.max_queue_depth = 0;
+    mca_base_var_register("orcm", "db", "base", "max_queue_depth",
+                          "Max number of requests queued on a db worker before new data requests are refused (0 = unbounded)",
+                          MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                          OPAL_INFO_LVL_9,
+                          MCA_BASE_VAR_SCOPE_READONLY,
+                          &orcm_db_base.max_queue_depth);
     return ORCM_SUCCESS;
 }
 
@@ -64,6 +81,7 @@ static int orcm_db_base_frame_close(void)
     orcm_db_base_active_component_t *active;
     int i;
     orcm_db_handle_t *hdl;
+    orcm_db_base_worker_t *worker;
 
     /* cleanup the globals */
     for (i=0; i < orcm_db_base.handles.size; i++) {
@@ -72,6 +90,7 @@ static int orcm_db_base_frame_close(void)
         }
     }
     OBJ_DESTRUCT(&orcm_db_base.handles);
+    OBJ_DESTRUCT(&orcm_db_base.handles_lock);
 
     /* cycle across all the active db components and let them cleanup - order
      * doesn't matter in this case
@@ -83,32 +102,77 @@ static int orcm_db_base_frame_close(void)
     }
     OBJ_DESTRUCT(&orcm_db_base.actives);
 
-    if (orcm_db_base_create_evbase && orcm_db_base.ev_base_active) {
-        orcm_db_base.ev_base_active = false;
-        opal_stop_progress_thread("db", true);
+    for (i=0; i < orcm_db_base.num_workers; i++) {
+        worker = &orcm_db_base.workers[i];
+        opal_output_verbose(2, orcm_db_base_framework.framework_output,
+                            "db:base: worker %s processed %" PRIi64
+                            " requests, rejected %" PRIi64
+                            ", max queue depth %d",
+                            worker->name, worker->processed,
+                            worker->rejected, worker->max_depth);
+        if (orcm_db_base_create_evbase && orcm_db_base.ev_base_active) {
+            opal_stop_progress_thread(worker->name, true);
+        }
+        free(worker->name);
     }
+    orcm_db_base.ev_base_active = false;
+    free(orcm_db_base.workers);
+    orcm_db_base.workers = NULL;
 
     return mca_base_framework_components_close(&orcm_db_base_framework, NULL);
 }
 
 static int orcm_db_base_frame_open(mca_base_open_flag_t flags)
 {
+    orcm_db_base_worker_t *worker;
+    int i;
+
     OBJ_CONSTRUCT(&orcm_db_base.actives, opal_list_t);
     OBJ_CONSTRUCT(&orcm_db_base.handles, opal_pointer_array_t);
     opal_pointer_array_init(&orcm_db_base.handles, 3, INT_MAX, 1);
+    OBJ_CONSTRUCT(&orcm_db_base.handles_lock, opal_mutex_t);
+
+    if (!orcm_db_base_create_evbase || orcm_db_base.num_workers < 1) {
+        /* everything runs on a single event base */
+        orcm_db_base.num_workers = 1;
+    }
+    orcm_db_base.workers = (orcm_db_base_worker_t*)calloc(orcm_db_base.num_workers,
+                                                          sizeof(orcm_db_base_worker_t));
+    if (NULL == orcm_db_base.workers) {
+        orcm_db_base.num_workers = 0;
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
 
-    if (orcm_db_base_create_evbase) {
-        /* create our own event base */
-        orcm_db_base.ev_base_active = true;
-        if (NULL == (orcm_db_base.ev_base =
-                opal_start_progress_thread("db", true))) {
-            orcm_db_base.ev_base_active = false;
-            return ORCM_ERROR;
+    for (i=0; i < orcm_db_base.num_workers; i++) {
+        worker = &orcm_db_base.workers[i];
+        /* keep the historical name for the first worker */
+        if (0 == i) {
+            worker->name = strdup("db");
+        } else {
+            asprintf(&worker->name, "db%d", i);
+        }
+        if (orcm_db_base_create_evbase) {
+            /* create our own event base */
+            if (NULL == (worker->ev_base =
+                    opal_start_progress_thread(worker->name, true))) {
+                /* shutdown the ones we already started */
+                free(worker->name);
+                while (0 <= --i) {
+                    opal_stop_progress_thread(orcm_db_base.workers[i].name, true);
+                    free(orcm_db_base.workers[i].name);
+                }
+                free(orcm_db_base.workers);
+                orcm_db_base.workers = NULL;
+                orcm_db_base.num_workers = 0;
+                return ORCM_ERROR;
+            }
+        } else {
+            /* tie us to the orte_event_base */
+            worker->ev_base = orte_event_base;
         }
-    } else {
-        /* tie us to the orte_event_base */
-        orcm_db_base.ev_base = orte_event_base;
     }
+    orcm_db_base.ev_base_active = orcm_db_base_create_evbase;
+    orcm_db_base.ev_base = orcm_db_base.workers[0].ev_base;
 
     /* Open up all available components */
     return mca_base_framework_components_open(&orcm_db_base_framework, flags);
@@ -122,6 +186,9 @@ MCA_BASE_FRAMEWORK_DECLARE(orcm, db, "ORCM Database Framework",
 
 static void req_con(orcm_db_request_t *p)
 {
+    p->dbhandle = -1;
+    p->worker = NULL;
+    p->process = NULL;
     p->cbdata = NULL;
 
     p->properties = NULL;
@@ -145,9 +212,15 @@ OBJ_CLASS_INSTANCE(orcm_db_request_t,
                    opal_object_t,
                    req_con, NULL);
 
+static void hdl_con(orcm_db_handle_t *p)
+{
+    p->component = NULL;
+    p->module = NULL;
+    p->worker = 0;
+}
 OBJ_CLASS_INSTANCE(orcm_db_handle_t,
                    opal_object_t,
-                   NULL, NULL);
+                   hdl_con, NULL);
 
 OBJ_CLASS_INSTANCE(orcm_db_base_active_component_t,
                    opal_list_item_t,
@@ -14,6 +14,7 @@
 #include "opal_stdint.h"
 #include "opal/mca/mca.h"
 #include "opal/util/error.h"
+#include "opal/sys/atomic.h"
 #include "opal/util/output.h"
 #include "opal/mca/base/base.h"
 #include "opal/dss/dss_types.h"
@@ -21,6 +22,95 @@
 #include "orcm/mca/db/base/base.h"
 
 
+/* Each handle is bound to one worker for its whole life, so all of its
+ * requests are processed in order on the same thread */
+static inline orcm_db_base_worker_t *db_base_worker(int dbhandle)
+{
+    if (dbhandle < 0) {
+        return &orcm_db_base.workers[0];
+    }
+    return &orcm_db_base.workers[dbhandle % orcm_db_base.num_workers];
+}
+
+/* handles are opened and closed on one worker and looked up on all
+ * of them, so every access to the handles array takes its lock */
+static orcm_db_handle_t *db_base_handle(int dbhandle)
+{
+    orcm_db_handle_t *hdl;
+
+    opal_mutex_lock(&orcm_db_base.handles_lock);
+    hdl = (orcm_db_handle_t*)opal_pointer_array_get_item(&orcm_db_base.handles, dbhandle);
+    opal_mutex_unlock(&orcm_db_base.handles_lock);
+    return hdl;
+}
+
+static void process_request(int fd, short args, void *cbdata)
+{
+    orcm_db_request_t *req = (orcm_db_request_t*)cbdata;
+
+    opal_atomic_sub_32(&req->worker->depth, 1);
+    opal_atomic_add_64(&req->worker->processed, 1);
+    req->process(fd, args, req);
+}
+
+/* push the request into the event base of the worker owning the handle.
+ * If the worker is backed up beyond max_queue_depth, data requests are
+ * refused right away so the caller can release its data instead of
+ * letting the queue grow without bound */
+static void db_base_queue(orcm_db_request_t *req,
+                          opal_event_cbfunc_t process,
+                          bool data)
+{
+    orcm_db_base_worker_t *worker = db_base_worker(req->dbhandle);
+    int32_t depth;
+
+    if (data && 0 < orcm_db_base.max_queue_depth &&
+        orcm_db_base.max_queue_depth <= worker->depth) {
+        opal_atomic_add_64(&worker->rejected, 1);
+        opal_output_verbose(5, orcm_db_base_framework.framework_output,
+                            "db:base: worker %s queue full - request for handle %d refused",
+                            worker->name, req->dbhandle);
+        if (NULL != req->cbfunc) {
+            req->cbfunc(req->dbhandle, ORCM_ERR_OUT_OF_RESOURCE,
+                        req->kvs, req->cbdata);
+        }
+        OBJ_RELEASE(req);
+        return;
+    }
+
+    depth = opal_atomic_add_32(&worker->depth, 1);
+    /* only a metric, so a racy update is fine */
+    if (worker->max_depth < depth) {
+        worker->max_depth = depth;
+    }
+
+    req->worker = worker;
+    req->process = process;
+    opal_event_set(worker->ev_base, &req->ev, -1,
+                   OPAL_EV_WRITE,
+                   process_request, req);
+    opal_event_set_priority(&req->ev, OPAL_EV_SYS_HI_PRI);
+    opal_event_active(&req->ev, OPAL_EV_WRITE, 1);
+}
+
+opal_event_base_t *orcm_db_base_module_evbase(struct orcm_db_base_module_t *mod)
+{
+    orcm_db_handle_t *hdl;
+    opal_event_base_t *evbase = orcm_db_base.ev_base;
+    int i;
+
+    opal_mutex_lock(&orcm_db_base.handles_lock);
+    for (i=0; i < orcm_db_base.handles.size; i++) {
+        if (NULL != (hdl = (orcm_db_handle_t*)opal_pointer_array_get_item(&orcm_db_base.handles, i)) &&
+            (struct orcm_db_base_module_t*)hdl->module == mod) {
+            evbase = orcm_db_base.workers[hdl->worker].ev_base;
+            break;
+        }
+    }
+    opal_mutex_unlock(&orcm_db_base.handles_lock);
+    return evbase;
+}
+
 static void process_open(int fd, short args, void *cbdata)
 {
     orcm_db_request_t *req = (orcm_db_request_t*)cbdata;
@@ -65,7 +155,11 @@ static void process_open(int fd, short args, void *cbdata)
                 hdl = OBJ_NEW(orcm_db_handle_t);
                 hdl->component = component;
                 hdl->module = mod;
+                /* bind it to its worker before anyone can look it up */
+                opal_mutex_lock(&orcm_db_base.handles_lock);
                 index = opal_pointer_array_add(&orcm_db_base.handles, hdl);
+                hdl->worker = index % orcm_db_base.num_workers;
+                opal_mutex_unlock(&orcm_db_base.handles_lock);
                 if (NULL != req->cbfunc) {
                     req->cbfunc(index, ORCM_SUCCESS, NULL, req->cbdata);
                 }
@@ -101,11 +195,7 @@ void orcm_db_base_open(char *name,
     req->properties = properties;
     req->cbfunc = cbfunc;
     req->cbdata = cbdata;
-    opal_event_set(orcm_db_base.ev_base, &req->ev, -1,
-                   OPAL_EV_WRITE,
-                   process_open, req);
-    opal_event_set_priority(&req->ev, OPAL_EV_SYS_HI_PRI);
-    opal_event_active(&req->ev, OPAL_EV_WRITE, 1);
+    db_base_queue(req, process_open, false);
 }
 
 static void process_close(int fd, short args, void *cbdata)
@@ -115,7 +205,7 @@ static void process_close(int fd, short args, void *cbdata)
     int rc=ORCM_SUCCESS;
 
     /* get the handle object */
-    if (NULL == (hdl = (orcm_db_handle_t*)opal_pointer_array_get_item(&orcm_db_base.handles, req->dbhandle))) {
+    if (NULL == (hdl = db_base_handle(req->dbhandle))) {
         rc = ORCM_ERR_NOT_FOUND;
         goto found;
     }
@@ -132,7 +222,9 @@ static void process_close(int fd, short args, void *cbdata)
         req->cbfunc(req->dbhandle, rc, NULL, req->cbdata);
     }
     /* release the handle */
+    opal_mutex_lock(&orcm_db_base.handles_lock);
     opal_pointer_array_set_item(&orcm_db_base.handles, req->dbhandle, NULL);
+    opal_mutex_unlock(&orcm_db_base.handles_lock);
     if (NULL != hdl) {
         OBJ_RELEASE(hdl);
     }
@@ -153,11 +245,7 @@ void orcm_db_base_close(int dbhandle,
     req->dbhandle = dbhandle;
     req->cbfunc = cbfunc;
     req->cbdata = cbdata;
-    opal_event_set(orcm_db_base.ev_base, &req->ev, -1,
-                   OPAL_EV_WRITE,
-                   process_close, req);
-    opal_event_set_priority(&req->ev, OPAL_EV_SYS_HI_PRI);
-    opal_event_active(&req->ev, OPAL_EV_WRITE, 1);
+    db_base_queue(req, process_close, false);
 }
 
 
@@ -168,7 +256,7 @@ static void process_store(int fd, short args, void *cbdata)
     int rc=ORCM_SUCCESS;
 
     /* get the handle object */
-    if (NULL == (hdl = (orcm_db_handle_t*)opal_pointer_array_get_item(&orcm_db_base.handles, req->dbhandle))) {
+    if (NULL == (hdl = db_base_handle(req->dbhandle))) {
         rc = ORCM_ERR_NOT_FOUND;
         goto found;
     }
@@ -205,11 +293,7 @@ void orcm_db_base_store(int dbhandle,
     req->kvs = kvs;
     req->cbfunc = cbfunc;
     req->cbdata = cbdata;
-    opal_event_set(orcm_db_base.ev_base, &req->ev, -1,
-                   OPAL_EV_WRITE,
-                   process_store, req);
-    opal_event_set_priority(&req->ev, OPAL_EV_SYS_HI_PRI);
-    opal_event_active(&req->ev, OPAL_EV_WRITE, 1);
+    db_base_queue(req, process_store, true);
 }
 
 static void process_record_data_samples(int fd, short args, void *cbdata)
@@ -219,8 +303,7 @@ static void process_record_data_samples(int fd, short args, void *cbdata)
     int rc = ORCM_SUCCESS;
 
     /* get the handle object */
-    if (NULL == (hdl = (orcm_db_handle_t*)opal_pointer_array_get_item(
-            &orcm_db_base.handles, req->dbhandle))) {
+    if (NULL == (hdl = db_base_handle(req->dbhandle))) {
         rc = ORCM_ERR_NOT_FOUND;
         goto callback;
     }
@@ -265,11 +348,7 @@ void orcm_db_base_record_data_samples(int dbhandle,
     req->kvs = samples;
     req->cbfunc = cbfunc;
     req->cbdata = cbdata;
-    opal_event_set(orcm_db_base.ev_base, &req->ev, -1,
-                   OPAL_EV_WRITE,
-                   process_record_data_samples, req);
-    opal_event_set_priority(&req->ev, OPAL_EV_SYS_HI_PRI);
-    opal_event_active(&req->ev, OPAL_EV_WRITE, 1);
+    db_base_queue(req, process_record_data_samples, true);
 }
 
 static void process_update_node_features(int fd, short args, void *cbdata)
@@ -279,8 +358,7 @@ static void process_update_node_features(int fd, short args, void *cbdata)
     int rc = ORCM_SUCCESS;
 
     /* get the handle object */
-    if (NULL == (hdl = (orcm_db_handle_t*)opal_pointer_array_get_item(
-            &orcm_db_base.handles, req->dbhandle))) {
+    if (NULL == (hdl = db_base_handle(req->dbhandle))) {
         rc = ORCM_ERR_NOT_FOUND;
         goto callback;
     }
@@ -321,11 +399,7 @@ void orcm_db_base_update_node_features(int dbhandle,
     req->kvs = features;
     req->cbfunc = cbfunc;
     req->cbdata = cbdata;
-    opal_event_set(orcm_db_base.ev_base, &req->ev, -1,
-                   OPAL_EV_WRITE,
-                   process_update_node_features, req);
-    opal_event_set_priority(&req->ev, OPAL_EV_SYS_HI_PRI);
-    opal_event_active(&req->ev, OPAL_EV_WRITE, 1);
+    db_base_queue(req, process_update_node_features, true);
 }
 
 static void process_record_diag_test(int fd, short args, void *cbdata)
@@ -335,8 +409,7 @@ static void process_record_diag_test(int fd, short args, void *cbdata)
     int rc = ORCM_SUCCESS;
 
     /* get the handle object */
-    if (NULL == (hdl = (orcm_db_handle_t*)opal_pointer_array_get_item(
-            &orcm_db_base.handles, req->dbhandle))) {
+    if (NULL == (hdl = db_base_handle(req->dbhandle))) {
         rc = ORCM_ERR_NOT_FOUND;
         goto callback;
     }
@@ -396,11 +469,7 @@ void orcm_db_base_record_diag_test(int dbhandle,
     req->kvs = test_params;
     req->cbfunc = cbfunc;
     req->cbdata = cbdata;
-    opal_event_set(orcm_db_base.ev_base, &req->ev, -1,
-                   OPAL_EV_WRITE,
-                   process_record_diag_test, req);
-    opal_event_set_priority(&req->ev, OPAL_EV_SYS_HI_PRI);
-    opal_event_active(&req->ev, OPAL_EV_WRITE, 1);
+    db_base_queue(req, process_record_diag_test, true);
 }
 
 static void process_commit(int fd, short args, void *cbdata)
@@ -410,7 +479,7 @@ static void process_commit(int fd, short args, void *cbdata)
     int rc=ORCM_SUCCESS;
 
     /* get the handle object */
-    if (NULL == (hdl = (orcm_db_handle_t*)opal_pointer_array_get_item(&orcm_db_base.handles, req->dbhandle))) {
+    if (NULL == (hdl = db_base_handle(req->dbhandle))) {
         rc = ORCM_ERR_NOT_FOUND;
         goto found;
     }
@@ -443,11 +512,7 @@ void orcm_db_base_commit(int dbhandle,
     req->dbhandle = dbhandle;
     req->cbfunc = cbfunc;
     req->cbdata = cbdata;
-    opal_event_set(orcm_db_base.ev_base, &req->ev, -1,
-                   OPAL_EV_WRITE,
-                   process_commit, req);
-    opal_event_set_priority(&req->ev, OPAL_EV_SYS_HI_PRI);
-    opal_event_active(&req->ev, OPAL_EV_WRITE, 1);
+    db_base_queue(req, process_commit, false);
 }
 
 static void process_fetch(int fd, short args, void *cbdata)
@@ -457,7 +522,7 @@ static void process_fetch(int fd, short args, void *cbdata)
     int rc;
 
     /* get the handle object */
-    if (NULL == (hdl = (orcm_db_handle_t*)opal_pointer_array_get_item(&orcm_db_base.handles, req->dbhandle))) {
+    if (NULL == (hdl = db_base_handle(req->dbhandle))) {
         rc = ORCM_ERR_NOT_FOUND;
         goto found;
     }
@@ -493,11 +558,7 @@ void orcm_db_base_fetch(int dbhandle,
     req->kvs = kvs;
     req->cbfunc = cbfunc;
     req->cbdata = cbdata;
-    opal_event_set(orcm_db_base.ev_base, &req->ev, -1,
-                   OPAL_EV_WRITE,
-                   process_fetch, req);
-    opal_event_set_priority(&req->ev, OPAL_EV_SYS_HI_PRI);
-    opal_event_active(&req->ev, OPAL_EV_WRITE, 1);
+    db_base_queue(req, process_fetch, false);
 }
 
 static void process_remove(int fd, short args, void *cbdata)
@@ -507,7 +568,7 @@ static void process_remove(int fd, short args, void *cbdata)
     int rc;
 
     /* get the handle object */
-    if (NULL == (hdl = (orcm_db_handle_t*)opal_pointer_array_get_item(&orcm_db_base.handles, req->dbhandle))) {
+    if (NULL == (hdl = db_base_handle(req->dbhandle))) {
         rc = ORCM_ERR_NOT_FOUND;
         goto found;
     }
@@ -541,9 +602,5 @@ void orcm_db_base_remove_data(int dbhandle,
     req->key = (char*)key;
     req->cbfunc = cbfunc;
     req->cbdata = cbdata;
-    opal_event_set(orcm_db_base.ev_base, &req->ev, -1,
-                   OPAL_EV_WRITE,
-                   process_remove, req);
-    opal_event_set_priority(&req->ev, OPAL_EV_SYS_HI_PRI);
-    opal_event_active(&req->ev, OPAL_EV_WRITE, 1);
+    db_base_queue(req, process_remove, false);
 }
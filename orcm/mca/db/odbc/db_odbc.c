@@ -72,8 +72,17 @@ static int odbc_fetch(struct orcm_db_base_module_t *imod,
 static int odbc_remove(struct orcm_db_base_module_t *imod,
                       const char *primary_key,
                       const char *key);
+static void odbc_commit(struct orcm_db_base_module_t *imod);
 
 /* Internal helper functions */
+static int odbc_batch_init(mca_db_odbc_module_t *mod);
+static void odbc_batch_finalize(mca_db_odbc_module_t *mod);
+static int odbc_batch_flush(mca_db_odbc_module_t *mod);
+static int odbc_batch_record_data_samples(mca_db_odbc_module_t *mod,
+                                          const char *hostname,
+                                          const struct timeval *time_stamp,
+                                          const char *data_group,
+                                          opal_list_t *samples);
 static void odbc_error_info(SQLSMALLINT handle_type, SQLHANDLE handle);
 static void tm_to_sql_timestamp(SQL_TIMESTAMP_STRUCT *sql_timestamp,
                                 const struct tm *time_info);
@@ -88,7 +97,7 @@ mca_db_odbc_module_t mca_db_odbc_module = {
         odbc_record_data_samples,
         odbc_update_node_features,
         odbc_record_diag_test,
-        NULL,
+        odbc_commit,
         odbc_fetch,
         odbc_remove
     },
@@ -174,6 +183,14 @@ static int odbc_init(struct orcm_db_base_module_t *imod)
                         "db:odbc: Connection established to %s",
                         mod->odbcdsn);
 
+    if (1 < mod->batch.size && ORCM_SUCCESS != odbc_batch_init(mod)) {
+        /* not fatal - just record the samples one row at a time */
+        opal_output(0, "db:odbc: Unable to set up batched data samples, "
+                    "falling back to one execute per sample");
+        odbc_batch_finalize(mod);
+        mod->batch.size = 1;
+    }
+
     return ORCM_SUCCESS;
 }
 
@@ -188,6 +205,10 @@ static void odbc_finalize(struct orcm_db_base_module_t *imod)
         free(mod->user);
     }
 
+    /* push out anything still staged before dropping the connection */
+    odbc_batch_flush(mod);
+    odbc_batch_finalize(mod);
+
     if (NULL != mod->dbhandle) {
         SQLFreeHandle(SQL_HANDLE_DBC, mod->dbhandle);
     }
@@ -590,6 +611,7 @@ static int odbc_record_data_samples(struct orcm_db_base_module_t *imod,
 {
     mca_db_odbc_module_t *mod = (mca_db_odbc_module_t*)imod;
     orcm_metric_value_t *mv;
+    int rc;
 
     SQL_TIMESTAMP_STRUCT sampletime;
     orcm_db_item_t item;
@@ -620,6 +642,16 @@ static int odbc_record_data_samples(struct orcm_db_base_module_t *imod,
         return ORCM_ERR_BAD_PARAM;
     }
 
+    if (1 < mod->batch.size) {
+        rc = odbc_batch_record_data_samples(mod, hostname, time_stamp,
+                                            data_group, samples);
+        /* samples that don't fit the staging buffers are recorded
+         * individually below */
+        if (ORCM_ERR_VALUE_OUT_OF_BOUNDS != rc) {
+            return rc;
+        }
+    }
+
     tv_to_sql_timestamp(&sampletime, time_stamp);
 
     ret = SQLAllocHandle(SQL_HANDLE_STMT, mod->dbhandle, &stmt);
@@ -884,6 +916,364 @@ static int odbc_record_data_samples(struct orcm_db_base_module_t *imod,
     return ORCM_SUCCESS;
 }
 
+static void odbc_batch_timeout(int fd, short args, void *cbdata)
+{
+    mca_db_odbc_module_t *mod = (mca_db_odbc_module_t*)cbdata;
+
+    mod->batch.timer_active = false;
+    odbc_batch_flush(mod);
+}
+
+static int odbc_batch_init(mca_db_odbc_module_t *mod)
+{
+    mca_db_odbc_batch_t *batch = &mod->batch;
+    int n = batch->size;
+    int i;
+
+    SQLRETURN ret;
+
+    batch->hostname = calloc(n, sizeof(*batch->hostname));
+    batch->hostname_len = calloc(n, sizeof(SQLLEN));
+    batch->data_group = calloc(n, sizeof(*batch->data_group));
+    batch->data_group_len = calloc(n, sizeof(SQLLEN));
+    batch->data_item = calloc(n, sizeof(*batch->data_item));
+    batch->data_item_len = calloc(n, sizeof(SQLLEN));
+    batch->sampletime = calloc(n, sizeof(SQL_TIMESTAMP_STRUCT));
+    batch->data_type = calloc(n, sizeof(SQLINTEGER));
+    batch->value_int = calloc(n, sizeof(SQLBIGINT));
+    batch->value_int_len = calloc(n, sizeof(SQLLEN));
+    batch->value_real = calloc(n, sizeof(SQLDOUBLE));
+    batch->value_real_len = calloc(n, sizeof(SQLLEN));
+    batch->value_str = calloc(n, sizeof(*batch->value_str));
+    batch->value_str_len = calloc(n, sizeof(SQLLEN));
+    batch->units = calloc(n, sizeof(*batch->units));
+    batch->units_len = calloc(n, sizeof(SQLLEN));
+    batch->status = calloc(n, sizeof(SQLUSMALLINT));
+    if (NULL == batch->hostname || NULL == batch->hostname_len ||
+        NULL == batch->data_group || NULL == batch->data_group_len ||
+        NULL == batch->data_item || NULL == batch->data_item_len ||
+        NULL == batch->sampletime || NULL == batch->data_type ||
+        NULL == batch->value_int || NULL == batch->value_int_len ||
+        NULL == batch->value_real || NULL == batch->value_real_len ||
+        NULL == batch->value_str || NULL == batch->value_str_len ||
+        NULL == batch->units || NULL == batch->units_len ||
+        NULL == batch->status) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+
+    ret = SQLAllocHandle(SQL_HANDLE_STMT, mod->dbhandle, &batch->stmt);
+    if (!(SQL_SUCCEEDED(ret))) {
+        batch->stmt = NULL;
+        ERR_MSG_FMT_STORE("SQLAllocHandle returned: %d", ret);
+        return ORCM_ERROR;
+    }
+
+    /* same parameter order as in odbc_record_data_samples */
+    ret = SQLPrepare(batch->stmt,
+                     (SQLCHAR *)
+                     "{call record_data_sample(?, ?, ?, ?, ?, ?, ?, ?, ?)}",
+                     SQL_NTS);
+    if (!(SQL_SUCCEEDED(ret))) {
+        ERR_MSG_FMT_SQL_STORE(SQL_HANDLE_STMT, batch->stmt,
+                              "SQLPrepare returned: %d", ret);
+        return ORCM_ERROR;
+    }
+
+    ret = SQLSetStmtAttr(batch->stmt, SQL_ATTR_PARAM_BIND_TYPE,
+                         (SQLPOINTER)SQL_PARAM_BIND_BY_COLUMN, 0);
+    if (SQL_SUCCEEDED(ret)) {
+        ret = SQLSetStmtAttr(batch->stmt, SQL_ATTR_PARAM_STATUS_PTR,
+                             (SQLPOINTER)batch->status, 0);
+    }
+    if (SQL_SUCCEEDED(ret)) {
+        ret = SQLSetStmtAttr(batch->stmt, SQL_ATTR_PARAMS_PROCESSED_PTR,
+                             (SQLPOINTER)&batch->processed, 0);
+    }
+    if (!(SQL_SUCCEEDED(ret))) {
+        ERR_MSG_FMT_SQL_STORE(SQL_HANDLE_STMT, batch->stmt,
+                              "SQLSetStmtAttr returned: %d", ret);
+        return ORCM_ERROR;
+    }
+
+    /* Bind every parameter once to its column array - staging a row only
+     * requires filling in the arrays */
+    {
+        struct {
+            SQLSMALLINT c_type;
+            SQLSMALLINT sql_type;
+            SQLULEN column_size;
+            SQLPOINTER buffer;
+            SQLLEN buffer_len;
+            SQLLEN *len;
+        } params[] = {
+            { SQL_C_CHAR, SQL_VARCHAR, ORCM_DB_ODBC_BATCH_NAME_LEN - 1,
+              batch->hostname, ORCM_DB_ODBC_BATCH_NAME_LEN,
+              batch->hostname_len },
+            { SQL_C_CHAR, SQL_VARCHAR, ORCM_DB_ODBC_BATCH_NAME_LEN - 1,
+              batch->data_group, ORCM_DB_ODBC_BATCH_NAME_LEN,
+              batch->data_group_len },
+            { SQL_C_CHAR, SQL_VARCHAR, ORCM_DB_ODBC_BATCH_NAME_LEN - 1,
+              batch->data_item, ORCM_DB_ODBC_BATCH_NAME_LEN,
+              batch->data_item_len },
+            { SQL_C_TYPE_TIMESTAMP, SQL_TYPE_TIMESTAMP, 0,
+              batch->sampletime, sizeof(SQL_TIMESTAMP_STRUCT), NULL },
+            { SQL_C_LONG, SQL_INTEGER, 0,
+              batch->data_type, sizeof(SQLINTEGER), NULL },
+            { SQL_C_SBIGINT, SQL_BIGINT, 0,
+              batch->value_int, sizeof(SQLBIGINT), batch->value_int_len },
+            { SQL_C_DOUBLE, SQL_DOUBLE, 0,
+              batch->value_real, sizeof(SQLDOUBLE), batch->value_real_len },
+            { SQL_C_CHAR, SQL_VARCHAR, ORCM_DB_ODBC_BATCH_STR_LEN - 1,
+              batch->value_str, ORCM_DB_ODBC_BATCH_STR_LEN,
+              batch->value_str_len },
+            { SQL_C_CHAR, SQL_VARCHAR, ORCM_DB_ODBC_BATCH_NAME_LEN - 1,
+              batch->units, ORCM_DB_ODBC_BATCH_NAME_LEN,
+              batch->units_len }
+        };
+
+        for (i = 0; i < (int)(sizeof(params) / sizeof(params[0])); i++) {
+            ret = SQLBindParameter(batch->stmt, i + 1, SQL_PARAM_INPUT,
+                                   params[i].c_type, params[i].sql_type,
+                                   params[i].column_size, 0,
+                                   params[i].buffer, params[i].buffer_len,
+                                   params[i].len);
+            if (!(SQL_SUCCEEDED(ret))) {
+                ERR_MSG_FMT_STORE("SQLBindParameter %d returned: %d",
+                                  i + 1, ret);
+                return ORCM_ERROR;
+            }
+        }
+    }
+
+    batch->timer_active = false;
+    batch->count = 0;
+
+    opal_output_verbose(5, orcm_db_base_framework.framework_output,
+                        "db:odbc: Batching up to %d data samples per execute",
+                        batch->size);
+
+    return ORCM_SUCCESS;
+}
+
+static void odbc_batch_finalize(mca_db_odbc_module_t *mod)
+{
+    mca_db_odbc_batch_t *batch = &mod->batch;
+    int size, timeout;
+
+    if (batch->timer_active) {
+        opal_event_evtimer_del(&batch->ev);
+        batch->timer_active = false;
+    }
+    if (NULL != batch->stmt) {
+        SQLFreeHandle(SQL_HANDLE_STMT, batch->stmt);
+        batch->stmt = NULL;
+    }
+
+    free(batch->hostname);
+    free(batch->hostname_len);
+    free(batch->data_group);
+    free(batch->data_group_len);
+    free(batch->data_item);
+    free(batch->data_item_len);
+    free(batch->sampletime);
+    free(batch->data_type);
+    free(batch->value_int);
+    free(batch->value_int_len);
+    free(batch->value_real);
+    free(batch->value_real_len);
+    free(batch->value_str);
+    free(batch->value_str_len);
+    free(batch->units);
+    free(batch->units_len);
+    free(batch->status);
+
+    /* keep the configuration, drop everything else */
+    size = batch->size;
+    timeout = batch->timeout;
+    memset(batch, 0, sizeof(*batch));
+    batch->size = size;
+    batch->timeout = timeout;
+}
+
+static int odbc_batch_flush(mca_db_odbc_module_t *mod)
+{
+    mca_db_odbc_batch_t *batch = &mod->batch;
+    int rows = batch->count;
+    int failed = 0;
+    SQLULEN i;
+
+    SQLRETURN ret;
+
+    if (batch->timer_active) {
+        opal_event_evtimer_del(&batch->ev);
+        batch->timer_active = false;
+    }
+
+    if (0 == rows || NULL == batch->stmt) {
+        return ORCM_SUCCESS;
+    }
+    /* the staged rows are consumed whatever the outcome */
+    batch->count = 0;
+
+    ret = SQLSetStmtAttr(batch->stmt, SQL_ATTR_PARAMSET_SIZE,
+                         (SQLPOINTER)(SQLULEN)rows, 0);
+    if (!(SQL_SUCCEEDED(ret))) {
+        ERR_MSG_FMT_SQL_STORE(SQL_HANDLE_STMT, batch->stmt,
+                              "SQLSetStmtAttr returned: %d", ret);
+        return ORCM_ERROR;
+    }
+
+    ret = SQLExecute(batch->stmt);
+    if (!(SQL_SUCCEEDED(ret))) {
+        ERR_MSG_FMT_SQL_STORE(SQL_HANDLE_STMT, batch->stmt,
+                              "SQLExecute returned: %d (%d samples dropped)",
+                              ret, rows);
+        SQLFreeStmt(batch->stmt, SQL_CLOSE);
+        return ORCM_ERROR;
+    }
+
+    /* the driver may accept the batch but reject individual rows */
+    for (i = 0; i < batch->processed; i++) {
+        if (SQL_PARAM_ERROR == batch->status[i]) {
+            failed++;
+        }
+    }
+    SQLFreeStmt(batch->stmt, SQL_CLOSE);
+
+    if (0 < failed) {
+        ERR_MSG_FMT_STORE("%d of %d batched samples were rejected",
+                          failed, rows);
+        return ORCM_ERROR;
+    }
+
+    opal_output_verbose(2, orcm_db_base_framework.framework_output,
+                        "db:odbc: Flushed %d data samples", rows);
+
+    return ORCM_SUCCESS;
+}
+
+static int odbc_batch_record_data_samples(mca_db_odbc_module_t *mod,
+                                          const char *hostname,
+                                          const struct timeval *time_stamp,
+                                          const char *data_group,
+                                          opal_list_t *samples)
+{
+    mca_db_odbc_batch_t *batch = &mod->batch;
+    orcm_metric_value_t *mv;
+    SQL_TIMESTAMP_STRUCT sampletime;
+    orcm_db_item_t item;
+    size_t hostname_len = strlen(hostname);
+    size_t data_group_len = strlen(data_group);
+    size_t len;
+    int rc, row;
+    struct timeval tv;
+
+    /* Validate the whole list up front so that a call is either staged
+     * completely or not at all */
+    if (ORCM_DB_ODBC_BATCH_NAME_LEN <= hostname_len ||
+        ORCM_DB_ODBC_BATCH_NAME_LEN <= data_group_len) {
+        rc = ORCM_ERR_VALUE_OUT_OF_BOUNDS;
+    } else {
+        rc = ORCM_SUCCESS;
+    }
+    OPAL_LIST_FOREACH(mv, samples, orcm_metric_value_t) {
+        if (NULL == mv->value.key || 0 == strlen(mv->value.key)) {
+            ERR_MSG_STORE("Key or data item name not provided for value");
+            return ORCM_ERR_BAD_PARAM;
+        }
+        if (ORCM_SUCCESS != opal_value_to_orcm_db_item(&mv->value, &item)) {
+            ERR_MSG_STORE("Unsupported value type");
+            return ORCM_ERR_NOT_SUPPORTED;
+        }
+        if (ORCM_DB_ODBC_BATCH_NAME_LEN <= strlen(mv->value.key) ||
+            (NULL != mv->units &&
+             ORCM_DB_ODBC_BATCH_NAME_LEN <= strlen(mv->units)) ||
+            (ORCM_DB_ITEM_STRING == item.item_type &&
+             ORCM_DB_ODBC_BATCH_STR_LEN <= strlen(item.value.value_str))) {
+            rc = ORCM_ERR_VALUE_OUT_OF_BOUNDS;
+        }
+    }
+    if (ORCM_SUCCESS != rc) {
+        /* keep the samples in order: push out what's staged and let the
+         * caller record these ones individually */
+        odbc_batch_flush(mod);
+        return rc;
+    }
+
+    tv_to_sql_timestamp(&sampletime, time_stamp);
+
+    OPAL_LIST_FOREACH(mv, samples, orcm_metric_value_t) {
+        opal_value_to_orcm_db_item(&mv->value, &item);
+        row = batch->count;
+
+        memcpy(batch->hostname[row], hostname, hostname_len + 1);
+        batch->hostname_len[row] = hostname_len;
+        memcpy(batch->data_group[row], data_group, data_group_len + 1);
+        batch->data_group_len[row] = data_group_len;
+        len = strlen(mv->value.key);
+        memcpy(batch->data_item[row], mv->value.key, len + 1);
+        batch->data_item_len[row] = len;
+        batch->sampletime[row] = sampletime;
+        batch->data_type[row] = item.opal_type;
+
+        batch->value_int_len[row] = SQL_NULL_DATA;
+        batch->value_real_len[row] = SQL_NULL_DATA;
+        batch->value_str_len[row] = SQL_NULL_DATA;
+        switch (item.item_type) {
+        case ORCM_DB_ITEM_INTEGER:
+            batch->value_int[row] = item.value.value_int;
+            batch->value_int_len[row] = 0;
+            break;
+        case ORCM_DB_ITEM_REAL:
+            batch->value_real[row] = item.value.value_real;
+            batch->value_real_len[row] = 0;
+            break;
+        case ORCM_DB_ITEM_STRING:
+            len = strlen(item.value.value_str);
+            memcpy(batch->value_str[row], item.value.value_str, len + 1);
+            batch->value_str_len[row] = len;
+            break;
+        }
+
+        if (NULL != mv->units) {
+            len = strlen(mv->units);
+            memcpy(batch->units[row], mv->units, len + 1);
+            batch->units_len[row] = len;
+        } else {
+            batch->units_len[row] = SQL_NULL_DATA;
+        }
+
+        if (batch->size == ++batch->count &&
+            ORCM_SUCCESS != (rc = odbc_batch_flush(mod))) {
+            return rc;
+        }
+    }
+
+    if (0 < batch->count) {
+        if (0 >= batch->timeout) {
+            /* no timeout - only coalesce within this call */
+            return odbc_batch_flush(mod);
+        }
+        if (!batch->timer_active) {
+            /* the timer must fire on the thread processing this handle */
+            opal_event_evtimer_set(orcm_db_base_module_evbase(
+                                       (struct orcm_db_base_module_t*)mod),
+                                   &batch->ev, odbc_batch_timeout, mod);
+            tv.tv_sec = batch->timeout / 1000;
+            tv.tv_usec = (batch->timeout % 1000) * 1000;
+            opal_event_evtimer_add(&batch->ev, &tv);
+            batch->timer_active = true;
+        }
+    }
+
+    return ORCM_SUCCESS;
+}
+
+static void odbc_commit(struct orcm_db_base_module_t *imod)
+{
+    odbc_batch_flush((mca_db_odbc_module_t*)imod);
+}
+
 #define ERR_MSG_UNF(msg) \
     opal_output(0, "***********************************************"); \
     opal_output(0, "db:odbc: Unable to update node features"); \
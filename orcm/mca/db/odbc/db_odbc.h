@@ -19,6 +19,44 @@ BEGIN_C_DECLS
 
 ORCM_MODULE_DECLSPEC extern orcm_db_base_component_t mca_db_odbc_component;
 
+/* Column widths used when staging data samples for array execution */
+#define ORCM_DB_ODBC_BATCH_NAME_LEN 256
+#define ORCM_DB_ODBC_BATCH_STR_LEN 1024
+
+/*
+ * Staging area for batched data samples. Each parameter of the
+ * record_data_sample call is bound once to a column-wise array and a
+ * whole batch of rows is sent to the driver with a single SQLExecute
+ * (SQL_ATTR_PARAMSET_SIZE). Rows may come from any host/data group.
+ */
+typedef struct {
+    int size;       /* max number of rows per execute */
+    int count;      /* number of rows currently staged */
+    int timeout;    /* max msec a staged row may wait before a flush */
+    SQLHSTMT stmt;
+    opal_event_t ev;
+    bool timer_active;
+
+    char (*hostname)[ORCM_DB_ODBC_BATCH_NAME_LEN];
+    SQLLEN *hostname_len;
+    char (*data_group)[ORCM_DB_ODBC_BATCH_NAME_LEN];
+    SQLLEN *data_group_len;
+    char (*data_item)[ORCM_DB_ODBC_BATCH_NAME_LEN];
+    SQLLEN *data_item_len;
+    SQL_TIMESTAMP_STRUCT *sampletime;
+    SQLINTEGER *data_type;
+    SQLBIGINT *value_int;
+    SQLLEN *value_int_len;
+    SQLDOUBLE *value_real;
+    SQLLEN *value_real_len;
+    char (*value_str)[ORCM_DB_ODBC_BATCH_STR_LEN];
+    SQLLEN *value_str_len;
+    char (*units)[ORCM_DB_ODBC_BATCH_NAME_LEN];
+    SQLLEN *units_len;
+    SQLUSMALLINT *status;
+    SQLULEN processed;
+} mca_db_odbc_batch_t;
+
 typedef struct {
     orcm_db_base_module_t api;
     char *odbcdsn; /* ODBC Data Source Name */
@@ -26,6 +64,7 @@ typedef struct {
     char *user;    
     SQLHENV envhandle;
     SQLHDBC dbhandle;
+    mca_db_odbc_batch_t batch;
 } mca_db_odbc_module_t;
 ORCM_MODULE_DECLSPEC extern mca_db_odbc_module_t mca_db_odbc_module;
 
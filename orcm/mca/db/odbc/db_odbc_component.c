@@ -62,6 +62,8 @@ orcm_db_base_component_t mca_db_odbc_component = {
 static char *table;
 static char *user;
 static char *odbcdsn;
+static int batch_size;
+static int batch_timeout;
 
 static int component_register(void) {
     mca_base_component_t *c = &mca_db_odbc_component.base_version;
@@ -93,6 +95,29 @@ static int component_register(void) {
                                           MCA_BASE_VAR_SCOPE_READONLY,
                                           &user);
 
+    /* number of data samples to coalesce into a single execute */
+    batch_size = 1;
+    (void)mca_base_component_var_register(c, "batch_size",
+                                          "Number of data samples to stage "
+                                          "and send to the database in a "
+                                          "single execute (1 = disable "
+                                          "batching)",
+                                          MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          OPAL_INFO_LVL_9,
+                                          MCA_BASE_VAR_SCOPE_READONLY,
+                                          &batch_size);
+
+    /* max time a staged data sample may wait before being flushed */
+    batch_timeout = 1000;
+    (void)mca_base_component_var_register(c, "batch_timeout",
+                                          "Max time (in msec) a staged data "
+                                          "sample may wait before the batch "
+                                          "is flushed to the database",
+                                          MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          OPAL_INFO_LVL_9,
+                                          MCA_BASE_VAR_SCOPE_READONLY,
+                                          &batch_timeout);
+
     return ORCM_SUCCESS;
 }
 
@@ -151,6 +176,8 @@ static orcm_db_base_module_t *component_create(opal_list_t *props)
     if (NULL == mod->user && NULL != user) {
         mod->user = strdup(user);
     }
+    mod->batch.size = batch_size;
+    mod->batch.timeout = batch_timeout;
 
     /* let the module init */
     if (ORCM_SUCCESS != mod->api.init((struct orcm_db_base_module_t*)mod)) {
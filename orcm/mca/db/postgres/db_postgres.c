@@ -46,6 +46,11 @@ static void postgres_finalize(struct orcm_db_base_module_t *imod);
 static int postgres_store_sample(struct orcm_db_base_module_t *imod,
                                  const char *data_group,
                                  opal_list_t *kvs);
+static int postgres_record_data_samples(struct orcm_db_base_module_t *imod,
+                                        const char *hostname,
+                                        const struct timeval *time_stamp,
+                                        const char *data_group,
+                                        opal_list_t *samples);
 static int postgres_update_node_features(struct orcm_db_base_module_t *imod,
                                          const char *hostname,
                                          opal_list_t *features);
@@ -58,8 +63,18 @@ static int postgres_record_diag_test(struct orcm_db_base_module_t *imod,
                                      const int *component_index,
                                      const char *test_result,
                                      opal_list_t *test_params);
+static void postgres_commit(struct orcm_db_base_module_t *imod);
 
 /* Internal helper functions */
+static int postgres_batch_add(mca_db_postgres_module_t *mod,
+                              const char *hostname,
+                              const char *data_group,
+                              const char *data_item,
+                              const char *time_stamp,
+                              const orcm_db_item_t *item,
+                              const char *units);
+static int postgres_batch_done(mca_db_postgres_module_t *mod);
+static int postgres_batch_flush(mca_db_postgres_module_t *mod);
 static void tv_to_str_time_stamp(const struct timeval *time, char *tbuf,
                                  size_t size);
 static void tm_to_str_time_stamp(const struct tm *time, char *tbuf,
@@ -71,10 +86,10 @@ mca_db_postgres_module_t mca_db_postgres_module = {
         postgres_init,
         postgres_finalize,
         postgres_store_sample,
-        NULL,
+        postgres_record_data_samples,
         postgres_update_node_features,
         postgres_record_diag_test,
-        NULL,
+        postgres_commit,
         NULL,
         NULL
     },
@@ -148,6 +163,8 @@ static int postgres_init(struct orcm_db_base_module_t *imod)
         mod->prepared[i] = false;
     }
 
+    mod->batch.timer_active = false;
+
     opal_output_verbose(5, orcm_db_base_framework.framework_output,
                         "db:postgres: Connection established to %s",
                         mod->dbname);
@@ -175,8 +192,17 @@ static void postgres_finalize(struct orcm_db_base_module_t *imod)
         free(mod->pgtty);
     }
     if (NULL != mod->conn) {
+        /* push out anything still staged before disconnecting */
+        postgres_batch_flush(mod);
         PQfinish(mod->conn);
     }
+    if (mod->batch.timer_active) {
+        opal_event_evtimer_del(&mod->batch.ev);
+        mod->batch.timer_active = false;
+    }
+    if (NULL != mod->batch.buf) {
+        free(mod->batch.buf);
+    }
 }
 
 #define ERR_MSG_STORE(msg) \
@@ -277,6 +303,38 @@ static int postgres_store_sample(struct orcm_db_base_module_t *imod,
     OBJ_RELEASE(timestamp_item);
     OBJ_RELEASE(hostname_item);
 
+    if (1 < mod->batch.size) {
+        /* stage the samples and let them be streamed with COPY */
+        OPAL_LIST_FOREACH(kv, kvs, opal_value_t) {
+            /* kv->key will contain: <data_item>:<units> */
+            data_item_parts = opal_argv_split(kv->key, ':');
+            count = opal_argv_count(data_item_parts);
+            if (0 == count) {
+                opal_argv_free(data_item_parts);
+                ERR_MSG_STORE("No data item specified");
+                return ORCM_ERR_BAD_PARAM;
+            }
+
+            ret = opal_value_to_orcm_db_item(kv, &item);
+            if (ORCM_SUCCESS != ret) {
+                opal_argv_free(data_item_parts);
+                ERR_MSG_FMT_STORE("Unsupported data type: %s",
+                                  opal_dss.lookup_data_type(kv->type));
+                return ORCM_ERR_NOT_SUPPORTED;
+            }
+
+            ret = postgres_batch_add(mod, hostname, data_group,
+                                     data_item_parts[0], time_stamp, &item,
+                                     count > 1 ? data_item_parts[1] : NULL);
+            opal_argv_free(data_item_parts);
+            if (ORCM_SUCCESS != ret) {
+                return ret;
+            }
+        }
+
+        return postgres_batch_done(mod);
+    }
+
     num_items = opal_list_get_size(kvs);
     rows = (char **)malloc(sizeof(char *) * (num_items + 1));
     for (i = 0; i < num_items + 1; i++) {
@@ -384,6 +442,325 @@ static int postgres_store_sample(struct orcm_db_base_module_t *imod,
     return ORCM_SUCCESS;
 }
 
+static int postgres_record_data_samples(struct orcm_db_base_module_t *imod,
+                                        const char *hostname,
+                                        const struct timeval *time_stamp,
+                                        const char *data_group,
+                                        opal_list_t *samples)
+{
+    mca_db_postgres_module_t *mod = (mca_db_postgres_module_t*)imod;
+    orcm_metric_value_t *mv;
+    orcm_db_item_t item;
+    char time_stamp_str[40];
+    int ret;
+
+    if (NULL == data_group) {
+        ERR_MSG_STORE("No data group provided");
+        return ORCM_ERR_BAD_PARAM;
+    }
+
+    if (NULL == hostname) {
+        ERR_MSG_STORE("No hostname provided");
+        return ORCM_ERR_BAD_PARAM;
+    }
+
+    if (NULL == time_stamp) {
+        ERR_MSG_STORE("No time stamp provided");
+        return ORCM_ERR_BAD_PARAM;
+    }
+
+    if (NULL == samples) {
+        ERR_MSG_STORE("No value list provided");
+        return ORCM_ERR_BAD_PARAM;
+    }
+
+    /* all the samples share the time stamp, so format it only once */
+    tv_to_str_time_stamp(time_stamp, time_stamp_str, sizeof(time_stamp_str));
+
+    OPAL_LIST_FOREACH(mv, samples, orcm_metric_value_t) {
+        if (NULL == mv->value.key || 0 == strlen(mv->value.key)) {
+            ERR_MSG_STORE("Key or data item name not provided for value");
+            return ORCM_ERR_BAD_PARAM;
+        }
+
+        ret = opal_value_to_orcm_db_item(&mv->value, &item);
+        if (ORCM_SUCCESS != ret) {
+            ERR_MSG_FMT_STORE("Unsupported data type: %s",
+                              opal_dss.lookup_data_type(mv->value.type));
+            return ORCM_ERR_NOT_SUPPORTED;
+        }
+
+        ret = postgres_batch_add(mod, hostname, data_group, mv->value.key,
+                                 time_stamp_str, &item, mv->units);
+        if (ORCM_SUCCESS != ret) {
+            return ret;
+        }
+    }
+
+    return postgres_batch_done(mod);
+}
+
+static void postgres_commit(struct orcm_db_base_module_t *imod)
+{
+    postgres_batch_flush((mca_db_postgres_module_t*)imod);
+}
+
+#define ORCM_PG_BATCH_INITIAL_SIZE 65536
+
+static int batch_reserve(mca_db_postgres_batch_t *batch, size_t len)
+{
+    size_t alloc;
+    char *buf;
+
+    if (batch->len + len <= batch->alloc) {
+        return ORCM_SUCCESS;
+    }
+
+    alloc = 0 == batch->alloc ? ORCM_PG_BATCH_INITIAL_SIZE : batch->alloc;
+    while (alloc < batch->len + len) {
+        alloc *= 2;
+    }
+    if (NULL == (buf = (char*)realloc(batch->buf, alloc))) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    batch->buf = buf;
+    batch->alloc = alloc;
+
+    return ORCM_SUCCESS;
+}
+
+/* Append a column in COPY text format: NULL is \N and backslash, tab,
+ * newline and carriage return are escaped */
+static int batch_append_column(mca_db_postgres_batch_t *batch,
+                               const char *str, char delim)
+{
+    const char *p;
+    char *out;
+
+    if (NULL == str) {
+        if (ORCM_SUCCESS != batch_reserve(batch, 3)) {
+            return ORCM_ERR_OUT_OF_RESOURCE;
+        }
+        out = batch->buf + batch->len;
+        *out++ = '\\';
+        *out++ = 'N';
+        *out++ = delim;
+        batch->len += 3;
+        return ORCM_SUCCESS;
+    }
+
+    /* worst case every character needs escaping */
+    if (ORCM_SUCCESS != batch_reserve(batch, 2 * strlen(str) + 1)) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    out = batch->buf + batch->len;
+    for (p = str; '\0' != *p; p++) {
+        switch (*p) {
+        case '\\':
+            *out++ = '\\';
+            *out++ = '\\';
+            break;
+        case '\t':
+            *out++ = '\\';
+            *out++ = 't';
+            break;
+        case '\n':
+            *out++ = '\\';
+            *out++ = 'n';
+            break;
+        case '\r':
+            *out++ = '\\';
+            *out++ = 'r';
+            break;
+        default:
+            *out++ = *p;
+        }
+    }
+    *out++ = delim;
+    batch->len = out - batch->buf;
+
+    return ORCM_SUCCESS;
+}
+
+static int postgres_batch_add(mca_db_postgres_module_t *mod,
+                              const char *hostname,
+                              const char *data_group,
+                              const char *data_item,
+                              const char *time_stamp,
+                              const orcm_db_item_t *item,
+                              const char *units)
+{
+    mca_db_postgres_batch_t *batch = &mod->batch;
+    size_t mark = batch->len;
+    char value[64];
+    char type[16];
+    int rc;
+
+    /* (hostname,
+     *  data_item,
+     *  time_stamp,
+     *  value_int,
+     *  value_real,
+     *  value_str,
+     *  units,
+     *  data_type_id) */
+    rc = batch_append_column(batch, hostname, '\t');
+    /* the data item is stored as <data group>_<data item> */
+    if (ORCM_SUCCESS == rc) {
+        rc = batch_append_column(batch, data_group, '_');
+    }
+    if (ORCM_SUCCESS == rc) {
+        rc = batch_append_column(batch, data_item, '\t');
+    }
+    if (ORCM_SUCCESS == rc) {
+        rc = batch_append_column(batch, time_stamp, '\t');
+    }
+    if (ORCM_SUCCESS == rc) {
+        switch (item->item_type) {
+        case ORCM_DB_ITEM_STRING:
+            rc = batch_append_column(batch, NULL, '\t');
+            if (ORCM_SUCCESS == rc) {
+                rc = batch_append_column(batch, NULL, '\t');
+            }
+            if (ORCM_SUCCESS == rc) {
+                rc = batch_append_column(batch, item->value.value_str, '\t');
+            }
+            break;
+        case ORCM_DB_ITEM_REAL:
+            snprintf(value, sizeof(value), "%.17g", item->value.value_real);
+            rc = batch_append_column(batch, NULL, '\t');
+            if (ORCM_SUCCESS == rc) {
+                rc = batch_append_column(batch, value, '\t');
+            }
+            if (ORCM_SUCCESS == rc) {
+                rc = batch_append_column(batch, NULL, '\t');
+            }
+            break;
+        default: /* ORCM_DB_ITEM_INTEGER */
+            snprintf(value, sizeof(value), "%lld", item->value.value_int);
+            rc = batch_append_column(batch, value, '\t');
+            if (ORCM_SUCCESS == rc) {
+                rc = batch_append_column(batch, NULL, '\t');
+            }
+            if (ORCM_SUCCESS == rc) {
+                rc = batch_append_column(batch, NULL, '\t');
+            }
+        }
+    }
+    if (ORCM_SUCCESS == rc) {
+        rc = batch_append_column(batch, units, '\t');
+    }
+    if (ORCM_SUCCESS == rc) {
+        snprintf(type, sizeof(type), "%d", item->opal_type);
+        rc = batch_append_column(batch, type, '\n');
+    }
+
+    if (ORCM_SUCCESS != rc) {
+        /* drop the partial row */
+        batch->len = mark;
+        ERR_MSG_STORE("Unable to stage data sample");
+        return rc;
+    }
+    batch->count++;
+
+    if (1 < batch->size && batch->size <= batch->count) {
+        return postgres_batch_flush(mod);
+    }
+
+    return ORCM_SUCCESS;
+}
+
+static void postgres_batch_timeout(int fd, short args, void *cbdata)
+{
+    mca_db_postgres_module_t *mod = (mca_db_postgres_module_t*)cbdata;
+
+    mod->batch.timer_active = false;
+    postgres_batch_flush(mod);
+}
+
+/* Called once a whole request has been staged */
+static int postgres_batch_done(mca_db_postgres_module_t *mod)
+{
+    mca_db_postgres_batch_t *batch = &mod->batch;
+    struct timeval tv;
+
+    if (0 == batch->count) {
+        return ORCM_SUCCESS;
+    }
+    if (1 >= batch->size || 0 >= batch->timeout) {
+        /* not batching across requests */
+        return postgres_batch_flush(mod);
+    }
+    if (!batch->timer_active) {
+        /* the timer must fire on the thread processing this handle */
+        opal_event_evtimer_set(orcm_db_base_module_evbase(
+                                   (struct orcm_db_base_module_t*)mod),
+                               &batch->ev, postgres_batch_timeout, mod);
+        tv.tv_sec = batch->timeout / 1000;
+        tv.tv_usec = (batch->timeout % 1000) * 1000;
+        opal_event_evtimer_add(&batch->ev, &tv);
+        batch->timer_active = true;
+    }
+
+    return ORCM_SUCCESS;
+}
+
+static int postgres_batch_flush(mca_db_postgres_module_t *mod)
+{
+    mca_db_postgres_batch_t *batch = &mod->batch;
+    int rows = batch->count;
+    int rc = ORCM_SUCCESS;
+    PGresult *res;
+
+    if (batch->timer_active) {
+        opal_event_evtimer_del(&batch->ev);
+        batch->timer_active = false;
+    }
+
+    if (0 == rows) {
+        return ORCM_SUCCESS;
+    }
+    /* the staged rows are consumed whatever the outcome */
+    batch->count = 0;
+
+    res = PQexec(mod->conn, "copy data_sample_raw(hostname,data_item,"
+                 "time_stamp,value_int,value_real,value_str,units,"
+                 "data_type_id) from stdin");
+    if (PGRES_COPY_IN != PQresultStatus(res)) {
+        ERR_MSG_FMT_STORE("%s", PQresultErrorMessage(res));
+        PQclear(res);
+        batch->len = 0;
+        return ORCM_ERROR;
+    }
+    PQclear(res);
+
+    if (1 != PQputCopyData(mod->conn, batch->buf, (int)batch->len)) {
+        ERR_MSG_FMT_STORE("%s", PQerrorMessage(mod->conn));
+        PQputCopyEnd(mod->conn, "unable to send staged data samples");
+        rc = ORCM_ERROR;
+    } else if (1 != PQputCopyEnd(mod->conn, NULL)) {
+        ERR_MSG_FMT_STORE("%s", PQerrorMessage(mod->conn));
+        rc = ORCM_ERROR;
+    }
+    batch->len = 0;
+
+    /* collect the result of the COPY */
+    while (NULL != (res = PQgetResult(mod->conn))) {
+        if (ORCM_SUCCESS == rc && !status_ok(res)) {
+            ERR_MSG_FMT_STORE("%s", PQresultErrorMessage(res));
+            rc = ORCM_ERROR;
+        }
+        PQclear(res);
+    }
+
+    if (ORCM_SUCCESS == rc) {
+        opal_output_verbose(2, orcm_db_base_framework.framework_output,
+                            "db:postgres: Flushed %d data samples", rows);
+    }
+
+    return rc;
+}
+
 #define ERR_MSG_UNF(msg) \
     opal_output(0, "***********************************************"); \
     opal_output(0, "db:postgres: Unable to update node features"); \
@@ -26,6 +26,22 @@ typedef enum {
     ORCM_DB_PG_STMT_NUM_STMTS
 } orcm_db_postgres_prepared_statement_t;
 
+/*
+ * Staging buffer for data samples streamed to the database with
+ * "COPY ... FROM STDIN". Rows are kept in COPY text format so a flush
+ * is a single round trip with no per-row statement parsing/planning.
+ */
+typedef struct {
+    int size;       /* max number of staged samples before a flush */
+    int count;      /* number of samples currently staged */
+    int timeout;    /* max msec a staged sample may wait before a flush */
+    char *buf;
+    size_t len;
+    size_t alloc;
+    opal_event_t ev;
+    bool timer_active;
+} mca_db_postgres_batch_t;
+
 typedef struct {
     orcm_db_base_module_t api;
     char *pguri;
@@ -35,6 +51,7 @@ typedef struct {
     char *user;
     PGconn *conn;
     bool prepared[ORCM_DB_PG_STMT_NUM_STMTS];
+    mca_db_postgres_batch_t batch;
 } mca_db_postgres_module_t;
 ORCM_MODULE_DECLSPEC extern mca_db_postgres_module_t mca_db_postgres_module;
 
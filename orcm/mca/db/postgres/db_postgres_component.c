@@ -64,6 +64,8 @@ static char *pgoptions;
 static char *pgtty;
 static char *dbname;
 static char *user;
+static int batch_size;
+static int batch_timeout;
 
 static int component_register(void) {
     mca_base_component_t *c = &mca_db_postgres_component.base_version;
@@ -113,6 +115,29 @@ static int component_register(void) {
                                           MCA_BASE_VAR_SCOPE_READONLY,
                                           &user);
 
+    /* number of data samples to stage before streaming them with COPY */
+    batch_size = 1;
+    (void)mca_base_component_var_register(c, "batch_size",
+                                          "Number of data samples to stage "
+                                          "and stream to the database with "
+                                          "a single COPY (1 = disable "
+                                          "batching)",
+                                          MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          OPAL_INFO_LVL_9,
+                                          MCA_BASE_VAR_SCOPE_READONLY,
+                                          &batch_size);
+
+    /* max time a staged data sample may wait before being flushed */
+    batch_timeout = 1000;
+    (void)mca_base_component_var_register(c, "batch_timeout",
+                                          "Max time (in msec) a staged data "
+                                          "sample may wait before the batch "
+                                          "is flushed to the database",
+                                          MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          OPAL_INFO_LVL_9,
+                                          MCA_BASE_VAR_SCOPE_READONLY,
+                                          &batch_timeout);
+
     return ORCM_SUCCESS;
 }
 
@@ -180,6 +205,8 @@ static orcm_db_base_module_t *component_create(opal_list_t *props)
     if (NULL == mod->user && NULL != user) {
         mod->user = strdup(user);
     }
+    mod->batch.size = batch_size;
+    mod->batch.timeout = batch_timeout;
 
     /* let the module init */
     if (ORCM_SUCCESS != mod->api.init((struct orcm_db_base_module_t*)mod)) {
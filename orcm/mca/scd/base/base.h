@@ -121,6 +121,49 @@ ORCM_DECLSPEC void scd_base_rm_finalize(void);
 ORCM_DECLSPEC int orcm_scd_base_rm_comm_start(void);
 ORCM_DECLSPEC int orcm_scd_base_rm_comm_stop(void);
 
+/* node index and free-node pool - a node is free when it is up and
+ * unallocated. Call orcm_scd_base_node_update after changing either
+ * state of a node so the pool stays in step */
+ORCM_DECLSPEC int orcm_scd_base_node_index_init(void);
+ORCM_DECLSPEC void orcm_scd_base_node_index_finalize(void);
+ORCM_DECLSPEC orcm_node_t* orcm_scd_base_node_lookup(const char *name, int *slot);
+ORCM_DECLSPEC void orcm_scd_base_node_update(orcm_node_t *node);
+ORCM_DECLSPEC int orcm_scd_base_num_free_nodes(void);
+/* allocate num_nodes free nodes, returning their regex */
+ORCM_DECLSPEC int orcm_scd_base_take_free_nodes(int num_nodes, char **regex);
+/* set the scd_state of every node in a regex */
+ORCM_DECLSPEC int orcm_scd_base_set_nodes_state(const char *regex,
+                                                orcm_scd_node_state_t state);
+
+/* the filters of an ORCM_NODE_QUERY_COMMAND - each node's state
+ * changes are stamped with an epoch, so a query can ask for only the
+ * nodes that changed since its last answer */
+typedef struct {
+    orcm_node_state_t state;         /* -1 for any */
+    orcm_scd_node_state_t scd_state; /* -1 for any */
+    char *regex;                     /* NULL for all nodes */
+    char *rack;                      /* NULL for any */
+    uint64_t since;
+    int32_t offset;
+    int32_t limit;                   /* 0 for no limit */
+} orcm_scd_node_query_t;
+ORCM_DECLSPEC int orcm_scd_base_node_query(opal_buffer_t *buf, orcm_scd_node_query_t *query);
+
+/* session store - every queued session is found by id, and each
+ * queue keeps its sessions in a heap ordered by priority and then
+ * submission. Sessions must enter and leave queues through these
+ * calls so the heap and index stay in step with q->sessions */
+ORCM_DECLSPEC int orcm_scd_base_session_store_init(void);
+ORCM_DECLSPEC void orcm_scd_base_session_store_finalize(void);
+ORCM_DECLSPEC orcm_queue_t* orcm_scd_base_get_queue(const char *name);
+ORCM_DECLSPEC int orcm_scd_base_queue_add(orcm_queue_t *q, orcm_session_t *session);
+ORCM_DECLSPEC void orcm_scd_base_queue_remove(orcm_session_t *session);
+ORCM_DECLSPEC orcm_session_t* orcm_scd_base_session_find(orcm_session_id_t id);
+/* fill sessions with up to max of the queue's sessions in priority
+ * order, without removing them, and return how many were found */
+ORCM_DECLSPEC int orcm_scd_base_queue_top(orcm_queue_t *q, orcm_session_t **sessions,
+                                          int max);
+
 /* base code stubs */
 ORCM_DECLSPEC void orcm_scd_base_activate_session_state(orcm_session_t *s,
                                                         orcm_scd_session_state_t state);
@@ -233,6 +233,7 @@ static int orcm_scd_base_close(void)
     /* deconstruct the base objects */
     OPAL_LIST_DESTRUCT(&orcm_scd_base.states);
     OPAL_LIST_DESTRUCT(&orcm_scd_base.rmstates);
+    orcm_scd_base_session_store_finalize();
     OPAL_LIST_DESTRUCT(&orcm_scd_base.queues);
     OPAL_LIST_DESTRUCT(&orcm_scd_base.tracking);
     
@@ -249,6 +250,7 @@ static int orcm_scd_base_close(void)
         }
     }
     OBJ_DESTRUCT(&orcm_scd_base.nodes);
+    orcm_scd_base_node_index_finalize();
     
     /* give the selected plugin a chance to finalize */
     if (NULL != orcm_scd_base.module->finalize) {
@@ -278,6 +280,12 @@ static int orcm_scd_base_open(mca_base_open_flag_t flags)
     OBJ_CONSTRUCT(&orcm_scd_base.topologies, opal_pointer_array_t);
     opal_pointer_array_init(&orcm_scd_base.topologies, 1, INT_MAX, 1);
     OBJ_CONSTRUCT(&orcm_scd_base.tracking, opal_list_t);
+    if (ORCM_SUCCESS != (rc = orcm_scd_base_node_index_init())) {
+        return rc;
+    }
+    if (ORCM_SUCCESS != (rc = orcm_scd_base_session_store_init())) {
+        return rc;
+    }
 
     if (OPAL_SUCCESS !=
         (rc = mca_base_framework_components_open(&orcm_scd_base_framework,
@@ -488,6 +496,9 @@ static void sess_con(orcm_session_t *s)
 {
     s->alloc = NULL;
     OBJ_CONSTRUCT(&s->steps, opal_list_t);
+    s->start = 0;
+    s->queue = NULL;
+    s->heap_index = -1;
 }
 static void sess_des(orcm_session_t *s)
 {
@@ -505,6 +516,9 @@ static void queue_con(orcm_queue_t *q)
     q->name = NULL;
     q->priority = 1;
     OBJ_CONSTRUCT(&q->sessions, opal_list_t);
+    q->heap = NULL;
+    q->heap_size = 0;
+    q->heap_alloc = 0;
 }
 static void queue_des(orcm_queue_t *q)
 {
@@ -512,6 +526,9 @@ static void queue_des(orcm_queue_t *q)
         free(q->name);
     }
     OPAL_LIST_DESTRUCT(&q->sessions);
+    if (NULL != q->heap) {
+        free(q->heap);
+    }
 }
 OBJ_CLASS_INSTANCE(orcm_queue_t,
                    opal_list_item_t,
@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Node index and free-node pool. Nodes are found by name through a
+ * hash of their slot in orcm_scd_base.nodes, and the nodes that can
+ * be allocated - up and unallocated - are kept as a bitmap of slots
+ * with a count. Whoever changes a node's state or scd_state calls
+ * orcm_scd_base_node_update so the pool follows, which lets the
+ * scheduler size and pick allocations without walking every node.
+ * The same call stamps the node with a new epoch when either state
+ * really changed, which node queries use to answer with only the
+ * nodes a poller has not yet seen.
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+#include "orcm/types.h"
+
+#include <string.h>
+
+#include "opal/dss/dss.h"
+
+#include "opal/class/opal_hash_table.h"
+#include "opal/util/argv.h"
+#include "opal/util/output.h"
+
+#include "orte/mca/errmgr/errmgr.h"
+#include "orte/util/name_fns.h"
+#include "orte/util/regex.h"
+#include "orte/runtime/orte_globals.h"
+
+#include "orcm/runtime/orcm_globals.h"
+#include "orcm/mca/scd/base/base.h"
+
+static bool initialized = false;
+static opal_hash_table_t by_name;   /* node name -> slot + 1 */
+static uint64_t *free_bits = NULL;
+static int nwords = 0;
+static int nfree = 0;
+static int nindexed = -1;           /* nodes in the index, -1 if not built */
+static uint64_t epoch = 0;          /* stamp of the latest node change */
+static uint64_t *stamps = NULL;     /* per slot: epoch of its last change */
+static uint16_t *seen = NULL;       /* per slot: states at that change */
+static int nslots = 0;
+static orcm_node_t **matched = NULL;    /* scratch for node queries */
+static int nmatched_alloc = 0;
+
+#define NODE_STATES(n)                                          \
+    ((uint16_t)(((uint8_t)(n)->state << 8) | (uint8_t)(n)->scd_state))
+
+#define NODE_IS_FREE(n)                                 \
+    (ORCM_SCD_NODE_STATE_UNALLOC == (n)->scd_state &&   \
+     ORCM_NODE_STATE_UP == (n)->state)
+
+int orcm_scd_base_node_index_init(void)
+{
+    if (initialized) {
+        return ORCM_SUCCESS;
+    }
+    OBJ_CONSTRUCT(&by_name, opal_hash_table_t);
+    opal_hash_table_init(&by_name, 1024);
+    initialized = true;
+    nindexed = -1;
+    return ORCM_SUCCESS;
+}
+
+void orcm_scd_base_node_index_finalize(void)
+{
+    if (!initialized) {
+        return;
+    }
+    OBJ_DESTRUCT(&by_name);
+    free(free_bits);
+    free_bits = NULL;
+    free(stamps);
+    stamps = NULL;
+    free(seen);
+    seen = NULL;
+    nslots = 0;
+    free(matched);
+    matched = NULL;
+    nmatched_alloc = 0;
+    nwords = 0;
+    nfree = 0;
+    nindexed = -1;
+    initialized = false;
+}
+
+/* nodes are added to orcm_scd_base.nodes by the sst at startup, so
+ * (re)build the index the first time it is used after that */
+static int sync_index(void)
+{
+    orcm_node_t *node;
+    uint64_t *st;
+    uint16_t *sn;
+    int i, n;
+
+    if (!initialized) {
+        return ORCM_ERR_NOT_AVAILABLE;
+    }
+    n = orcm_scd_base.nodes.size - orcm_scd_base.nodes.number_free;
+    if (n == nindexed) {
+        return ORCM_SUCCESS;
+    }
+
+    opal_hash_table_remove_all(&by_name);
+    free(free_bits);
+    nwords = (orcm_scd_base.nodes.size + 63) / 64;
+    if (NULL == (free_bits = (uint64_t*)calloc(nwords + 1, sizeof(uint64_t)))) {
+        nwords = 0;
+        nindexed = -1;
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    /* stamps follow the slots, so nodes already known keep theirs
+     * and the new ones are stamped as changed now */
+    if (nslots < orcm_scd_base.nodes.size) {
+        n = orcm_scd_base.nodes.size;
+        if (NULL == (st = (uint64_t*)realloc(stamps, n * sizeof(uint64_t)))) {
+            nindexed = -1;
+            return ORCM_ERR_OUT_OF_RESOURCE;
+        }
+        stamps = st;
+        if (NULL == (sn = (uint16_t*)realloc(seen, n * sizeof(uint16_t)))) {
+            nindexed = -1;
+            return ORCM_ERR_OUT_OF_RESOURCE;
+        }
+        seen = sn;
+        memset(&stamps[nslots], 0, (n - nslots) * sizeof(uint64_t));
+        memset(&seen[nslots], 0, (n - nslots) * sizeof(uint16_t));
+        nslots = n;
+    }
+    epoch++;
+
+    nfree = 0;
+    for (i=0; i < orcm_scd_base.nodes.size; i++) {
+        if (NULL == (node = (orcm_node_t*)opal_pointer_array_get_item(&orcm_scd_base.nodes, i)) ||
+            NULL == node->name) {
+            continue;
+        }
+        opal_hash_table_set_value_ptr(&by_name, node->name, strlen(node->name),
+                                      (void*)(uintptr_t)(i + 1));
+        if (0 == stamps[i]) {
+            stamps[i] = epoch;
+            seen[i] = NODE_STATES(node);
+        }
+        if (NODE_IS_FREE(node)) {
+            free_bits[i / 64] |= (uint64_t)1 << (i % 64);
+            nfree++;
+        }
+    }
+    nindexed = orcm_scd_base.nodes.size - orcm_scd_base.nodes.number_free;
+    return ORCM_SUCCESS;
+}
+
+orcm_node_t* orcm_scd_base_node_lookup(const char *name, int *slot)
+{
+    void *val;
+    int i;
+
+    if (NULL == name || ORCM_SUCCESS != sync_index() ||
+        OPAL_SUCCESS != opal_hash_table_get_value_ptr(&by_name, name,
+                                                      strlen(name), &val)) {
+        return NULL;
+    }
+    i = (int)(uintptr_t)val - 1;
+    if (NULL != slot) {
+        *slot = i;
+    }
+    return (orcm_node_t*)opal_pointer_array_get_item(&orcm_scd_base.nodes, i);
+}
+
+void orcm_scd_base_node_update(orcm_node_t *node)
+{
+    uint64_t bit, *word;
+    int i;
+
+    if (NULL == orcm_scd_base_node_lookup(node->name, &i)) {
+        return;
+    }
+    if (seen[i] != NODE_STATES(node)) {
+        seen[i] = NODE_STATES(node);
+        stamps[i] = ++epoch;
+    }
+    word = &free_bits[i / 64];
+    bit = (uint64_t)1 << (i % 64);
+    if (NODE_IS_FREE(node)) {
+        if (0 == (*word & bit)) {
+            *word |= bit;
+            nfree++;
+        }
+    } else if (0 != (*word & bit)) {
+        *word &= ~bit;
+        nfree--;
+    }
+}
+
+int orcm_scd_base_num_free_nodes(void)
+{
+    if (ORCM_SUCCESS != sync_index()) {
+        return 0;
+    }
+    return nfree;
+}
+
+int orcm_scd_base_take_free_nodes(int num_nodes, char **regex)
+{
+    orcm_node_t *node;
+    orte_nodeset_t taken;
+    uint64_t w;
+    int i, k, n = 0, rc;
+
+    *regex = NULL;
+    if (ORCM_SUCCESS != (rc = sync_index())) {
+        return rc;
+    }
+    if (num_nodes <= 0 || num_nodes > nfree) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+
+    /* lowest free slots first, a word of 64 nodes at a time - the
+     * nodeset gathers runs of names into ranges as they come */
+    OBJ_CONSTRUCT(&taken, orte_nodeset_t);
+    for (k=0; k < nwords && n < num_nodes; k++) {
+        for (w = free_bits[k]; 0 != w && n < num_nodes; w &= w - 1) {
+            i = k * 64 + __builtin_ctzll(w);
+            node = (orcm_node_t*)opal_pointer_array_get_item(&orcm_scd_base.nodes, i);
+            if (ORTE_SUCCESS != (rc = orte_nodeset_add(&taken, node->name))) {
+                ORTE_ERROR_LOG(rc);
+                OBJ_DESTRUCT(&taken);
+                return rc;
+            }
+            n++;
+        }
+    }
+    if (ORTE_SUCCESS != (rc = orte_regex_create_nodeset(&taken, regex))) {
+        ORTE_ERROR_LOG(rc);
+        OBJ_DESTRUCT(&taken);
+        return rc;
+    }
+    OBJ_DESTRUCT(&taken);
+
+    /* only now take them - the same nodes, as nothing changed */
+    for (k=0, n=0; k < nwords && n < num_nodes; k++) {
+        for (w = free_bits[k]; 0 != w && n < num_nodes; w &= w - 1) {
+            i = k * 64 + __builtin_ctzll(w);
+            node = (orcm_node_t*)opal_pointer_array_get_item(&orcm_scd_base.nodes, i);
+            node->scd_state = ORCM_SCD_NODE_STATE_ALLOC;
+            orcm_scd_base_node_update(node);
+            n++;
+        }
+    }
+    return ORCM_SUCCESS;
+}
+
+int orcm_scd_base_set_nodes_state(const char *regex, orcm_scd_node_state_t state)
+{
+    orcm_node_t *node;
+    char **names = NULL;
+    int i, rc;
+
+    if (ORTE_SUCCESS != (rc = orte_regex_extract_node_names((char*)regex, &names))) {
+        ORTE_ERROR_LOG(rc);
+        opal_argv_free(names);
+        return rc;
+    }
+    for (i=0; NULL != names && NULL != names[i]; i++) {
+        if (NULL != (node = orcm_scd_base_node_lookup(names[i], NULL))) {
+            node->scd_state = state;
+            orcm_scd_base_node_update(node);
+        }
+    }
+    opal_argv_free(names);
+    return ORCM_SUCCESS;
+}
+
+static bool query_match(orcm_scd_node_query_t *query, orcm_node_t *node, int slot)
+{
+    orcm_rack_t *rack = (orcm_rack_t*)node->rack;
+
+    if (stamps[slot] <= query->since) {
+        return false;
+    }
+    if (0 <= query->state && node->state != query->state) {
+        return false;
+    }
+    if (0 <= query->scd_state && node->scd_state != query->scd_state) {
+        return false;
+    }
+    if (NULL != query->rack &&
+        (NULL == rack || NULL == rack->name || 0 != strcmp(rack->name, query->rack))) {
+        return false;
+    }
+    return true;
+}
+
+static int query_add(orcm_node_t *node, int32_t *nmatched)
+{
+    orcm_node_t **m;
+    int n;
+
+    if (*nmatched == nmatched_alloc) {
+        n = (0 == nmatched_alloc) ? 256 : 2 * nmatched_alloc;
+        if (NULL == (m = (orcm_node_t**)realloc(matched, n * sizeof(orcm_node_t*)))) {
+            return ORCM_ERR_OUT_OF_RESOURCE;
+        }
+        matched = m;
+        nmatched_alloc = n;
+    }
+    matched[(*nmatched)++] = node;
+    return ORCM_SUCCESS;
+}
+
+int orcm_scd_base_node_query(opal_buffer_t *buf, orcm_scd_node_query_t *query)
+{
+    orcm_node_t *node;
+    char **names = NULL;
+    int32_t total = 0, nmatched = 0;
+    int i, slot, rc;
+
+    if (ORCM_SUCCESS != (rc = sync_index())) {
+        return rc;
+    }
+
+    /* a regex names the nodes outright, so only those are looked at */
+    if (NULL != query->regex) {
+        if (ORTE_SUCCESS != (rc = orte_regex_extract_node_names(query->regex, &names))) {
+            ORTE_ERROR_LOG(rc);
+            opal_argv_free(names);
+            return rc;
+        }
+    }
+    for (i=0; ; i++) {
+        if (NULL != query->regex) {
+            if (NULL == names || NULL == names[i]) {
+                break;
+            }
+            if (NULL == (node = orcm_scd_base_node_lookup(names[i], &slot))) {
+                continue;
+            }
+        } else {
+            if (orcm_scd_base.nodes.size <= i) {
+                break;
+            }
+            if (NULL == (node = (orcm_node_t*)opal_pointer_array_get_item(&orcm_scd_base.nodes, i))) {
+                continue;
+            }
+            slot = i;
+        }
+        /* a state written without orcm_scd_base_node_update still
+         * has to reach delta pollers - stamp it now */
+        if (seen[slot] != NODE_STATES(node)) {
+            orcm_scd_base_node_update(node);
+        }
+        if (!query_match(query, node, slot)) {
+            continue;
+        }
+        if (total++ < query->offset ||
+            (0 < query->limit && query->limit <= nmatched)) {
+            continue;
+        }
+        if (ORCM_SUCCESS != (rc = query_add(node, &nmatched))) {
+            ORTE_ERROR_LOG(rc);
+            opal_argv_free(names);
+            return rc;
+        }
+    }
+    opal_argv_free(names);
+
+    if (OPAL_SUCCESS != (rc = opal_dss.pack(buf, &epoch, 1, OPAL_UINT64)) ||
+        OPAL_SUCCESS != (rc = opal_dss.pack(buf, &total, 1, OPAL_INT32)) ||
+        OPAL_SUCCESS != (rc = opal_dss.pack(buf, &nmatched, 1, OPAL_INT32))) {
+        ORTE_ERROR_LOG(rc);
+        return rc;
+    }
+    if (0 < nmatched &&
+        OPAL_SUCCESS != (rc = opal_dss.pack(buf, matched, nmatched, ORCM_NODE))) {
+        ORTE_ERROR_LOG(rc);
+        return rc;
+    }
+    return ORCM_SUCCESS;
+}
@@ -91,7 +91,8 @@ static void orcm_scd_base_recv(int status, orte_process_name_t* sender,
     orcm_queue_t *q;
     orcm_node_t **nodes;
     orcm_session_id_t sessionid;
-    bool per_session, found;
+    orcm_scd_node_query_t query;
+    bool per_session;
     int success = OPAL_SUCCESS;
 
     OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
@@ -373,6 +374,58 @@ static void orcm_scd_base_recv(int status, orte_process_name_t* sender,
             return;
         }
 
+        return;
+    } else if (ORCM_NODE_QUERY_COMMAND == command) {
+        memset(&query, 0, sizeof(query));
+        rmbuf = NULL;
+        cnt = 1;
+        if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &query.state,
+                                                  &cnt, ORCM_NODE_STATE_T)) ||
+            OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &query.scd_state,
+                                                  &cnt, ORCM_SCD_NODE_STATE_T)) ||
+            OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &query.regex,
+                                                  &cnt, OPAL_STRING)) ||
+            OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &query.rack,
+                                                  &cnt, OPAL_STRING)) ||
+            OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &query.since,
+                                                  &cnt, OPAL_UINT64)) ||
+            OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &query.offset,
+                                                  &cnt, OPAL_INT32)) ||
+            OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &query.limit,
+                                                  &cnt, OPAL_INT32))) {
+            ORTE_ERROR_LOG(rc);
+            result = rc;
+        } else {
+            /* the answer is packed after the status, so pack the
+             * results into their own buffer first */
+            rmbuf = OBJ_NEW(opal_buffer_t);
+            result = orcm_scd_base_node_query(rmbuf, &query);
+        }
+        if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT)) ||
+            (ORCM_SUCCESS == result &&
+             OPAL_SUCCESS != (rc = opal_dss.copy_payload(ans, rmbuf)))) {
+            ORTE_ERROR_LOG(rc);
+        }
+        if (NULL != rmbuf) {
+            OBJ_RELEASE(rmbuf);
+        }
+        if (NULL != query.regex) {
+            free(query.regex);
+        }
+        if (NULL != query.rack) {
+            free(query.rack);
+        }
+
+        /* send back results */
+        if (ORTE_SUCCESS != (rc = orte_rml.send_buffer_nb(sender, ans,
+                                                          ORCM_RML_TAG_SCD,
+                                                          orte_rml_send_callback,
+                                                          NULL))) {
+            ORTE_ERROR_LOG(rc);
+            OBJ_RELEASE(ans);
+            return;
+        }
+
         return;
     } else if (ORCM_SET_POWER_COMMAND == command) {
         cnt = 1;
@@ -479,150 +532,140 @@ static void orcm_scd_base_recv(int status, orte_process_name_t* sender,
             }
 
             //let's find the session
-            found = false;
-            /* for each queue, */
-            OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-                OPAL_LIST_FOREACH(session, &q->sessions, orcm_session_t) {
-                    alloc = session->alloc;
-                    if(alloc->id == sessionid) { //found the session
-                        found = true;
-                        switch(sub_command) {
-                        case ORCM_SET_POWER_BUDGET_COMMAND:
-                            if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &int_param,
-                                                                      &cnt, OPAL_INT32))) {
-                                ORTE_ERROR_LOG(rc);
-                                goto answer;
-                            }
-                            result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_POWER_BUDGET_KEY, 
-                                                        ORTE_ATTR_GLOBAL, &int_param, OPAL_INT32);
-                        break;
-                        case ORCM_SET_POWER_MODE_COMMAND:
-                            if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &int_param,
-                                                                      &cnt, OPAL_INT32))) {
-                                ORTE_ERROR_LOG(rc);
-                                goto answer;
-                            }
-                            result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_POWER_MODE_KEY, 
-                                                        ORTE_ATTR_GLOBAL, &int_param, OPAL_INT32);
-                            orcm_pwrmgmt.alloc_notify(alloc);
-                        break;
-                        case ORCM_SET_POWER_WINDOW_COMMAND:
-                            if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &int_param,
-                                                                      &cnt, OPAL_INT32))) {
-                                ORTE_ERROR_LOG(rc);
-                                goto answer;
-                            }
-                            result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_POWER_WINDOW_KEY, 
-                                                        ORTE_ATTR_GLOBAL, &int_param, OPAL_INT32);
-                        break;
-                        case ORCM_SET_POWER_OVERAGE_COMMAND:
-                            if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &int_param,
-                                                                      &cnt, OPAL_INT32))) {
-                                ORTE_ERROR_LOG(rc);
-                                goto answer;
-                            }
-                            result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_OVERAGE_LIMIT_KEY, 
-                                                        ORTE_ATTR_GLOBAL, &int_param, OPAL_INT32);
-                        break;
-                        case ORCM_SET_POWER_UNDERAGE_COMMAND:
-                            if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &int_param,
-                                                                      &cnt, OPAL_INT32))) {
-                                ORTE_ERROR_LOG(rc);
-                                goto answer;
-                            }
-                            result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_UNDERAGE_LIMIT_KEY, 
-                                                        ORTE_ATTR_GLOBAL, &int_param, OPAL_INT32);
-                        break;
-                        case ORCM_SET_POWER_OVERAGE_TIME_COMMAND:
-                            if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &int_param,
-                                                                      &cnt, OPAL_INT32))) {
-                                ORTE_ERROR_LOG(rc);
-                                goto answer;
-                            }
-                            result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_OVERAGE_TIME_LIMIT_KEY, 
-                                                        ORTE_ATTR_GLOBAL, &int_param, OPAL_INT32);
-                        break;
-                        case ORCM_SET_POWER_UNDERAGE_TIME_COMMAND:
-                            if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &int_param,
-                                                                      &cnt, OPAL_INT32))) {
-                                ORTE_ERROR_LOG(rc);
-                                goto answer;
-                            }
-                            result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_UNDERAGE_TIME_LIMIT_KEY, 
-                                                        ORTE_ATTR_GLOBAL, &int_param, OPAL_INT32);
-                        break;
-                        case ORCM_SET_POWER_FREQUENCY_COMMAND:
-                            if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &float_param,
-                                                                      &cnt, OPAL_FLOAT))) {
-                                ORTE_ERROR_LOG(rc);
-                                goto answer;
-                            }
-                            result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_MANUAL_FREQUENCY_KEY, 
-                                                        ORTE_ATTR_GLOBAL, &float_param, OPAL_FLOAT);
-                        break;
-                        case ORCM_SET_POWER_STRICT_COMMAND:
-                            if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &bool_param,
-                                                                      &cnt, OPAL_BOOL))) {
-                                ORTE_ERROR_LOG(rc);
-                                goto answer;
-                            }
-                            result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_FREQ_STRICT_KEY, 
-                                                        ORTE_ATTR_GLOBAL, &bool_param, OPAL_BOOL);
-                        break;
-                        default:
-                            result = ORTE_ERR_BAD_PARAM;
+            session = orcm_scd_base_session_find(sessionid);
+            if (NULL == session || NULL == session->queue) {
+                result = ORCM_ERR_NOT_FOUND;
+            } else {
+                alloc = session->alloc;
+                switch(sub_command) {
+                case ORCM_SET_POWER_BUDGET_COMMAND:
+                    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &int_param,
+                                                              &cnt, OPAL_INT32))) {
+                        ORTE_ERROR_LOG(rc);
+                        goto answer;
+                    }
+                    result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_POWER_BUDGET_KEY, 
+                                                ORTE_ATTR_GLOBAL, &int_param, OPAL_INT32);
+                break;
+                case ORCM_SET_POWER_MODE_COMMAND:
+                    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &int_param,
+                                                              &cnt, OPAL_INT32))) {
+                        ORTE_ERROR_LOG(rc);
+                        goto answer;
+                    }
+                    result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_POWER_MODE_KEY, 
+                                                ORTE_ATTR_GLOBAL, &int_param, OPAL_INT32);
+                    orcm_pwrmgmt.alloc_notify(alloc);
+                break;
+                case ORCM_SET_POWER_WINDOW_COMMAND:
+                    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &int_param,
+                                                              &cnt, OPAL_INT32))) {
+                        ORTE_ERROR_LOG(rc);
+                        goto answer;
+                    }
+                    result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_POWER_WINDOW_KEY, 
+                                                ORTE_ATTR_GLOBAL, &int_param, OPAL_INT32);
+                break;
+                case ORCM_SET_POWER_OVERAGE_COMMAND:
+                    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &int_param,
+                                                              &cnt, OPAL_INT32))) {
+                        ORTE_ERROR_LOG(rc);
+                        goto answer;
+                    }
+                    result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_OVERAGE_LIMIT_KEY, 
+                                                ORTE_ATTR_GLOBAL, &int_param, OPAL_INT32);
+                break;
+                case ORCM_SET_POWER_UNDERAGE_COMMAND:
+                    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &int_param,
+                                                              &cnt, OPAL_INT32))) {
+                        ORTE_ERROR_LOG(rc);
+                        goto answer;
+                    }
+                    result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_UNDERAGE_LIMIT_KEY, 
+                                                ORTE_ATTR_GLOBAL, &int_param, OPAL_INT32);
+                break;
+                case ORCM_SET_POWER_OVERAGE_TIME_COMMAND:
+                    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &int_param,
+                                                              &cnt, OPAL_INT32))) {
+                        ORTE_ERROR_LOG(rc);
+                        goto answer;
+                    }
+                    result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_OVERAGE_TIME_LIMIT_KEY, 
+                                                ORTE_ATTR_GLOBAL, &int_param, OPAL_INT32);
+                break;
+                case ORCM_SET_POWER_UNDERAGE_TIME_COMMAND:
+                    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &int_param,
+                                                              &cnt, OPAL_INT32))) {
+                        ORTE_ERROR_LOG(rc);
+                        goto answer;
+                    }
+                    result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_UNDERAGE_TIME_LIMIT_KEY, 
+                                                ORTE_ATTR_GLOBAL, &int_param, OPAL_INT32);
+                break;
+                case ORCM_SET_POWER_FREQUENCY_COMMAND:
+                    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &float_param,
+                                                              &cnt, OPAL_FLOAT))) {
+                        ORTE_ERROR_LOG(rc);
+                        goto answer;
+                    }
+                    result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_MANUAL_FREQUENCY_KEY, 
+                                                ORTE_ATTR_GLOBAL, &float_param, OPAL_FLOAT);
+                break;
+                case ORCM_SET_POWER_STRICT_COMMAND:
+                    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buffer, &bool_param,
+                                                              &cnt, OPAL_BOOL))) {
+                        ORTE_ERROR_LOG(rc);
+                        goto answer;
+                    }
+                    result = orte_set_attribute(&alloc->constraints, ORCM_PWRMGMT_FREQ_STRICT_KEY, 
+                                                ORTE_ATTR_GLOBAL, &bool_param, OPAL_BOOL);
+                break;
+                default:
+                    result = ORTE_ERR_BAD_PARAM;
+                }
+                if(!strncmp(session->queue->name, "running", 8)) {
+                    //session is currently running, send request to the RM
+                    rmbuf = OBJ_NEW(opal_buffer_t);
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(rmbuf, &command,
+                                    1, ORCM_RM_CMD_T))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(rmbuf);
+                        result = rc;
+                        if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
+                            ORTE_ERROR_LOG(rc);
+                            OBJ_RELEASE(ans);
+                            return;
                         }
-                        if(!strncmp(q->name, "running", 8)) {
-                            //session is currently running, send request to the RM
-                            rmbuf = OBJ_NEW(opal_buffer_t);
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(rmbuf, &command,
-                                            1, ORCM_RM_CMD_T))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(rmbuf);
-                                result = rc;
-                                if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
-                                    ORTE_ERROR_LOG(rc);
-                                    OBJ_RELEASE(ans);
-                                    return;
-                                }
-                                goto answer;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(rmbuf, &alloc,
-                                                        1, ORCM_ALLOC))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(rmbuf);
-                                result = rc;
-                                if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
-                                    ORTE_ERROR_LOG(rc);
-                                    OBJ_RELEASE(ans);
-                                    return;
-                                }
-                                goto answer;
-                            }
-                            if (ORTE_SUCCESS != (rc = orte_rml.send_buffer_nb(ORTE_PROC_MY_SCHEDULER,
-                                                      rmbuf,
-                                                      ORCM_RML_TAG_RM,
-                                                      orte_rml_send_callback,
-                                                      NULL))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(rmbuf);
-                                result = rc;
-                                if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
-                                    ORTE_ERROR_LOG(rc);
-                                    OBJ_RELEASE(ans);
-                                    return;
-                                }
-                                goto answer;
-                            }
+                        goto answer;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(rmbuf, &alloc,
+                                                1, ORCM_ALLOC))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(rmbuf);
+                        result = rc;
+                        if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
+                            ORTE_ERROR_LOG(rc);
+                            OBJ_RELEASE(ans);
+                            return;
                         }
+                        goto answer;
                     }
-                    if (true == found) {
-                        break;
+                    if (ORTE_SUCCESS != (rc = orte_rml.send_buffer_nb(ORTE_PROC_MY_SCHEDULER,
+                                              rmbuf,
+                                              ORCM_RML_TAG_RM,
+                                              orte_rml_send_callback,
+                                              NULL))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(rmbuf);
+                        result = rc;
+                        if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
+                            ORTE_ERROR_LOG(rc);
+                            OBJ_RELEASE(ans);
+                            return;
+                        }
+                        goto answer;
                     }
                 }
-                if (true == found) {
-                    break;
-                }
             }
         }
 
@@ -794,228 +837,215 @@ static void orcm_scd_base_recv(int status, orte_process_name_t* sender,
             }
  
             //let's find the session
-            found = false;
-            /* for each queue, */
-            OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-                OPAL_LIST_FOREACH(session, &q->sessions, orcm_session_t) {
-                    alloc = session->alloc;
-                    if(alloc->id == sessionid) { //found the session
-                        found = true;
-                        switch(sub_command) {
-                        case ORCM_GET_POWER_BUDGET_COMMAND:
-                            if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_POWER_BUDGET_KEY, 
-                                                            (void**)&int_param_ptr, OPAL_INT32)) {
-                                result = ORTE_ERR_BAD_PARAM;
-                                if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
-                                    ORTE_ERROR_LOG(rc);
-                                    OBJ_RELEASE(ans);
-                                    return;
-                                }
-                                goto answer;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &int_param, 1, OPAL_INT32))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }                   
-                        break;
-                        case ORCM_GET_POWER_MODE_COMMAND:
-                            if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_POWER_MODE_KEY, 
-                                                            (void**)&int_param_ptr, OPAL_INT32)) {
-                                result = ORTE_ERR_BAD_PARAM;
-                                if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
-                                    ORTE_ERROR_LOG(rc);
-                                    OBJ_RELEASE(ans);
-                                    return;
-                                }
-                                goto answer;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &int_param, 1, OPAL_INT32))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }                   
-                        break;
-                        case ORCM_GET_POWER_WINDOW_COMMAND:
-                            if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_POWER_WINDOW_KEY, 
-                                                            (void**)&int_param_ptr, OPAL_INT32)) {
-                                result = ORTE_ERR_BAD_PARAM;
-                                if (OPAL_SUCCESS != (result = opal_dss.pack(ans, &rc, 1, OPAL_INT))) {
-                                    ORTE_ERROR_LOG(rc);
-                                    OBJ_RELEASE(ans);
-                                    return;
-                                }
-                                goto answer;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &int_param, 1, OPAL_INT32))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }                   
-                        break;
-                        case ORCM_GET_POWER_OVERAGE_COMMAND:
-                            if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_OVERAGE_LIMIT_KEY, 
-                                                            (void**)&int_param_ptr, OPAL_INT32)) {
-                                result = ORTE_ERR_BAD_PARAM;
-                                if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
-                                    ORTE_ERROR_LOG(rc);
-                                    OBJ_RELEASE(ans);
-                                    return;
-                                }
-                                goto answer;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &int_param, 1, OPAL_INT32))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }                   
-                        break;
-                        case ORCM_GET_POWER_UNDERAGE_COMMAND:
-                            if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_UNDERAGE_LIMIT_KEY, 
-                                                            (void**)&int_param_ptr, OPAL_INT32)) {
-                                result = ORTE_ERR_BAD_PARAM;
-                                if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
-                                    ORTE_ERROR_LOG(rc);
-                                    OBJ_RELEASE(ans);
-                                    return;
-                                }
-                                goto answer;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &int_param, 1, OPAL_INT32))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }                   
-                        break;
-                        case ORCM_GET_POWER_OVERAGE_TIME_COMMAND:
-                            if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_OVERAGE_TIME_LIMIT_KEY, 
-                                                            (void**)&int_param_ptr, OPAL_INT32)) {
-                                result = ORTE_ERR_BAD_PARAM;
-                                if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
-                                    ORTE_ERROR_LOG(rc);
-                                    OBJ_RELEASE(ans);
-                                    return;
-                                }
-                                goto answer;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &int_param, 1, OPAL_INT32))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }                   
-                        break;
-                        case ORCM_GET_POWER_UNDERAGE_TIME_COMMAND:
-                            if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_UNDERAGE_TIME_LIMIT_KEY, 
-                                                            (void**)&int_param_ptr, OPAL_INT32)) {
-                                result = ORTE_ERR_BAD_PARAM;
-                                if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
-                                    ORTE_ERROR_LOG(rc);
-                                    OBJ_RELEASE(ans);
-                                    return;
-                                }
-                                goto answer;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &int_param, 1, OPAL_INT32))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }                   
-                        break;
-                        case ORCM_GET_POWER_FREQUENCY_COMMAND:
-                            if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_MANUAL_FREQUENCY_KEY, 
-                                                            (void**)&float_param_ptr, OPAL_FLOAT)) {
-                                result = ORTE_ERR_BAD_PARAM;
-                                if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
-                                    ORTE_ERROR_LOG(rc);
-                                    OBJ_RELEASE(ans);
-                                    return;
-                                }
-                                goto answer;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &float_param, 1, OPAL_FLOAT))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }                   
-                        break;
-                        case ORCM_GET_POWER_STRICT_COMMAND:
-                            if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_FREQ_STRICT_KEY, 
-                                                            (void**)&bool_param_ptr, OPAL_BOOL)) {
-                                result = ORTE_ERR_BAD_PARAM;
-                                if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
-                                    ORTE_ERROR_LOG(rc);
-                                    OBJ_RELEASE(ans);
-                                    return;
-                                }
-                                goto answer;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }
-                            if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &bool_param, 1, OPAL_BOOL))) {
-                                ORTE_ERROR_LOG(rc);
-                                OBJ_RELEASE(ans);
-                                return;
-                            }                   
-                        break;
-                       default:
-                           rc = ORTE_ERR_BAD_PARAM;
-                           if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &rc, 1, OPAL_INT))) {
-                               ORTE_ERROR_LOG(rc);
-                               OBJ_RELEASE(ans);
-                               return;
-                           }
-                       }
+            if (NULL != (session = orcm_scd_base_session_find(sessionid))) {
+                alloc = session->alloc;
+                switch(sub_command) {
+                case ORCM_GET_POWER_BUDGET_COMMAND:
+                    if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_POWER_BUDGET_KEY, 
+                                                    (void**)&int_param_ptr, OPAL_INT32)) {
+                        result = ORTE_ERR_BAD_PARAM;
+                        if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
+                            ORTE_ERROR_LOG(rc);
+                            OBJ_RELEASE(ans);
+                            return;
+                        }
+                        goto answer;
                     }
-                    if (true == found) {
-                        break;
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
                     }
-                }
-                if (true == found) {
-                    break;
-                }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &int_param, 1, OPAL_INT32))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }                   
+                break;
+                case ORCM_GET_POWER_MODE_COMMAND:
+                    if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_POWER_MODE_KEY, 
+                                                    (void**)&int_param_ptr, OPAL_INT32)) {
+                        result = ORTE_ERR_BAD_PARAM;
+                        if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
+                            ORTE_ERROR_LOG(rc);
+                            OBJ_RELEASE(ans);
+                            return;
+                        }
+                        goto answer;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &int_param, 1, OPAL_INT32))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }                   
+                break;
+                case ORCM_GET_POWER_WINDOW_COMMAND:
+                    if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_POWER_WINDOW_KEY, 
+                                                    (void**)&int_param_ptr, OPAL_INT32)) {
+                        result = ORTE_ERR_BAD_PARAM;
+                        if (OPAL_SUCCESS != (result = opal_dss.pack(ans, &rc, 1, OPAL_INT))) {
+                            ORTE_ERROR_LOG(rc);
+                            OBJ_RELEASE(ans);
+                            return;
+                        }
+                        goto answer;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &int_param, 1, OPAL_INT32))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }                   
+                break;
+                case ORCM_GET_POWER_OVERAGE_COMMAND:
+                    if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_OVERAGE_LIMIT_KEY, 
+                                                    (void**)&int_param_ptr, OPAL_INT32)) {
+                        result = ORTE_ERR_BAD_PARAM;
+                        if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
+                            ORTE_ERROR_LOG(rc);
+                            OBJ_RELEASE(ans);
+                            return;
+                        }
+                        goto answer;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &int_param, 1, OPAL_INT32))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }                   
+                break;
+                case ORCM_GET_POWER_UNDERAGE_COMMAND:
+                    if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_UNDERAGE_LIMIT_KEY, 
+                                                    (void**)&int_param_ptr, OPAL_INT32)) {
+                        result = ORTE_ERR_BAD_PARAM;
+                        if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
+                            ORTE_ERROR_LOG(rc);
+                            OBJ_RELEASE(ans);
+                            return;
+                        }
+                        goto answer;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &int_param, 1, OPAL_INT32))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }                   
+                break;
+                case ORCM_GET_POWER_OVERAGE_TIME_COMMAND:
+                    if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_OVERAGE_TIME_LIMIT_KEY, 
+                                                    (void**)&int_param_ptr, OPAL_INT32)) {
+                        result = ORTE_ERR_BAD_PARAM;
+                        if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
+                            ORTE_ERROR_LOG(rc);
+                            OBJ_RELEASE(ans);
+                            return;
+                        }
+                        goto answer;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &int_param, 1, OPAL_INT32))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }                   
+                break;
+                case ORCM_GET_POWER_UNDERAGE_TIME_COMMAND:
+                    if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_CAP_UNDERAGE_TIME_LIMIT_KEY, 
+                                                    (void**)&int_param_ptr, OPAL_INT32)) {
+                        result = ORTE_ERR_BAD_PARAM;
+                        if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
+                            ORTE_ERROR_LOG(rc);
+                            OBJ_RELEASE(ans);
+                            return;
+                        }
+                        goto answer;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &int_param, 1, OPAL_INT32))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }                   
+                break;
+                case ORCM_GET_POWER_FREQUENCY_COMMAND:
+                    if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_MANUAL_FREQUENCY_KEY, 
+                                                    (void**)&float_param_ptr, OPAL_FLOAT)) {
+                        result = ORTE_ERR_BAD_PARAM;
+                        if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
+                            ORTE_ERROR_LOG(rc);
+                            OBJ_RELEASE(ans);
+                            return;
+                        }
+                        goto answer;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &float_param, 1, OPAL_FLOAT))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }                   
+                break;
+                case ORCM_GET_POWER_STRICT_COMMAND:
+                    if (false == orte_get_attribute(&alloc->constraints, ORCM_PWRMGMT_FREQ_STRICT_KEY, 
+                                                    (void**)&bool_param_ptr, OPAL_BOOL)) {
+                        result = ORTE_ERR_BAD_PARAM;
+                        if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &result, 1, OPAL_INT))) {
+                            ORTE_ERROR_LOG(rc);
+                            OBJ_RELEASE(ans);
+                            return;
+                        }
+                        goto answer;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &success, 1, OPAL_INT))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }
+                    if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &bool_param, 1, OPAL_BOOL))) {
+                        ORTE_ERROR_LOG(rc);
+                        OBJ_RELEASE(ans);
+                        return;
+                    }                   
+                break;
+               default:
+                   rc = ORTE_ERR_BAD_PARAM;
+                   if (OPAL_SUCCESS != (rc = opal_dss.pack(ans, &rc, 1, OPAL_INT))) {
+                       ORTE_ERROR_LOG(rc);
+                       OBJ_RELEASE(ans);
+                       return;
+                   }
+               }
             }
         }
 
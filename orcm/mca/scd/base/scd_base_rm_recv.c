@@ -393,6 +393,7 @@ static int update_nodestate_byproc(orcm_node_state_t state, opal_list_t *nodelis
                      (ORCM_SCD_NODE_STATE_UNKNOWN == nodeptr->scd_state))) {
                         nodeptr->scd_state = ORCM_SCD_NODE_STATE_UNALLOC;
                     }
+                orcm_scd_base_node_update(nodeptr);
                 break;
             }
         }
@@ -412,7 +413,7 @@ static int update_nodestate_byproc(orcm_node_state_t state, opal_list_t *nodelis
 
 static int update_nodestate_byname(orcm_node_state_t state, char *regexp, hwloc_topology_t topo)
 {
-    int cnt, i, j, rc;
+    int cnt, i, rc;
     orcm_node_t *nodeptr;
     char **nodenames = NULL;
     bool found = false;
@@ -432,36 +433,29 @@ static int update_nodestate_byname(orcm_node_state_t state, char *regexp, hwloc_
     }
     cnt = opal_argv_count(nodenames);
     for (i = 0; i < cnt; i++) {
-        for (j = 0; j < orcm_scd_base.nodes.size; j++) {
-            if (NULL == (nodeptr =
-                         (orcm_node_t*)opal_pointer_array_get_item(&orcm_scd_base.nodes,
-                                                                   j))) {
-                             continue;
-                         }
-            if (0 == strcmp(nodeptr->name, nodenames[i])) {
-                OPAL_OUTPUT_VERBOSE((1, orcm_scd_base_framework.framework_output,
-                                     "%s scd:base:rm:update_nodestate_byname Setting node %s to state %i (%s)",
-                                     ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                     ORTE_NAME_PRINT(&nodeptr->daemon),
-                                     (int)state,
-                                     orcm_node_state_to_str(state)));
-                found = true;
-                nodeptr->state = newstate;
-                
-                /* associate node topology with node */
-                if (ORCM_NODE_STATE_UP == state) {
-                    nodeptr->topology = topo;
-                }
-                
-                /* if the node is coming online, reset the scheduling state
-                 only if its either undefined or unknown */
-                if ((ORCM_NODE_STATE_UP == state) &&
-                    ((ORCM_SCD_NODE_STATE_UNDEF == nodeptr->scd_state) ||
-                     (ORCM_SCD_NODE_STATE_UNKNOWN == nodeptr->scd_state))) {
-                        nodeptr->scd_state = ORCM_SCD_NODE_STATE_UNALLOC;
-                    }
-                break;
+        if (NULL != (nodeptr = orcm_scd_base_node_lookup(nodenames[i], NULL))) {
+            OPAL_OUTPUT_VERBOSE((1, orcm_scd_base_framework.framework_output,
+                                 "%s scd:base:rm:update_nodestate_byname Setting node %s to state %i (%s)",
+                                 ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                                 ORTE_NAME_PRINT(&nodeptr->daemon),
+                                 (int)state,
+                                 orcm_node_state_to_str(state)));
+            found = true;
+            nodeptr->state = newstate;
+
+            /* associate node topology with node */
+            if (ORCM_NODE_STATE_UP == state) {
+                nodeptr->topology = topo;
+            }
+
+            /* if the node is coming online, reset the scheduling state
+             only if its either undefined or unknown */
+            if ((ORCM_NODE_STATE_UP == state) &&
+                ((ORCM_SCD_NODE_STATE_UNDEF == nodeptr->scd_state) ||
+                 (ORCM_SCD_NODE_STATE_UNKNOWN == nodeptr->scd_state))) {
+                nodeptr->scd_state = ORCM_SCD_NODE_STATE_UNALLOC;
             }
+            orcm_scd_base_node_update(nodeptr);
         }
     }
     opal_argv_free(nodenames);
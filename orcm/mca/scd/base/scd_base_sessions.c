@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Session store. Each queue keeps its sessions twice: in q->sessions,
+ * in the order they were queued, for listing, and in a binary heap
+ * ordered by priority - highest first - and then by session id, which
+ * is handed out in submission order. Every queued session is also
+ * indexed by id, so cancel, terminate and the per-session power
+ * commands find a session without walking the queues, and removing it
+ * from the middle of its queue costs O(log n).
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#include <string.h>
+
+#include "opal/class/opal_hash_table.h"
+#include "opal/util/output.h"
+
+#include "orte/mca/errmgr/errmgr.h"
+
+#include "orcm/mca/scd/base/base.h"
+
+static bool initialized = false;
+static opal_hash_table_t by_id;     /* session id -> session */
+static int *cand = NULL;            /* scratch heap for queue_top */
+static int ncand_alloc = 0;
+
+/* true if a should run before b */
+static inline bool before(orcm_session_t *a, orcm_session_t *b)
+{
+    int32_t pa = (NULL == a->alloc) ? 0 : a->alloc->priority;
+    int32_t pb = (NULL == b->alloc) ? 0 : b->alloc->priority;
+
+    if (pa != pb) {
+        return pa > pb;
+    }
+    return a->id < b->id;
+}
+
+static inline void heap_set(orcm_queue_t *q, int i, orcm_session_t *s)
+{
+    q->heap[i] = s;
+    s->heap_index = i;
+}
+
+static void sift_up(orcm_queue_t *q, int i)
+{
+    orcm_session_t *s = q->heap[i];
+    int parent;
+
+    while (0 < i) {
+        parent = (i - 1) / 2;
+        if (!before(s, q->heap[parent])) {
+            break;
+        }
+        heap_set(q, i, q->heap[parent]);
+        i = parent;
+    }
+    heap_set(q, i, s);
+}
+
+static void sift_down(orcm_queue_t *q, int i)
+{
+    orcm_session_t *s = q->heap[i];
+    int child;
+
+    while ((child = 2 * i + 1) < q->heap_size) {
+        if (child + 1 < q->heap_size && before(q->heap[child + 1], q->heap[child])) {
+            child++;
+        }
+        if (!before(q->heap[child], s)) {
+            break;
+        }
+        heap_set(q, i, q->heap[child]);
+        i = child;
+    }
+    heap_set(q, i, s);
+}
+
+int orcm_scd_base_session_store_init(void)
+{
+    if (initialized) {
+        return ORCM_SUCCESS;
+    }
+    OBJ_CONSTRUCT(&by_id, opal_hash_table_t);
+    opal_hash_table_init(&by_id, 1024);
+    initialized = true;
+    return ORCM_SUCCESS;
+}
+
+void orcm_scd_base_session_store_finalize(void)
+{
+    if (!initialized) {
+        return;
+    }
+    OBJ_DESTRUCT(&by_id);
+    free(cand);
+    cand = NULL;
+    ncand_alloc = 0;
+    initialized = false;
+}
+
+orcm_queue_t* orcm_scd_base_get_queue(const char *name)
+{
+    orcm_queue_t *q;
+
+    /* there are only a handful of queues */
+    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
+        if (0 == strcmp(q->name, name)) {
+            return q;
+        }
+    }
+    return NULL;
+}
+
+int orcm_scd_base_queue_add(orcm_queue_t *q, orcm_session_t *session)
+{
+    orcm_session_t **heap;
+    int n;
+
+    if (NULL != session->queue) {
+        orcm_scd_base_queue_remove(session);
+    }
+    if (q->heap_size == q->heap_alloc) {
+        n = (0 == q->heap_alloc) ? 64 : 2 * q->heap_alloc;
+        if (NULL == (heap = (orcm_session_t**)realloc(q->heap, n * sizeof(orcm_session_t*)))) {
+            ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+            return ORCM_ERR_OUT_OF_RESOURCE;
+        }
+        q->heap = heap;
+        q->heap_alloc = n;
+    }
+
+    opal_list_append(&q->sessions, &session->super);
+    session->queue = q;
+    heap_set(q, q->heap_size++, session);
+    sift_up(q, session->heap_index);
+    if (initialized) {
+        opal_hash_table_set_value_uint32(&by_id, session->id, session);
+    }
+    return ORCM_SUCCESS;
+}
+
+void orcm_scd_base_queue_remove(orcm_session_t *session)
+{
+    orcm_queue_t *q = session->queue;
+    orcm_session_t *last;
+    int i = session->heap_index;
+
+    if (NULL == q) {
+        return;
+    }
+    opal_list_remove_item(&q->sessions, &session->super);
+    if (initialized) {
+        opal_hash_table_remove_value_uint32(&by_id, session->id);
+    }
+
+    /* move the last entry into the hole and restore the heap */
+    last = q->heap[--q->heap_size];
+    if (last != session) {
+        heap_set(q, i, last);
+        if (0 < i && before(last, q->heap[(i - 1) / 2])) {
+            sift_up(q, i);
+        } else {
+            sift_down(q, i);
+        }
+    }
+    session->queue = NULL;
+    session->heap_index = -1;
+}
+
+orcm_session_t* orcm_scd_base_session_find(orcm_session_id_t id)
+{
+    void *session;
+
+    if (!initialized ||
+        OPAL_SUCCESS != opal_hash_table_get_value_uint32(&by_id, id, &session)) {
+        return NULL;
+    }
+    return (orcm_session_t*)session;
+}
+
+static void cand_push(orcm_queue_t *q, int *n, int idx)
+{
+    int i = (*n)++, parent;
+
+    while (0 < i) {
+        parent = (i - 1) / 2;
+        if (!before(q->heap[idx], q->heap[cand[parent]])) {
+            break;
+        }
+        cand[i] = cand[parent];
+        i = parent;
+    }
+    cand[i] = idx;
+}
+
+static int cand_pop(orcm_queue_t *q, int *n)
+{
+    int top = cand[0], idx, i = 0, child;
+
+    idx = cand[--(*n)];
+    while ((child = 2 * i + 1) < *n) {
+        if (child + 1 < *n && before(q->heap[cand[child + 1]], q->heap[cand[child]])) {
+            child++;
+        }
+        if (!before(q->heap[cand[child]], q->heap[idx])) {
+            break;
+        }
+        cand[i] = cand[child];
+        i = child;
+    }
+    cand[i] = idx;
+    return top;
+}
+
+int orcm_scd_base_queue_top(orcm_queue_t *q, orcm_session_t **sessions, int max)
+{
+    int *c, n = 0, found = 0, idx;
+
+    if (NULL == q || 0 == q->heap_size || max <= 0) {
+        return 0;
+    }
+    if (max > q->heap_size) {
+        max = q->heap_size;
+    }
+    /* walk the heap best-first: the next session is always the best
+     * of the children of those already taken, so it costs
+     * O(max log max) however long the queue is */
+    if (ncand_alloc < max + 1) {
+        if (NULL == (c = (int*)realloc(cand, (max + 1) * sizeof(int)))) {
+            ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+            return 0;
+        }
+        cand = c;
+        ncand_alloc = max + 1;
+    }
+    cand_push(q, &n, 0);
+    while (found < max && 0 < n) {
+        idx = cand_pop(q, &n);
+        sessions[found++] = q->heap[idx];
+        if (2 * idx + 1 < q->heap_size) {
+            cand_push(q, &n, 2 * idx + 1);
+        }
+        if (2 * idx + 2 < q->heap_size) {
+            cand_push(q, &n, 2 * idx + 2);
+        }
+    }
+    return found;
+}
@@ -84,7 +84,7 @@ static void finalize(void)
 static int external_launch(orcm_session_t *session)
 {
     char **nodenames = NULL;
-    int rc, num_nodes, i, j;
+    int rc, num_nodes, i;
     orcm_node_t *nodeptr;
     orcm_queue_t *q;
 
@@ -95,12 +95,9 @@ static int external_launch(orcm_session_t *session)
                          session->alloc->nodes));
 
     /* put session on running queue */
-    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-        if (0 == strcmp(q->name, "running")) {
-            session->alloc->queues = strdup(q->name);
-            opal_list_append(&q->sessions, &session->super);
-            break;
-        }
+    if (NULL != (q = orcm_scd_base_get_queue("running"))) {
+        session->alloc->queues = strdup(q->name);
+        orcm_scd_base_queue_add(q, session);
     }
 
     ORCM_ACTIVATE_RM_STATE(session, ORCM_SESSION_STATE_ACTIVE);
@@ -129,18 +126,10 @@ static int external_launch(orcm_session_t *session)
         goto ERROR;
     }
 
-    /* node array should be indexed by node num, 
-     * if we change to lookup by index that would be faster 
-     */
     for (i = 0; i < num_nodes; i++) {
-        for (j = 0; j < orcm_scd_base.nodes.size; j++) {
-            if (NULL == (nodeptr =
-                         (orcm_node_t*)opal_pointer_array_get_item(&orcm_scd_base.nodes, j))) {
-                continue;
-            }
-            if (0 == strcmp(nodeptr->name, nodenames[i])) {
-                nodeptr->scd_state = ORCM_SCD_NODE_STATE_ALLOC;
-            }
+        if (NULL != (nodeptr = orcm_scd_base_node_lookup(nodenames[i], NULL))) {
+            nodeptr->scd_state = ORCM_SCD_NODE_STATE_ALLOC;
+            orcm_scd_base_node_update(nodeptr);
         }
     }
 
@@ -156,32 +145,21 @@ ERROR:
     }
     /* remove session from running queue
      */
-    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-        if (0 == strcmp(q->name, "running")) {
-            opal_list_remove_first(&q->sessions);
-            break;
-        }
-    }
+    orcm_scd_base_queue_remove(session);
     return ORCM_ERR_OUT_OF_RESOURCE;
 }
 
 static int external_cancel(orcm_session_id_t sessionid)
 {
-    orcm_queue_t *q;
     orcm_session_t *session;
 
     /* if session is queued, find it and delete it */
-    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-        OPAL_LIST_FOREACH(session, &q->sessions, orcm_session_t) {
-            if (session->id == sessionid) {
-                /* if session is running, send cancel launch command */
-                if (0 == strcmp(q->name, "running")) {
-                    ORCM_ACTIVATE_RM_STATE(session, ORCM_SESSION_STATE_KILL);
-                } else {
-                    opal_list_remove_item(&q->sessions, &session->super);
-                }
-                break;
-            }
+    if (NULL != (session = orcm_scd_base_session_find(sessionid))) {
+        /* if session is running, send cancel launch command */
+        if (0 == strcmp(session->queue->name, "running")) {
+            ORCM_ACTIVATE_RM_STATE(session, ORCM_SESSION_STATE_KILL);
+        } else {
+            orcm_scd_base_queue_remove(session);
         }
     }
     return ORCM_SUCCESS;
@@ -191,61 +169,27 @@ static int external_cancel(orcm_session_id_t sessionid)
 static void external_terminated(int sd, short args, void *cbdata)
 {
     orcm_session_caddy_t *caddy = (orcm_session_caddy_t*)cbdata;
-    int rc, i, j, num_nodes;
-    orcm_node_t* nodeptr;
-    char **nodenames = NULL;
-    orcm_queue_t *q;
     orcm_session_t *session;
+    int rc;
 
     /* set nodes to UNALLOC
     */
-    if (ORTE_SUCCESS !=
-        (rc = orte_regex_extract_node_names(caddy->session->alloc->nodes,
-                                            &nodenames))) {
-        ORTE_ERROR_LOG(rc);
+    if (ORCM_SUCCESS !=
+        (rc = orcm_scd_base_set_nodes_state(caddy->session->alloc->nodes,
+                                            ORCM_SCD_NODE_STATE_UNALLOC))) {
         OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
                              "%s scd:external:terminated - (session: %d) could not extract nodelist\n",
                              ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
                              caddy->session->id));
-
-        if (NULL != nodenames) {
-            opal_argv_free(nodenames);
-        }
-
+        OBJ_RELEASE(caddy);
         return;
     }
 
-    num_nodes = opal_argv_count(nodenames);
-
-    /* node array should be indexed by node num, 
-     * if we change to lookup by index that would be faster 
-     */
-    for (i = 0; i < num_nodes; i++) {
-        for (j = 0; j < orcm_scd_base.nodes.size; j++) {
-            if (NULL == (nodeptr =
-                         (orcm_node_t*)opal_pointer_array_get_item(&orcm_scd_base.nodes, j))) {
-                continue;
-            }
-            if (0 == strcmp(nodeptr->name, nodenames[i])) {
-                nodeptr->scd_state = ORCM_SCD_NODE_STATE_UNALLOC;
-            }
-        }
-    }
-
-    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-        if (0 == strcmp(q->name, "running")) {
-            OPAL_LIST_FOREACH(session, &q->sessions, orcm_session_t) {
-                if (session->id == caddy->session->id) {
-                    opal_list_remove_item(&q->sessions, &session->super);
-                }
-            }
-            break;
-        }
+    if (NULL != (session = orcm_scd_base_session_find(caddy->session->id)) &&
+        NULL != session->queue && 0 == strcmp(session->queue->name, "running")) {
+        orcm_scd_base_queue_remove(session);
     }
 
     OBJ_RELEASE(caddy);
-    if (NULL != nodenames) {
-        opal_argv_free(nodenames);
-    }
 }
 
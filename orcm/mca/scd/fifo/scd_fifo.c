@@ -10,6 +10,9 @@
 #include "orcm_config.h"
 #include "orcm/constants.h"
 
+#include <string.h>
+#include <time.h>
+
 #include "opal/util/output.h"
 
 #include "orte/mca/errmgr/errmgr.h"
@@ -119,17 +122,14 @@ static void fifo_find_queue(int sd, short args, void *cbdata)
                              caddy->session->id));
 
         /* put session on hold */
-        OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-            if (0 == strcmp(q->name, "hold")) {
-                caddy->session->alloc->queues = strdup(q->name);
-                opal_list_append(&q->sessions, &caddy->session->super);
-                ORCM_ACTIVATE_SCD_STATE(caddy->session, ORCM_SESSION_STATE_SCHEDULE);
-
-                OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
-                                     "%s scd:fifo:find_queue %s\n",
-                                     ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), q->name));
-                break;
-            }
+        if (NULL != (q = orcm_scd_base_get_queue("hold"))) {
+            caddy->session->alloc->queues = strdup(q->name);
+            orcm_scd_base_queue_add(q, caddy->session);
+            ORCM_ACTIVATE_SCD_STATE(caddy->session, ORCM_SESSION_STATE_SCHEDULE);
+
+            OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
+                                 "%s scd:fifo:find_queue %s\n",
+                                 ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), q->name));
         }
 
         /* update information within the session info to state what happened */
@@ -154,87 +154,246 @@ static void fifo_find_queue(int sd, short args, void *cbdata)
      * default always.
      */
 
-    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-        if (0 == strcmp(q->name, "default")) {
-            caddy->session->alloc->queues = strdup(q->name);
-            opal_list_append(&q->sessions, &caddy->session->super);
-            ORCM_ACTIVATE_SCD_STATE(caddy->session, ORCM_SESSION_STATE_SCHEDULE);
+    if (NULL != (q = orcm_scd_base_get_queue("default"))) {
+        caddy->session->alloc->queues = strdup(q->name);
+        orcm_scd_base_queue_add(q, caddy->session);
+        ORCM_ACTIVATE_SCD_STATE(caddy->session, ORCM_SESSION_STATE_SCHEDULE);
 
-            OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
-                                 "%s scd:fifo:find_queue %s\n",
-                                 ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), q->name));
-            break;
-        }
+        OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
+                             "%s scd:fifo:find_queue %s\n",
+                             ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), q->name));
     }
 
     OBJ_RELEASE(caddy);
 }
 
+/* Availability profile for conservative backfill: avail[k] nodes are
+ * free from times[k] until times[k+1] (or forever for the last
+ * segment). Built each pass from the free-node count and the walltimes
+ * of the running sessions, then reduced by every reservation made for
+ * a queued session, so its cost depends on the number of sessions and
+ * not on the number of nodes. */
+#define FIFO_FOREVER ((time_t)-1)
+
+static time_t *times = NULL;
+static int *avail = NULL;
+static int nsegs = 0, maxsegs = 0;
+/* the head of the default queue, considered each pass */
+static orcm_session_t **considered = NULL;
+static int nconsidered = 0;
+
+static int profile_grow(void)
+{
+    time_t *t;
+    int *a, n = (0 == maxsegs) ? 64 : 2 * maxsegs;
+
+    if (NULL == (t = (time_t*)realloc(times, n * sizeof(time_t)))) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    times = t;
+    if (NULL == (a = (int*)realloc(avail, n * sizeof(int)))) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    avail = a;
+    maxsegs = n;
+    return ORCM_SUCCESS;
+}
+
+/* index of the segment starting at t, splitting one if needed */
+static int profile_split(time_t t)
+{
+    int k;
+
+    if (t < times[0]) {
+        t = times[0];
+    }
+    for (k=0; k < nsegs && times[k] < t; k++);
+    if (k < nsegs && times[k] == t) {
+        return k;
+    }
+    if (nsegs == maxsegs && ORCM_SUCCESS != profile_grow()) {
+        return -1;
+    }
+    memmove(&times[k+1], &times[k], (nsegs - k) * sizeof(time_t));
+    memmove(&avail[k+1], &avail[k], (nsegs - k) * sizeof(int));
+    times[k] = t;
+    avail[k] = avail[k-1];
+    nsegs++;
+    return k;
+}
+
+/* add n nodes to [start, end) */
+static int profile_add(time_t start, time_t end, int n)
+{
+    int k, last;
+
+    if (0 > (k = profile_split(start))) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    if (FIFO_FOREVER == end) {
+        last = nsegs;
+    } else if (0 > (last = profile_split(end))) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    for (; k < last; k++) {
+        avail[k] += n;
+    }
+    return ORCM_SUCCESS;
+}
+
+/* earliest time n nodes are free for the duration wt (0 - unknown,
+ * so for ever), or FIFO_FOREVER if that never happens */
+static time_t profile_earliest(int n, time_t wt)
+{
+    int k, j;
+
+    for (k=0; k < nsegs; k++) {
+        for (j=k; j < nsegs; j++) {
+            if (0 < wt && times[j] >= times[k] + wt) {
+                break;
+            }
+            if (avail[j] < n) {
+                break;
+            }
+        }
+        if (j == nsegs || (0 < wt && times[j] >= times[k] + wt)) {
+            return times[k];
+        }
+        /* no point starting before the segment that was short */
+        k = j;
+    }
+    return FIFO_FOREVER;
+}
+
+static int profile_build(orcm_queue_t *running, time_t now)
+{
+    orcm_session_t *session;
+    time_t end;
+
+    if (0 == maxsegs && ORCM_SUCCESS != profile_grow()) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    times[0] = now;
+    avail[0] = orcm_scd_base_num_free_nodes();
+    nsegs = 1;
+    if (NULL == running) {
+        return ORCM_SUCCESS;
+    }
+    OPAL_LIST_FOREACH(session, &running->sessions, orcm_session_t) {
+        /* nodes of a session without a walltime never come back */
+        if (0 == session->start || 0 >= session->alloc->walltime) {
+            continue;
+        }
+        end = session->start + session->alloc->walltime;
+        if (end <= now) {
+            /* overdue - expect it any moment */
+            end = now + 1;
+        }
+        if (ORCM_SUCCESS != profile_add(end, FIFO_FOREVER, session->alloc->min_nodes)) {
+            return ORCM_ERR_OUT_OF_RESOURCE;
+        }
+    }
+    return ORCM_SUCCESS;
+}
+
+/* give a session its nodes now and pass it to the resource manager */
+static bool fifo_start(orcm_session_t *session, time_t now)
+{
+    char *regex;
+    int rc;
+
+    if (ORCM_SUCCESS !=
+        (rc = orcm_scd_base_take_free_nodes(session->alloc->min_nodes, &regex))) {
+        return false;
+    }
+    if (NULL != session->alloc->nodes) {
+        free(session->alloc->nodes);
+    }
+    session->alloc->nodes = regex;
+    session->start = now;
+    OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
+                         "%s scd:fifo:schedule - (session: %d) starting on %s\n",
+                         ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                         session->id, regex));
+    ORCM_ACTIVATE_RM_STATE(session, ORCM_SESSION_STATE_REQ);
+    return true;
+}
+
 static void fifo_schedule(int sd, short args, void *cbdata)
 {
     orcm_session_caddy_t *caddy = (orcm_session_caddy_t*)cbdata;
     orcm_session_t *sessionptr;
-    orcm_node_t* nodeptr;
-    int i, free_nodes;
+    orcm_queue_t *def, *running;
+    time_t now, when, wt;
+    int n, i, nconsider;
+
+    def = orcm_scd_base_get_queue("default");
+    running = orcm_scd_base_get_queue("running");
+    /* if its empty, we are done */
+    if (NULL == def || 0 == def->heap_size) {
+        OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
+                             "%s scd:fifo:schedule - no (more) sessions found on queue\n",
+                             ORTE_NAME_PRINT(ORTE_PROC_MY_NAME)));
+        OBJ_RELEASE(caddy);
+        return;
+    }
 
-    orcm_queue_t *q;
+    now = time(NULL);
+    if (ORCM_SUCCESS != profile_build(running, now)) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+        OBJ_RELEASE(caddy);
+        return;
+    }
 
-    /* search the queues for the next allocation to be scheduled */
-
-    /* find the default queue */
-    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-        /* found it */
-        if (0 == strcmp(q->name, "default")) {
-            /* if its empty, we are done */
-            if (opal_list_is_empty(&q->sessions)) {
-                OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
-                                     "%s scd:fifo:schedule - no (more) sessions found on queue\n",
-                                     ORTE_NAME_PRINT(ORTE_PROC_MY_NAME)));
-                return;
-            }
-            /* as per FIFO rules, get the first session on the queue */
-            sessionptr = (orcm_session_t*)opal_list_remove_first(&q->sessions);
-            if (NULL == sessionptr) {
-                /* should never be able to get here, this function should only be called after sessions 
-                 * are already placed on a queue */
-                OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
-                                     "%s scd:fifo:schedule - no sessions found on queue when there should have been!\n",
-                                     ORTE_NAME_PRINT(ORTE_PROC_MY_NAME)));
-                OBJ_RELEASE(caddy);
-                return;
-            }
+    /* sessions start in priority order, and in submission order
+     * within a priority - with backfill a later one may start first
+     * if every session ahead of it still gets its nodes no later than
+     * its reserved time. Only the head of the queue is ever looked at,
+     * however many sessions are waiting */
+    if (NULL == considered || nconsidered < mca_scd_fifo_backfill_depth) {
+        free(considered);
+        nconsidered = (0 < mca_scd_fifo_backfill_depth) ? mca_scd_fifo_backfill_depth : 1;
+        if (NULL == (considered = (orcm_session_t**)malloc(nconsidered * sizeof(orcm_session_t*)))) {
+            nconsidered = 0;
+            ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+            OBJ_RELEASE(caddy);
+            return;
+        }
+    }
+    nconsider = orcm_scd_base_queue_top(def, considered, mca_scd_fifo_backfill_depth);
+    for (i=0; i < nconsider; i++) {
+        sessionptr = considered[i];
+        n = sessionptr->alloc->min_nodes;
+        if (0 >= n) {
+            /* nothing to allocate */
+            continue;
+        }
+        wt = (0 < sessionptr->alloc->walltime) ? sessionptr->alloc->walltime : 0;
+        when = profile_earliest(n, wt);
 
-            /* find out how many nodes are available */
-            free_nodes = 0;
-            for (i = 0; i < orcm_scd_base.nodes.size; i++) {
-                if (NULL ==
-                    (nodeptr =
-                     (orcm_node_t*)opal_pointer_array_get_item(&orcm_scd_base.nodes, i))) {
-                    continue;
-                }
-                /* TODO need to add logic for partially allocated nodes */
-                /* TODO check for other constraints, but how? */
-                if (ORCM_SCD_NODE_STATE_UNALLOC == nodeptr->scd_state
-                    && ORCM_NODE_STATE_UP == nodeptr->state) {
-                    free_nodes++;
-                }
+        if (when == now && n <= avail[0]) {
+            if (!fifo_start(sessionptr, now)) {
+                break;
             }
-
-            /* if there are enough nodes to meet job requirement, allocate them */
-            if (sessionptr->alloc->min_nodes <= free_nodes) {
-                OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
-                                     "%s scd:fifo:schedule - found enough nodes, activiating session\n",
-                                     ORTE_NAME_PRINT(ORTE_PROC_MY_NAME)));
-                ORCM_ACTIVATE_RM_STATE(sessionptr, ORCM_SESSION_STATE_REQ);
-            } else {
-                OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
-                                     "%s scd:fifo:schedule - (session: %d) not enough free nodes (required: %d found: %d), re-queueing session\n",
-                                     ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                     sessionptr->id,
-                                     sessionptr->alloc->min_nodes,
-                                     free_nodes));
-                opal_list_prepend(&q->sessions, &sessionptr->super);
+            orcm_scd_base_queue_remove(sessionptr);
+            if (ORCM_SUCCESS != profile_add(now, (0 < wt) ? now + wt : FIFO_FOREVER, -n)) {
+                break;
             }
+            continue;
+        }
+
+        OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
+                             "%s scd:fifo:schedule - (session: %d) not enough free nodes (required: %d found: %d), leaving it queued\n",
+                             ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                             sessionptr->id, n, avail[0]));
+        if (!mca_scd_fifo_backfill) {
+            break;
+        }
+        /* hold its nodes from its earliest start so nothing behind it
+         * can delay it - one that can never start holds nothing */
+        if (FIFO_FOREVER != when &&
+            ORCM_SUCCESS != profile_add(when, (0 < wt) ? when + wt : FIFO_FOREVER, -n)) {
+            break;
         }
     }
 
@@ -245,7 +404,7 @@ static void fifo_allocated(int sd, short args, void *cbdata)
 {
     orcm_session_caddy_t *caddy = (orcm_session_caddy_t*)cbdata;
     char **nodenames = NULL;
-    int rc, num_nodes, i, j;
+    int rc, num_nodes, i;
     orcm_node_t *nodeptr;
     orcm_queue_t *q;
 
@@ -256,12 +415,9 @@ static void fifo_allocated(int sd, short args, void *cbdata)
                          caddy->session->alloc->nodes));
 
     /* put session on running queue */
-    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-        if (0 == strcmp(q->name, "running")) {
-            caddy->session->alloc->queues = strdup(q->name);
-            opal_list_append(&q->sessions, &caddy->session->super);
-            break;
-        }
+    if (NULL != (q = orcm_scd_base_get_queue("running"))) {
+        caddy->session->alloc->queues = strdup(q->name);
+        orcm_scd_base_queue_add(q, caddy->session);
     }
 
     if (0 == strcmp(caddy->session->alloc->nodes, "ERROR")) {
@@ -299,18 +455,10 @@ static void fifo_allocated(int sd, short args, void *cbdata)
         goto ERROR;
     }
 
-    /* node array should be indexed by node num, 
-     * if we change to lookup by index that would be faster 
-     */
     for (i = 0; i < num_nodes; i++) {
-        for (j = 0; j < orcm_scd_base.nodes.size; j++) {
-            if (NULL == (nodeptr =
-                         (orcm_node_t*)opal_pointer_array_get_item(&orcm_scd_base.nodes, j))) {
-                continue;
-            }
-            if (0 == strcmp(nodeptr->name, nodenames[i])) {
-                nodeptr->scd_state = ORCM_SCD_NODE_STATE_ALLOC;
-            }
+        if (NULL != (nodeptr = orcm_scd_base_node_lookup(nodenames[i], NULL))) {
+            nodeptr->scd_state = ORCM_SCD_NODE_STATE_ALLOC;
+            orcm_scd_base_node_update(nodeptr);
         }
     }
 
@@ -327,105 +475,64 @@ ERROR:
     }
     /* remove session from running queue
      */
-    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-        if (0 == strcmp(q->name, "running")) {
-            opal_list_remove_first(&q->sessions);
-            break;
-        }
+    orcm_scd_base_queue_remove(caddy->session);
+    /* give back any nodes it was given and let it be scheduled again */
+    if (0 != strcmp(caddy->session->alloc->nodes, "ERROR")) {
+        orcm_scd_base_set_nodes_state(caddy->session->alloc->nodes,
+                                      ORCM_SCD_NODE_STATE_UNALLOC);
     }
-    /* try to find the default queue and requeue session */
-    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-        /* found it */
-        if (0 == strcmp(q->name, "default")) {
-            opal_list_prepend(&q->sessions, &caddy->session->super);
-            ORCM_ACTIVATE_SCD_STATE(caddy->session, ORCM_SESSION_STATE_SCHEDULE);
-            break;
-        }
+    free(caddy->session->alloc->nodes);
+    caddy->session->alloc->nodes = NULL;
+    caddy->session->start = 0;
+    /* requeue the session - it keeps its place as its id orders
+     * it ahead of everything submitted after it */
+    if (NULL != (q = orcm_scd_base_get_queue("default"))) {
+        orcm_scd_base_queue_add(q, caddy->session);
+        ORCM_ACTIVATE_SCD_STATE(caddy->session, ORCM_SESSION_STATE_SCHEDULE);
     }
 }
 
 static void fifo_terminated(int sd, short args, void *cbdata)
 {
     orcm_session_caddy_t *caddy = (orcm_session_caddy_t*)cbdata;
-    int rc, i, j, num_nodes;
-    orcm_node_t* nodeptr;
-    char **nodenames = NULL;
-    orcm_queue_t *q;
+    int rc;
     orcm_session_t *session;
 
     /* set nodes to UNALLOC
     */
-    if (ORTE_SUCCESS !=
-        (rc = orte_regex_extract_node_names(caddy->session->alloc->nodes,
-                                            &nodenames))) {
-        ORTE_ERROR_LOG(rc);
+    if (ORCM_SUCCESS !=
+        (rc = orcm_scd_base_set_nodes_state(caddy->session->alloc->nodes,
+                                            ORCM_SCD_NODE_STATE_UNALLOC))) {
         OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
                              "%s scd:fifo:terminated - (session: %d) could not extract nodelist\n",
                              ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
                              caddy->session->id));
-
-        if (NULL != nodenames) {
-            opal_argv_free(nodenames);
-        }
-
         return;
     }
 
-    num_nodes = opal_argv_count(nodenames);
-
-    /* node array should be indexed by node num, 
-     * if we change to lookup by index that would be faster 
-     */
-    for (i = 0; i < num_nodes; i++) {
-        for (j = 0; j < orcm_scd_base.nodes.size; j++) {
-            if (NULL == (nodeptr =
-                         (orcm_node_t*)opal_pointer_array_get_item(&orcm_scd_base.nodes, j))) {
-                continue;
-            }
-            if (0 == strcmp(nodeptr->name, nodenames[i])) {
-                nodeptr->scd_state = ORCM_SCD_NODE_STATE_UNALLOC;
-            }
-        }
-    }
-
-    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-        if (0 == strcmp(q->name, "running")) {
-            OPAL_LIST_FOREACH(session, &q->sessions, orcm_session_t) {
-                if (session->id == caddy->session->id) {
-                    opal_list_remove_item(&q->sessions, &session->super);
-                }
-            }
-            break;
-        }
+    if (NULL != (session = orcm_scd_base_session_find(caddy->session->id)) &&
+        NULL != session->queue && 0 == strcmp(session->queue->name, "running")) {
+        orcm_scd_base_queue_remove(session);
     }
 
     ORCM_ACTIVATE_SCD_STATE(caddy->session, ORCM_SESSION_STATE_SCHEDULE);
 
     OBJ_RELEASE(caddy);
-    if (NULL != nodenames) {
-        opal_argv_free(nodenames);
-    }
 }
 
 static void fifo_cancel(int sd, short args, void *cbdata)
 {
     orcm_session_caddy_t *caddy = (orcm_session_caddy_t*)cbdata;
-    orcm_queue_t *q;
     orcm_session_t *session;
 
     /* if session is queued, find it and delete it */
-    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-        OPAL_LIST_FOREACH(session, &q->sessions, orcm_session_t) {
-            if (session->id == caddy->session->id) {
-                /* if session is running, send cancel launch command */
-                if (0 == strcmp(q->name, "running")) {
-                    ORCM_ACTIVATE_RM_STATE(session, ORCM_SESSION_STATE_KILL);
-                } else {
-                    opal_list_remove_item(&q->sessions, &session->super);
-                    ORCM_ACTIVATE_SCD_STATE(caddy->session, ORCM_SESSION_STATE_SCHEDULE);
-                }
-                break;
-            }
+    if (NULL != (session = orcm_scd_base_session_find(caddy->session->id))) {
+        /* if session is running, send cancel launch command */
+        if (0 == strcmp(session->queue->name, "running")) {
+            ORCM_ACTIVATE_RM_STATE(session, ORCM_SESSION_STATE_KILL);
+        } else {
+            orcm_scd_base_queue_remove(session);
+            ORCM_ACTIVATE_SCD_STATE(caddy->session, ORCM_SESSION_STATE_SCHEDULE);
         }
     }
 
@@ -28,6 +28,12 @@ BEGIN_C_DECLS
 
 ORCM_MODULE_DECLSPEC extern orcm_scd_base_component_t mca_scd_fifo_component;
 
+/* start queued sessions out of order when that delays no session
+ * ahead of them, judged by their walltimes */
+ORCM_MODULE_DECLSPEC extern bool mca_scd_fifo_backfill;
+/* queued sessions looked at in one scheduling pass */
+ORCM_MODULE_DECLSPEC extern int mca_scd_fifo_backfill_depth;
+
 ORCM_DECLSPEC extern orcm_scd_base_module_t orcm_scd_fifo_module;
 
 END_C_DECLS
@@ -28,6 +28,10 @@ const char *orcm_scd_fifo_component_version_string =
 static int scd_fifo_open(void);
 static int scd_fifo_close(void);
 static int scd_fifo_component_query(mca_base_module_t **module, int *priority);
+static int scd_fifo_register(void);
+
+bool mca_scd_fifo_backfill = false;
+int mca_scd_fifo_backfill_depth = 100;
 
 /*
  * Instantiate the public struct with all of our public information
@@ -45,7 +49,7 @@ orcm_scd_base_component_t mca_scd_fifo_component = {
         .mca_open_component = scd_fifo_open,
         .mca_close_component = scd_fifo_close,
         .mca_query_component = scd_fifo_component_query,
-        NULL
+        .mca_register_component_params = scd_fifo_register
     },
     .base_data = {
         /* The component is checkpoint ready */
@@ -63,6 +67,27 @@ static int scd_fifo_close(void)
     return ORCM_SUCCESS;
 }
 
+static int scd_fifo_register(void)
+{
+    mca_base_component_t *c = &mca_scd_fifo_component.base_version;
+
+    mca_scd_fifo_backfill = false;
+    (void) mca_base_component_var_register(c, "backfill",
+                                           "Start queued sessions ahead of the head of the queue when their walltime shows they delay no earlier session (conservative backfill)",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_scd_fifo_backfill);
+    mca_scd_fifo_backfill_depth = 100;
+    (void) mca_base_component_var_register(c, "backfill_depth",
+                                           "Maximum number of queued sessions considered in one backfill pass",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_scd_fifo_backfill_depth);
+    return ORCM_SUCCESS;
+}
+
 static int scd_fifo_component_query(mca_base_module_t **module, int *priority)
 {
     if (ORCM_PROC_IS_SCHED) {
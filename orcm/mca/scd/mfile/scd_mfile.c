@@ -164,17 +164,14 @@ static void mfile_find_queue(int sd, short args, void *cbdata)
      * default always.
      */
 
-    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-        if (0 == strcmp(q->name, "default")) {
-            caddy->session->alloc->queues = strdup(q->name);
-            opal_list_append(&q->sessions, &caddy->session->super);
-            ORCM_ACTIVATE_SCD_STATE(caddy->session, ORCM_SESSION_STATE_SCHEDULE);
-
-            OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
-                                 "%s scd:mfile:find_queue %s\n",
-                                 ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), q->name));
-            break;
-        }
+    if (NULL != (q = orcm_scd_base_get_queue("default"))) {
+        caddy->session->alloc->queues = strdup(q->name);
+        orcm_scd_base_queue_add(q, caddy->session);
+        ORCM_ACTIVATE_SCD_STATE(caddy->session, ORCM_SESSION_STATE_SCHEDULE);
+
+        OPAL_OUTPUT_VERBOSE((5, orcm_scd_base_framework.framework_output,
+                             "%s scd:mfile:find_queue %s\n",
+                             ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), q->name));
     }
 
     OBJ_RELEASE(caddy);
@@ -199,12 +196,9 @@ static void mfile_allocated(int sd, short args, void *cbdata)
                          caddy->session->alloc->nodes));
 
     /* put session on running queue */
-    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-        if (0 == strcmp(q->name, "running")) {
-            caddy->session->alloc->queues = strdup(q->name);
-            opal_list_append(&q->sessions, &caddy->session->super);
-            break;
-        }
+    if (NULL != (q = orcm_scd_base_get_queue("running"))) {
+        caddy->session->alloc->queues = strdup(q->name);
+        orcm_scd_base_queue_add(q, caddy->session);
     }
 
     OBJ_RELEASE(caddy);
@@ -223,22 +217,16 @@ static void mfile_terminated(int sd, short args, void *cbdata)
 static void mfile_cancel(int sd, short args, void *cbdata)
 {
     orcm_session_caddy_t *caddy = (orcm_session_caddy_t*)cbdata;
-    orcm_queue_t *q;
     orcm_session_t *session;
 
     /* if session is queued, find it and delete it */
-    OPAL_LIST_FOREACH(q, &orcm_scd_base.queues, orcm_queue_t) {
-        OPAL_LIST_FOREACH(session, &q->sessions, orcm_session_t) {
-            if (session->id == caddy->session->id) {
-                /* if session is running, send cancel launch command */
-                if (0 == strcmp(q->name, "running")) {
-                    ORCM_ACTIVATE_RM_STATE(session, ORCM_SESSION_STATE_KILL);
-                } else {
-                    opal_list_remove_item(&q->sessions, &session->super);
-                    ORCM_ACTIVATE_SCD_STATE(caddy->session, ORCM_SESSION_STATE_SCHEDULE);
-                }
-                break;
-            }
+    if (NULL != (session = orcm_scd_base_session_find(caddy->session->id))) {
+        /* if session is running, send cancel launch command */
+        if (0 == strcmp(session->queue->name, "running")) {
+            ORCM_ACTIVATE_RM_STATE(session, ORCM_SESSION_STATE_KILL);
+        } else {
+            orcm_scd_base_queue_remove(session);
+            ORCM_ACTIVATE_SCD_STATE(caddy->session, ORCM_SESSION_STATE_SCHEDULE);
         }
     }
 
@@ -117,11 +117,15 @@ OBJ_CLASS_DECLARATION(orcm_alloc_t);
  * in multiple binned arrays - e.g., once for power
  * and again for nodes.
  */
+struct orcm_session_t;
 typedef struct {
     opal_list_item_t super;
     char *name;
     int32_t priority;
-    opal_list_t sessions;
+    opal_list_t sessions;          // sessions in the order they were queued
+    struct orcm_session_t **heap;  // the same sessions, highest priority first
+    int heap_size;
+    int heap_alloc;
 } orcm_queue_t;
 OBJ_CLASS_DECLARATION(orcm_queue_t);
 
@@ -177,13 +181,16 @@ OBJ_CLASS_DECLARATION(orcm_step_t);
  */
 typedef uint32_t orcm_scd_session_state_t;
 typedef uint32_t orcm_session_id_t;
-typedef struct {
+typedef struct orcm_session_t {
     opal_list_item_t super;
     orcm_session_id_t id;
     int32_t uid;
     orte_process_name_t requestor;
     orcm_alloc_t *alloc;  // master allocation for the session
     opal_list_t steps;
+    time_t start;         // when the session was given its nodes, 0 if not yet
+    orcm_queue_t *queue;  // queue holding the session, NULL if none
+    int heap_index;       // position in the queue's heap
 } orcm_session_t;
 OBJ_CLASS_DECLARATION(orcm_session_t);
 
@@ -244,6 +251,23 @@ typedef uint8_t orcm_scd_cmd_flag_t;
 #define ORCM_SESSION_CANCEL_COMMAND 3
 #define ORCM_NODE_INFO_COMMAND      4
 #define ORCM_RUN_COMMAND            5
+#define ORCM_NODE_QUERY_COMMAND     6
+
+/* A node query is followed by its filters:
+ *
+ *   ORCM_NODE_STATE_T      node state, or -1 for any
+ *   ORCM_SCD_NODE_STATE_T  scheduler state, or -1 for any
+ *   OPAL_STRING            node regex, or NULL for all nodes
+ *   OPAL_STRING            rack name, or NULL for any
+ *   OPAL_UINT64            only nodes changed after this epoch, 0 for all
+ *   OPAL_INT32             matching nodes to skip
+ *   OPAL_INT32             most nodes to return, 0 for no limit
+ *
+ * and answered with the status (OPAL_INT), the current epoch
+ * (OPAL_UINT64) to pass as the next query's epoch, the number of
+ * matching nodes (OPAL_INT32), the number returned (OPAL_INT32) and
+ * then those nodes (ORCM_NODE).
+ */
 
 END_C_DECLS
 
@@ -65,7 +65,6 @@ void orcm_sensor_base_start(orte_jobid_t job)
     int i;
     opal_buffer_t *inventory_snapshot;
 
-    orcm_sensor_sampler_t *sampler;
     opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
                         "%s sensor:base: sensor start called",
                         ORTE_NAME_PRINT(ORTE_PROC_MY_NAME));
@@ -115,19 +114,13 @@ void orcm_sensor_base_start(orte_jobid_t job)
         }
 
         if (mods_active && 0 < orcm_sensor_base.sample_rate && orcm_sensor_base.collect_metrics) {
-            /* startup a timer to wake us up periodically
-             * for a data sample, and pass in the sampler
-             */
+            /* startup the schedule that wakes us up to sample
+             * each sensor on its own period */
             opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
                                 "%s sensor:base: creating sampler with rate %d",
                                 ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
                                 orcm_sensor_base.sample_rate);
-            sampler = OBJ_NEW(orcm_sensor_sampler_t);
-            sampler->rate.tv_sec = orcm_sensor_base.sample_rate;
-            sampler->log_data = orcm_sensor_base.log_samples;
-            opal_event_evtimer_set(orcm_sensor_base.ev_base, &sampler->ev,
-                                   take_sample, sampler);
-            opal_event_evtimer_add(&sampler->ev, &sampler->rate);
+            orcm_sensor_base_sched_start();
         }
     } else if (!orcm_sensor_base.ev_active) {
         orcm_sensor_base.ev_active = true;
@@ -358,37 +351,45 @@ static void take_sample(int fd, short args, void *cbdata)
     return;
 }
 
-void orcm_sensor_base_log(char *comp, opal_buffer_t *data)
+int orcm_sensor_base_component_id(const char *comp)
+{
+    void *id;
+
+    if (NULL == comp ||
+        OPAL_SUCCESS != opal_hash_table_get_value_ptr(&orcm_sensor_base.ids, comp,
+                                                      strlen(comp), &id)) {
+        return -1;
+    }
+    /* ids are stored offset by one so a NULL value never means index zero */
+    return (int)((uintptr_t)id - 1);
+}
+
+void orcm_sensor_base_log_id(int id, opal_buffer_t *data)
 {
-    int i;
     orcm_sensor_active_module_t *i_module;
 
-    /* if no modules are available, then there is nothing to do */
-    if (0 == orcm_sensor_base.modules.size) {
+    if (id < 0 || (orcm_sensor_base.dbhandle < 0 &&
+                   0 == orcm_sensor_base.nsubscribers)) {
+        /* nothing we can do */
         return;
     }
 
-    if (NULL == comp || orcm_sensor_base.dbhandle < 0) {
-        /* nothing we can do */
+    /* dispatch straight to the module */
+    i_module = (orcm_sensor_active_module_t*)opal_pointer_array_get_item(&orcm_sensor_base.modules, id);
+    if (NULL == i_module || NULL == i_module->module->log) {
         return;
     }
 
     opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
                         "%s sensor:base: logging sensor %s",
-                        ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), comp);
+                        ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                        i_module->component->base_version.mca_component_name);
+    i_module->module->log(data);
+}
 
-    /* find the specified module  */
-    for (i=0; i < orcm_sensor_base.modules.size; i++) {
-        if (NULL == (i_module = (orcm_sensor_active_module_t*)opal_pointer_array_get_item(&orcm_sensor_base.modules, i))) {
-            continue;
-        }
-        if (0 == strcmp(comp, i_module->component->base_version.mca_component_name)) {
-            if (NULL != i_module->module->log) {
-                i_module->module->log(data);
-            }
-            return;
-        }
-    }
+void orcm_sensor_base_log(char *comp, opal_buffer_t *data)
+{
+    orcm_sensor_base_log_id(orcm_sensor_base_component_id(comp), data);
 }
 
 void orcm_sensor_base_manually_sample(char *sensors,
@@ -434,7 +435,7 @@ static void orcm_sensor_base_recv(int status, orte_process_name_t *sender,
     bool  hi_thres;
     int   max_count, time_window;
     orte_notifier_severity_t sev;
-    orcm_sensor_policy_t *plc, *newplc;
+    orcm_sensor_policy_t *plc;
     bool found_me;
 
     OPAL_OUTPUT_VERBOSE((5, orcm_sensor_base_framework.framework_output,
@@ -566,40 +567,17 @@ static void orcm_sensor_base_recv(int status, orte_process_name_t *sender,
                 goto ERROR;
             }
 
-            /* look for sensor event policy; update with new setting or create new policy if not existing */
-            found_me = false;
-            OPAL_LIST_FOREACH(plc, &orcm_sensor_base.policy, orcm_sensor_policy_t) {
-                if ( (0 == strcmp(sensor_name, plc->sensor_name)) &&
-                     (hi_thres == plc->hi_thres ) &&
-                     (sev == plc->severity) ) {
-                    found_me = true;
-                    /* update existing policy */
-                    plc->threshold = threshold;
-                    plc->max_count = max_count;
-                    plc->time_window = time_window;
-                    plc->action = strdup(action);
-                    break;
-                }
-            }
-
-            if ( !found_me ) {
-                /* matched policy not found, insert into policy list */
-                newplc = OBJ_NEW(orcm_sensor_policy_t);
-                newplc->sensor_name = strdup(sensor_name);
-                newplc->threshold = threshold;
-                newplc->hi_thres  = hi_thres;
-                newplc->max_count = max_count;
-                newplc->time_window = time_window;
-                newplc->severity  = sev;
-                newplc->action = strdup(action);
-
-                opal_list_append(&orcm_sensor_base.policy, &newplc->super);
-                opal_output(0, "Add policy: %s %.2f %s %d %d %d %s!",
-                                    newplc->sensor_name, newplc->threshold, 
-                                    newplc->hi_thres ? "higher" : "lower",
-                                    newplc->max_count, newplc->time_window, 
-                                    newplc->severity, newplc->action);
+            /* update the matching sensor event policy or create a new one */
+            if (ORCM_SUCCESS != (rc = orcm_sensor_base_policy_set(sensor_name, threshold,
+                                                                  hi_thres, max_count,
+                                                                  time_window, sev, action))) {
+                ORTE_ERROR_LOG(rc);
+                free(sensor_name);
+                free(action);
+                goto ERROR;
             }
+            free(sensor_name);
+            free(action);
 
             /* send confirmation back to sender */
             response = ORCM_SUCCESS;
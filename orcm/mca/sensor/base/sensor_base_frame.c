@@ -26,10 +26,10 @@
 #include "opal/mca/base/base.h"
 #include "opal/class/opal_pointer_array.h"
 #include "opal/threads/threads.h"
+#include "opal/runtime/opal_progress_threads.h"
 
 #include "orte/mca/errmgr/errmgr.h"
 
-#include "orcm/runtime/orcm_progress.h"
 #include "orcm/mca/sensor/base/base.h"
 #include "orcm/mca/sensor/base/sensor_private.h"
 
@@ -60,6 +60,22 @@ static int orcm_sensor_base_register(mca_base_register_flag_t flags)
                                 OPAL_INFO_LVL_9,
                                 MCA_BASE_VAR_SCOPE_READONLY,
                                 &orcm_sensor_base.sample_rate);
+
+    orcm_sensor_base.sample_periods = NULL;
+    (void)mca_base_var_register("orcm", "sensor", "base", "sample_periods",
+                                "Comma-separated list of sensor:seconds sample periods overriding sample_rate (e.g., coretemp:1,ipmi:60 - 0 disables periodic sampling of that sensor)",
+                                MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0,
+                                OPAL_INFO_LVL_9,
+                                MCA_BASE_VAR_SCOPE_READONLY,
+                                &orcm_sensor_base.sample_periods);
+
+    orcm_sensor_base.sample_jitter = true;
+    (void)mca_base_var_register("orcm", "sensor", "base", "sample_jitter",
+                                "Spread the first sample of each sensor over its period by a per-node phase",
+                                MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                OPAL_INFO_LVL_9,
+                                MCA_BASE_VAR_SCOPE_READONLY,
+                                &orcm_sensor_base.sample_jitter);
   
     /* see if we want samples logged */
     orcm_sensor_base.log_samples = false;
@@ -94,6 +110,14 @@ static int orcm_sensor_base_register(mca_base_register_flag_t flags)
                                 MCA_BASE_VAR_SCOPE_READONLY,
                                 &orcm_sensor_base.set_dynamic_inventory);
 
+    orcm_sensor_base.schema_refresh = 60;
+    (void)mca_base_var_register("orcm", "sensor", "base", "schema_refresh",
+                                "Number of samples between re-announcements of a sensor's sample schema (0 = announce only once)",
+                                MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                OPAL_INFO_LVL_9,
+                                MCA_BASE_VAR_SCOPE_READONLY,
+                                &orcm_sensor_base.schema_refresh);
+
     return ORCM_SUCCESS;
 }
 
@@ -104,10 +128,14 @@ static int orcm_sensor_base_close(void)
     
     if (orcm_sensor_base.ev_active) {
         orcm_sensor_base.ev_active = false;
-        /* stop the thread */
-        orcm_stop_progress_thread("sensor", true);
+        /* stop the thread before tearing down the schedule it drives */
+        opal_stop_progress_thread("sensor", false);
     }
 
+    orcm_sensor_base_sched_finalize();
+
+    orcm_sensor_base_policy_finalize();
+    orcm_sensor_base_ingest_finalize();
     OPAL_LIST_DESTRUCT(&orcm_sensor_base.policy);
     for (i=0; i < orcm_sensor_base.modules.size; i++) {
         if (NULL == (i_module = (orcm_sensor_active_module_t*)opal_pointer_array_get_item(&orcm_sensor_base.modules, i))) {
@@ -118,9 +146,16 @@ static int orcm_sensor_base_close(void)
         }
     }
     OBJ_DESTRUCT(&orcm_sensor_base.modules);
+    OBJ_DESTRUCT(&orcm_sensor_base.ids);
+
+    /* nothing is left on the sensor event base - release it */
+    opal_stop_progress_thread("sensor", true);
 
     /* clear the per-component-thread collection cache */
     OBJ_DESTRUCT(&orcm_sensor_base.cache);
+
+    /* release the cached sample schemas */
+    orcm_sensor_base_schema_finalize();
     
     /* Close all remaining available components */
     return mca_base_framework_components_close(&orcm_sensor_base_framework, NULL);
@@ -143,6 +178,18 @@ static int orcm_sensor_base_open(mca_base_open_flag_t flags)
     /* construct the array of modules */
     OBJ_CONSTRUCT(&orcm_sensor_base.modules, opal_pointer_array_t);
     opal_pointer_array_init(&orcm_sensor_base.modules, 3, INT_MAX, 1);
+    OBJ_CONSTRUCT(&orcm_sensor_base.ids, opal_hash_table_t);
+    opal_hash_table_init(&orcm_sensor_base.ids, 32);
+
+    if (ORCM_SUCCESS != (rc = orcm_sensor_base_schema_init())) {
+        return rc;
+    }
+    if (ORCM_SUCCESS != (rc = orcm_sensor_base_policy_init())) {
+        return rc;
+    }
+    if (ORCM_SUCCESS != (rc = orcm_sensor_base_ingest_init())) {
+        return rc;
+    }
     
     /* Open up all available components */
     if (OPAL_SUCCESS != (rc = mca_base_framework_components_open(&orcm_sensor_base_framework, flags))) {
@@ -187,6 +234,7 @@ OBJ_CLASS_INSTANCE(orcm_sensor_sampler_t,
 
 static void pcon(orcm_sensor_policy_t *plc)
 {
+    plc->id           = 0;
     plc->sensor_name  = NULL;
     plc->max_count    = 2;
     plc->time_window  = 60;
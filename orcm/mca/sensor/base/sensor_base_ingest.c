@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ *
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Ingest subscriptions. Consumers at an aggregator - the analytics
+ * workflows - register a component pattern and are handed the values
+ * each matching component logs, before they go to the database. The
+ * pattern of every subscription is matched once per component, and
+ * the result is cached until the subscriptions change.
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#include <fnmatch.h>
+#include <string.h>
+
+#include "opal/class/opal_hash_table.h"
+#include "opal/class/opal_list.h"
+#include "opal/threads/mutex.h"
+#include "opal/util/output.h"
+
+#include "orte/util/name_fns.h"
+#include "orte/runtime/orte_globals.h"
+
+#include "orcm/mca/sensor/base/base.h"
+#include "orcm/mca/sensor/base/sensor_private.h"
+
+typedef struct {
+    opal_list_item_t super;
+    int id;
+    char *pattern;
+    orcm_sensor_base_ingest_fn_t cbfunc;
+    void *cbdata;
+} ingest_sub_t;
+static void subcon(ingest_sub_t *p)
+{
+    p->pattern = NULL;
+}
+static void subdes(ingest_sub_t *p)
+{
+    if (NULL != p->pattern) {
+        free(p->pattern);
+    }
+}
+static OBJ_CLASS_INSTANCE(ingest_sub_t,
+                          opal_list_item_t,
+                          subcon, subdes);
+
+/* the subscriptions matching one component */
+typedef struct {
+    int nsubs;
+    ingest_sub_t **subs;
+} ingest_match_t;
+
+static bool ingest_initialized = false;
+static opal_mutex_t ingest_lock;
+static opal_list_t subscriptions;
+static opal_hash_table_t matches;   /* component name -> ingest_match_t */
+static int next_id = 0;
+static uint64_t seq = 0;
+
+static void clear_matches(void)
+{
+    ingest_match_t *m;
+    void *key, *node, *next;
+    size_t keylen;
+    int rc;
+
+    rc = opal_hash_table_get_first_key_ptr(&matches, &key, &keylen,
+                                           (void**)&m, &node);
+    while (OPAL_SUCCESS == rc) {
+        free(m->subs);
+        free(m);
+        rc = opal_hash_table_get_next_key_ptr(&matches, &key, &keylen,
+                                              (void**)&m, node, &next);
+        node = next;
+    }
+    opal_hash_table_remove_all(&matches);
+}
+
+int orcm_sensor_base_ingest_init(void)
+{
+    if (ingest_initialized) {
+        return ORCM_SUCCESS;
+    }
+    OBJ_CONSTRUCT(&ingest_lock, opal_mutex_t);
+    OBJ_CONSTRUCT(&subscriptions, opal_list_t);
+    OBJ_CONSTRUCT(&matches, opal_hash_table_t);
+    opal_hash_table_init(&matches, 32);
+    orcm_sensor_base.nsubscribers = 0;
+    ingest_initialized = true;
+    return ORCM_SUCCESS;
+}
+
+void orcm_sensor_base_ingest_finalize(void)
+{
+    if (!ingest_initialized) {
+        return;
+    }
+    clear_matches();
+    OBJ_DESTRUCT(&matches);
+    OPAL_LIST_DESTRUCT(&subscriptions);
+    OBJ_DESTRUCT(&ingest_lock);
+    orcm_sensor_base.nsubscribers = 0;
+    ingest_initialized = false;
+}
+
+int orcm_sensor_base_subscribe(const char *pattern,
+                               orcm_sensor_base_ingest_fn_t cbfunc,
+                               void *cbdata, int *id)
+{
+    ingest_sub_t *sub;
+
+    if (!ingest_initialized) {
+        return ORCM_ERR_NOT_AVAILABLE;
+    }
+    if (NULL == cbfunc) {
+        return ORCM_ERR_BAD_PARAM;
+    }
+    sub = OBJ_NEW(ingest_sub_t);
+    sub->pattern = strdup((NULL == pattern) ? "*" : pattern);
+    sub->cbfunc = cbfunc;
+    sub->cbdata = cbdata;
+
+    OPAL_THREAD_LOCK(&ingest_lock);
+    sub->id = next_id++;
+    opal_list_append(&subscriptions, &sub->super);
+    clear_matches();
+    orcm_sensor_base.nsubscribers = (int32_t)opal_list_get_size(&subscriptions);
+    OPAL_THREAD_UNLOCK(&ingest_lock);
+
+    opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+                        "%s sensor:base: subscription %d to %s",
+                        ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), sub->id, sub->pattern);
+    *id = sub->id;
+    return ORCM_SUCCESS;
+}
+
+void orcm_sensor_base_unsubscribe(int id)
+{
+    ingest_sub_t *sub;
+
+    if (!ingest_initialized) {
+        return;
+    }
+    OPAL_THREAD_LOCK(&ingest_lock);
+    OPAL_LIST_FOREACH(sub, &subscriptions, ingest_sub_t) {
+        if (id == sub->id) {
+            opal_list_remove_item(&subscriptions, &sub->super);
+            OBJ_RELEASE(sub);
+            clear_matches();
+            break;
+        }
+    }
+    orcm_sensor_base.nsubscribers = (int32_t)opal_list_get_size(&subscriptions);
+    OPAL_THREAD_UNLOCK(&ingest_lock);
+}
+
+/* called with the lock held */
+static ingest_match_t* lookup(const char *component)
+{
+    ingest_match_t *m;
+    ingest_sub_t *sub;
+    size_t len = strlen(component);
+
+    if (OPAL_SUCCESS == opal_hash_table_get_value_ptr(&matches, component, len, (void**)&m)) {
+        return m;
+    }
+    if (NULL == (m = (ingest_match_t*)calloc(1, sizeof(ingest_match_t))) ||
+        NULL == (m->subs = (ingest_sub_t**)malloc(opal_list_get_size(&subscriptions) *
+                                                   sizeof(ingest_sub_t*)))) {
+        free(m);
+        return NULL;
+    }
+    OPAL_LIST_FOREACH(sub, &subscriptions, ingest_sub_t) {
+        if (0 == fnmatch(sub->pattern, component, 0)) {
+            m->subs[m->nsubs++] = sub;
+        }
+    }
+    opal_hash_table_set_value_ptr(&matches, component, len, m);
+    return m;
+}
+
+void orcm_sensor_base_publish(const char *component, opal_list_t *vals)
+{
+    ingest_match_t *m;
+    int i;
+
+    if (!ingest_initialized || 0 == orcm_sensor_base.nsubscribers ||
+        NULL == component || NULL == vals) {
+        return;
+    }
+
+    OPAL_THREAD_LOCK(&ingest_lock);
+    if (NULL != (m = lookup(component))) {
+        seq++;
+        for (i=0; i < m->nsubs; i++) {
+            m->subs[i]->cbfunc(seq, component, vals, m->subs[i]->cbdata);
+        }
+    }
+    OPAL_THREAD_UNLOCK(&ingest_lock);
+}
@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ *
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Sensor event policy engine. The configured policies in
+ * orcm_sensor_base.policy are compiled into one set per sensor, with
+ * the high and low thresholds in separate arrays. A batch of readings
+ * is then checked one threshold at a time with a branch-free compare
+ * loop the compiler can vectorize, so a reading costs nothing for a
+ * policy it does not cross. Only crossings touch the event history:
+ * each (host, policy, metric) keeps the times of its last max_count
+ * crossings in a ring, and an event fires when all of them fall
+ * within the policy's time_window.
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "opal/class/opal_hash_table.h"
+#include "opal/threads/mutex.h"
+#include "opal/util/output.h"
+
+#include "orte/mca/errmgr/errmgr.h"
+#include "orte/mca/notifier/base/base.h"
+
+#include "orcm/mca/sensor/base/base.h"
+#include "orcm/mca/sensor/base/sensor_private.h"
+
+/* the compiled policies of one sensor */
+typedef struct {
+    opal_object_t super;
+    int nhi, nlo;
+    float *hi_thres;                /* trigger when reading >= threshold */
+    float *lo_thres;                /* trigger when reading <= threshold */
+    orcm_sensor_policy_t **hi_plc;
+    orcm_sensor_policy_t **lo_plc;
+} policy_set_t;
+static void pscon(policy_set_t *p)
+{
+    p->nhi = p->nlo = 0;
+    p->hi_thres = p->lo_thres = NULL;
+    p->hi_plc = p->lo_plc = NULL;
+}
+static void psdes(policy_set_t *p)
+{
+    free(p->hi_thres);
+    free(p->lo_thres);
+    free(p->hi_plc);
+    free(p->lo_plc);
+}
+static OBJ_CLASS_INSTANCE(policy_set_t,
+                          opal_object_t,
+                          pscon, psdes);
+
+/* times of the most recent crossings of one policy by one metric */
+typedef struct {
+    int size;
+    int head;
+    int count;
+    time_t *ts;
+} policy_ring_t;
+
+/* history key: hostname, then policy id and metric index */
+typedef struct {
+    uint32_t id;
+    int32_t metric;
+    char host[256];
+} policy_key_t;
+
+static bool policy_initialized = false;
+static opal_mutex_t policy_lock;
+static opal_hash_table_t compiled;      /* sensor name -> policy_set_t */
+static opal_hash_table_t history;       /* policy_key_t -> policy_ring_t */
+static int compiled_gen = -1;
+static int policy_gen = 0;
+static uint32_t next_policy_id = 0;
+
+int orcm_sensor_base_policy_init(void)
+{
+    if (policy_initialized) {
+        return ORCM_SUCCESS;
+    }
+    OBJ_CONSTRUCT(&policy_lock, opal_mutex_t);
+    OBJ_CONSTRUCT(&compiled, opal_hash_table_t);
+    opal_hash_table_init(&compiled, 32);
+    OBJ_CONSTRUCT(&history, opal_hash_table_t);
+    opal_hash_table_init(&history, 1024);
+    compiled_gen = -1;
+    policy_initialized = true;
+    return ORCM_SUCCESS;
+}
+
+static void release_compiled(void)
+{
+    policy_set_t *set;
+    void *key, *node, *next;
+    size_t keylen;
+    int rc;
+
+    rc = opal_hash_table_get_first_key_ptr(&compiled, &key, &keylen,
+                                           (void**)&set, &node);
+    while (OPAL_SUCCESS == rc) {
+        OBJ_RELEASE(set);
+        rc = opal_hash_table_get_next_key_ptr(&compiled, &key, &keylen,
+                                              (void**)&set, node, &next);
+        node = next;
+    }
+    opal_hash_table_remove_all(&compiled);
+}
+
+void orcm_sensor_base_policy_finalize(void)
+{
+    policy_ring_t *ring;
+    void *key, *node, *next;
+    size_t keylen;
+    int rc;
+
+    if (!policy_initialized) {
+        return;
+    }
+    release_compiled();
+    OBJ_DESTRUCT(&compiled);
+    rc = opal_hash_table_get_first_key_ptr(&history, &key, &keylen,
+                                           (void**)&ring, &node);
+    while (OPAL_SUCCESS == rc) {
+        free(ring->ts);
+        free(ring);
+        rc = opal_hash_table_get_next_key_ptr(&history, &key, &keylen,
+                                              (void**)&ring, node, &next);
+        node = next;
+    }
+    OBJ_DESTRUCT(&history);
+    OBJ_DESTRUCT(&policy_lock);
+    policy_initialized = false;
+}
+
+int orcm_sensor_base_policy_set(const char *sensor_name, float threshold,
+                                bool hi_thres, int max_count, int time_window,
+                                orte_notifier_severity_t severity,
+                                const char *action)
+{
+    orcm_sensor_policy_t *plc;
+
+    if (NULL == sensor_name || max_count < 1) {
+        return ORCM_ERR_BAD_PARAM;
+    }
+
+    OPAL_THREAD_LOCK(&policy_lock);
+    /* update an existing policy of the same sensor, direction and severity */
+    OPAL_LIST_FOREACH(plc, &orcm_sensor_base.policy, orcm_sensor_policy_t) {
+        if ( (0 == strcmp(sensor_name, plc->sensor_name)) &&
+             (hi_thres == plc->hi_thres ) &&
+             (severity == plc->severity) ) {
+            plc->threshold = threshold;
+            plc->max_count = max_count;
+            plc->time_window = time_window;
+            if (NULL != plc->action) {
+                free(plc->action);
+            }
+            plc->action = (NULL == action) ? NULL : strdup(action);
+            policy_gen++;
+            OPAL_THREAD_UNLOCK(&policy_lock);
+            return ORCM_SUCCESS;
+        }
+    }
+
+    /* matched policy not found, insert into policy list */
+    plc = OBJ_NEW(orcm_sensor_policy_t);
+    plc->id = next_policy_id++;
+    plc->sensor_name = strdup(sensor_name);
+    plc->threshold = threshold;
+    plc->hi_thres  = hi_thres;
+    plc->max_count = max_count;
+    plc->time_window = time_window;
+    plc->severity  = severity;
+    plc->action = (NULL == action) ? NULL : strdup(action);
+    opal_list_append(&orcm_sensor_base.policy, &plc->super);
+    policy_gen++;
+    OPAL_THREAD_UNLOCK(&policy_lock);
+
+    opal_output(0, "Add policy: %s %.2f %s %d %d %d %s!",
+                plc->sensor_name, plc->threshold, plc->hi_thres ? "higher" : "lower",
+                plc->max_count, plc->time_window, plc->severity, plc->action);
+    return ORCM_SUCCESS;
+}
+
+/* rebuild the per-sensor sets - called with the lock held */
+static void compile(void)
+{
+    orcm_sensor_policy_t *plc;
+    policy_set_t *set;
+    size_t len;
+
+    release_compiled();
+    OPAL_LIST_FOREACH(plc, &orcm_sensor_base.policy, orcm_sensor_policy_t) {
+        len = strlen(plc->sensor_name);
+        if (OPAL_SUCCESS != opal_hash_table_get_value_ptr(&compiled, plc->sensor_name,
+                                                          len, (void**)&set)) {
+            set = OBJ_NEW(policy_set_t);
+            opal_hash_table_set_value_ptr(&compiled, plc->sensor_name, len, set);
+        }
+        if (plc->hi_thres) {
+            set->hi_thres = (float*)realloc(set->hi_thres, (set->nhi + 1) * sizeof(float));
+            set->hi_plc = (orcm_sensor_policy_t**)realloc(set->hi_plc, (set->nhi + 1) * sizeof(orcm_sensor_policy_t*));
+            set->hi_thres[set->nhi] = plc->threshold;
+            set->hi_plc[set->nhi++] = plc;
+        } else {
+            set->lo_thres = (float*)realloc(set->lo_thres, (set->nlo + 1) * sizeof(float));
+            set->lo_plc = (orcm_sensor_policy_t**)realloc(set->lo_plc, (set->nlo + 1) * sizeof(orcm_sensor_policy_t*));
+            set->lo_thres[set->nlo] = plc->threshold;
+            set->lo_plc[set->nlo++] = plc;
+        }
+    }
+    compiled_gen = policy_gen;
+}
+
+static void fire(orcm_sensor_policy_t *plc, const char *hostname, int metric,
+                 float value, const char *what, const char *unit)
+{
+    char *msg;
+
+    if (0 > asprintf(&msg, "host: %s core %d %s %f %s, %s than threshold %f %s for %d times in %d seconds",
+                     hostname, metric, what, value, unit, plc->hi_thres ? "higher" : "lower",
+                     plc->threshold, unit, plc->max_count, plc->time_window)) {
+        return;
+    }
+    opal_output(0, "%s, trigger %s event!", msg, orte_notifier_base_sev2str(plc->severity));
+    /* the notifier frees both once the event is delivered, and the
+     * policy's action can be replaced before then */
+    ORTE_NOTIFIER_SYSTEM_EVENT(plc->severity, msg,
+                               (NULL == plc->action) ? NULL : strdup(plc->action));
+}
+
+/* account for one crossing and report whether the policy fired */
+static bool record(orcm_sensor_policy_t *plc, const char *hostname,
+                   int metric, time_t ts)
+{
+    policy_key_t key;
+    size_t keylen;
+    policy_ring_t *ring;
+    time_t oldest;
+
+    if (1 == plc->max_count) {
+        /* fire an event right away, no need to store in history */
+        return true;
+    }
+
+    memset(&key, 0, sizeof(key));
+    key.id = plc->id;
+    key.metric = metric;
+    strncpy(key.host, hostname, sizeof(key.host) - 1);
+    keylen = offsetof(policy_key_t, host) + strlen(key.host);
+
+    if (OPAL_SUCCESS != opal_hash_table_get_value_ptr(&history, &key, keylen, (void**)&ring)) {
+        if (NULL == (ring = (policy_ring_t*)calloc(1, sizeof(policy_ring_t)))) {
+            return false;
+        }
+        opal_hash_table_set_value_ptr(&history, &key, keylen, ring);
+    }
+    if (ring->size != plc->max_count) {
+        /* new ring, or the policy was updated */
+        free(ring->ts);
+        ring->size = plc->max_count;
+        ring->ts = (time_t*)malloc(ring->size * sizeof(time_t));
+        ring->head = ring->count = 0;
+        if (NULL == ring->ts) {
+            ring->size = 0;
+            return false;
+        }
+    }
+
+    ring->ts[ring->head] = ts;
+    ring->head = (ring->head + 1) % ring->size;
+    if (ring->count < ring->size) {
+        ring->count++;
+    }
+    if (ring->count < ring->size) {
+        return false;
+    }
+    /* the ring is full - the slot after the newest holds the oldest */
+    oldest = ring->ts[ring->head];
+    if (ts - oldest > plc->time_window) {
+        return false;
+    }
+    /* start counting afresh after an event */
+    ring->count = 0;
+    return true;
+}
+
+void orcm_sensor_base_policy_eval(const char *sensor_name, const char *hostname,
+                                  const float *values, int nvalues, time_t ts,
+                                  const char *what, const char *unit)
+{
+    policy_set_t *set;
+    unsigned char *hit;
+    float t;
+    int p, i;
+
+    if (!policy_initialized || NULL == hostname || 0 >= nvalues ||
+        0 == opal_list_get_size(&orcm_sensor_base.policy)) {
+        return;
+    }
+
+    OPAL_THREAD_LOCK(&policy_lock);
+    if (compiled_gen != policy_gen) {
+        compile();
+    }
+    if (OPAL_SUCCESS != opal_hash_table_get_value_ptr(&compiled, sensor_name,
+                                                      strlen(sensor_name), (void**)&set) ||
+        NULL == (hit = (unsigned char*)malloc(nvalues))) {
+        OPAL_THREAD_UNLOCK(&policy_lock);
+        return;
+    }
+
+    for (p=0; p < set->nhi; p++) {
+        t = set->hi_thres[p];
+        for (i=0; i < nvalues; i++) {
+            hit[i] = (values[i] >= t);
+        }
+        for (i=0; i < nvalues; i++) {
+            if (hit[i] && record(set->hi_plc[p], hostname, i, ts)) {
+                fire(set->hi_plc[p], hostname, i, values[i], what, unit);
+            }
+        }
+    }
+    for (p=0; p < set->nlo; p++) {
+        t = set->lo_thres[p];
+        for (i=0; i < nvalues; i++) {
+            hit[i] = (values[i] <= t);
+        }
+        for (i=0; i < nvalues; i++) {
+            if (hit[i] && record(set->lo_plc[p], hostname, i, ts)) {
+                fire(set->lo_plc[p], hostname, i, values[i], what, unit);
+            }
+        }
+    }
+    free(hit);
+    OPAL_THREAD_UNLOCK(&policy_lock);
+}
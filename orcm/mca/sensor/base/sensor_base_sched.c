@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ *
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Per-sensor sampling schedule. Each active module is sampled on its
+ * own period (orcm_sensor_base_sample_periods, defaulting to the base
+ * sample_rate) with an optional per-node phase offset. Pending samples
+ * sit in a two-level hashed timer wheel driven by a single timer on
+ * the sensor progress thread, so the cost of a tick is proportional
+ * to the sensors that are due rather than to all active sensors.
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+
+#include "opal/class/opal_list.h"
+#include "opal/dss/dss.h"
+#include "opal/mca/event/event.h"
+#include "opal/util/argv.h"
+#include "opal/util/output.h"
+
+#include "orte/mca/errmgr/errmgr.h"
+#include "orte/util/proc_info.h"
+#include "orte/util/name_fns.h"
+
+#include "orcm/mca/sensor/base/base.h"
+#include "orcm/mca/sensor/base/sensor_private.h"
+
+#define SCHED_WHEEL_BITS  6
+#define SCHED_WHEEL_SIZE  (1 << SCHED_WHEEL_BITS)
+#define SCHED_WHEEL_MASK  (SCHED_WHEEL_SIZE - 1)
+#define SCHED_WHEEL_SPAN  ((uint64_t)SCHED_WHEEL_SIZE * SCHED_WHEEL_SIZE)
+
+typedef struct {
+    opal_list_item_t super;
+    int index;          /* position of the module in orcm_sensor_base.modules */
+    uint64_t period;    /* ticks between samples */
+    uint64_t expires;   /* absolute tick of the next sample */
+} sched_entry_t;
+static OBJ_CLASS_INSTANCE(sched_entry_t,
+                          opal_list_item_t,
+                          NULL, NULL);
+
+typedef struct {
+    bool active;
+    orcm_sensor_sampler_t *sampler;
+    int tick;           /* seconds per tick */
+    int base_rate;      /* sample_rate the schedule was built for */
+    uint64_t now;       /* ticks since the schedule started */
+    opal_list_t wheel[2][SCHED_WHEEL_SIZE];
+} sched_t;
+static sched_t sched;
+
+static void sched_tick(int fd, short args, void *cbdata);
+
+static int gcd(int a, int b)
+{
+    int t;
+
+    while (0 != b) {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* look up the configured period of a sensor, in seconds */
+static int sensor_period(char **periods, const char *name)
+{
+    int i;
+    size_t len = strlen(name);
+
+    for (i=0; NULL != periods && NULL != periods[i]; i++) {
+        if (0 == strncasecmp(periods[i], name, len) && ':' == periods[i][len]) {
+            return (int)strtol(&periods[i][len+1], NULL, 10);
+        }
+    }
+    return orcm_sensor_base.sample_rate;
+}
+
+/* spread the first sample of each sensor over its period using a
+ * hash of the node and sensor name, so neighbouring nodes don't all
+ * sample (and hit their BMC or the network) in the same instant */
+static uint64_t sensor_phase(const char *name, uint64_t period)
+{
+    unsigned long hash = 5381;
+    const char *p;
+
+    if (!orcm_sensor_base.sample_jitter || 1 >= period) {
+        return period;
+    }
+    for (p=orte_process_info.nodename; NULL != p && '\0' != *p; p++) {
+        hash = hash * 33 + (unsigned char)*p;
+    }
+    for (p=name; '\0' != *p; p++) {
+        hash = hash * 33 + (unsigned char)*p;
+    }
+    return 1 + (hash % period);
+}
+
+/* whole-tick phases only spread sensors whose period spans several
+ * ticks - in the default config every period equals the tick, so also
+ * shift this node's first tick by a hashed offset within the tick */
+static void node_offset(struct timeval *tv)
+{
+    unsigned long hash = 5381;
+    uint64_t usec;
+    const char *p;
+
+    tv->tv_sec = sched.tick;
+    tv->tv_usec = 0;
+    if (!orcm_sensor_base.sample_jitter) {
+        return;
+    }
+    for (p=orte_process_info.nodename; NULL != p && '\0' != *p; p++) {
+        hash = hash * 33 + (unsigned char)*p;
+    }
+    usec = hash % ((uint64_t)sched.tick * 1000000);
+    tv->tv_sec = usec / 1000000;
+    tv->tv_usec = usec % 1000000;
+}
+
+static void wheel_insert(sched_entry_t *e)
+{
+    uint64_t delta = e->expires - sched.now;
+
+    if (delta < SCHED_WHEEL_SIZE) {
+        opal_list_append(&sched.wheel[0][e->expires & SCHED_WHEEL_MASK], &e->super);
+    } else if (delta < SCHED_WHEEL_SPAN) {
+        opal_list_append(&sched.wheel[1][(e->expires >> SCHED_WHEEL_BITS) & SCHED_WHEEL_MASK], &e->super);
+    } else {
+        /* beyond the wheel - park it in the slot that is cascaded last
+         * and let it be re-inserted from there */
+        opal_list_append(&sched.wheel[1][(sched.now >> SCHED_WHEEL_BITS) & SCHED_WHEEL_MASK], &e->super);
+    }
+}
+
+static void wheel_clear(void)
+{
+    int l, s;
+
+    for (l=0; l < 2; l++) {
+        for (s=0; s < SCHED_WHEEL_SIZE; s++) {
+            OPAL_LIST_DESTRUCT(&sched.wheel[l][s]);
+            OBJ_CONSTRUCT(&sched.wheel[l][s], opal_list_t);
+        }
+    }
+}
+
+/* (re)compute the period and phase of every active module */
+static void sched_build(void)
+{
+    orcm_sensor_active_module_t *i_module;
+    sched_entry_t *e;
+    char **periods = NULL;
+    int *secs;
+    int i, tick = 0;
+
+    wheel_clear();
+    sched.base_rate = orcm_sensor_base.sample_rate;
+
+    if (NULL != orcm_sensor_base.sample_periods) {
+        periods = opal_argv_split(orcm_sensor_base.sample_periods, ',');
+    }
+    secs = (int*)calloc(orcm_sensor_base.modules.size, sizeof(int));
+    if (NULL == secs) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+        opal_argv_free(periods);
+        return;
+    }
+
+    /* the tick is the largest interval that divides every period */
+    for (i=0; i < orcm_sensor_base.modules.size; i++) {
+        if (NULL == (i_module = (orcm_sensor_active_module_t*)opal_pointer_array_get_item(&orcm_sensor_base.modules, i))) {
+            continue;
+        }
+        secs[i] = sensor_period(periods, i_module->component->base_version.mca_component_name);
+        if (0 < secs[i]) {
+            tick = gcd(secs[i], tick);
+        }
+    }
+    sched.tick = (0 < tick) ? tick : orcm_sensor_base.sample_rate;
+
+    for (i=0; i < orcm_sensor_base.modules.size; i++) {
+        if (NULL == (i_module = (orcm_sensor_active_module_t*)opal_pointer_array_get_item(&orcm_sensor_base.modules, i))) {
+            continue;
+        }
+        if (0 >= secs[i]) {
+            opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+                                "%s sensor:base: periodic sampling of %s disabled",
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                                i_module->component->base_version.mca_component_name);
+            continue;
+        }
+        e = OBJ_NEW(sched_entry_t);
+        e->index = i;
+        e->period = secs[i] / sched.tick;
+        e->expires = sched.now + sensor_phase(i_module->component->base_version.mca_component_name,
+                                              e->period);
+        wheel_insert(e);
+        opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+                            "%s sensor:base: sampling %s every %d sec, first in %d sec",
+                            ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                            i_module->component->base_version.mca_component_name,
+                            secs[i], (int)((e->expires - sched.now) * sched.tick));
+    }
+    free(secs);
+    opal_argv_free(periods);
+}
+
+int orcm_sensor_base_sched_start(void)
+{
+    struct timeval tv;
+    int l, s;
+
+    if (sched.active) {
+        return ORCM_SUCCESS;
+    }
+    for (l=0; l < 2; l++) {
+        for (s=0; s < SCHED_WHEEL_SIZE; s++) {
+            OBJ_CONSTRUCT(&sched.wheel[l][s], opal_list_t);
+        }
+    }
+    sched.now = 0;
+    sched.sampler = OBJ_NEW(orcm_sensor_sampler_t);
+    sched.sampler->log_data = orcm_sensor_base.log_samples;
+    sched_build();
+    sched.active = true;
+
+    sched.sampler->rate.tv_sec = sched.tick;
+    node_offset(&tv);
+    opal_event_evtimer_set(orcm_sensor_base.ev_base, &sched.sampler->ev,
+                           sched_tick, &sched);
+    opal_event_evtimer_add(&sched.sampler->ev, &tv);
+    return ORCM_SUCCESS;
+}
+
+void orcm_sensor_base_sched_finalize(void)
+{
+    int l, s;
+
+    /* the caller must have stopped the sensor progress thread - the
+     * timer callback touches the sampler and the wheel */
+    if (!sched.active) {
+        return;
+    }
+    opal_event_evtimer_del(&sched.sampler->ev);
+    OBJ_RELEASE(sched.sampler);
+    for (l=0; l < 2; l++) {
+        for (s=0; s < SCHED_WHEEL_SIZE; s++) {
+            OPAL_LIST_DESTRUCT(&sched.wheel[l][s]);
+        }
+    }
+    sched.active = false;
+}
+
+static void sched_tick(int fd, short args, void *cbdata)
+{
+    orcm_sensor_sampler_t *sampler = sched.sampler;
+    orcm_sensor_active_module_t *i_module;
+    opal_list_t due, cascade;
+    opal_list_item_t *item;
+    sched_entry_t *e, *next;
+    struct timeval tv;
+
+    /* the base sample rate can be changed at runtime - sensors
+     * that follow it need a new schedule */
+    if (0 < orcm_sensor_base.sample_rate &&
+        sched.base_rate != orcm_sensor_base.sample_rate) {
+        sched_build();
+    }
+
+    sched.now++;
+
+    /* at the start of each lap of the inner wheel, pull the
+     * next outer slot down to its exact position */
+    if (0 == (sched.now & SCHED_WHEEL_MASK)) {
+        OBJ_CONSTRUCT(&cascade, opal_list_t);
+        opal_list_join(&cascade, opal_list_get_end(&cascade),
+                       &sched.wheel[1][(sched.now >> SCHED_WHEEL_BITS) & SCHED_WHEEL_MASK]);
+        while (NULL != (item = opal_list_remove_first(&cascade))) {
+            wheel_insert((sched_entry_t*)item);
+        }
+        OBJ_DESTRUCT(&cascade);
+    }
+
+    /* order the due sensors by module priority - the heartbeat
+     * is always the lowest, so it sends whatever was collected */
+    OBJ_CONSTRUCT(&due, opal_list_t);
+    while (NULL != (item = opal_list_remove_first(&sched.wheel[0][sched.now & SCHED_WHEEL_MASK]))) {
+        e = (sched_entry_t*)item;
+        OPAL_LIST_FOREACH(next, &due, sched_entry_t) {
+            if (e->index < next->index) {
+                break;
+            }
+        }
+        opal_list_insert_pos(&due, &next->super, &e->super);
+    }
+
+    if (!opal_list_is_empty(&due)) {
+        opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+                            "%s sensor:base: sampling %d sensors at tick %lu",
+                            ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                            (int)opal_list_get_size(&due), (unsigned long)sched.now);
+
+        /* pick up anything the per-component threads cached */
+        if (0 < orcm_sensor_base.cache.bytes_used) {
+            opal_dss.copy_payload(&sampler->bucket, &orcm_sensor_base.cache);
+            OBJ_DESTRUCT(&orcm_sensor_base.cache);
+            OBJ_CONSTRUCT(&orcm_sensor_base.cache, opal_buffer_t);
+        }
+    }
+
+    while (NULL != (item = opal_list_remove_first(&due))) {
+        e = (sched_entry_t*)item;
+        i_module = (orcm_sensor_active_module_t*)opal_pointer_array_get_item(&orcm_sensor_base.modules, e->index);
+        if (NULL != i_module && NULL != i_module->module->sample) {
+            opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+                                "%s sensor:base: sampling component %s",
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                                i_module->component->base_version.mca_component_name);
+            i_module->module->sample(sampler);
+        }
+        e->expires = sched.now + e->period;
+        wheel_insert(e);
+    }
+    OBJ_DESTRUCT(&due);
+
+    sampler->rate.tv_sec = sched.tick;
+    tv.tv_sec = sched.tick;
+    tv.tv_usec = 0;
+    opal_event_evtimer_add(&sampler->ev, &tv);
+}
@@ -0,0 +1,450 @@
+/*
+ * Copyright (c) 2014-2015 Intel, Inc. All rights reserved.
+ *
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include "opal/class/opal_hash_table.h"
+#include "opal/class/opal_pointer_array.h"
+#include "opal/dss/dss.h"
+#include "opal/sys/atomic.h"
+#include "opal/threads/mutex.h"
+#include "opal/util/argv.h"
+#include "opal/util/output.h"
+
+#include "orte/mca/errmgr/errmgr.h"
+#include "orte/util/proc_info.h"
+
+#include "orcm/mca/sensor/base/base.h"
+#include "orcm/mca/sensor/base/sensor_private.h"
+
+/* Wire format of a schema-encoded sample:
+ *
+ *   hostname     OPAL_STRING
+ *   schema id    OPAL_UINT32
+ *   announce     OPAL_BOOL
+ *   [nmetrics    OPAL_INT32     - only if announce is true
+ *    component   OPAL_STRING
+ *    type        OPAL_DATA_TYPE
+ *    labels      nmetrics x OPAL_STRING
+ *    units       nmetrics x OPAL_STRING]
+ *   timestamp    OPAL_INT64     - microseconds since the epoch
+ *   values       nmetrics x wire type of the schema
+ *
+ * Floating point values travel as their IEEE bit patterns so the
+ * dss does not convert each of them to a string.
+ */
+
+/* schemas received from remote daemons, indexed by schema id */
+typedef struct {
+    opal_object_t super;
+    opal_pointer_array_t schemas;
+} schema_host_t;
+static void hcon(schema_host_t *p)
+{
+    OBJ_CONSTRUCT(&p->schemas, opal_pointer_array_t);
+    opal_pointer_array_init(&p->schemas, 4, INT_MAX, 4);
+}
+static void hdes(schema_host_t *p)
+{
+    orcm_sensor_schema_t *s;
+    int i;
+
+    for (i=0; i < p->schemas.size; i++) {
+        if (NULL != (s = (orcm_sensor_schema_t*)opal_pointer_array_get_item(&p->schemas, i))) {
+            OBJ_RELEASE(s);
+        }
+    }
+    OBJ_DESTRUCT(&p->schemas);
+}
+static OBJ_CLASS_INSTANCE(schema_host_t,
+                          opal_object_t,
+                          hcon, hdes);
+
+static volatile int32_t next_schema_id = 0;
+static bool schema_initialized = false;
+static opal_mutex_t schema_lock;
+static opal_hash_table_t remote_schemas;
+
+static opal_data_type_t wire_type(opal_data_type_t type)
+{
+    switch (type) {
+    case OPAL_FLOAT:
+    case OPAL_INT32:
+    case OPAL_UINT32:
+        return OPAL_UINT32;
+    case OPAL_DOUBLE:
+    case OPAL_INT64:
+    case OPAL_UINT64:
+        return OPAL_UINT64;
+    default:
+        return OPAL_UNDEF;
+    }
+}
+
+int orcm_sensor_base_schema_init(void)
+{
+    int rc;
+
+    if (schema_initialized) {
+        return ORCM_SUCCESS;
+    }
+    OBJ_CONSTRUCT(&schema_lock, opal_mutex_t);
+    OBJ_CONSTRUCT(&remote_schemas, opal_hash_table_t);
+    if (OPAL_SUCCESS != (rc = opal_hash_table_init(&remote_schemas, 1024))) {
+        ORTE_ERROR_LOG(rc);
+        OBJ_DESTRUCT(&remote_schemas);
+        OBJ_DESTRUCT(&schema_lock);
+        return rc;
+    }
+    schema_initialized = true;
+    return ORCM_SUCCESS;
+}
+
+void orcm_sensor_base_schema_finalize(void)
+{
+    schema_host_t *host;
+    void *key, *node, *next;
+    size_t keylen;
+    int rc;
+
+    if (!schema_initialized) {
+        return;
+    }
+    rc = opal_hash_table_get_first_key_ptr(&remote_schemas, &key, &keylen,
+                                           (void**)&host, &node);
+    while (OPAL_SUCCESS == rc) {
+        OBJ_RELEASE(host);
+        rc = opal_hash_table_get_next_key_ptr(&remote_schemas, &key, &keylen,
+                                              (void**)&host, node, &next);
+        node = next;
+    }
+    OBJ_DESTRUCT(&remote_schemas);
+    OBJ_DESTRUCT(&schema_lock);
+    schema_initialized = false;
+}
+
+orcm_sensor_schema_t* orcm_sensor_base_schema_register(const char *component,
+                                                       int32_t nmetrics,
+                                                       char **labels,
+                                                       char **units,
+                                                       opal_data_type_t type)
+{
+    orcm_sensor_schema_t *schema;
+    int32_t i;
+
+    if (NULL == component || NULL == labels || nmetrics < 0 ||
+        OPAL_UNDEF == wire_type(type)) {
+        ORTE_ERROR_LOG(ORCM_ERR_BAD_PARAM);
+        return NULL;
+    }
+
+    schema = OBJ_NEW(orcm_sensor_schema_t);
+    schema->component = strdup(component);
+    schema->id = (uint32_t)(opal_atomic_add_32(&next_schema_id, 1) - 1);
+    schema->nmetrics = nmetrics;
+    schema->type = type;
+    schema->labels = (char**)calloc(nmetrics+1, sizeof(char*));
+    schema->units = (char**)calloc(nmetrics+1, sizeof(char*));
+    if (NULL == schema->labels || NULL == schema->units) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+        OBJ_RELEASE(schema);
+        return NULL;
+    }
+    for (i=0; i < nmetrics; i++) {
+        schema->labels[i] = (NULL == labels[i]) ? NULL : strdup(labels[i]);
+        if (NULL != units && NULL != units[i]) {
+            schema->units[i] = strdup(units[i]);
+        }
+    }
+
+    opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+                        "%s sensor:base: registered schema %u for %s with %d metrics",
+                        ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                        schema->id, component, nmetrics);
+    return schema;
+}
+
+int orcm_sensor_base_pack_sample(opal_buffer_t *buf,
+                                 orcm_sensor_schema_t *schema,
+                                 const struct timeval *tv,
+                                 const void *values)
+{
+    int rc;
+    bool announce;
+    int64_t usec;
+    char *hostname = orte_process_info.nodename;
+
+    if (NULL == buf || NULL == schema || NULL == tv ||
+        (NULL == values && 0 < schema->nmetrics)) {
+        return ORCM_ERR_BAD_PARAM;
+    }
+
+    if (OPAL_SUCCESS != (rc = opal_dss.pack(buf, &hostname, 1, OPAL_STRING))) {
+        return rc;
+    }
+    if (OPAL_SUCCESS != (rc = opal_dss.pack(buf, &schema->id, 1, OPAL_UINT32))) {
+        return rc;
+    }
+    announce = (0 >= schema->countdown);
+    if (OPAL_SUCCESS != (rc = opal_dss.pack(buf, &announce, 1, OPAL_BOOL))) {
+        return rc;
+    }
+    if (announce) {
+        if (OPAL_SUCCESS != (rc = opal_dss.pack(buf, &schema->nmetrics, 1, OPAL_INT32))) {
+            return rc;
+        }
+        if (OPAL_SUCCESS != (rc = opal_dss.pack(buf, &schema->component, 1, OPAL_STRING))) {
+            return rc;
+        }
+        if (OPAL_SUCCESS != (rc = opal_dss.pack(buf, &schema->type, 1, OPAL_DATA_TYPE))) {
+            return rc;
+        }
+        if (0 < schema->nmetrics) {
+            if (OPAL_SUCCESS != (rc = opal_dss.pack(buf, schema->labels, schema->nmetrics, OPAL_STRING))) {
+                return rc;
+            }
+            if (OPAL_SUCCESS != (rc = opal_dss.pack(buf, schema->units, schema->nmetrics, OPAL_STRING))) {
+                return rc;
+            }
+        }
+        /* a countdown of zero means never announce again */
+        schema->countdown = (0 < orcm_sensor_base.schema_refresh) ?
+                            orcm_sensor_base.schema_refresh : INT32_MAX;
+    }
+    schema->countdown--;
+
+    usec = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+    if (OPAL_SUCCESS != (rc = opal_dss.pack(buf, &usec, 1, OPAL_INT64))) {
+        return rc;
+    }
+    if (0 < schema->nmetrics) {
+        if (OPAL_SUCCESS != (rc = opal_dss.pack(buf, (void*)values, schema->nmetrics,
+                                                wire_type(schema->type)))) {
+            return rc;
+        }
+    }
+    return ORCM_SUCCESS;
+}
+
+/* record a newly announced schema and drop any older
+ * schema the same component registered on that host */
+static void cache_schema(const char *hostname, orcm_sensor_schema_t *schema)
+{
+    schema_host_t *host = NULL;
+    orcm_sensor_schema_t *s;
+    int i;
+
+    OPAL_THREAD_LOCK(&schema_lock);
+    if (OPAL_SUCCESS != opal_hash_table_get_value_ptr(&remote_schemas, hostname,
+                                                      strlen(hostname), (void**)&host)) {
+        host = OBJ_NEW(schema_host_t);
+        opal_hash_table_set_value_ptr(&remote_schemas, hostname, strlen(hostname), host);
+    }
+    for (i=0; i < host->schemas.size; i++) {
+        if (NULL == (s = (orcm_sensor_schema_t*)opal_pointer_array_get_item(&host->schemas, i))) {
+            continue;
+        }
+        if ((uint32_t)i == schema->id || 0 == strcmp(s->component, schema->component)) {
+            opal_pointer_array_set_item(&host->schemas, i, NULL);
+            OBJ_RELEASE(s);
+        }
+    }
+    opal_pointer_array_set_item(&host->schemas, schema->id, schema);
+    OPAL_THREAD_UNLOCK(&schema_lock);
+}
+
+static orcm_sensor_schema_t* lookup_schema(const char *hostname, uint32_t id)
+{
+    schema_host_t *host;
+    orcm_sensor_schema_t *schema = NULL;
+
+    OPAL_THREAD_LOCK(&schema_lock);
+    if (OPAL_SUCCESS == opal_hash_table_get_value_ptr(&remote_schemas, hostname,
+                                                      strlen(hostname), (void**)&host)) {
+        schema = (orcm_sensor_schema_t*)opal_pointer_array_get_item(&host->schemas, id);
+        if (NULL != schema) {
+            OBJ_RETAIN(schema);
+        }
+    }
+    OPAL_THREAD_UNLOCK(&schema_lock);
+    return schema;
+}
+
+static int unpack_schema(opal_buffer_t *buf, uint32_t id,
+                         orcm_sensor_schema_t **schema)
+{
+    orcm_sensor_schema_t *s;
+    int rc;
+    int32_t n;
+
+    s = OBJ_NEW(orcm_sensor_schema_t);
+    s->id = id;
+    n=1;
+    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buf, &s->nmetrics, &n, OPAL_INT32))) {
+        goto error;
+    }
+    n=1;
+    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buf, &s->component, &n, OPAL_STRING))) {
+        goto error;
+    }
+    n=1;
+    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buf, &s->type, &n, OPAL_DATA_TYPE))) {
+        goto error;
+    }
+    if (s->nmetrics < 0 || NULL == s->component || OPAL_UNDEF == wire_type(s->type)) {
+        rc = ORCM_ERR_BAD_PARAM;
+        goto error;
+    }
+    s->labels = (char**)calloc(s->nmetrics+1, sizeof(char*));
+    s->units = (char**)calloc(s->nmetrics+1, sizeof(char*));
+    if (NULL == s->labels || NULL == s->units) {
+        rc = ORCM_ERR_OUT_OF_RESOURCE;
+        goto error;
+    }
+    if (0 < s->nmetrics) {
+        n = s->nmetrics;
+        if (OPAL_SUCCESS != (rc = opal_dss.unpack(buf, s->labels, &n, OPAL_STRING))) {
+            goto error;
+        }
+        n = s->nmetrics;
+        if (OPAL_SUCCESS != (rc = opal_dss.unpack(buf, s->units, &n, OPAL_STRING))) {
+            goto error;
+        }
+    }
+    *schema = s;
+    return ORCM_SUCCESS;
+
+ error:
+    OBJ_RELEASE(s);
+    return rc;
+}
+
+int orcm_sensor_base_unpack_sample(opal_buffer_t *buf,
+                                   char **hostname,
+                                   orcm_sensor_schema_t **schema,
+                                   struct timeval *tv,
+                                   void **values)
+{
+    char *host = NULL;
+    orcm_sensor_schema_t *s = NULL;
+    uint32_t id;
+    bool announce;
+    int64_t usec;
+    void *vals = NULL;
+    size_t width;
+    int32_t n;
+    int rc;
+
+    n=1;
+    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buf, &host, &n, OPAL_STRING))) {
+        return rc;
+    }
+    if (NULL == host) {
+        return ORCM_ERR_BAD_PARAM;
+    }
+    n=1;
+    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buf, &id, &n, OPAL_UINT32))) {
+        goto error;
+    }
+    n=1;
+    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buf, &announce, &n, OPAL_BOOL))) {
+        goto error;
+    }
+    if (announce) {
+        if (ORCM_SUCCESS != (rc = unpack_schema(buf, id, &s))) {
+            goto error;
+        }
+        OBJ_RETAIN(s);
+        cache_schema(host, s);
+    } else if (NULL == (s = lookup_schema(host, id))) {
+        /* we joined after the schema was announced - the
+         * sample cannot be decoded until it is sent again */
+        opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
+                            "%s sensor:base: no schema %u cached for host %s - dropping sample",
+                            ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), id, host);
+        rc = ORCM_ERR_NOT_FOUND;
+        goto error;
+    }
+
+    n=1;
+    if (OPAL_SUCCESS != (rc = opal_dss.unpack(buf, &usec, &n, OPAL_INT64))) {
+        goto error;
+    }
+    if (0 < s->nmetrics) {
+        width = (OPAL_UINT32 == wire_type(s->type)) ? sizeof(uint32_t) : sizeof(uint64_t);
+        if (NULL == (vals = malloc(s->nmetrics * width))) {
+            rc = ORCM_ERR_OUT_OF_RESOURCE;
+            goto error;
+        }
+        n = s->nmetrics;
+        if (OPAL_SUCCESS != (rc = opal_dss.unpack(buf, vals, &n, wire_type(s->type)))) {
+            goto error;
+        }
+    }
+
+    tv->tv_sec = usec / 1000000;
+    tv->tv_usec = usec % 1000000;
+    *hostname = host;
+    *schema = s;
+    *values = vals;
+    return ORCM_SUCCESS;
+
+ error:
+    free(host);
+    if (NULL != vals) {
+        free(vals);
+    }
+    if (NULL != s) {
+        OBJ_RELEASE(s);
+    }
+    return rc;
+}
+
+static void schcon(orcm_sensor_schema_t *p)
+{
+    p->component = NULL;
+    p->id = 0;
+    p->nmetrics = 0;
+    p->labels = NULL;
+    p->units = NULL;
+    p->type = OPAL_UNDEF;
+    p->countdown = 0;
+}
+static void schdes(orcm_sensor_schema_t *p)
+{
+    int32_t i;
+
+    if (NULL != p->component) {
+        free(p->component);
+    }
+    for (i=0; i < p->nmetrics; i++) {
+        if (NULL != p->labels && NULL != p->labels[i]) {
+            free(p->labels[i]);
+        }
+        if (NULL != p->units && NULL != p->units[i]) {
+            free(p->units[i]);
+        }
+    }
+    if (NULL != p->labels) {
+        free(p->labels);
+    }
+    if (NULL != p->units) {
+        free(p->units);
+    }
+}
+OBJ_CLASS_INSTANCE(orcm_sensor_schema_t,
+                   opal_object_t,
+                   schcon, schdes);
@@ -49,6 +49,7 @@ int orcm_sensor_base_select(void)
     bool none_found;
     orcm_sensor_active_module_t *tmp_module = NULL, *tmp_module_sw = NULL;
     bool duplicate;
+    char *name;
 
     if (selected) {
         return ORCM_SUCCESS;
@@ -215,9 +216,14 @@ int orcm_sensor_base_select(void)
                     i_module->module->finalize();
                     opal_pointer_array_set_item(&orcm_sensor_base.modules, i, NULL);
                     OBJ_RELEASE(i_module);
+                    continue;
                 }
             }
         }
+        /* intern the component name to its module index */
+        name = i_module->component->base_version.mca_component_name;
+        opal_hash_table_set_value_ptr(&orcm_sensor_base.ids, name, strlen(name),
+                                      (void*)(uintptr_t)(i + 1));
     }
 
     return ORCM_SUCCESS;
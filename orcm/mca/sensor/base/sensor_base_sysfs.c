@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ *
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Readers for the small sysfs, procfs and msr files that sensors poll
+ * on every sample. The file is opened once and kept open - sysfs
+ * attributes are regenerated on each read from offset zero - so a
+ * sample costs a single pread into a stack buffer, with no stdio
+ * allocation and no strtoul.
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "orcm/mca/sensor/base/base.h"
+#include "orcm/mca/sensor/base/sensor_private.h"
+
+#define SYSFS_VALUE_MAX 32
+
+int orcm_sensor_base_sysfs_open(const char *path)
+{
+    int fd;
+
+    do {
+        fd = open(path, O_RDONLY);
+    } while (0 > fd && EINTR == errno);
+    if (0 <= fd) {
+        (void)fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    return fd;
+}
+
+void orcm_sensor_base_sysfs_close(int *fd)
+{
+    if (0 <= *fd) {
+        close(*fd);
+        *fd = -1;
+    }
+}
+
+int orcm_sensor_base_sysfs_read_int64(int fd, int64_t *value)
+{
+    char buf[SYSFS_VALUE_MAX];
+    ssize_t n;
+    char *p, *end;
+    bool neg = false;
+    int64_t v = 0;
+
+    do {
+        n = pread(fd, buf, sizeof(buf), 0);
+    } while (0 > n && EINTR == errno);
+    if (0 >= n) {
+        return ORCM_ERR_FILE_READ_FAILURE;
+    }
+
+    p = buf;
+    end = buf + n;
+    while (p < end && (' ' == *p || '\t' == *p)) {
+        p++;
+    }
+    if (p < end && ('-' == *p || '+' == *p)) {
+        neg = ('-' == *p);
+        p++;
+    }
+    if (p == end || *p < '0' || '9' < *p) {
+        return ORCM_ERR_BAD_PARAM;
+    }
+    while (p < end && '0' <= *p && *p <= '9') {
+        v = v * 10 + (*p - '0');
+        p++;
+    }
+    *value = neg ? -v : v;
+    return ORCM_SUCCESS;
+}
+
+int orcm_sensor_base_msr_read(int fd, off_t reg, uint64_t *value)
+{
+    ssize_t n;
+
+    do {
+        n = pread(fd, value, sizeof(uint64_t), reg);
+    } while (0 > n && EINTR == errno);
+    if (sizeof(uint64_t) != n) {
+        return ORCM_ERR_FILE_READ_FAILURE;
+    }
+    return ORCM_SUCCESS;
+}
@@ -23,8 +23,13 @@
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif  /* HAVE_UNISTD_H */
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif  /* HAVE_SYS_TIME_H */
 
+#include "opal/class/opal_hash_table.h"
 #include "opal/class/opal_pointer_array.h"
+#include "opal/dss/dss_types.h"
 #include "opal/mca/event/event.h"
 #include "opal/threads/threads.h"
 
@@ -47,6 +52,7 @@ BEGIN_C_DECLS
  * hi_thres: high or low threshold
  * severity: severity level assigned to this event policy
  * action: notification mechanism of this event
+ * id: assigned by orcm_sensor_base_policy_set, keys the event history
  *
  * Example: coretemp:100:hi:2:60:alert:syslog
  *    If we see two times of coretemp reading higher than 100 in 60 seconds'
@@ -54,6 +60,7 @@ BEGIN_C_DECLS
  */
 typedef struct {
     opal_list_item_t super;
+    uint32_t id;
     char  *sensor_name;
     int   max_count;
     int   time_window;
@@ -64,13 +71,37 @@ typedef struct {
 } orcm_sensor_policy_t;
 OBJ_CLASS_DECLARATION(orcm_sensor_policy_t);
 
+/****    SENSOR SAMPLE SCHEMA    ****/
+/* A schema describes the metrics a sensor reports on every sample:
+ * one label and unit per metric, plus the numeric type shared by
+ * all values. A daemon registers each schema once and samples then
+ * carry only the schema id, a timestamp and the packed values. The
+ * full schema travels with the first sample (and every
+ * orcm_sensor_base_schema_refresh samples after that) so the
+ * aggregator can cache it per host.
+ */
+typedef struct {
+    opal_object_t super;
+    char *component;
+    uint32_t id;
+    int32_t nmetrics;
+    char **labels;
+    char **units;
+    opal_data_type_t type;  /* OPAL_FLOAT, OPAL_DOUBLE, OPAL_[U]INT32 or OPAL_[U]INT64 */
+    int32_t countdown;      /* samples until the schema is announced again */
+} orcm_sensor_schema_t;
+OBJ_CLASS_DECLARATION(orcm_sensor_schema_t);
+
 /* define a struct to hold framework-global values */
 typedef struct {
     opal_event_base_t *ev_base;
     bool ev_active;
     opal_pointer_array_t modules;
+    opal_hash_table_t ids;  /* component name -> index of its active module */
     bool log_samples;
     int sample_rate;    /* Holds the rate at which the sensors need to be sampled in seconds */
+    char *sample_periods;   /* Comma-separated sensor:seconds overrides of sample_rate */
+    bool sample_jitter;     /* Offset each sensor's first sample by a per-node phase */
     opal_buffer_t cache;  // caches any data collected by per-component threads
     opal_list_t policy; /* Holds user configured RAS event policy */
     int dbhandle;       /* Stores the unique database handle assigned for sensor framework after calling db_open */
@@ -78,6 +109,8 @@ typedef struct {
     bool collect_metrics;       /* Holds the user configured variable indicating whether sensor metric sampling is enabled or not */
     bool collect_inventory;     /* Holds the user configured variable indicating whether inventory collection is enabled or not */
     bool set_dynamic_inventory; /* Holds the user configured variable indicating whether dynamic inventory collection is enabled or not */
+    int schema_refresh;         /* Number of samples between schema announcements, 0 = announce only once */
+    int32_t nsubscribers;       /* Number of ingest subscriptions */
 } orcm_sensor_base_t;
 
 typedef struct {
@@ -114,6 +147,11 @@ ORCM_DECLSPEC extern orcm_sensor_base_t orcm_sensor_base;
 ORCM_DECLSPEC void orcm_sensor_base_start(orte_jobid_t job);
 ORCM_DECLSPEC void orcm_sensor_base_stop(orte_jobid_t job);
 ORCM_DECLSPEC void orcm_sensor_base_log(char *comp, opal_buffer_t *data);
+/* components are interned to the index of their active module so
+ * received data can be dispatched without comparing names. The id
+ * is local to this daemon - peers exchange name/id tables */
+ORCM_DECLSPEC int orcm_sensor_base_component_id(const char *comp);
+ORCM_DECLSPEC void orcm_sensor_base_log_id(int id, opal_buffer_t *data);
 /* manually sample one or more sensors */
 ORCM_DECLSPEC void orcm_sensor_base_manually_sample(char *sensors,
                                                     orcm_sensor_sample_cb_fn_t cbfunc,
@@ -121,6 +159,71 @@ ORCM_DECLSPEC void orcm_sensor_base_manually_sample(char *sensors,
 ORCM_DECLSPEC void orcm_sensor_base_collect(int fd, short args, void *cbdata);
 ORCM_DECLSPEC void orcm_sensor_base_set_sample_rate(int sample_rate);
 ORCM_DECLSPEC void orcm_sensor_base_get_sample_rate(int *sample_rate);
+/* periodic sampling - must be called from the sensor event base */
+ORCM_DECLSPEC int orcm_sensor_base_sched_start(void);
+ORCM_DECLSPEC void orcm_sensor_base_sched_finalize(void);
+
+/* event policies - policies are added or updated with policy_set and
+ * checked against a batch of readings (one per metric, e.g. per core)
+ * with policy_eval. what and unit name the reading in the event text */
+ORCM_DECLSPEC int orcm_sensor_base_policy_init(void);
+ORCM_DECLSPEC void orcm_sensor_base_policy_finalize(void);
+ORCM_DECLSPEC int orcm_sensor_base_policy_set(const char *sensor_name, float threshold,
+                                              bool hi_thres, int max_count, int time_window,
+                                              orte_notifier_severity_t severity,
+                                              const char *action);
+ORCM_DECLSPEC void orcm_sensor_base_policy_eval(const char *sensor_name, const char *hostname,
+                                                const float *values, int nvalues, time_t ts,
+                                                const char *what, const char *unit);
+
+/* ingest subscriptions - a subscriber sees the values every component
+ * logs at this daemon whose name matches its pattern (a shell glob).
+ * The callback runs synchronously in the log path and must not keep
+ * vals; seq identifies the logged sample, so a subscriber registered
+ * more than once can convert each sample only once */
+typedef void (*orcm_sensor_base_ingest_fn_t)(uint64_t seq, const char *component,
+                                             opal_list_t *vals, void *cbdata);
+ORCM_DECLSPEC int orcm_sensor_base_subscribe(const char *pattern,
+                                             orcm_sensor_base_ingest_fn_t cbfunc,
+                                             void *cbdata, int *id);
+ORCM_DECLSPEC void orcm_sensor_base_unsubscribe(int id);
+/* called by the components' log functions before the values are stored */
+ORCM_DECLSPEC void orcm_sensor_base_publish(const char *component, opal_list_t *vals);
+ORCM_DECLSPEC int orcm_sensor_base_ingest_init(void);
+ORCM_DECLSPEC void orcm_sensor_base_ingest_finalize(void);
+
+/* sysfs readers - open a file once and re-read it with pread
+ * on every sample. fds are -1 when closed */
+ORCM_DECLSPEC int orcm_sensor_base_sysfs_open(const char *path);
+ORCM_DECLSPEC void orcm_sensor_base_sysfs_close(int *fd);
+/* parse the leading decimal integer of the file */
+ORCM_DECLSPEC int orcm_sensor_base_sysfs_read_int64(int fd, int64_t *value);
+/* read a 64-bit model specific register from a /dev/cpu/N/msr fd */
+ORCM_DECLSPEC int orcm_sensor_base_msr_read(int fd, off_t reg, uint64_t *value);
+
+/* schema-encoded samples */
+ORCM_DECLSPEC int orcm_sensor_base_schema_init(void);
+ORCM_DECLSPEC void orcm_sensor_base_schema_finalize(void);
+/* register a schema for the local daemon - the labels and units
+ * arrays are copied (units may be NULL). The returned schema is
+ * owned by the caller, who releases it with OBJ_RELEASE when done */
+ORCM_DECLSPEC orcm_sensor_schema_t* orcm_sensor_base_schema_register(const char *component,
+                                                                    int32_t nmetrics,
+                                                                    char **labels,
+                                                                    char **units,
+                                                                    opal_data_type_t type);
+/* pack one sample of schema->nmetrics values of schema->type */
+ORCM_DECLSPEC int orcm_sensor_base_pack_sample(opal_buffer_t *buf,
+                                               orcm_sensor_schema_t *schema,
+                                               const struct timeval *tv,
+                                               const void *values);
+/* unpack a sample, caching any announced schema. On success the
+ * caller owns hostname and values, and must OBJ_RELEASE the schema */
+ORCM_DECLSPEC int orcm_sensor_base_unpack_sample(opal_buffer_t *buf,
+                                                 char **hostname,
+                                                 orcm_sensor_schema_t **schema,
+                                                 struct timeval *tv,
+                                                 void **values);
 
 END_C_DECLS
 #endif
@@ -33,6 +33,7 @@
 #include "opal_stdint.h"
 #include "opal/class/opal_list.h"
 #include "opal/dss/dss.h"
+#include "opal/util/argv.h"
 #include "opal/util/os_path.h"
 #include "opal/util/output.h"
 #include "opal/util/os_dirpath.h"
@@ -85,6 +86,7 @@ __rapl _rapl;
 static orcm_sensor_sampler_t *componentpower_sampler = NULL;
 static orcm_sensor_componentpower_t orcm_sensor_componentpower;
 static bool log_enabled = true;
+static orcm_sensor_schema_t *componentpower_schema = NULL;
 
 static int init(void)
 {
@@ -93,9 +95,40 @@ static int init(void)
 
 static void finalize(void)
 {
+    if (NULL != componentpower_schema) {
+        OBJ_RELEASE(componentpower_schema);
+    }
     return;
 }
 
+/* build the sample schema - the cpu power of each socket, then the
+ * ddr power of each */
+static int componentpower_build_schema(void)
+{
+    char **labels = NULL, **units = NULL, label[64];
+    int32_t nmetrics = 0;
+    int i;
+
+    for (i=0; i<_rapl.n_sockets; i++){
+        snprintf(label, sizeof(label), "cpu%d_power", i);
+        opal_argv_append(&nmetrics, &labels, label);
+        opal_argv_append_nosize(&units, "W");
+    }
+    for (i=0; i<_rapl.n_sockets; i++){
+        snprintf(label, sizeof(label), "ddr%d_power", i);
+        opal_argv_append(&nmetrics, &labels, label);
+        opal_argv_append_nosize(&units, "W");
+    }
+    componentpower_schema = orcm_sensor_base_schema_register("componentpower", nmetrics,
+                                                             labels, units, OPAL_FLOAT);
+    opal_argv_free(labels);
+    opal_argv_free(units);
+    if (NULL == componentpower_schema) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    return ORCM_SUCCESS;
+}
+
 /*
  detect num of sockets
  */
@@ -220,9 +253,9 @@ static void detect_cpu_for_each_socket(void)
  */
 static void start(orte_jobid_t jobid)
 {
-    int n_cpus, n_sockets, i;
+    int n_cpus, n_sockets, i, rc;
     char path[STR_LEN];
-    unsigned long long msr, msr1, msr2;
+    uint64_t msr, msr1, msr2;
 
     /* we must be root to run */
     if (0 != geteuid()) {
@@ -267,8 +300,12 @@ static void start(orte_jobid_t jobid)
         return;
     }
 
-    lseek(_rapl.fd_cpu[0], RAPL_UNIT, 0);
-    read(_rapl.fd_cpu[0], &msr, sizeof(unsigned long long));
+    if (ORCM_SUCCESS != orcm_sensor_base_msr_read(_rapl.fd_cpu[0], RAPL_UNIT, &msr)) {
+        opal_output(0, "error reading the RAPL unit msr\n");
+        _rapl.cpu_rapl_support=0;
+        _rapl.ddr_rapl_support=0;
+        return;
+    }
 /* get energy unit */
     msr=(msr>>8)&0x1f;
     if (!msr){
@@ -284,22 +321,20 @@ static void start(orte_jobid_t jobid)
         _rapl.ddr_rapl_support=0;
     }
 
-    lseek(_rapl.fd_cpu[0], RAPL_CPU_ENERGY, 0);
-    read(_rapl.fd_cpu[0], &msr1, sizeof(unsigned long long));
+    rc = orcm_sensor_base_msr_read(_rapl.fd_cpu[0], RAPL_CPU_ENERGY, &msr1);
     usleep(100000);
-    lseek(_rapl.fd_cpu[0], RAPL_CPU_ENERGY, 0);
-    read(_rapl.fd_cpu[0], &msr2, sizeof(unsigned long long));
-    if (msr1==msr2){
+    if (ORCM_SUCCESS != rc ||
+        ORCM_SUCCESS != orcm_sensor_base_msr_read(_rapl.fd_cpu[0], RAPL_CPU_ENERGY, &msr2) ||
+        msr1==msr2){
         opal_output(0, "CPU RAPL is not enabled\n");
         _rapl.cpu_rapl_support=0;
     }
 
-    lseek(_rapl.fd_cpu[0], RAPL_DDR_ENERGY, 0);
-    read(_rapl.fd_cpu[0], &msr1, sizeof(unsigned long long));
+    rc = orcm_sensor_base_msr_read(_rapl.fd_cpu[0], RAPL_DDR_ENERGY, &msr1);
     usleep(100000);
-    lseek(_rapl.fd_cpu[0], RAPL_DDR_ENERGY, 0);
-    read(_rapl.fd_cpu[0], &msr2, sizeof(unsigned long long));
-    if (msr1==msr2){
+    if (ORCM_SUCCESS != rc ||
+        ORCM_SUCCESS != orcm_sensor_base_msr_read(_rapl.fd_cpu[0], RAPL_DDR_ENERGY, &msr2) ||
+        msr1==msr2){
         opal_output(0, "DDR RAPL is not enabled\n");
         _rapl.ddr_rapl_support=0;
     }
@@ -389,12 +424,10 @@ static void collect_sample(orcm_sensor_sampler_t *sampler)
     int ret;
     char *freq;
     opal_buffer_t data, *bptr;
-    int32_t nsockets;
-    bool packed;
-
-    float power_cur;
+    float values[2*MAX_SOCKETS];
     int i;
-    unsigned long long interval, msr, rapl_delta;
+    unsigned long long interval, rapl_delta;
+    uint64_t msr;
 
      /* we must be root to run */
     if (0 != geteuid()) {
@@ -423,9 +456,22 @@ static void collect_sample(orcm_sensor_sampler_t *sampler)
     } else {
         _rapl.rapl_calls++;
         for (i=0; i<_rapl.n_sockets; i++){
-            lseek(_rapl.fd_cpu[i], RAPL_CPU_ENERGY, 0);
-            read(_rapl.fd_cpu[i], &msr, sizeof(unsigned long long));
+            if (ORCM_SUCCESS != orcm_sensor_base_msr_read(_rapl.fd_cpu[i], RAPL_CPU_ENERGY, &msr)) {
+                /* skip this socket's sample and drop its baseline */
+                opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+                                    "%s sensor:componentpower: failed to read cpu energy of socket %d",
+                                    ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), i);
+                _rapl.cpu_power[i]=-1.0;
+                _rapl.cpu_rapl_prev[i]=0;
+                continue;
+            }
             _rapl.cpu_rapl[i]=msr;
+            if (0 == _rapl.cpu_rapl_prev[i]) {
+                /* no baseline after a failed read - start a new one */
+                _rapl.cpu_power[i]=-1.0;
+                _rapl.cpu_rapl_prev[i]=msr;
+                continue;
+            }
     
             if (_rapl.cpu_rapl[i]>=_rapl.cpu_rapl_prev[i]){
                 rapl_delta=_rapl.cpu_rapl[i]-_rapl.cpu_rapl_prev[i];
@@ -451,9 +497,21 @@ static void collect_sample(orcm_sensor_sampler_t *sampler)
         }
     } else {
         for (i=0; i<_rapl.n_sockets; i++){
-            lseek(_rapl.fd_cpu[i], RAPL_DDR_ENERGY, 0);
-            read(_rapl.fd_cpu[i], &msr, sizeof(unsigned long long));
+            if (ORCM_SUCCESS != orcm_sensor_base_msr_read(_rapl.fd_cpu[i], RAPL_DDR_ENERGY, &msr)) {
+                opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+                                    "%s sensor:componentpower: failed to read ddr energy of socket %d",
+                                    ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), i);
+                _rapl.ddr_power[i]=-1.0;
+                _rapl.ddr_rapl_prev[i]=0;
+                continue;
+            }
             _rapl.ddr_rapl[i]=msr;
+            if (0 == _rapl.ddr_rapl_prev[i]) {
+                /* no baseline after a failed read - start a new one */
+                _rapl.ddr_power[i]=-1.0;
+                _rapl.ddr_rapl_prev[i]=msr;
+                continue;
+            }
             if (_rapl.ddr_rapl[i]>=_rapl.ddr_rapl_prev[i]){
                 rapl_delta=_rapl.ddr_rapl[i]-_rapl.ddr_rapl_prev[i];
             } else {
@@ -473,72 +531,51 @@ static void collect_sample(orcm_sensor_sampler_t *sampler)
 
     }
 
+    /* one cpu and one ddr reading per socket - the socket count is
+     * fixed once sampling has started, so the schema is built once */
+    if (NULL == componentpower_schema &&
+        ORCM_SUCCESS != (ret = componentpower_build_schema())) {
+        ORTE_ERROR_LOG(ret);
+        return;
+    }
+    for (i=0; i<_rapl.n_sockets; i++){
+        if (_rapl.rapl_calls<=1){
+            values[i]=0.0;
+            values[_rapl.n_sockets+i]=0.0;
+        } else{
+            values[i]=(float)(_rapl.cpu_power[i]);
+            values[_rapl.n_sockets+i]=(float)(_rapl.ddr_power[i]);
+        }
+    }
+
     /* prep to store the results */
     OBJ_CONSTRUCT(&data, opal_buffer_t);
-    packed = false;
 
     /* pack our name */
     freq = strdup("componentpower");
     if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &freq, 1, OPAL_STRING))) {
         ORTE_ERROR_LOG(ret);
         OBJ_DESTRUCT(&data);
+        free(freq);
         return;
     }
     free(freq);
 
-    /* store our hostname */
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &orte_process_info.nodename, 1, OPAL_STRING))) {
+    /* pack the schema-encoded sample */
+    if (ORCM_SUCCESS != (ret = orcm_sensor_base_pack_sample(&data, componentpower_schema,
+                                                            &_tv.tv_curr, values))) {
         ORTE_ERROR_LOG(ret);
         OBJ_DESTRUCT(&data);
         return;
     }
 
-    /* store the number of sockets */
-    nsockets = detect_num_sockets();
-
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &nsockets, 1, OPAL_INT32))) {
-
-        ORTE_ERROR_LOG(ret);
-        OBJ_DESTRUCT(&data);
-        return;
-    }
-
-    /* get the sample time */
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &(_tv.tv_curr), 1, OPAL_TIMEVAL))) {
+    /* xfer the data for transmission */
+    bptr = &data;
+    if (OPAL_SUCCESS != (ret = opal_dss.pack(&sampler->bucket, &bptr, 1, OPAL_BUFFER))) {
         ORTE_ERROR_LOG(ret);
         OBJ_DESTRUCT(&data);
         return;
     }
-
-    for (i=0; i<_rapl.n_sockets; i++){
-        if (_rapl.rapl_calls<=1){
-            power_cur=0.0;
-        } else{
-            power_cur=(float)(_rapl.cpu_power[i]);
-        }
-        opal_dss.pack(&data, &power_cur, 1, OPAL_FLOAT);
-    }
-
-    for (i=0; i<_rapl.n_sockets; i++){
-        if (_rapl.rapl_calls<=1){
-            power_cur=0.0;
-        } else{
-            power_cur=(float)(_rapl.ddr_power[i]);
-        }
-        opal_dss.pack(&data, &power_cur, 1, OPAL_FLOAT);
-    }
-
-    packed=true;
-
-    /* xfer the data for transmission */
-    if (packed) {
-        bptr = &data;
-        if (OPAL_SUCCESS != (ret = opal_dss.pack(&sampler->bucket, &bptr, 1, OPAL_BUFFER))) {
-            ORTE_ERROR_LOG(ret);
-            OBJ_DESTRUCT(&data);
-            return;
-        }
-    }
     OBJ_DESTRUCT(&data);
 
 }
@@ -558,69 +595,33 @@ static void mycleanup(int dbhandle, int status,
 static void componentpower_log(opal_buffer_t *sample)
 {
     char *hostname=NULL;
-    char temp_str[64];
+    orcm_sensor_schema_t *schema;
     int rc;
-    int32_t n, nsockets;
     opal_list_t *vals;
     opal_value_t *kv;
-    int i;
+    int32_t i;
     int sensor_not_avail=0;
     struct timeval tv_curr;
-    float power_cur, cpu_power_temp[MAX_SOCKETS], ddr_power_temp[MAX_SOCKETS];
+    float *values;
     char time_str[40];
 
     if (!log_enabled) {
         return;
     }
 
-    /* unpack the host this came from */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &hostname, &n, OPAL_STRING))) {
-        ORTE_ERROR_LOG(rc);
-        return;
-    }
-
-    /* and the number of sockets on that host */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &nsockets, &n, OPAL_INT32))) {
-        ORTE_ERROR_LOG(rc);
+    /* unpack the schema-encoded sample */
+    if (ORCM_SUCCESS != (rc = orcm_sensor_base_unpack_sample(sample, &hostname, &schema,
+                                                             &tv_curr, (void**)&values))) {
+        if (ORCM_ERR_NOT_FOUND != rc) {
+            ORTE_ERROR_LOG(rc);
+        }
         return;
     }
 
     opal_output_verbose(3, orcm_sensor_base_framework.framework_output,
                         "%s Received freq log from host %s with %d sockets",
                         ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                        (NULL == hostname) ? "NULL" : hostname, nsockets);
-
-    /* timestamp */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &tv_curr, &n, OPAL_TIMEVAL))) {
-        ORTE_ERROR_LOG(rc);
-        return;
-    }
-
-    if (nsockets>MAX_SOCKETS)
-        nsockets=MAX_SOCKETS;
-
-    /* cpu power */
-    n=1;
-    for (i=0; i<nsockets; i++){
-        if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &power_cur, &n, OPAL_FLOAT))){
-            ORTE_ERROR_LOG(rc);
-            return;
-        }
-        cpu_power_temp[i]=power_cur;
-    }
-
-    /* ddr power */
-    n=1;
-    for (i=0; i<nsockets; i++){
-        if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &power_cur, &n, OPAL_FLOAT))){
-            ORTE_ERROR_LOG(rc);
-            return;
-        }
-        ddr_power_temp[i]=power_cur;
-    }
+                        hostname, schema->nmetrics / 2);
 
     /* xfr to storage */
     vals = OBJ_NEW(opal_list_t);
@@ -642,51 +643,38 @@ static void componentpower_log(opal_buffer_t *sample)
     kv = OBJ_NEW(opal_value_t);
     kv->key = strdup("hostname");
     kv->type = OPAL_STRING;
-    if (hostname==NULL)
-        kv->data.string = strdup("NULL");
-    else
-        kv->data.string = strdup(hostname);
+    kv->data.string = strdup(hostname);
     opal_list_append(vals, &kv->super);
 
-    for (i=0; i<nsockets; i++){
-        snprintf(temp_str, sizeof(temp_str), "cpu%d_power:W", i);
-        kv = OBJ_NEW(opal_value_t);
-        kv->key=strdup(temp_str);
-        kv->type=OPAL_FLOAT;
-        kv->data.fval=cpu_power_temp[i];
-        if (power_cur<=(float)(0.0)){
+    /* cpu power for each socket, then ddr power */
+    for (i=0; i < schema->nmetrics; i++){
+        if (values[i]<=(float)(0.0)){
             sensor_not_avail=1;
-	} else {
-            opal_list_append(vals, &kv->super);
+            continue;
         }
-    }
-
-    for (i=0; i<nsockets; i++){
-        snprintf(temp_str, sizeof(temp_str), "ddr%d_power:W", i);
         kv = OBJ_NEW(opal_value_t);
-        kv->key=strdup(temp_str);
+        asprintf(&kv->key, "%s:%s", schema->labels[i],
+                 (NULL == schema->units[i]) ? "" : schema->units[i]);
         kv->type=OPAL_FLOAT;
-        kv->data.fval=ddr_power_temp[i];
-        if (power_cur<=(float)(0.0)){
-            sensor_not_avail=1;
-        } else {
-            opal_list_append(vals, &kv->super);
-        }
+        kv->data.fval=values[i];
+        opal_list_append(vals, &kv->super);
     }
 
+    /* hand the values to any analytics subscribed to them */
+    orcm_sensor_base_publish("componentpower", vals);
+
     /* store it */
-    if (0 <= orcm_sensor_base.dbhandle) {
-        if (!sensor_not_avail){
-            orcm_db.store(orcm_sensor_base.dbhandle, "componentpower", vals, mycleanup, NULL);
-        }
+    if (0 <= orcm_sensor_base.dbhandle && !sensor_not_avail) {
+        orcm_db.store(orcm_sensor_base.dbhandle, "componentpower", vals, mycleanup, NULL);
     } else {
         OPAL_LIST_RELEASE(vals);
     }
 
-    if (NULL != hostname) {
-        free(hostname);
+    OBJ_RELEASE(schema);
+    if (NULL != values) {
+        free(values);
     }
-
+    free(hostname);
 }
 
 static void componentpower_set_sample_rate(int sample_rate)
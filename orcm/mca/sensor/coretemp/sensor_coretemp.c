@@ -22,6 +22,9 @@
 #ifdef HAVE_TIME_H
 #include <time.h>
 #endif
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
 #ifdef HAVE_DIRENT_H
 #include <dirent.h>
 #endif  /* HAVE_DIRENT_H */
@@ -30,6 +33,7 @@
 #include "opal_stdint.h"
 #include "opal/class/opal_list.h"
 #include "opal/dss/dss.h"
+#include "opal/util/argv.h"
 #include "opal/util/os_path.h"
 #include "opal/util/output.h"
 #include "opal/util/os_dirpath.h"
@@ -74,50 +78,10 @@ orcm_sensor_base_module_t orcm_sensor_coretemp_module = {
     coretemp_get_sample_rate
 };
 
-/****    CORETEMP EVENT HISTORY TYPE    ****/
-/* To reduce memory footprint, we don't store the count for all nodes and cores.
- * we only keep the count of the specific core of specific node that ever cross
- * threshold.
- * An event history consists of:
- * hostname: host name of the compute node that we see coretemp cross threshold
- * core_no: the core number of the compute node that we see coretemp cross threshold
- * hi_thres: high or low threshold
- * severity: severity level assigned to this event
- * count: the number of samples that we see coretemp cross threshold
- * tstamp: timestamp of the cross threshold sample last seen
- */
-typedef struct {
-    opal_list_item_t super;
-    char   *hostname;
-    int    core_no;
-    bool   hi_thres;
-    orte_notifier_severity_t severity;
-    int    count;
-    time_t tstamp;
-} coretemp_history_t;
-static void hst_con(coretemp_history_t *hst)
-{
-    hst->hostname = NULL;
-    hst->core_no  = 0;
-    hst->hi_thres = true;
-    hst->severity = ORTE_NOTIFIER_INFO;
-    hst->count    = 0;
-    hst->tstamp   = 0;
-}
-static void hst_des(coretemp_history_t *hst)
-{
-    if (NULL != hst->hostname) {
-        free(hst->hostname);
-    }
-
-}
-OBJ_CLASS_INSTANCE(coretemp_history_t,
-                   opal_list_item_t,
-                   hst_con, hst_des);
-
 typedef struct {
     opal_list_item_t super;
     char *file;
+    int fd;         /* kept open across samples */
     int socket;
     int core;
     char *label;
@@ -127,12 +91,14 @@ typedef struct {
 static void ctr_con(coretemp_tracker_t *trk)
 {
     trk->file = NULL;
+    trk->fd = -1;
     trk->label = NULL;
     trk->socket = -1;
     trk->core = -1;
 }
 static void ctr_des(coretemp_tracker_t *trk)
 {
+    orcm_sensor_base_sysfs_close(&trk->fd);
     if (NULL != trk->file) {
         free(trk->file);
     }
@@ -146,8 +112,8 @@ OBJ_CLASS_INSTANCE(coretemp_tracker_t,
 
 static bool log_enabled = true;
 static opal_list_t tracking;
-static opal_list_t event_history;
 static orcm_sensor_sampler_t *coretemp_sampler = NULL;
+static orcm_sensor_schema_t *coretemp_schema = NULL;
 static orcm_sensor_coretemp_t orcm_sensor_coretemp;
 
 char **coretemp_policy_list; /* store coretemp policies from MCA parameter */
@@ -171,8 +137,6 @@ static int coretemp_load_policy(char *policy)
 {
     char **tokens = NULL;
     int array_length = 0;
-    orcm_sensor_policy_t *plc, *newplc;
-    bool found_me;
     char *sensor_name = NULL;
     char *action = NULL;
     float threshold;
@@ -230,39 +194,9 @@ static int coretemp_load_policy(char *policy)
 
         action = strdup(tokens[5]);
 
-        /* look for sensor event policy; update with new setting or create new policy if not existing */
-        found_me = false;
-        OPAL_LIST_FOREACH(plc, &orcm_sensor_base.policy, orcm_sensor_policy_t) {
-            if ( (0 == strcmp(sensor_name, plc->sensor_name)) &&
-                 (hi_thres == plc->hi_thres ) &&
-                 (sev == plc->severity) ) {
-                found_me = true;
-                /* update existing policy */
-                plc->threshold = threshold;
-                plc->max_count = max_count;
-                plc->time_window = time_window;
-                plc->action = strdup(action);
-                break;
-            }
-        }
-
-        if ( !found_me ) {
-            /* matched policy not found, insert into policy list */
-            newplc = OBJ_NEW(orcm_sensor_policy_t);
-            newplc->sensor_name = strdup(sensor_name);
-            newplc->threshold = threshold;
-            newplc->hi_thres  = hi_thres;
-            newplc->max_count = max_count;
-            newplc->time_window = time_window;
-            newplc->severity  = sev;
-            newplc->action = strdup(action);
-
-            opal_list_append(&orcm_sensor_base.policy, &newplc->super);
-            opal_output(0, "Add policy: %s %.2f %s %d %d %d %s!",
-                                newplc->sensor_name, newplc->threshold, newplc->hi_thres ? "higher" : "lower",
-                                newplc->max_count, newplc->time_window, newplc->severity, newplc->action);
-        }
-        ret = ORCM_SUCCESS;
+        /* update the matching sensor event policy or create a new one */
+        ret = orcm_sensor_base_policy_set(sensor_name, threshold, hi_thres,
+                                          max_count, time_window, sev, action);
 
     } else {
         goto done;
@@ -281,130 +215,6 @@ done:
     return ret;
 }
 
-static int coretemp_policy_filter(char *hostname, int core_no, float ct, time_t ts)
-{
-    orcm_sensor_policy_t *plc;
-    coretemp_history_t *hst, *newhst;
-    bool found_me;
-    char *sev;
-    char *msg;
-
-    /* Check if this sample may be filtered
-     * We have to check for all policies, one single sample might trigger
-     * multiple events with different severity levels
-     */
-    OPAL_LIST_FOREACH(plc, &orcm_sensor_base.policy, orcm_sensor_policy_t) {
-        /* check for coretemp sensor type */
-        if ( 0 != strcmp(plc->sensor_name, "coretemp") ) {
-            continue;
-        }
-
-        if ( (plc->hi_thres && (ct < plc->threshold) ) ||
-             (!plc->hi_thres && (ct > plc->threshold) ) ) {
-            continue;
-        }
-
-        switch ( plc->severity ) {
-        case ORTE_NOTIFIER_EMERG:
-            sev = strdup("EMERG");
-            break;
-        case ORTE_NOTIFIER_ALERT:
-            sev = strdup("ALERT");
-            break;
-        case ORTE_NOTIFIER_CRIT:
-            sev = strdup("CRIT");
-            break;
-        case ORTE_NOTIFIER_ERROR:
-            sev = strdup("ERROR");
-            break;
-        case ORTE_NOTIFIER_WARN:
-            sev = strdup("WARN");
-            break;
-        case ORTE_NOTIFIER_NOTICE:
-            sev = strdup("NOTICE");
-            break;
-        case ORTE_NOTIFIER_INFO:
-            sev = strdup("INFO");
-            break;
-        case ORTE_NOTIFIER_DEBUG:
-            sev = strdup("DEBUG");
-            break;
-        default:
-            sev = strdup("UNKNOWN");
-            break;
-        }
-
-        /* this sample should be accounted for this policy
-         * we have a candidate, let's check there is similar sample accounted in history or not
-         */
-        found_me = false;
-        OPAL_LIST_FOREACH(hst, &event_history, coretemp_history_t) {
-            /* check for any matching record in history list */
-            /* match by host name and core number */
-            if (   hst->tstamp &&
-                 ( 0 == strcmp(hostname, hst->hostname) ) &&
-                 ( core_no == hst->core_no ) &&
-                 ( plc->hi_thres == hst->hi_thres ) &&
-                 ( plc->severity == hst->severity) ) {
-                found_me = true;
-                /* this sample pattern has been captured in history
-                 * let's test the time windows expiration
-                 */
-                if ( (hst->tstamp + plc->time_window) < ts ) {
-                    /* Matching history record had expired, just overwrite it */
-                    hst->count = 1;
-                    hst->tstamp = ts;
-                } else {
-                    hst->count++;
-                }
-
-                /* filter policy threshold reached */
-                if ( hst->count >= plc->max_count ) {
-                    /* fire an event */
-                    asprintf(&msg, "host: %s core %d temperature %f °C, %s than threshold %f °C for %d times in %d seconds",
-                                    hostname, core_no, ct, plc->hi_thres ? "higher" : "lower",
-                                    plc->threshold, plc->max_count, plc->time_window);
-                    ORTE_NOTIFIER_SYSTEM_EVENT(plc->severity, msg, plc->action);
-                    opal_output(0, "host: %s core %d temperature %f °C, %s than threshold %f °C for %d times in %d seconds, trigger %s event!",
-                                    hostname, core_no, ct, plc->hi_thres ? "higher" : "lower",
-                                    plc->threshold, plc->max_count, plc->time_window, sev);
-                    /* stop watching for this history record, remove from list */
-                    opal_list_remove_item(&event_history, &hst->super);
-                }
-
-                break;
-            }
-        }
-
-        if ( !found_me ) {
-            /* matched sample not seen before, insert into history list */
-            if ( 1 == plc->max_count ) {
-                /* fire an event right away, no need to store in history list */
-                asprintf(&msg, "host: %s core %d temperature %f °C, %s than threshold %f °C for %d times in %d seconds",
-                                    hostname, core_no, ct, plc->hi_thres ? "higher" : "lower",
-                                    plc->threshold, plc->max_count, plc->time_window);
-                ORTE_NOTIFIER_SYSTEM_EVENT(plc->severity, msg, plc->action);
-                opal_output(0, "host: %s Core %d temperature %f °C, %s than threshold %f °C for %d times in %d seconds, trigger %s event!",
-                                    hostname, core_no, ct, plc->hi_thres ? "higher" : "lower",
-                                    plc->threshold, plc->max_count, plc->time_window, sev);
-            } else {
-                newhst = OBJ_NEW(coretemp_history_t);
-                newhst->hostname = strdup(hostname);
-                newhst->core_no = core_no;
-                newhst->hi_thres = plc->hi_thres;
-                newhst->severity = plc->severity;
-                newhst->count = 1;
-                newhst->tstamp = ts;
-                opal_list_append(&event_history, &newhst->super);
-            }
-        }
-        free(sev);
-    }
-
-
-  return 1;
-}
-
 /* FOR FUTURE: extend to read cooling device speeds in
  *     current speed: /sys/class/thermal/cooling_deviceN/cur_state
  *     max speed: /sys/class/thermal/cooling_deviceN/max_state
@@ -429,7 +239,6 @@ static int init(void)
 
     /* always construct this so we don't segfault in finalize */
     OBJ_CONSTRUCT(&tracking, opal_list_t);
-    OBJ_CONSTRUCT(&event_history, opal_list_t);
 
     /* get policy from MCA parameters */
     if( NULL != mca_sensor_coretemp_component.policy ) {
@@ -655,8 +464,10 @@ static int init(void)
 
 static void finalize(void)
 {
+    if (NULL != coretemp_schema) {
+        OBJ_RELEASE(coretemp_schema);
+    }
     OPAL_LIST_DESTRUCT(&tracking);
-    OPAL_LIST_DESTRUCT(&event_history);
 }
 
 /*
@@ -740,74 +551,59 @@ static void perthread_coretemp_sample(int fd, short args, void *cbdata)
     opal_event_evtimer_add(&sampler->ev, &sampler->rate);
 }
 
+/* (re)build the sample schema from the current tracker list */
+static int coretemp_build_schema(void)
+{
+    coretemp_tracker_t *trk;
+    char **labels = NULL, **units = NULL;
+    int32_t ncores = 0;
+
+    if (NULL != coretemp_schema) {
+        OBJ_RELEASE(coretemp_schema);
+    }
+    OPAL_LIST_FOREACH(trk, &tracking, coretemp_tracker_t) {
+        opal_argv_append(&ncores, &labels, trk->label);
+        opal_argv_append_nosize(&units, "degrees C");
+    }
+    coretemp_schema = orcm_sensor_base_schema_register("coretemp", ncores,
+                                                       labels, units, OPAL_FLOAT);
+    opal_argv_free(labels);
+    opal_argv_free(units);
+    if (NULL == coretemp_schema) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    return ORCM_SUCCESS;
+}
+
 static void collect_sample(orcm_sensor_sampler_t *sampler)
 {
     int ret;
     coretemp_tracker_t *trk, *nxt;
-    FILE *fp;
+    int64_t millideg;
     char *temp;
-    float degc;
+    float degc, *values;
     opal_buffer_t data, *bptr;
     int32_t ncores;
-    time_t now;
-    char time_str[40];
-    char *timestamp_str;
-    bool packed;
-    struct tm *sample_time;
+    struct timeval now;
+    bool changed = false;
 
     if (0 == opal_list_get_size(&tracking)) {
         return;
     }
 
-    /* prep to store the results */
-    OBJ_CONSTRUCT(&data, opal_buffer_t);
-    packed = false;
-
-    /* pack our name */
-    temp = strdup("coretemp");
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &temp, 1, OPAL_STRING))) {
-        ORTE_ERROR_LOG(ret);
-        OBJ_DESTRUCT(&data);
-        return;
-    }
-    free(temp);
-
-    /* store our hostname */
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &orte_process_info.nodename, 1, OPAL_STRING))) {
-        ORTE_ERROR_LOG(ret);
-        OBJ_DESTRUCT(&data);
-        return;
-    }
+    /* get the sample time */
+    gettimeofday(&now, NULL);
 
-    /* store the number of cores */
     ncores = (int32_t)opal_list_get_size(&tracking);
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &ncores, 1, OPAL_INT32))) {
-        ORTE_ERROR_LOG(ret);
-        OBJ_DESTRUCT(&data);
+    if (NULL == (values = (float*)malloc(ncores * sizeof(float)))) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
         return;
     }
-
-    /* get the sample time */
-    now = time(NULL);
-    /* pass the time along as a simple string */
-    sample_time = localtime(&now);
-    if (NULL == sample_time) {
-        ORTE_ERROR_LOG(OPAL_ERR_BAD_PARAM);
-        return;
-    }
-    strftime(time_str, sizeof(time_str), "%F %T%z", sample_time);
-    asprintf(&timestamp_str, "%s", time_str);
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &timestamp_str, 1, OPAL_STRING))) {
-        ORTE_ERROR_LOG(ret);
-        OBJ_DESTRUCT(&data);
-        free(timestamp_str);
-        return;
-    }
-    free(timestamp_str);
+    ncores = 0;
 
     OPAL_LIST_FOREACH_SAFE(trk, nxt, &tracking, coretemp_tracker_t) {
         /* read the temp */
-        if (NULL == (fp = fopen(trk->file, "r"))) {
+        if (0 > trk->fd && 0 > (trk->fd = orcm_sensor_base_sysfs_open(trk->file))) {
             /* we can't be read, so remove it from the list */
             opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
                                 "%s access denied to coretemp file %s - removing it",
@@ -815,56 +611,80 @@ static void collect_sample(orcm_sensor_sampler_t *sampler)
                                 trk->file);
             opal_list_remove_item(&tracking, &trk->super);
             OBJ_RELEASE(trk);
+            changed = true;
             continue;
         }
-        if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &trk->label, 1, OPAL_STRING))) {
-            ORTE_ERROR_LOG(ret);
-            fclose(fp);
-            OBJ_DESTRUCT(&data);
-            return;
+        if (ORCM_SUCCESS != orcm_sensor_base_sysfs_read_int64(trk->fd, &millideg)) {
+            opal_list_remove_item(&tracking, &trk->super);
+            OBJ_RELEASE(trk);
+            changed = true;
+            continue;
         }
-        while (NULL != (temp = orte_getline(fp))) {
-            degc = strtoul(temp, NULL, 10) / 1000.0;
+        degc = millideg / 1000.0;
+        opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+                            "%s sensor:coretemp: Core %d in Socket %d temp %f max %f critical %f",
+                            ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                            trk->core, trk->socket, degc, trk->max_temp, trk->critical_temp);
+        values[ncores++] = degc;
+        /* check for exceed critical temp */
+        if (trk->critical_temp < degc) {
+            /* alert the errmgr - this is a critical problem */
             opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
-                                "%s sensor:coretemp: Core %d in Socket %d temp %f max %f critical %f",
+                                "%s sensor:coretemp: Core %d (socket %d) CRITICAL",
                                 ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                trk->core, trk->socket, degc, trk->max_temp, trk->critical_temp);
-            if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &degc, 1, OPAL_FLOAT))) {
-                ORTE_ERROR_LOG(ret);
-                free(temp);
-                fclose(fp);
-                OBJ_DESTRUCT(&data);
-                return;
-            }
-            free(temp);
-            packed = true;
-            /* check for exceed critical temp */
-            if (trk->critical_temp < degc) {
-                /* alert the errmgr - this is a critical problem */
-                opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
-                                    "%s sensor:coretemp: Core %d (socket %d) CRITICAL",
-                                    ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                    trk->core, trk->socket);
-             } else if (trk->max_temp < degc) {
-                /* alert the errmgr */
-                opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
-                                    "%s sensor:coretemp: Core %d (socket %d) MAX",
-                                    ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                    trk->core, trk->socket);
-             }
+                                trk->core, trk->socket);
+        } else if (trk->max_temp < degc) {
+            /* alert the errmgr */
+            opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+                                "%s sensor:coretemp: Core %d (socket %d) MAX",
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                                trk->core, trk->socket);
         }
-        fclose(fp);
     }
 
-    /* xfer the data for transmission */
-    if (packed) {
-        bptr = &data;
-        if (OPAL_SUCCESS != (ret = opal_dss.pack(&sampler->bucket, &bptr, 1, OPAL_BUFFER))) {
+    /* the set of cores changed, so the old schema no longer applies */
+    if (changed || NULL == coretemp_schema) {
+        if (ORCM_SUCCESS != (ret = coretemp_build_schema())) {
             ORTE_ERROR_LOG(ret);
-            OBJ_DESTRUCT(&data);
+            free(values);
             return;
         }
     }
+    if (0 == ncores) {
+        free(values);
+        return;
+    }
+
+    /* prep to store the results */
+    OBJ_CONSTRUCT(&data, opal_buffer_t);
+
+    /* pack our name */
+    temp = strdup("coretemp");
+    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &temp, 1, OPAL_STRING))) {
+        ORTE_ERROR_LOG(ret);
+        OBJ_DESTRUCT(&data);
+        free(temp);
+        free(values);
+        return;
+    }
+    free(temp);
+
+    /* pack the schema-encoded sample */
+    ret = orcm_sensor_base_pack_sample(&data, coretemp_schema, &now, values);
+    free(values);
+    if (ORCM_SUCCESS != ret) {
+        ORTE_ERROR_LOG(ret);
+        OBJ_DESTRUCT(&data);
+        return;
+    }
+
+    /* xfer the data for transmission */
+    bptr = &data;
+    if (OPAL_SUCCESS != (ret = opal_dss.pack(&sampler->bucket, &bptr, 1, OPAL_BUFFER))) {
+        ORTE_ERROR_LOG(ret);
+        OBJ_DESTRUCT(&data);
+        return;
+    }
     OBJ_DESTRUCT(&data);
 }
 
@@ -880,96 +700,65 @@ static void mycleanup(int dbhandle, int status,
 static void coretemp_log(opal_buffer_t *sample)
 {
     char *hostname=NULL;
-    char *sampletime;
-    struct tm time_info;
-    time_t ts;
+    orcm_sensor_schema_t *schema;
+    struct timeval sampletime;
+    float *values;
     int rc;
-    int32_t n, ncores;
     opal_list_t *vals;
     opal_value_t *kv;
-    float fval;
-    int i;
-    char *core_label;
+    int32_t i;
 
     if (!log_enabled) {
         return;
     }
 
-    /* unpack the host this came from */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &hostname, &n, OPAL_STRING))) {
-        ORTE_ERROR_LOG(rc);
-        return;
-    }
-    /* and the number of cores on that host */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &ncores, &n, OPAL_INT32))) {
-        ORTE_ERROR_LOG(rc);
-        return;
-    }
-
-    /* sample time */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &sampletime, &n, OPAL_STRING))) {
-        ORTE_ERROR_LOG(rc);
+    /* unpack the schema-encoded sample */
+    if (ORCM_SUCCESS != (rc = orcm_sensor_base_unpack_sample(sample, &hostname, &schema,
+                                                             &sampletime, (void**)&values))) {
+        if (ORCM_ERR_NOT_FOUND != rc) {
+            ORTE_ERROR_LOG(rc);
+        }
         return;
     }
 
     opal_output_verbose(3, orcm_sensor_base_framework.framework_output,
                         "%s Received log from host %s with %d cores",
                         ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                        (NULL == hostname) ? "NULL" : hostname, ncores);
+                        hostname, schema->nmetrics);
 
     /* xfr to storage */
     vals = OBJ_NEW(opal_list_t);
 
     /* load the sample time at the start */
-    if (NULL == sampletime) {
-        ORTE_ERROR_LOG(OPAL_ERR_BAD_PARAM);
-        return;
-    }
     kv = OBJ_NEW(opal_value_t);
     kv->key = strdup("ctime");
-    kv->type = OPAL_STRING;
-    kv->data.string = strdup(sampletime);
-    free(sampletime);
+    kv->type = OPAL_TIMEVAL;
+    kv->data.tv = sampletime;
     opal_list_append(vals, &kv->super);
 
     /* load the hostname */
-    if (NULL == hostname) {
-        ORTE_ERROR_LOG(OPAL_ERR_BAD_PARAM);
-        return;
-    }
     kv = OBJ_NEW(opal_value_t);
     kv->key = strdup("hostname");
     kv->type = OPAL_STRING;
     kv->data.string = strdup(hostname);
     opal_list_append(vals, &kv->super);
 
-    for (i=0; i < ncores; i++) {
+    for (i=0; i < schema->nmetrics; i++) {
         kv = OBJ_NEW(opal_value_t);
-        n=1;
-        if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &core_label, &n, OPAL_STRING))) {
-            ORTE_ERROR_LOG(rc);
-            goto cleanup;
-        }
-        asprintf(&kv->key, "%s:degrees C", core_label);
+        asprintf(&kv->key, "%s:%s", schema->labels[i],
+                 (NULL == schema->units[i]) ? "" : schema->units[i]);
         kv->type = OPAL_FLOAT;
-        n=1;
-        if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &fval, &n, OPAL_FLOAT))) {
-            ORTE_ERROR_LOG(rc);
-            goto cleanup;
-        }
-
-        /* check coretemp event policy */
-        strptime(sampletime, "%F %T%z", &time_info);
-        ts = mktime(&time_info);
-        coretemp_policy_filter(hostname, i, fval, ts);
-
-        kv->data.fval = fval;
+        kv->data.fval = values[i];
         opal_list_append(vals, &kv->super);
     }
 
+    /* check the coretemp event policies against all cores at once */
+    orcm_sensor_base_policy_eval("coretemp", hostname, values, schema->nmetrics,
+                                 sampletime.tv_sec, "temperature", "°C");
+
+    /* hand the values to any analytics subscribed to them */
+    orcm_sensor_base_publish("coretemp", vals);
+
     /* store it */
     if (0 <= orcm_sensor_base.dbhandle) {
         orcm_db.store(orcm_sensor_base.dbhandle, "coretemp", vals, mycleanup, NULL);
@@ -977,11 +766,11 @@ static void coretemp_log(opal_buffer_t *sample)
         OPAL_LIST_RELEASE(vals);
     }
 
- cleanup:
-    if (NULL != hostname) {
-        free(hostname);
+    OBJ_RELEASE(schema);
+    if (NULL != values) {
+        free(values);
     }
-
+    free(hostname);
 }
 
 static void coretemp_set_sample_rate(int sample_rate)
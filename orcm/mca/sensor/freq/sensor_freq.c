@@ -22,6 +22,9 @@
 #ifdef HAVE_TIME_H
 #include <time.h>
 #endif
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
 #ifdef HAVE_DIRENT_H
 #include <dirent.h>
 #endif  /* HAVE_DIRENT_H */
@@ -30,6 +33,7 @@
 #include "opal_stdint.h"
 #include "opal/class/opal_list.h"
 #include "opal/dss/dss.h"
+#include "opal/util/argv.h"
 #include "opal/util/os_path.h"
 #include "opal/util/output.h"
 #include "opal/util/os_dirpath.h"
@@ -74,50 +78,10 @@ orcm_sensor_base_module_t orcm_sensor_freq_module = {
     freq_get_sample_rate
 };
 
-/****    COREFREQ EVENT HISTORY TYPE    ****/
-/* To reduce memory footprint, we don't store the count for all nodes and cores.
- * we only keep the count of the specific core of specific node that ever cross
- * threshold.
- * An event history consists of:
- * hostname: host name of the compute node that we see coretemp cross threshold
- * core_no: the core number of the compute node that we see coretemp cross threshold
- * hi_thres: high or low threshold
- * severity: severity level assigned to this event
- * count: the number of samples that we see coretemp cross threshold
- * tstamp: timestamp of the cross threshold sample last seen
- */
-typedef struct {
-    opal_list_item_t super;
-    char   *hostname;
-    int    core_no;
-    bool   hi_thres;
-    orte_notifier_severity_t severity;
-    int    count;
-    time_t tstamp;
-} corefreq_history_t;
-static void hst_con(corefreq_history_t *hst)
-{
-    hst->hostname = NULL;
-    hst->core_no  = 0;
-    hst->hi_thres = true;
-    hst->severity = ORTE_NOTIFIER_INFO;
-    hst->count    = 0;
-    hst->tstamp   = 0;
-}
-static void hst_des(corefreq_history_t *hst)
-{
-    if (NULL != hst->hostname) {
-        free(hst->hostname);
-    }
-
-}
-OBJ_CLASS_INSTANCE(corefreq_history_t,
-                   opal_list_item_t,
-                   hst_con, hst_des);
-
 typedef struct {
     opal_list_item_t super;
     char *file;
+    int fd;         /* kept open across samples */
     int core;
     float max_freq;
     float min_freq;
@@ -125,9 +89,11 @@ typedef struct {
 static void ctr_con(corefreq_tracker_t *trk)
 {
     trk->file = NULL;
+    trk->fd = -1;
 }
 static void ctr_des(corefreq_tracker_t *trk)
 {
+    orcm_sensor_base_sysfs_close(&trk->fd);
     if (NULL != trk->file) {
         free(trk->file);
     }
@@ -139,15 +105,18 @@ OBJ_CLASS_INSTANCE(corefreq_tracker_t,
 typedef struct {
     opal_list_item_t super;
     char *file;     /* sysfs entry file location */
+    int fd;         /* kept open across samples */
     char *sysname;  /* sysfs entry name */
     unsigned int value;
 } pstate_tracker_t;
 static void ptrk_con(pstate_tracker_t *trk)
 {
     trk->file = NULL;
+    trk->fd = -1;
 }
 static void ptrk_des(pstate_tracker_t *trk)
 {
+    orcm_sensor_base_sysfs_close(&trk->fd);
     if (NULL != trk->file) {
         free(trk->file);
     }
@@ -163,9 +132,10 @@ static bool log_enabled = true;
 static bool intel_pstate_avail = false;
 static opal_list_t tracking;
 static opal_list_t pstate_list;
-static opal_list_t event_history;
 static orcm_sensor_sampler_t *freq_sampler = NULL;
 static orcm_sensor_freq_t orcm_sensor_freq;
+static orcm_sensor_schema_t *freq_schema = NULL;
+static orcm_sensor_schema_t *pstate_schema = NULL;
 
 char **corefreq_policy_list; /* store corefreq policies from MCA parameter */
 
@@ -188,8 +158,6 @@ static int corefreq_load_policy(char *policy)
 {
     char **tokens = NULL;
     int array_length = 0;
-    orcm_sensor_policy_t *plc, *newplc;
-    bool found_me;
     char *sensor_name = NULL;
     char *action = NULL;
     float threshold;
@@ -247,39 +215,9 @@ static int corefreq_load_policy(char *policy)
 
         action = strdup(tokens[5]);
 
-        /* look for sensor event policy; update with new setting or create new policy if not existing */
-        found_me = false;
-        OPAL_LIST_FOREACH(plc, &orcm_sensor_base.policy, orcm_sensor_policy_t) {
-            if ( (0 == strcmp(sensor_name, plc->sensor_name)) &&
-                 (hi_thres == plc->hi_thres ) &&
-                 (sev == plc->severity) ) {
-                found_me = true;
-                /* update existing policy */
-                plc->threshold = threshold;
-                plc->max_count = max_count;
-                plc->time_window = time_window;
-                plc->action = strdup(action);
-                break;
-            }
-        }
-
-        if ( !found_me ) {
-            /* matched policy not found, insert into policy list */
-            newplc = OBJ_NEW(orcm_sensor_policy_t);
-            newplc->sensor_name = strdup(sensor_name);
-            newplc->threshold = threshold;
-            newplc->hi_thres  = hi_thres;
-            newplc->max_count = max_count;
-            newplc->time_window = time_window;
-            newplc->severity  = sev;
-            newplc->action = strdup(action);
-
-            opal_list_append(&orcm_sensor_base.policy, &newplc->super);
-            opal_output(0, "Add policy: %s %.2f %s %d %d %d %s!",
-                                newplc->sensor_name, newplc->threshold, newplc->hi_thres ? "higher" : "lower",
-                                newplc->max_count, newplc->time_window, newplc->severity, newplc->action);
-        }
-        ret = ORCM_SUCCESS;
+        /* update the matching sensor event policy or create a new one */
+        ret = orcm_sensor_base_policy_set(sensor_name, threshold, hi_thres,
+                                          max_count, time_window, sev, action);
 
     } else {
         goto done;
@@ -298,130 +236,6 @@ done:
     return ret;
 }
 
-static int corefreq_policy_filter(char *hostname, int core_no, float cf, time_t ts)
-{
-    orcm_sensor_policy_t *plc;
-    corefreq_history_t *hst, *newhst;
-    bool found_me;
-    char *sev;
-    char *msg;
-
-    /* Check if this sample may be filtered
-     * We have to check for all policies, one single sample might trigger
-     * multiple events with different severity levels
-     */
-    OPAL_LIST_FOREACH(plc, &orcm_sensor_base.policy, orcm_sensor_policy_t) {
-        /* check for corefreq sensor type */
-        if ( 0 != strcmp(plc->sensor_name, "corefreq") ) {
-            continue;
-        }
-
-        if ( (plc->hi_thres && (cf < plc->threshold) ) ||
-             (!plc->hi_thres && (cf > plc->threshold) ) ) {
-            continue;
-        }
-
-        switch ( plc->severity ) {
-        case ORTE_NOTIFIER_EMERG:
-            sev = strdup("EMERG");
-            break;
-        case ORTE_NOTIFIER_ALERT:
-            sev = strdup("ALERT");
-            break;
-        case ORTE_NOTIFIER_CRIT:
-            sev = strdup("CRIT");
-            break;
-        case ORTE_NOTIFIER_ERROR:
-            sev = strdup("ERROR");
-            break;
-        case ORTE_NOTIFIER_WARN:
-            sev = strdup("WARN");
-            break;
-        case ORTE_NOTIFIER_NOTICE:
-            sev = strdup("NOTICE");
-            break;
-        case ORTE_NOTIFIER_INFO:
-            sev = strdup("INFO");
-            break;
-        case ORTE_NOTIFIER_DEBUG:
-            sev = strdup("DEBUG");
-            break;
-        default:
-            sev = strdup("UNKNOWN");
-            break;
-        }
-
-        /* this sample should be accounted for this policy
-         * we have a candidate, let's check there is similar sample accounted in history or not
-         */
-        found_me = false;
-        OPAL_LIST_FOREACH(hst, &event_history, corefreq_history_t) {
-            /* check for any matching record in history list */
-            /* match by host name and core number */
-            if (   hst->tstamp &&
-                 ( 0 == strcmp(hostname, hst->hostname) ) &&
-                 ( core_no == hst->core_no ) &&
-                 ( plc->hi_thres == hst->hi_thres ) &&
-                 ( plc->severity == hst->severity) ) {
-                found_me = true;
-                /* this sample pattern has been captured in history
-                 * let's test the time windows expiration
-                 */
-                if ( (hst->tstamp + plc->time_window) < ts ) {
-                    /* Matching history record had expired, just overwrite it */
-                    hst->count = 1;
-                    hst->tstamp = ts;
-                } else {
-                    hst->count++;
-                }
-
-                /* filter policy threshold reached */
-                if ( hst->count >= plc->max_count ) {
-                    /* fire an event */
-                    asprintf(&msg, "host: %s core %d freq %f GHz, %s than threshold %f GHz for %d times in %d seconds",
-                                    hostname, core_no, cf, plc->hi_thres ? "higher" : "lower",
-                                    plc->threshold, plc->max_count, plc->time_window);
-                    ORTE_NOTIFIER_SYSTEM_EVENT(plc->severity, msg, plc->action);
-                    opal_output(0, "host: %s core %d freq %f GHz, %s than threshold %f GHz for %d times in %d seconds, trigger %s event!",
-                                    hostname, core_no, cf, plc->hi_thres ? "higher" : "lower",
-                                    plc->threshold, plc->max_count, plc->time_window, sev);
-                    /* stop watching for this history record, remove from list */
-                    opal_list_remove_item(&event_history, &hst->super);
-                }
-
-                break;
-            }
-        }
-
-        if ( !found_me ) {
-            /* matched sample not seen before, insert into history list */
-            if ( 1 == plc->max_count ) {
-                /* fire an event right away, no need to store in history list */
-                asprintf(&msg, "host: %s core %d freq %f GHz, %s than threshold %f GHz for %d times in %d seconds",
-                                    hostname, core_no, cf, plc->hi_thres ? "higher" : "lower",
-                                    plc->threshold, plc->max_count, plc->time_window);
-                ORTE_NOTIFIER_SYSTEM_EVENT(plc->severity, msg, plc->action);
-                opal_output(0, "host: %s Core %d freq %f GHz, %s than threshold %f GHz for %d times in %d seconds, trigger %s event!",
-                                    hostname, core_no, cf, plc->hi_thres ? "higher" : "lower",
-                                    plc->threshold, plc->max_count, plc->time_window, sev);
-            } else {
-                newhst = OBJ_NEW(corefreq_history_t);
-                newhst->hostname = strdup(hostname);
-                newhst->core_no = core_no;
-                newhst->hi_thres = plc->hi_thres;
-                newhst->severity = plc->severity;
-                newhst->count = 1;
-                newhst->tstamp = ts;
-                opal_list_append(&event_history, &newhst->super);
-            }
-        }
-        free(sev);
-    }
-
-
-  return 1;
-}
-
 /* FOR FUTURE: extend to read cooling device speeds in
  *     current speed: /sys/class/thermal/cooling_deviceN/cur_state
  *     max speed: /sys/class/thermal/cooling_deviceN/max_state
@@ -442,7 +256,6 @@ static int init(void)
     /* always construct this so we don't segfault in finalize */
     OBJ_CONSTRUCT(&tracking, opal_list_t);
     OBJ_CONSTRUCT(&pstate_list, opal_list_t);
-    OBJ_CONSTRUCT(&event_history, opal_list_t);
 
     /* get policy from MCA parameters */
     if( NULL != mca_sensor_freq_component.policy ) {
@@ -639,9 +452,14 @@ static int init(void)
 
 static void finalize(void)
 {
+    if (NULL != freq_schema) {
+        OBJ_RELEASE(freq_schema);
+    }
+    if (NULL != pstate_schema) {
+        OBJ_RELEASE(pstate_schema);
+    }
     OPAL_LIST_DESTRUCT(&tracking);
     OPAL_LIST_DESTRUCT(&pstate_list);
-    OPAL_LIST_DESTRUCT(&event_history);
 }
 
 /*
@@ -725,23 +543,68 @@ static void perthread_freq_sample(int fd, short args, void *cbdata)
     opal_event_evtimer_add(&sampler->ev, &sampler->rate);
 }
 
+/* (re)build the sample schemas from the current tracker lists - the
+ * pstate entries go out under their own component, as they are
+ * stored apart from the core frequencies */
+static int freq_build_schema(void)
+{
+    corefreq_tracker_t *trk;
+    char **labels = NULL, **units = NULL, *label;
+    int32_t ncores = 0;
+
+    if (NULL != freq_schema) {
+        OBJ_RELEASE(freq_schema);
+    }
+    OPAL_LIST_FOREACH(trk, &tracking, corefreq_tracker_t) {
+        asprintf(&label, "core%d", trk->core);
+        opal_argv_append(&ncores, &labels, label);
+        free(label);
+        opal_argv_append_nosize(&units, "GHz");
+    }
+    freq_schema = orcm_sensor_base_schema_register("freq", ncores,
+                                                   labels, units, OPAL_FLOAT);
+    opal_argv_free(labels);
+    opal_argv_free(units);
+    if (NULL == freq_schema) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    return ORCM_SUCCESS;
+}
+
+static int pstate_build_schema(void)
+{
+    pstate_tracker_t *ptrk;
+    char **labels = NULL;
+    int32_t nitems = 0;
+
+    if (NULL != pstate_schema) {
+        OBJ_RELEASE(pstate_schema);
+    }
+    OPAL_LIST_FOREACH(ptrk, &pstate_list, pstate_tracker_t) {
+        opal_argv_append(&nitems, &labels, ptrk->sysname);
+    }
+    pstate_schema = orcm_sensor_base_schema_register("pstate", nitems,
+                                                     labels, NULL, OPAL_UINT32);
+    opal_argv_free(labels);
+    if (NULL == pstate_schema) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    return ORCM_SUCCESS;
+}
+
 static void collect_sample(orcm_sensor_sampler_t *sampler)
 {
     int ret;
     corefreq_tracker_t *trk, *nxt;
     pstate_tracker_t *ptrk, *pnxt;
-
-    FILE *fp;
+    int64_t value;
     char *freq;
-    float ghz;
+    float *ghz;
+    uint32_t *pstates = NULL;
     opal_buffer_t data, *bptr;
-    int32_t ncores;
-    time_t now;
-    char time_str[40];
-    char *timestamp_str;
-    bool packed;
-    struct tm *sample_time;
-    unsigned int item_count = 0;
+    int32_t ncores, nitems = 0;
+    struct timeval now;
+    bool changed = false, have_pstate;
 
     if (0 == opal_list_get_size(&tracking)) {
         return;
@@ -751,59 +614,23 @@ static void collect_sample(orcm_sensor_sampler_t *sampler)
                         "%s sampling freq",
                         ORTE_NAME_PRINT(ORTE_PROC_MY_NAME));
 
-    /* prep to store the results */
-    OBJ_CONSTRUCT(&data, opal_buffer_t);
-    packed = false;
-
-    /* pack our name */
-    freq = strdup("freq");
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &freq, 1, OPAL_STRING))) {
-        ORTE_ERROR_LOG(ret);
-        OBJ_DESTRUCT(&data);
-        return;
-    }
-    free(freq);
-
-    /* store our hostname */
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &orte_process_info.nodename, 1, OPAL_STRING))) {
-        ORTE_ERROR_LOG(ret);
-        OBJ_DESTRUCT(&data);
-        return;
-    }
-
-    /* store the number of cores */
-    ncores = (int32_t)opal_list_get_size(&tracking);
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &ncores, 1, OPAL_INT32))) {
-        ORTE_ERROR_LOG(ret);
-        OBJ_DESTRUCT(&data);
-        return;
-    }
-
     /* get the sample time */
-    now = time(NULL);
-    /* pass the time along as a simple string */
-    sample_time = localtime(&now);
-    if (NULL == sample_time) {
-        ORTE_ERROR_LOG(OPAL_ERR_BAD_PARAM);
-        return;
-    }
-    strftime(time_str, sizeof(time_str), "%F %T%z", sample_time);
-    asprintf(&timestamp_str, "%s", time_str);
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &timestamp_str, 1, OPAL_STRING))) {
-        ORTE_ERROR_LOG(ret);
-        OBJ_DESTRUCT(&data);
-        free(timestamp_str);
+    gettimeofday(&now, NULL);
+
+    ghz = (float*)malloc(opal_list_get_size(&tracking) * sizeof(float));
+    if (NULL == ghz) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
         return;
     }
-    free(timestamp_str);
-
+    ncores = 0;
     OPAL_LIST_FOREACH_SAFE(trk, nxt, &tracking, corefreq_tracker_t) {
         opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
                             "%s processing freq file %s",
                             ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
                             trk->file);
         /* read the freq */
-        if (NULL == (fp = fopen(trk->file, "r"))) {
+        if ((0 > trk->fd && 0 > (trk->fd = orcm_sensor_base_sysfs_open(trk->file))) ||
+            ORCM_SUCCESS != orcm_sensor_base_sysfs_read_int64(trk->fd, &value)) {
             /* we can't be read, so remove it from the list */
             opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
                                 "%s access denied to freq file %s - removing it",
@@ -811,42 +638,40 @@ static void collect_sample(orcm_sensor_sampler_t *sampler)
                                 trk->file);
             opal_list_remove_item(&tracking, &trk->super);
             OBJ_RELEASE(trk);
+            changed = true;
             continue;
         }
-        while (NULL != (freq = orte_getline(fp))) {
-            ghz = strtoul(freq, NULL, 10) / 1000000.0;
-            opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
-                                "%s sensor:freq: Core %d freq %f max %f min %f",
-                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                trk->core, ghz, trk->max_freq, trk->min_freq);
-            if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &ghz, 1, OPAL_FLOAT))) {
-                ORTE_ERROR_LOG(ret);
-                free(freq);
-                fclose(fp);
-                OBJ_DESTRUCT(&data);
-                return;
-            }
-            packed = true;
-            free(freq);
-        }
-        fclose(fp);
+        ghz[ncores] = value / 1000000.0;
+        opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+                            "%s sensor:freq: Core %d freq %f max %f min %f",
+                            ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                            trk->core, ghz[ncores], trk->max_freq, trk->min_freq);
+        ncores++;
     }
-
-    if(true == intel_pstate_avail) {
-        item_count = opal_list_get_size(&pstate_list);
-        if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &item_count, 1, OPAL_UINT))) {
+    /* the set of cores changed, so the old schema no longer applies */
+    if (changed || NULL == freq_schema) {
+        if (ORCM_SUCCESS != (ret = freq_build_schema())) {
             ORTE_ERROR_LOG(ret);
-            OBJ_DESTRUCT(&data);
+            free(ghz);
             return;
         }
+    }
 
+    if (intel_pstate_avail && 0 < opal_list_get_size(&pstate_list)) {
+        pstates = (uint32_t*)malloc(opal_list_get_size(&pstate_list) * sizeof(uint32_t));
+        if (NULL == pstates) {
+            ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+            free(ghz);
+            return;
+        }
+        changed = false;
         OPAL_LIST_FOREACH_SAFE(ptrk, pnxt, &pstate_list, pstate_tracker_t) {
             opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
                                 "%s processing freq file %s",
                                 ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
                                 ptrk->file);
             /* read the value */
-            if (NULL == (fp = fopen(ptrk->file, "r"))) {
+            if (0 > ptrk->fd && 0 > (ptrk->fd = orcm_sensor_base_sysfs_open(ptrk->file))) {
                 /* we can't be read, so remove it from the list */
                 opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
                                     "%s access denied to freq file %s - removing it",
@@ -854,53 +679,73 @@ static void collect_sample(orcm_sensor_sampler_t *sampler)
                                     ptrk->file);
                 opal_list_remove_item(&pstate_list, &ptrk->super);
                 OBJ_RELEASE(ptrk);
+                changed = true;
                 continue;
             }
-            if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &ptrk->sysname, 1, OPAL_STRING))) {
-                    ORTE_ERROR_LOG(ret);
-                    free(freq);
-                    fclose(fp);
-                    OBJ_DESTRUCT(&data);
-                    return;
+            /* on a failed read, report the last value seen */
+            if (ORCM_SUCCESS == orcm_sensor_base_sysfs_read_int64(ptrk->fd, &value)) {
+                ptrk->value = (unsigned int)value;
             }
-            while (NULL != (freq = orte_getline(fp))) {
-                ptrk->value = strtoul(freq, NULL, 10);
-                opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
-                                    "%s sensor:pstate: file %s : %d",
-                                    ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                    ptrk->file, ptrk->value);
-                if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &ptrk->value, 1, OPAL_UINT))) {
-                    ORTE_ERROR_LOG(ret);
-                    free(freq);
-                    fclose(fp);
-                    OBJ_DESTRUCT(&data);
-                    return;
-                }
-                packed = true;
-                free(freq);
-            }
-            fclose(fp);
+            opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+                                "%s sensor:pstate: file %s : %d",
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                                ptrk->file, ptrk->value);
+            pstates[nitems++] = ptrk->value;
         }
-    } else {
-        /* Pack 0 pstate values available */
-        item_count = 0;
-        if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &item_count, 1, OPAL_UINT))) {
-            ORTE_ERROR_LOG(ret);
-            OBJ_DESTRUCT(&data);
-            return;
+        if (changed || NULL == pstate_schema) {
+            if (ORCM_SUCCESS != (ret = pstate_build_schema())) {
+                ORTE_ERROR_LOG(ret);
+                free(ghz);
+                free(pstates);
+                return;
+            }
         }
     }
+    have_pstate = (0 < nitems);
+    if (0 == ncores && !have_pstate) {
+        free(ghz);
+        return;
+    }
+
+    /* prep to store the results */
+    OBJ_CONSTRUCT(&data, opal_buffer_t);
+
+    /* pack our name */
+    freq = strdup("freq");
+    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &freq, 1, OPAL_STRING))) {
+        ORTE_ERROR_LOG(ret);
+        goto cleanup;
+    }
+
+    /* pack the schema-encoded core sample, then the pstate
+     * sample if there is one */
+    if (ORCM_SUCCESS != (ret = orcm_sensor_base_pack_sample(&data, freq_schema, &now, ghz))) {
+        ORTE_ERROR_LOG(ret);
+        goto cleanup;
+    }
+    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &have_pstate, 1, OPAL_BOOL))) {
+        ORTE_ERROR_LOG(ret);
+        goto cleanup;
+    }
+    if (have_pstate &&
+        ORCM_SUCCESS != (ret = orcm_sensor_base_pack_sample(&data, pstate_schema, &now, pstates))) {
+        ORTE_ERROR_LOG(ret);
+        goto cleanup;
+    }
 
     /* xfer the data for transmission */
-    if (packed) {
-        bptr = &data;
-        if (OPAL_SUCCESS != (ret = opal_dss.pack(&sampler->bucket, &bptr, 1, OPAL_BUFFER))) {
-            ORTE_ERROR_LOG(ret);
-            OBJ_DESTRUCT(&data);
-            return;
-        }
+    bptr = &data;
+    if (OPAL_SUCCESS != (ret = opal_dss.pack(&sampler->bucket, &bptr, 1, OPAL_BUFFER))) {
+        ORTE_ERROR_LOG(ret);
     }
+
+ cleanup:
     OBJ_DESTRUCT(&data);
+    free(freq);
+    free(ghz);
+    if (NULL != pstates) {
+        free(pstates);
+    }
 }
 
 static void mycleanup(int dbhandle, int status,
@@ -912,182 +757,148 @@ static void mycleanup(int dbhandle, int status,
     }
 }
 
-static void freq_log(opal_buffer_t *sample)
+/* the common head of the core and pstate records */
+static opal_list_t* freq_vals(const char *hostname, struct timeval *sampletime)
 {
-    char *hostname=NULL;
-    char *sampletime;
-    struct tm time_info;
-    time_t ts;
-    int rc;
-    int32_t n, ncores;
-    opal_list_t *vals, *pstate_vals=NULL;
+    opal_list_t *vals;
     opal_value_t *kv;
-    float fval;
-    int i;
-    unsigned int pstate_count = 0, pstate_value = 0;
-    char *pstate_name;
 
-    if (!log_enabled) {
-        return;
-    }
-    /* unpack the host this came from */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &hostname, &n, OPAL_STRING))) {
-        ORTE_ERROR_LOG(rc);
-        return;
-    }
-    /* and the number of cores on that host */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &ncores, &n, OPAL_INT32))) {
-        ORTE_ERROR_LOG(rc);
-        return;
-    }
-
-    /* sample time */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &sampletime, &n, OPAL_STRING))) {
-        ORTE_ERROR_LOG(rc);
-        return;
-    }
-
-    opal_output_verbose(3, orcm_sensor_base_framework.framework_output,
-                        "%s Received freq log from host %s with %d cores",
-                        ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                        (NULL == hostname) ? "NULL" : hostname, ncores);
-
-    /* xfr to storage */
     vals = OBJ_NEW(opal_list_t);
 
     /* load the sample time at the start */
-    if (NULL == sampletime) {
-        ORTE_ERROR_LOG(OPAL_ERR_BAD_PARAM);
-        return;
-    }
     kv = OBJ_NEW(opal_value_t);
     kv->key = strdup("ctime");
-    kv->type = OPAL_STRING;
-    kv->data.string = strdup(sampletime);
+    kv->type = OPAL_TIMEVAL;
+    kv->data.tv = *sampletime;
     opal_list_append(vals, &kv->super);
 
     /* load the hostname */
-    if (NULL == hostname) {
-        ORTE_ERROR_LOG(OPAL_ERR_BAD_PARAM);
-        return;
-    }
     kv = OBJ_NEW(opal_value_t);
     kv->key = strdup("hostname");
     kv->type = OPAL_STRING;
     kv->data.string = strdup(hostname);
     opal_list_append(vals, &kv->super);
+    return vals;
+}
 
-    for (i=0; i < ncores; i++) {
-        kv = OBJ_NEW(opal_value_t);
-        asprintf(&kv->key, "core%d:GHz", i);
-        kv->type = OPAL_FLOAT;
-        n=1;
-        if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &fval, &n, OPAL_FLOAT))) {
-            ORTE_ERROR_LOG(rc);
-            goto cleanup;
-        }
-
-        /* check corefreq event policy */
-        strptime(sampletime, "%F %T%z", &time_info);
-        ts = mktime(&time_info);
-        corefreq_policy_filter(hostname, i, fval, ts);
-
-        kv->data.fval = fval;
-        opal_list_append(vals, &kv->super);
-    }
+static void freq_log(opal_buffer_t *sample)
+{
+    char *hostname = NULL, *phost = NULL;
+    orcm_sensor_schema_t *schema, *pschema = NULL;
+    struct timeval sampletime, ptime;
+    float *fvals = NULL;
+    uint32_t *pvals = NULL;
+    bool have_pstate;
+    int rc;
+    int32_t n, i;
+    opal_list_t *vals;
+    opal_value_t *kv;
 
-    /* store it */
-    if (0 <= orcm_sensor_base.dbhandle) {
-        orcm_db.store(orcm_sensor_base.dbhandle, "freq", vals, mycleanup, NULL);
-    } else {
-        OPAL_LIST_RELEASE(vals);
+    if (!log_enabled) {
+        return;
     }
-
-    /* unpack the pstate entry count */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &pstate_count, &n, OPAL_UINT))) {
-        ORTE_ERROR_LOG(rc);
+    /* unpack the schema-encoded core sample */
+    if (ORCM_SUCCESS != (rc = orcm_sensor_base_unpack_sample(sample, &hostname, &schema,
+                                                             &sampletime, (void**)&fvals))) {
+        if (ORCM_ERR_NOT_FOUND != rc) {
+            ORTE_ERROR_LOG(rc);
+        }
         return;
     }
+
     opal_output_verbose(3, orcm_sensor_base_framework.framework_output,
-                "Total pstate count: %d", pstate_count);
+                        "%s Received freq log from host %s with %d cores",
+                        ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                        hostname, schema->nmetrics);
 
-    if (pstate_count > 0) {
+    if (0 < schema->nmetrics) {
         /* xfr to storage */
-        pstate_vals = OBJ_NEW(opal_list_t);
-
-        /* load the sample time at the start */
-        if (NULL == sampletime) {
-            ORTE_ERROR_LOG(OPAL_ERR_BAD_PARAM);
-            return;
+        vals = freq_vals(hostname, &sampletime);
+        for (i=0; i < schema->nmetrics; i++) {
+            kv = OBJ_NEW(opal_value_t);
+            asprintf(&kv->key, "%s:%s", schema->labels[i],
+                     (NULL == schema->units[i]) ? "" : schema->units[i]);
+            kv->type = OPAL_FLOAT;
+            kv->data.fval = fvals[i];
+            opal_list_append(vals, &kv->super);
         }
-        kv = OBJ_NEW(opal_value_t);
-        kv->key = strdup("ctime");
-        kv->type = OPAL_STRING;
-        kv->data.string = strdup(sampletime);
-        opal_list_append(pstate_vals, &kv->super);
-
-        /* load the hostname */
-        if (NULL == hostname) {
-            ORTE_ERROR_LOG(OPAL_ERR_BAD_PARAM);
-            return;
+
+        /* check the corefreq event policies against all cores at once */
+        orcm_sensor_base_policy_eval("corefreq", hostname, fvals, schema->nmetrics,
+                                     sampletime.tv_sec, "freq", "GHz");
+
+        /* hand the values to any analytics subscribed to them */
+        orcm_sensor_base_publish("freq", vals);
+
+        /* store it */
+        if (0 <= orcm_sensor_base.dbhandle) {
+            orcm_db.store(orcm_sensor_base.dbhandle, "freq", vals, mycleanup, NULL);
+        } else {
+            OPAL_LIST_RELEASE(vals);
         }
-        kv = OBJ_NEW(opal_value_t);
-        kv->key = strdup("hostname");
-        kv->type = OPAL_STRING;
-        kv->data.string = strdup(hostname);
-        opal_list_append(pstate_vals, &kv->super);
     }
 
-    while(pstate_count > 0)
-    {
-        /* unpack the pstate entry name */
-        n=1;
-        if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &pstate_name, &n, OPAL_STRING))) {
-            ORTE_ERROR_LOG(rc);
-            return;
-        }
-        /* unpack the pstate entry value */
-        n=1;
-        if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &pstate_value, &n, OPAL_UINT))) {
+    /* and the pstate entries, if the host has them */
+    n=1;
+    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &have_pstate, &n, OPAL_BOOL))) {
+        ORTE_ERROR_LOG(rc);
+        goto cleanup;
+    }
+    if (!have_pstate) {
+        goto cleanup;
+    }
+    if (ORCM_SUCCESS != (rc = orcm_sensor_base_unpack_sample(sample, &phost, &pschema,
+                                                             &ptime, (void**)&pvals))) {
+        if (ORCM_ERR_NOT_FOUND != rc) {
             ORTE_ERROR_LOG(rc);
-            return;
         }
-        opal_output_verbose(3, orcm_sensor_base_framework.framework_output,
-                            "%s : %d",pstate_name, pstate_value);
+        goto cleanup;
+    }
+    opal_output_verbose(3, orcm_sensor_base_framework.framework_output,
+                "Total pstate count: %d", pschema->nmetrics);
 
+    vals = freq_vals(hostname, &ptime);
+    for (i=0; i < pschema->nmetrics; i++) {
+        opal_output_verbose(3, orcm_sensor_base_framework.framework_output,
+                            "%s : %u", pschema->labels[i], pvals[i]);
         kv = OBJ_NEW(opal_value_t);
-        if (0 != strcmp(pstate_name,"no_turbo")) {
-            kv->key = strdup(pstate_name);
+        if (0 != strcmp(pschema->labels[i], "no_turbo")) {
+            kv->key = strdup(pschema->labels[i]);
             kv->type = OPAL_UINT;
-            kv->data.uint = pstate_value;
+            kv->data.uint = pvals[i];
         } else {
             kv->key = strdup("allow_turbo");
             kv->type = OPAL_BOOL;
-            kv->data.flag = ((0 == pstate_value) ? true: false);
+            kv->data.flag = ((0 == pvals[i]) ? true: false);
         }
-        opal_list_append(pstate_vals, &kv->super);
-        pstate_count--;
+        opal_list_append(vals, &kv->super);
     }
 
-    if (pstate_vals != NULL)
-    {
-        /* store it */
-        if (0 <= orcm_sensor_base.dbhandle) {
-            orcm_db.store(orcm_sensor_base.dbhandle, "pstate", pstate_vals, mycleanup, NULL);
-        } else {
-            OPAL_LIST_RELEASE(pstate_vals);
-        }
+    /* hand the values to any analytics subscribed to them */
+    orcm_sensor_base_publish("pstate", vals);
+
+    /* store it */
+    if (0 <= orcm_sensor_base.dbhandle) {
+        orcm_db.store(orcm_sensor_base.dbhandle, "pstate", vals, mycleanup, NULL);
+    } else {
+        OPAL_LIST_RELEASE(vals);
     }
 
  cleanup:
-    if (NULL != hostname) {
-        free(hostname);
+    OBJ_RELEASE(schema);
+    if (NULL != pschema) {
+        OBJ_RELEASE(pschema);
     }
-
+    if (NULL != fvals) {
+        free(fvals);
+    }
+    if (NULL != pvals) {
+        free(pvals);
+    }
+    if (NULL != phost) {
+        free(phost);
+    }
+    free(hostname);
 }
 
 static void freq_set_sample_rate(int sample_rate)
@@ -28,6 +28,9 @@
 #include "opal/util/argv.h"
 #include "opal/util/output.h"
 #include "opal/mca/event/event.h"
+#include "opal/mca/compress/compress.h"
+#include "opal/mca/timer/base/base.h"
+#include "opal/class/opal_hash_table.h"
 
 #include "orte/util/show_help.h"
 #include "orte/util/proc_info.h"
@@ -64,15 +67,145 @@ orcm_sensor_base_module_t orcm_sensor_heartbeat_module = {
 
 /* declare the local functions */
 static void check_heartbeat(int fd, short event, void *arg);
+static void send_alive(int fd, short event, void *arg);
+static void send_beat(orte_process_name_t *tgt, opal_buffer_t *buf);
 static void recv_beats(int status, orte_process_name_t* sender,
                        opal_buffer_t *buffer,
                        orte_rml_tag_t tag, void *cbdata);
 
+/* Heartbeat payload layout. Every beat starts with its mode and an
+ * optional component table mapping the sender's component ids to
+ * names - it is sent with the first beat and every keyframe beats
+ * after that. Sampled data then travels as (id, buffer) entries with
+ * the component name stripped, so the receiver dispatches through
+ * its own id table without comparing names.
+ *
+ * A raw beat carries the entries as-is. An encoded beat carries, for
+ * each entry, either the full buffer or its XOR against the buffer
+ * the same component sent in the previous beat - which is mostly
+ * zeroes for slowly changing metrics and compresses well. A full
+ * keyframe is sent every keyframe beats so an aggregator that
+ * misses a beat (or restarts) resynchronizes.
+ */
+#define HEARTBEAT_RAW      0
+#define HEARTBEAT_ENCODED  1
+
+#define HEARTBEAT_FULL     0
+#define HEARTBEAT_DELTA    1
+
+/* last payload of a component buffer, used as the delta reference */
+typedef struct {
+    opal_list_item_t super;
+    uint16_t id;
+    int occurrence;     /* nth buffer from this component in the beat */
+    uint8_t *bytes;
+    int32_t nbytes;
+} heartbeat_ref_t;
+static void rcon(heartbeat_ref_t *p)
+{
+    p->id = 0;
+    p->occurrence = 0;
+    p->bytes = NULL;
+    p->nbytes = 0;
+}
+static void rdes(heartbeat_ref_t *p)
+{
+    if (NULL != p->bytes) {
+        free(p->bytes);
+    }
+}
+static OBJ_CLASS_INSTANCE(heartbeat_ref_t,
+                          opal_list_item_t,
+                          rcon, rdes);
+
+/* decoding state for one sending daemon */
+typedef struct {
+    opal_object_t super;
+    uint32_t seq;
+    bool valid;
+    opal_list_t refs;
+    int nids;
+    int *ids;           /* sender component id -> local component id */
+} heartbeat_peer_t;
+static void pcon(heartbeat_peer_t *p)
+{
+    p->seq = 0;
+    p->valid = false;
+    OBJ_CONSTRUCT(&p->refs, opal_list_t);
+    p->nids = 0;
+    p->ids = NULL;
+}
+static void pdes(heartbeat_peer_t *p)
+{
+    OPAL_LIST_DESTRUCT(&p->refs);
+    if (NULL != p->ids) {
+        free(p->ids);
+    }
+}
+static OBJ_CLASS_INSTANCE(heartbeat_peer_t,
+                          opal_object_t,
+                          pcon, pdes);
+
 /* local globals */
+/* a beat that could not be sent, held for replay */
+typedef struct {
+    opal_list_item_t super;
+    opal_buffer_t *buf;
+} heartbeat_held_t;
+
+static void hcon(heartbeat_held_t *p)
+{
+    p->buf = NULL;
+}
+
+static void hdes(heartbeat_held_t *p)
+{
+    if (NULL != p->buf) {
+        OBJ_RELEASE(p->buf);
+    }
+}
+
+static OBJ_CLASS_INSTANCE(heartbeat_held_t,
+                          opal_list_item_t,
+                          hcon, hdes);
+
 static orte_job_t *daemons=NULL;
+static opal_list_t send_refs;
+static opal_list_t backlog;     /* heartbeat_held_t's, oldest first */
+static uint32_t send_seq = 0;
+static uint32_t beat_count = 0;
+static opal_hash_table_t peers;
 static opal_event_t check_ev;
 static bool check_active = false;
 static struct timeval check_time;
+static opal_event_t alive_ev;
+static bool alive_active = false;
+static struct timeval alive_time;
+
+/* Liveness of the daemons, indexed by vpid. Each daemon we are
+ * watching sits in the slot of a hashed timing wheel for the tick at
+ * which it times out, and every beat moves it to a later slot - so a
+ * check only visits the slots that have come due, and the daemons in
+ * them that have really gone quiet, however many daemons there are.
+ * The wheel spans more ticks than the timeout, so every deadline falls
+ * within one turn of it.
+ */
+typedef struct {
+    uint64_t last_seen;     /* usec of the last beat */
+    uint64_t deadline;      /* tick at which the daemon times out */
+    int next, prev;         /* slot list links, -1 terminated */
+    bool queued;
+    bool seeded;            /* picked up from the job's procs */
+} heartbeat_live_t;
+
+static heartbeat_live_t *live = NULL;
+static int nlive = 0;
+static int nseeded = 0;         /* daemons of the job picked up so far */
+static int *wheel = NULL;       /* slot -> first vpid queued in it */
+static int wheel_mask = 0;
+static uint64_t wheel_now = 0;  /* last tick the wheel was advanced to */
+static uint64_t tick_usec = 0;
+static uint64_t timeout_ticks = 0;
 
 static int init(void)
 {
@@ -80,6 +213,11 @@ static int init(void)
                          "%s initializing heartbeat recvs",
                          ORTE_NAME_PRINT(ORTE_PROC_MY_NAME)));
 
+    OBJ_CONSTRUCT(&send_refs, opal_list_t);
+    OBJ_CONSTRUCT(&backlog, opal_list_t);
+    OBJ_CONSTRUCT(&peers, opal_hash_table_t);
+    opal_hash_table_init(&peers, 1024);
+
     /* setup to receive heartbeats */
     if (ORTE_PROC_IS_HNP || ORTE_PROC_IS_AGGREGATOR) {
         orte_rml.recv_buffer_nb(ORTE_NAME_WILDCARD,
@@ -97,30 +235,638 @@ static int init(void)
 
 static void finalize(void)
 {
+    heartbeat_peer_t *peer;
+    uint32_t key;
+    void *node, *next;
+    int rc;
+
     orte_rml.recv_cancel(ORTE_NAME_WILDCARD, ORTE_RML_TAG_HEARTBEAT);
     if (check_active) {
         opal_event_del(&check_ev);
         check_active = false;
     }
+    if (alive_active) {
+        opal_event_del(&alive_ev);
+        alive_active = false;
+    }
+    if (NULL != live) {
+        free(live);
+        live = NULL;
+    }
+    if (NULL != wheel) {
+        free(wheel);
+        wheel = NULL;
+    }
+    nlive = nseeded = 0;
+
+    OPAL_LIST_DESTRUCT(&send_refs);
+    OPAL_LIST_DESTRUCT(&backlog);
+    rc = opal_hash_table_get_first_key_uint32(&peers, &key, (void**)&peer, &node);
+    while (OPAL_SUCCESS == rc) {
+        OBJ_RELEASE(peer);
+        rc = opal_hash_table_get_next_key_uint32(&peers, &key, (void**)&peer, node, &next);
+        node = next;
+    }
+    OBJ_DESTRUCT(&peers);
     return;
 }
 
+static heartbeat_peer_t* get_peer(orte_process_name_t *sender)
+{
+    heartbeat_peer_t *peer;
+
+    if (OPAL_SUCCESS != opal_hash_table_get_value_uint32(&peers, sender->vpid, (void**)&peer)) {
+        peer = OBJ_NEW(heartbeat_peer_t);
+        opal_hash_table_set_value_uint32(&peers, sender->vpid, peer);
+    }
+    return peer;
+}
+
+static heartbeat_ref_t* find_ref(opal_list_t *refs, uint16_t id,
+                                 int occurrence)
+{
+    heartbeat_ref_t *ref;
+
+    OPAL_LIST_FOREACH(ref, refs, heartbeat_ref_t) {
+        if (id == ref->id && occurrence == ref->occurrence) {
+            return ref;
+        }
+    }
+    ref = OBJ_NEW(heartbeat_ref_t);
+    ref->id = id;
+    ref->occurrence = occurrence;
+    opal_list_append(refs, &ref->super);
+    return ref;
+}
+
+/* count how many entries from this component came earlier in the beat */
+static int next_occurrence(uint16_t **seen, int *nseen, uint16_t id)
+{
+    int i, occurrence = 0;
+    uint16_t *tmp;
+
+    for (i=0; i < *nseen; i++) {
+        if (id == (*seen)[i]) {
+            occurrence++;
+        }
+    }
+    if (NULL != (tmp = (uint16_t*)realloc(*seen, (*nseen + 1) * sizeof(uint16_t)))) {
+        *seen = tmp;
+        tmp[(*nseen)++] = id;
+    }
+    return occurrence;
+}
+
+/* start a beat with its mode and, if requested, our component table */
+static int pack_header(opal_buffer_t *beat, uint8_t mode, bool announce)
+{
+    orcm_sensor_active_module_t *i_module;
+    int32_t i, ncomps = 0;
+    uint16_t id;
+    char *name;
+    int rc;
+
+    if (OPAL_SUCCESS != (rc = opal_dss.pack(beat, &mode, 1, OPAL_UINT8))) {
+        return rc;
+    }
+    if (OPAL_SUCCESS != (rc = opal_dss.pack(beat, &announce, 1, OPAL_BOOL))) {
+        return rc;
+    }
+    if (!announce) {
+        return ORCM_SUCCESS;
+    }
+    for (i=0; i < orcm_sensor_base.modules.size; i++) {
+        if (NULL != opal_pointer_array_get_item(&orcm_sensor_base.modules, i)) {
+            ncomps++;
+        }
+    }
+    if (OPAL_SUCCESS != (rc = opal_dss.pack(beat, &ncomps, 1, OPAL_INT32))) {
+        return rc;
+    }
+    for (i=0; i < orcm_sensor_base.modules.size; i++) {
+        if (NULL == (i_module = (orcm_sensor_active_module_t*)opal_pointer_array_get_item(&orcm_sensor_base.modules, i))) {
+            continue;
+        }
+        id = (uint16_t)i;
+        name = i_module->component->base_version.mca_component_name;
+        if (OPAL_SUCCESS != (rc = opal_dss.pack(beat, &id, 1, OPAL_UINT16)) ||
+            OPAL_SUCCESS != (rc = opal_dss.pack(beat, &name, 1, OPAL_STRING))) {
+            return rc;
+        }
+    }
+    return ORCM_SUCCESS;
+}
+
+/* record the sender's component table, if it sent one */
+static int unpack_header(heartbeat_peer_t *peer, opal_buffer_t *beat,
+                         uint8_t *mode)
+{
+    bool announce;
+    int32_t n, i, ncomps;
+    uint16_t id;
+    int *tmp, j;
+    char *name;
+    int rc;
+
+    n=1;
+    if (OPAL_SUCCESS != (rc = opal_dss.unpack(beat, mode, &n, OPAL_UINT8))) {
+        return rc;
+    }
+    n=1;
+    if (OPAL_SUCCESS != (rc = opal_dss.unpack(beat, &announce, &n, OPAL_BOOL))) {
+        return rc;
+    }
+    if (!announce) {
+        return ORCM_SUCCESS;
+    }
+    n=1;
+    if (OPAL_SUCCESS != (rc = opal_dss.unpack(beat, &ncomps, &n, OPAL_INT32))) {
+        return rc;
+    }
+    for (j=0; j < peer->nids; j++) {
+        peer->ids[j] = -1;
+    }
+    for (i=0; i < ncomps; i++) {
+        n=1;
+        if (OPAL_SUCCESS != (rc = opal_dss.unpack(beat, &id, &n, OPAL_UINT16))) {
+            return rc;
+        }
+        n=1;
+        if (OPAL_SUCCESS != (rc = opal_dss.unpack(beat, &name, &n, OPAL_STRING))) {
+            return rc;
+        }
+        if (peer->nids <= id) {
+            if (NULL == (tmp = (int*)realloc(peer->ids, (id + 1) * sizeof(int)))) {
+                free(name);
+                return ORCM_ERR_OUT_OF_RESOURCE;
+            }
+            for (j=peer->nids; j <= id; j++) {
+                tmp[j] = -1;
+            }
+            peer->ids = tmp;
+            peer->nids = id + 1;
+        }
+        peer->ids[id] = orcm_sensor_base_component_id(name);
+        free(name);
+    }
+    return ORCM_SUCCESS;
+}
+
+/* convert the sampler bucket into (id, buffer) entries, stripping
+ * the component name each sampler packed at the front */
+static int intern_bucket(opal_buffer_t *bucket, opal_buffer_t *entries)
+{
+    opal_buffer_t *buf, data, *dptr = &data;
+    char *component;
+    uint16_t id;
+    int32_t n;
+    void *ptr;
+    int rc, ret, idx;
+
+    /* the entries are only read here, so view them in place */
+    while (OPAL_SUCCESS == (rc = opal_dss.unpack_view(bucket, &buf))) {
+        n=1;
+        if (OPAL_SUCCESS != (rc = opal_dss.unpack(buf, &component, &n, OPAL_STRING))) {
+            OBJ_RELEASE(buf);
+            return rc;
+        }
+        idx = orcm_sensor_base_component_id(component);
+        if (idx < 0) {
+            opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
+                                "%s sensor:heartbeat: no active sensor %s - dropping its data",
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), component);
+            free(component);
+            OBJ_RELEASE(buf);
+            continue;
+        }
+        free(component);
+        id = (uint16_t)idx;
+        /* lend the rest of the view to a buffer so it is packed (size,
+         * then bytes) straight from where the name ended - no copy */
+        n = (int32_t)(buf->bytes_used - (buf->unpack_ptr - buf->base_ptr));
+        OBJ_CONSTRUCT(&data, opal_buffer_t);
+        opal_dss.load(&data, (0 < n) ? buf->unpack_ptr : NULL, n);
+        if (OPAL_SUCCESS == (rc = opal_dss.pack(entries, &id, 1, OPAL_UINT16))) {
+            rc = opal_dss.pack(entries, &dptr, 1, OPAL_BUFFER);
+        }
+        /* take the bytes back before the buffer goes away */
+        if (OPAL_SUCCESS != (ret = opal_dss.unload(&data, &ptr, &n)) &&
+            OPAL_SUCCESS == rc) {
+            rc = ret;
+        }
+        OBJ_DESTRUCT(&data);
+        OBJ_RELEASE(buf);
+        if (OPAL_SUCCESS != rc) {
+            return rc;
+        }
+    }
+    if (OPAL_ERR_UNPACK_READ_PAST_END_OF_BUFFER != rc) {
+        return rc;
+    }
+    return ORCM_SUCCESS;
+}
+
+static int encode_beat(opal_buffer_t *beat, opal_buffer_t *entries)
+{
+    opal_buffer_t payload, *buf;
+    heartbeat_ref_t *ref;
+    uint16_t id, *seen = NULL;
+    uint8_t kind, *bytes = NULL, *cbytes;
+    int32_t n, i, nbytes, rawlen;
+    int nseen = 0;
+    size_t clen;
+    bool keyframe, compressed = false;
+    int rc;
+
+    keyframe = (mca_sensor_heartbeat_component.keyframe <= 1 ||
+                0 == send_seq % mca_sensor_heartbeat_component.keyframe);
+    if (keyframe) {
+        OPAL_LIST_DESTRUCT(&send_refs);
+        OBJ_CONSTRUCT(&send_refs, opal_list_t);
+    }
+
+    OBJ_CONSTRUCT(&payload, opal_buffer_t);
+    n=1;
+    while (OPAL_SUCCESS == (rc = opal_dss.unpack(entries, &id, &n, OPAL_UINT16))) {
+        if (OPAL_SUCCESS != (rc = opal_dss.unpack_view(entries, &buf))) {
+            goto cleanup;
+        }
+        ref = find_ref(&send_refs, id, next_occurrence(&seen, &nseen, id));
+
+        if (OPAL_SUCCESS != (rc = opal_dss.pack(&payload, &id, 1, OPAL_UINT16))) {
+            OBJ_RELEASE(buf);
+            goto cleanup;
+        }
+        nbytes = (int32_t)buf->bytes_used;
+        if (NULL != ref->bytes && ref->nbytes == nbytes) {
+            kind = HEARTBEAT_DELTA;
+            for (i=0; i < nbytes; i++) {
+                ref->bytes[i] ^= (uint8_t)buf->base_ptr[i];
+            }
+            if (OPAL_SUCCESS != (rc = opal_dss.pack(&payload, &kind, 1, OPAL_UINT8)) ||
+                OPAL_SUCCESS != (rc = opal_dss.pack(&payload, &nbytes, 1, OPAL_INT32)) ||
+                OPAL_SUCCESS != (rc = opal_dss.pack(&payload, ref->bytes, nbytes, OPAL_BYTE))) {
+                OBJ_RELEASE(buf);
+                goto cleanup;
+            }
+            /* the reference becomes the buffer we just sent */
+            memcpy(ref->bytes, buf->base_ptr, nbytes);
+        } else {
+            kind = HEARTBEAT_FULL;
+            if (OPAL_SUCCESS != (rc = opal_dss.pack(&payload, &kind, 1, OPAL_UINT8)) ||
+                OPAL_SUCCESS != (rc = opal_dss.pack(&payload, &buf, 1, OPAL_BUFFER))) {
+                OBJ_RELEASE(buf);
+                goto cleanup;
+            }
+            if (NULL != ref->bytes) {
+                free(ref->bytes);
+            }
+            ref->nbytes = nbytes;
+            if (NULL != (ref->bytes = (uint8_t*)malloc(nbytes))) {
+                memcpy(ref->bytes, buf->base_ptr, nbytes);
+            }
+        }
+        OBJ_RELEASE(buf);
+        n=1;
+    }
+    if (OPAL_ERR_UNPACK_READ_PAST_END_OF_BUFFER != rc) {
+        goto cleanup;
+    }
+
+    if (OPAL_SUCCESS != (rc = opal_dss.unload(&payload, (void**)&bytes, &rawlen))) {
+        goto cleanup;
+    }
+    if (mca_sensor_heartbeat_component.compress && 0 < rawlen &&
+        opal_compress.compress_block(bytes, rawlen, &cbytes, &clen)) {
+        free(bytes);
+        bytes = cbytes;
+        nbytes = (int32_t)clen;
+        compressed = true;
+    } else {
+        nbytes = rawlen;
+    }
+
+    if (OPAL_SUCCESS != (rc = opal_dss.pack(beat, &send_seq, 1, OPAL_UINT32)) ||
+        OPAL_SUCCESS != (rc = opal_dss.pack(beat, &keyframe, 1, OPAL_BOOL)) ||
+        OPAL_SUCCESS != (rc = opal_dss.pack(beat, &compressed, 1, OPAL_BOOL)) ||
+        OPAL_SUCCESS != (rc = opal_dss.pack(beat, &rawlen, 1, OPAL_INT32)) ||
+        OPAL_SUCCESS != (rc = opal_dss.pack(beat, &nbytes, 1, OPAL_INT32))) {
+        goto cleanup;
+    }
+    if (0 < nbytes &&
+        OPAL_SUCCESS != (rc = opal_dss.pack(beat, bytes, nbytes, OPAL_BYTE))) {
+        goto cleanup;
+    }
+    OPAL_OUTPUT_VERBOSE((5, orcm_sensor_base_framework.framework_output,
+                         "%s encoded beat %u: %d bytes of samples sent as %d",
+                         ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                         send_seq, rawlen, nbytes));
+    send_seq++;
+    rc = ORCM_SUCCESS;
+
+ cleanup:
+    if (ORCM_SUCCESS != rc) {
+        /* make sure the next beat starts from a clean slate */
+        send_seq = 0;
+    }
+    if (NULL != bytes) {
+        free(bytes);
+    }
+    if (NULL != seen) {
+        free(seen);
+    }
+    OBJ_DESTRUCT(&payload);
+    return rc;
+}
+
+/* rebuild the (id, buffer) entries from an encoded beat - returns
+ * NULL if the beat cannot be decoded against what we have seen */
+static opal_buffer_t* decode_beat(orte_process_name_t *sender,
+                                  heartbeat_peer_t *peer,
+                                  opal_buffer_t *beat)
+{
+    heartbeat_ref_t *ref;
+    opal_buffer_t payload, *out = NULL, *buf;
+    uint16_t id, *seen = NULL;
+    uint8_t kind, *bytes = NULL, *raw;
+    uint32_t seq;
+    int32_t n, i, rawlen, nbytes;
+    int nseen = 0;
+    bool keyframe, compressed;
+    int rc;
+
+    OBJ_CONSTRUCT(&payload, opal_buffer_t);
+    n=1;
+    if (OPAL_SUCCESS != (rc = opal_dss.unpack(beat, &seq, &n, OPAL_UINT32)) ||
+        OPAL_SUCCESS != (rc = opal_dss.unpack(beat, &keyframe, &n, OPAL_BOOL)) ||
+        OPAL_SUCCESS != (rc = opal_dss.unpack(beat, &compressed, &n, OPAL_BOOL)) ||
+        OPAL_SUCCESS != (rc = opal_dss.unpack(beat, &rawlen, &n, OPAL_INT32)) ||
+        OPAL_SUCCESS != (rc = opal_dss.unpack(beat, &nbytes, &n, OPAL_INT32))) {
+        ORTE_ERROR_LOG(rc);
+        goto error;
+    }
+    if (0 < nbytes) {
+        if (NULL == (bytes = (uint8_t*)malloc(nbytes))) {
+            ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+            goto error;
+        }
+        n = nbytes;
+        if (OPAL_SUCCESS != (rc = opal_dss.unpack(beat, bytes, &n, OPAL_BYTE))) {
+            ORTE_ERROR_LOG(rc);
+            goto error;
+        }
+    }
+
+    if (keyframe) {
+        OPAL_LIST_DESTRUCT(&peer->refs);
+        OBJ_CONSTRUCT(&peer->refs, opal_list_t);
+    } else if (!peer->valid || seq != peer->seq + 1) {
+        opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
+                            "%s heartbeat %u from %s is out of sequence - waiting for keyframe",
+                            ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), seq,
+                            ORTE_NAME_PRINT(sender));
+        goto error;
+    }
+
+    if (compressed) {
+        if (!opal_compress.decompress_block(&raw, rawlen, bytes, nbytes)) {
+            opal_output(0, "%s could not decompress heartbeat from %s",
+                        ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                        ORTE_NAME_PRINT(sender));
+            goto error;
+        }
+        free(bytes);
+        bytes = raw;
+    }
+    /* the payload takes ownership of the bytes */
+    opal_dss.load(&payload, bytes, rawlen);
+    bytes = NULL;
+
+    out = OBJ_NEW(opal_buffer_t);
+    n=1;
+    while (OPAL_SUCCESS == (rc = opal_dss.unpack(&payload, &id, &n, OPAL_UINT16))) {
+        ref = find_ref(&peer->refs, id, next_occurrence(&seen, &nseen, id));
+        n=1;
+        if (OPAL_SUCCESS != (rc = opal_dss.unpack(&payload, &kind, &n, OPAL_UINT8))) {
+            ORTE_ERROR_LOG(rc);
+            goto error;
+        }
+        if (HEARTBEAT_FULL == kind) {
+            if (OPAL_SUCCESS != (rc = opal_dss.unpack_view(&payload, &buf))) {
+                ORTE_ERROR_LOG(rc);
+                goto error;
+            }
+            if (NULL != ref->bytes) {
+                free(ref->bytes);
+            }
+            ref->nbytes = (int32_t)buf->bytes_used;
+            if (NULL != (ref->bytes = (uint8_t*)malloc(ref->nbytes))) {
+                memcpy(ref->bytes, buf->base_ptr, ref->nbytes);
+            }
+        } else {
+            n=1;
+            if (OPAL_SUCCESS != (rc = opal_dss.unpack(&payload, &nbytes, &n, OPAL_INT32))) {
+                ORTE_ERROR_LOG(rc);
+                goto error;
+            }
+            if (NULL == ref->bytes || nbytes != ref->nbytes) {
+                opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
+                                    "%s heartbeat %u from %s has no reference for a delta",
+                                    ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), seq,
+                                    ORTE_NAME_PRINT(sender));
+                goto error;
+            }
+            if (NULL == (raw = (uint8_t*)malloc(nbytes))) {
+                ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+                goto error;
+            }
+            n = nbytes;
+            if (OPAL_SUCCESS != (rc = opal_dss.unpack(&payload, raw, &n, OPAL_BYTE))) {
+                ORTE_ERROR_LOG(rc);
+                free(raw);
+                goto error;
+            }
+            for (i=0; i < nbytes; i++) {
+                ref->bytes[i] ^= raw[i];
+            }
+            memcpy(raw, ref->bytes, nbytes);
+            buf = OBJ_NEW(opal_buffer_t);
+            opal_dss.load(buf, raw, nbytes);
+        }
+        if (OPAL_SUCCESS != (rc = opal_dss.pack(out, &id, 1, OPAL_UINT16)) ||
+            OPAL_SUCCESS != (rc = opal_dss.pack(out, &buf, 1, OPAL_BUFFER))) {
+            ORTE_ERROR_LOG(rc);
+            OBJ_RELEASE(buf);
+            goto error;
+        }
+        OBJ_RELEASE(buf);
+        n=1;
+    }
+    if (OPAL_ERR_UNPACK_READ_PAST_END_OF_BUFFER != rc) {
+        ORTE_ERROR_LOG(rc);
+        goto error;
+    }
+
+    peer->seq = seq;
+    peer->valid = true;
+    if (NULL != seen) {
+        free(seen);
+    }
+    OBJ_DESTRUCT(&payload);
+    return out;
+
+ error:
+    peer->valid = false;
+    if (NULL != bytes) {
+        free(bytes);
+    }
+    if (NULL != out) {
+        OBJ_RELEASE(out);
+    }
+    if (NULL != seen) {
+        free(seen);
+    }
+    OBJ_DESTRUCT(&payload);
+    return NULL;
+}
+
+static int wheel_setup(void)
+{
+    uint64_t timeout_usec;
+    int i, size;
+
+    if (0 < mca_sensor_heartbeat_component.timeout) {
+        timeout_usec = (uint64_t)mca_sensor_heartbeat_component.timeout * 1000;
+    } else {
+        timeout_usec = (uint64_t)(3 * orcm_sensor_base.sample_rate) * 1000000;
+    }
+    if (0 < mca_sensor_heartbeat_component.tick) {
+        tick_usec = (uint64_t)mca_sensor_heartbeat_component.tick * 1000;
+    } else {
+        tick_usec = timeout_usec / 16;
+    }
+    if (tick_usec < 1000) {
+        tick_usec = 1000;
+    }
+    timeout_ticks = (timeout_usec + tick_usec - 1) / tick_usec;
+    if (0 == timeout_ticks) {
+        timeout_ticks = 1;
+    }
+    for (size=2; (uint64_t)size <= timeout_ticks + 1; size <<= 1);
+    if (NULL == (wheel = (int*)malloc(size * sizeof(int)))) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    for (i=0; i < size; i++) {
+        wheel[i] = -1;
+    }
+    wheel_mask = size - 1;
+    wheel_now = opal_timer_base_get_usec() / tick_usec;
+    check_time.tv_sec = tick_usec / 1000000;
+    check_time.tv_usec = tick_usec % 1000000;
+    return ORCM_SUCCESS;
+}
+
+static heartbeat_live_t* get_live(int vpid)
+{
+    heartbeat_live_t *tmp;
+    int i, n;
+
+    if (vpid < nlive) {
+        return &live[vpid];
+    }
+    for (n = (0 == nlive) ? 1024 : nlive; n <= vpid; n <<= 1);
+    if (NULL == (tmp = (heartbeat_live_t*)realloc(live, n * sizeof(heartbeat_live_t)))) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+        return NULL;
+    }
+    for (i=nlive; i < n; i++) {
+        tmp[i].last_seen = 0;
+        tmp[i].deadline = 0;
+        tmp[i].next = tmp[i].prev = -1;
+        tmp[i].queued = false;
+        tmp[i].seeded = false;
+    }
+    live = tmp;
+    nlive = n;
+    return &live[vpid];
+}
+
+static void wheel_unlink(int vpid)
+{
+    heartbeat_live_t *lv = &live[vpid];
+
+    if (!lv->queued) {
+        return;
+    }
+    if (0 <= lv->prev) {
+        live[lv->prev].next = lv->next;
+    } else {
+        wheel[lv->deadline & wheel_mask] = lv->next;
+    }
+    if (0 <= lv->next) {
+        live[lv->next].prev = lv->prev;
+    }
+    lv->next = lv->prev = -1;
+    lv->queued = false;
+}
+
+/* (re)arm the daemon's deadline one timeout from now */
+static void wheel_arm(int vpid, uint64_t now)
+{
+    heartbeat_live_t *lv;
+    int slot;
+
+    if (NULL == wheel || NULL == (lv = get_live(vpid))) {
+        return;
+    }
+    wheel_unlink(vpid);
+    lv->deadline = now / tick_usec + timeout_ticks;
+    slot = lv->deadline & wheel_mask;
+    lv->next = wheel[slot];
+    if (0 <= lv->next) {
+        live[lv->next].prev = vpid;
+    }
+    wheel[slot] = vpid;
+    lv->queued = true;
+}
+
+static void mark_alive(int vpid, uint64_t now)
+{
+    wheel_arm(vpid, now);
+    if (vpid < nlive) {
+        live[vpid].last_seen = now;
+    }
+}
+
 static void start(orte_jobid_t job)
 {
     if (!check_active && NULL != daemons) {
         /* setup the check event */
-        check_time.tv_sec = 3 * orcm_sensor_base.sample_rate;
-        check_time.tv_usec = 0;
+        if (NULL == wheel && ORCM_SUCCESS != wheel_setup()) {
+            ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+            return;
+        }
         opal_event_evtimer_set(orte_event_base, &check_ev, check_heartbeat, &check_ev);
         opal_event_evtimer_add(&check_ev, &check_time);
         check_active = true;
     }
+    if (!alive_active && !ORTE_PROC_IS_HNP &&
+        0 < mca_sensor_heartbeat_component.interval) {
+        /* beat between samples so failures can be caught quickly */
+        alive_time.tv_sec = mca_sensor_heartbeat_component.interval / 1000;
+        alive_time.tv_usec = (mca_sensor_heartbeat_component.interval % 1000) * 1000;
+        opal_event_evtimer_set(orte_event_base, &alive_ev, send_alive, &alive_ev);
+        opal_event_evtimer_add(&alive_ev, &alive_time);
+        alive_active = true;
+    }
 }
 
 static void sample(orcm_sensor_sampler_t *sampler)
 {
-    opal_buffer_t *buf;
+    opal_buffer_t *buf, entries;
     int rc;
+    uint8_t mode;
+    bool announce;
     orte_process_name_t *tgt;
 
     /* if we are aborting or shutting down, ignore this */
@@ -147,22 +893,150 @@ static void sample(orcm_sensor_sampler_t *sampler)
                          "%s sending heartbeat",
                          ORTE_NAME_PRINT(ORTE_PROC_MY_NAME)));
 
-    /* if we want sampled data included, point to the bucket */
+    /* periodically remind the receiver of our component ids */
+    announce = (mca_sensor_heartbeat_component.keyframe <= 1 ||
+                0 == beat_count % mca_sensor_heartbeat_component.keyframe);
+    beat_count++;
+
     buf = OBJ_NEW(opal_buffer_t);
-    if (orcm_sensor_base.log_samples) {
-        opal_dss.copy_payload(buf, &sampler->bucket);
+    mode = (orcm_sensor_base.log_samples && mca_sensor_heartbeat_component.encode) ?
+           HEARTBEAT_ENCODED : HEARTBEAT_RAW;
+    rc = pack_header(buf, mode, announce);
+
+    /* if we want sampled data included, point to the bucket */
+    if (ORCM_SUCCESS == rc && orcm_sensor_base.log_samples) {
+        OBJ_CONSTRUCT(&entries, opal_buffer_t);
+        if (ORCM_SUCCESS == (rc = intern_bucket(&sampler->bucket, &entries))) {
+            if (HEARTBEAT_ENCODED == mode) {
+                rc = encode_beat(buf, &entries);
+            } else {
+                rc = opal_dss.copy_payload(buf, &entries);
+            }
+        }
+        OBJ_DESTRUCT(&entries);
         /* cycle this bucket to clear it */
         OBJ_DESTRUCT(&sampler->bucket);
         OBJ_CONSTRUCT(&sampler->bucket, opal_buffer_t);
     }
+    if (ORCM_SUCCESS != rc) {
+        ORTE_ERROR_LOG(rc);
+        /* still let them know we are alive */
+        OBJ_RELEASE(buf);
+        buf = OBJ_NEW(opal_buffer_t);
+        if (ORCM_SUCCESS != (rc = pack_header(buf, HEARTBEAT_RAW, false))) {
+            ORTE_ERROR_LOG(rc);
+            OBJ_RELEASE(buf);
+            return;
+        }
+    }
 
     /* send heartbeat */
-    if (ORCM_SUCCESS != (rc = orte_rml.send_buffer_nb(tgt, buf,
-                                                      ORTE_RML_TAG_HEARTBEAT,
-                                                      orte_rml_send_callback, NULL))) {
-        ORTE_ERROR_LOG(rc);
+    send_beat(tgt, buf);
+}
+
+/* send a beat carrying nothing but the fact that we are alive */
+static void send_alive(int fd, short dummy, void *arg)
+{
+    opal_event_t *tmp = (opal_event_t*)arg;
+    opal_buffer_t *buf;
+    orte_process_name_t *tgt;
+    int rc;
+
+    /* if we are aborting or shutting down, ignore this */
+    if (orte_abnormal_term_ordered || orte_finalizing || !orte_initialized) {
+        alive_active = false;
+        return;
+    }
+
+    tgt = ORTE_PROC_IS_CM ? ORTE_PROC_MY_DAEMON : ORTE_PROC_MY_HNP;
+    if (ORTE_JOBID_INVALID != tgt->jobid && ORTE_VPID_INVALID != tgt->vpid) {
+        buf = OBJ_NEW(opal_buffer_t);
+        if (ORCM_SUCCESS != (rc = pack_header(buf, HEARTBEAT_RAW, false))) {
+            ORTE_ERROR_LOG(rc);
+            OBJ_RELEASE(buf);
+        } else {
+            send_beat(tgt, buf);
+        }
+    }
+
+    /* reset the timer */
+    opal_event_evtimer_add(tmp, &alive_time);
+}
+
+/* hold a beat that failed to send so it goes out again, in order,
+ * once we have a route - after our parent dies, that is once the
+ * routed framework has failed us over to a backup aggregator */
+static void hold_beat(opal_buffer_t *buf)
+{
+    heartbeat_held_t *held;
+
+    if (mca_sensor_heartbeat_component.backlog <= 0 ||
+        orte_abnormal_term_ordered || orte_finalizing) {
         OBJ_RELEASE(buf);
+        return;
+    }
+    if ((int)opal_list_get_size(&backlog) >= mca_sensor_heartbeat_component.backlog) {
+        /* the receiver resyncs deltas at the next keyframe */
+        held = (heartbeat_held_t*)opal_list_remove_first(&backlog);
+        OBJ_RELEASE(held);
+        opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
+                            "%s sensor:heartbeat: backlog full - dropping oldest beat",
+                            ORTE_NAME_PRINT(ORTE_PROC_MY_NAME));
+    }
+    held = OBJ_NEW(heartbeat_held_t);
+    held->buf = buf;
+    opal_list_append(&backlog, &held->super);
+}
+
+static void beat_sent(int status, orte_process_name_t *peer,
+                      opal_buffer_t *buffer, orte_rml_tag_t tag,
+                      void *cbdata)
+{
+    if (ORTE_SUCCESS == status) {
+        OBJ_RELEASE(buffer);
+        return;
+    }
+    hold_beat(buffer);
+    ORTE_ACTIVATE_PROC_STATE(peer, ORTE_PROC_STATE_UNABLE_TO_SEND_MSG);
+}
+
+/* send a beat behind any we are holding, so the receiver sees
+ * them in the order they were taken */
+static void send_beat(orte_process_name_t *tgt, opal_buffer_t *buf)
+{
+    heartbeat_held_t *held;
+    opal_list_t pending;
+    int rc;
+
+    if (0 == opal_list_get_size(&backlog)) {
+        if (ORCM_SUCCESS != (rc = orte_rml.send_buffer_nb(tgt, buf,
+                                                          ORTE_RML_TAG_HEARTBEAT,
+                                                          beat_sent, NULL))) {
+            ORTE_ERROR_LOG(rc);
+            OBJ_RELEASE(buf);
+        }
+        return;
+    }
+
+    hold_beat(buf);
+    opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
+                        "%s sensor:heartbeat: replaying %d held beats to %s",
+                        ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                        (int)opal_list_get_size(&backlog), ORTE_NAME_PRINT(tgt));
+    /* any that fail again come back onto the backlog */
+    OBJ_CONSTRUCT(&pending, opal_list_t);
+    opal_list_join(&pending, opal_list_get_end(&pending), &backlog);
+    while (NULL != (held = (heartbeat_held_t*)opal_list_remove_first(&pending))) {
+        if (ORCM_SUCCESS != (rc = orte_rml.send_buffer_nb(tgt, held->buf,
+                                                          ORTE_RML_TAG_HEARTBEAT,
+                                                          beat_sent, NULL))) {
+            ORTE_ERROR_LOG(rc);
+        } else {
+            held->buf = NULL;
+        }
+        OBJ_RELEASE(held);
     }
+    OBJ_DESTRUCT(&pending);
 }
 
 /* this function automatically gets periodically called
@@ -171,10 +1045,11 @@ static void sample(orcm_sensor_sampler_t *sampler)
  */
 static void check_heartbeat(int fd, short dummy, void *arg)
 {
-    int v;
+    int v, next, slot;
     orte_proc_t *proc;
+    heartbeat_live_t *lv;
     opal_event_t *tmp = (opal_event_t*)arg;
-    int32_t beats, *bptr;
+    uint64_t now, target, t;
 
     OPAL_OUTPUT_VERBOSE((3, orcm_sensor_base_framework.framework_output,
                          "%s sensor:check_heartbeat",
@@ -191,43 +1066,71 @@ static void check_heartbeat(int fd, short dummy, void *arg)
         check_active = false;
         return;
     }
-    
-    for (v=0; v < daemons->procs->size; v++) {
-        if (NULL == (proc = (orte_proc_t*)opal_pointer_array_get_item(daemons->procs, v))) {
-            continue;
-        }
-        /* ignore myself */
-        if (proc->name.vpid == ORTE_PROC_MY_NAME->vpid) {
-            continue;
-        }
-        if (ORTE_PROC_STATE_RUNNING != proc->state) {
-            OPAL_OUTPUT_VERBOSE((1, orcm_sensor_base_framework.framework_output,
-                                 "%s sensor:heartbeat DAEMON %s IS NOT RUNNING",
-                                 ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                 ORTE_NAME_PRINT(&proc->name)));
-            continue;
+
+    now = opal_timer_base_get_usec();
+    target = now / tick_usec;
+
+    /* start watching daemons added since the last check - they
+     * get a full timeout to send their first beat. The procs can be
+     * filled in at any vpid, so scan every slot whenever the job
+     * holds a daemon we have not picked up yet */
+    if (nseeded != (int)daemons->num_procs) {
+        nseeded = 0;
+        for (v=0; v < daemons->procs->size; v++) {
+            if (NULL == opal_pointer_array_get_item(daemons->procs, v)) {
+                continue;
+            }
+            nseeded++;
+            if (v < nlive && live[v].seeded) {
+                continue;
+            }
+            if (NULL == (lv = get_live(v))) {
+                break;
+            }
+            lv->seeded = true;
+            if (v != (int)ORTE_PROC_MY_NAME->vpid && !lv->queued) {
+                wheel_arm(v, now);
+            }
         }
+    }
 
-        beats = 0;
-        bptr = &beats;
-        orte_get_attribute(&proc->attributes, ORTE_PROC_NBEATS, (void**)bptr, OPAL_INT32);
-        if (0 == beats) {
-            /* no heartbeat recvd in last window */
+    /* visit each slot that has come due - at most one turn of the
+     * wheel, however late we are */
+    if ((uint64_t)wheel_mask < target - wheel_now) {
+        wheel_now = target - wheel_mask - 1;
+    }
+    for (t = wheel_now + 1; t <= target; t++) {
+        slot = t & wheel_mask;
+        for (v = wheel[slot]; 0 <= v; v = next) {
+            next = live[v].next;
+            if (target < live[v].deadline) {
+                continue;
+            }
+            wheel_unlink(v);
+            if (NULL == (proc = (orte_proc_t*)opal_pointer_array_get_item(daemons->procs, v))) {
+                continue;
+            }
+            if (ORTE_PROC_STATE_RUNNING != proc->state) {
+                OPAL_OUTPUT_VERBOSE((1, orcm_sensor_base_framework.framework_output,
+                                     "%s sensor:heartbeat DAEMON %s IS NOT RUNNING",
+                                     ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                                     ORTE_NAME_PRINT(&proc->name)));
+                /* keep watching it unless it has already been failed */
+                if (ORTE_PROC_STATE_HEARTBEAT_FAILED != proc->state) {
+                    wheel_arm(v, now);
+                }
+                continue;
+            }
+            /* no heartbeat recvd in the timeout window */
             OPAL_OUTPUT_VERBOSE((1, orcm_sensor_base_framework.framework_output,
-                                 "%s sensor:check_heartbeat FAILED for daemon %s",
+                                 "%s sensor:check_heartbeat FAILED for daemon %s - last beat %s",
                                  ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                 ORTE_NAME_PRINT(&proc->name)));
+                                 ORTE_NAME_PRINT(&proc->name),
+                                 (0 == live[v].last_seen) ? "never" : "timed out"));
             ORTE_ACTIVATE_PROC_STATE(&proc->name, ORTE_PROC_STATE_HEARTBEAT_FAILED);
-        } else {
-            OPAL_OUTPUT_VERBOSE((1, orcm_sensor_base_framework.framework_output,
-                                 "%s HEARTBEAT DETECTED FOR %s: NUM BEATS %d",
-                                 ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                 ORTE_NAME_PRINT(&proc->name), beats));
         }
-        /* reset for next period */
-        beats = 0;
-        orte_set_attribute(&proc->attributes, ORTE_PROC_NBEATS, ORTE_ATTR_LOCAL, (void*)bptr, OPAL_INT32);
     }
+    wheel_now = target;
 
     /* reset the timer */
     opal_event_evtimer_add(tmp, &check_time);
@@ -238,10 +1141,11 @@ static void recv_beats(int status, orte_process_name_t* sender,
                        orte_rml_tag_t tag, void *cbdata)
 {
     orte_proc_t *proc;
+    heartbeat_peer_t *peer;
     int rc, n;
-    char *component=NULL;
-    opal_buffer_t *buf;
-    int32_t beats, *bptr;
+    opal_buffer_t *buf, *data;
+    uint16_t id;
+    uint8_t mode;
 
     opal_output_verbose(1, orcm_sensor_base_framework.framework_output,
                         "%s received beat from %s",
@@ -255,16 +1159,13 @@ static void recv_beats(int status, orte_process_name_t* sender,
 
     /* get this daemon's object */
     if (NULL != daemons) {
-        if (NULL != (proc = (orte_proc_t*)opal_pointer_array_get_item(daemons->procs, sender->vpid))) {
+        if (sender->vpid != ORTE_PROC_MY_NAME->vpid &&
+            NULL != (proc = (orte_proc_t*)opal_pointer_array_get_item(daemons->procs, sender->vpid))) {
             OPAL_OUTPUT_VERBOSE((1, orcm_sensor_base_framework.framework_output,
                                  "%s marked beat from %s",
                                  ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
                                  ORTE_NAME_PRINT(sender)));
-            beats = 0;
-            bptr = &beats;
-            orte_get_attribute(&proc->attributes, ORTE_PROC_NBEATS, (void**)bptr, OPAL_INT32);
-            beats++;
-            orte_set_attribute(&proc->attributes, ORTE_PROC_NBEATS, ORTE_ATTR_LOCAL, (void*)bptr, OPAL_INT32);
+            mark_alive(sender->vpid, opal_timer_base_get_usec());
             /* if this daemon has reappeared, reset things */
             if (ORTE_PROC_STATE_HEARTBEAT_FAILED == proc->state) {
                 proc->state = ORTE_PROC_STATE_RUNNING;
@@ -272,22 +1173,42 @@ static void recv_beats(int status, orte_process_name_t* sender,
         }
     }
 
+    /* pick up the sender's component table and see how the
+     * sampled data was sent */
+    peer = get_peer(sender);
+    if (ORCM_SUCCESS != (rc = unpack_header(peer, buffer, &mode))) {
+        ORTE_ERROR_LOG(rc);
+        return;
+    }
+    if (HEARTBEAT_ENCODED == mode) {
+        if (NULL == (data = decode_beat(sender, peer, buffer))) {
+            return;
+        }
+    } else {
+        data = buffer;
+        OBJ_RETAIN(data);
+    }
+
     /* unload any sampled data */
     n=1;
-    while (OPAL_SUCCESS == (rc = opal_dss.unpack(buffer, &buf, &n, OPAL_BUFFER))) {
-        if (NULL != buf) {
-            n=1;
-            if (OPAL_SUCCESS != (rc = opal_dss.unpack(buf, &component, &n, OPAL_STRING))) {
-                ORTE_ERROR_LOG(rc);
-                break;
-            }
-            orcm_sensor_base_log(component, buf);
-            OBJ_RELEASE(buf);
-            free(component);
-            n=1;
+    while (OPAL_SUCCESS == (rc = opal_dss.unpack(data, &id, &n, OPAL_UINT16))) {
+        if (OPAL_SUCCESS != (rc = opal_dss.unpack_view(data, &buf))) {
+            ORTE_ERROR_LOG(rc);
+            break;
         }
+        if (id < peer->nids) {
+            orcm_sensor_base_log_id(peer->ids[id], buf);
+        } else {
+            opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
+                                "%s no component table from %s yet - dropping data",
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                                ORTE_NAME_PRINT(sender));
+        }
+        OBJ_RELEASE(buf);
+        n=1;
     }
     if (OPAL_ERR_UNPACK_READ_PAST_END_OF_BUFFER != rc) {
         ORTE_ERROR_LOG(rc);
     }
+    OBJ_RELEASE(data);
 }
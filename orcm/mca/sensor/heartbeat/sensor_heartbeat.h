@@ -22,7 +22,18 @@
 
 BEGIN_C_DECLS
 
-ORCM_MODULE_DECLSPEC extern orcm_sensor_base_component_t mca_sensor_heartbeat_component;
+typedef struct {
+    orcm_sensor_base_component_t super;
+    bool encode;     /* send sample data as deltas against the previous beat */
+    bool compress;   /* compress encoded beats with the opal compress framework */
+    int keyframe;    /* number of beats between full (non-delta) payloads */
+    int timeout;     /* msec without a beat before a daemon is declared failed */
+    int tick;        /* msec resolution of failure detection */
+    int interval;    /* msec between liveness-only beats, 0 for none */
+    int backlog;     /* beats held for replay while we have no route */
+} orcm_sensor_heartbeat_component_t;
+
+ORCM_MODULE_DECLSPEC extern orcm_sensor_heartbeat_component_t mca_sensor_heartbeat_component;
 extern orcm_sensor_base_module_t orcm_sensor_heartbeat_module;
 
 
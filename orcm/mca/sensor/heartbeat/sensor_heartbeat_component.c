@@ -25,26 +25,29 @@
 static int orcm_sensor_heartbeat_open(void);
 static int orcm_sensor_heartbeat_close(void);
 static int orcm_sensor_heartbeat_query(mca_base_module_t **module, int *priority);
+static int heartbeat_component_register(void);
 
-orcm_sensor_base_component_t mca_sensor_heartbeat_component = {
+orcm_sensor_heartbeat_component_t mca_sensor_heartbeat_component = {
     {
-        ORCM_SENSOR_BASE_VERSION_1_0_0,
-        /* Component name and version */
-        .mca_component_name = "heartbeat",
-        MCA_BASE_MAKE_VERSION(component, ORCM_MAJOR_VERSION, ORCM_MINOR_VERSION,
-                              ORCM_RELEASE_VERSION),
+        {
+            ORCM_SENSOR_BASE_VERSION_1_0_0,
+            /* Component name and version */
+            .mca_component_name = "heartbeat",
+            MCA_BASE_MAKE_VERSION(component, ORCM_MAJOR_VERSION, ORCM_MINOR_VERSION,
+                                  ORCM_RELEASE_VERSION),
         
-        /* Component open and close functions */
-        .mca_open_component = orcm_sensor_heartbeat_open,
-        .mca_close_component = orcm_sensor_heartbeat_close,
-        .mca_query_component = orcm_sensor_heartbeat_query,
-        NULL
-    },
-    .base_data = {
-        /* The component is checkpoint ready */
-        MCA_BASE_METADATA_PARAM_CHECKPOINT
-    },
-    "heartbeat"
+            /* Component open and close functions */
+            .mca_open_component = orcm_sensor_heartbeat_open,
+            .mca_close_component = orcm_sensor_heartbeat_close,
+            .mca_query_component = orcm_sensor_heartbeat_query,
+            .mca_register_component_params = heartbeat_component_register
+        },
+        .base_data = {
+            /* The component is checkpoint ready */
+            MCA_BASE_METADATA_PARAM_CHECKPOINT
+        },
+        "heartbeat"
+    }
 };
 
 
@@ -72,3 +75,65 @@ static int orcm_sensor_heartbeat_close(void)
 {
     return ORCM_SUCCESS;
 }
+
+static int heartbeat_component_register(void)
+{
+    mca_base_component_t *c = &mca_sensor_heartbeat_component.super.base_version;
+
+    mca_sensor_heartbeat_component.encode = false;
+    (void) mca_base_component_var_register(c, "encode",
+                                           "Send sampled data as deltas against the previous heartbeat [default: false]",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_sensor_heartbeat_component.encode);
+
+    mca_sensor_heartbeat_component.compress = true;
+    (void) mca_base_component_var_register(c, "compress",
+                                           "Compress encoded heartbeats when a block compressor is available [default: true]",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_sensor_heartbeat_component.compress);
+
+    mca_sensor_heartbeat_component.keyframe = 10;
+    (void) mca_base_component_var_register(c, "keyframe",
+                                           "Number of encoded heartbeats between full payloads [default: 10]",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_sensor_heartbeat_component.keyframe);
+
+    mca_sensor_heartbeat_component.timeout = 0;
+    (void) mca_base_component_var_register(c, "timeout",
+                                           "Milliseconds without a heartbeat before a daemon is declared failed (0 = three sample periods) [default: 0]",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_sensor_heartbeat_component.timeout);
+
+    mca_sensor_heartbeat_component.tick = 0;
+    (void) mca_base_component_var_register(c, "tick",
+                                           "Resolution of heartbeat failure detection in milliseconds (0 = timeout/16) [default: 0]",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_sensor_heartbeat_component.tick);
+
+    mca_sensor_heartbeat_component.interval = 0;
+    (void) mca_base_component_var_register(c, "interval",
+                                           "Milliseconds between liveness-only heartbeats sent in addition to the sampled ones (0 = none) [default: 0]",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_sensor_heartbeat_component.interval);
+
+    mca_sensor_heartbeat_component.backlog = 32;
+    (void) mca_base_component_var_register(c, "backlog",
+                                           "Number of heartbeats held for replay while the route to our aggregator is down (0 = none) [default: 32]",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_sensor_heartbeat_component.backlog);
+    return ORCM_SUCCESS;
+}
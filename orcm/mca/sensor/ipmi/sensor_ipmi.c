@@ -60,9 +60,20 @@ static orcm_sensor_ipmi_t orcm_sensor_ipmi;
 
 static void ipmi_con(orcm_sensor_hosts_t *host)
 {
+    host->fresh = false;
+    host->failures = 0;
+    host->retry_at = 0;
+    host->have_devid = false;
+    host->nsdrs = 0;
+    host->sdr_bytes = 0;
+    host->sdr_sweeps = 0;
+    host->sdrs = NULL;
 }
 static void ipmi_des(orcm_sensor_hosts_t *host)
 {
+    if (NULL != host->sdrs) {
+        free(host->sdrs);
+    }
 }
 OBJ_CLASS_INSTANCE(orcm_sensor_hosts_t,
                    opal_list_item_t,
@@ -1102,26 +1113,15 @@ static void collect_sample(orcm_sensor_sampler_t *sampler)
     } /* End packing BMC credentials*/
 
     /* Begin sampling known nodes from here */
-    host_count = opal_list_get_size(&sensor_active_hosts);
-    if (0 == host_count) {
+    if (0 == opal_list_get_size(&sensor_active_hosts)) {
         opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
                 "No IPMI Device available for sampling");
         OBJ_DESTRUCT(&data);
         return;
     }
-    /* pack the numerical identifier for number of nodes*/
-    if (OPAL_SUCCESS != (rc = opal_dss.pack(&data, &host_count, 1, OPAL_INT))) {
-        ORTE_ERROR_LOG(rc);
-        OBJ_DESTRUCT(&data);
-        return;
-    }
 
-    /* Loop through each host from the host list*/
-    OPAL_LIST_FOREACH_SAFE(host, nxt, &sensor_active_hosts, orcm_sensor_hosts_t) {
-        opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
-            "Scanning metrics from node: %s",host->capsule.node.name);
-        /* Clear all memory for the ipmi_capsule */
-        memset(&(host->capsule.prop), '\0', sizeof(host->capsule.prop));
+    /* Set up the query for each host from the host list*/
+    OPAL_LIST_FOREACH(host, &sensor_active_hosts, orcm_sensor_hosts_t) {
         /* Enable/Disable the property/metric to be sampled */
         host->capsule.capability[BMC_REV]         = 1;
         host->capsule.capability[IPMI_VER]        = 1;
@@ -1150,9 +1150,39 @@ static void collect_sample(orcm_sensor_sampler_t *sampler)
         host->capsule.node.auth = IPMI_SESSION_AUTHTYPE_PASSWORD;
         host->capsule.node.priv = IPMI_PRIV_LEVEL_ADMIN;
         host->capsule.node.ciph = 3; /* Cipher suite No. 3 */
+    }
+
+    /* Running a sample for all Nodes */
+    orcm_sensor_ipmi_poll_hosts(&sensor_active_hosts);
 
-        /* Running a sample for a Node */
-        orcm_sensor_ipmi_exec_call(&host->capsule);
+    /* only the nodes whose BMC answered are reported */
+    host_count = 0;
+    OPAL_LIST_FOREACH(host, &sensor_active_hosts, orcm_sensor_hosts_t) {
+        if (host->fresh) {
+            host_count++;
+        }
+    }
+    if (0 == host_count) {
+        opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+                "No IPMI Device answered this sample");
+        OBJ_DESTRUCT(&data);
+        return;
+    }
+    /* pack the numerical identifier for number of nodes*/
+    if (OPAL_SUCCESS != (rc = opal_dss.pack(&data, &host_count, 1, OPAL_INT))) {
+        ORTE_ERROR_LOG(rc);
+        OBJ_DESTRUCT(&data);
+        return;
+    }
+
+    /* Loop through each host from the host list*/
+    OPAL_LIST_FOREACH_SAFE(host, nxt, &sensor_active_hosts, orcm_sensor_hosts_t) {
+        if (!host->fresh) {
+            continue;
+        }
+        opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+            "Packing metrics from node: %s",host->capsule.node.name);
+        int_count++;
 
         /* get the sample time */
         now = time(NULL);
@@ -1547,6 +1577,9 @@ static void ipmi_log(opal_buffer_t *sample)
                 "UnPacked NodeName: %s", nodename);
 
             /* Send the unpacked data for one Node */
+            /* hand the values to any analytics subscribed to them */
+            orcm_sensor_base_publish("ipmi", vals);
+
             /* store it */
             if (0 <= orcm_sensor_base.dbhandle) {
                 orcm_db.store(orcm_sensor_base.dbhandle, "ipmi", vals, mycleanup, NULL);
@@ -1737,6 +1770,9 @@ static void ipmi_log(opal_buffer_t *sample)
             free(key_unit);
         }
         /* Send the unpacked data for one Node */
+        /* hand the values to any analytics subscribed to them */
+        orcm_sensor_base_publish("ipmi", vals);
+
         /* store it */
         if (0 <= orcm_sensor_base.dbhandle) {
             orcm_db.store(orcm_sensor_base.dbhandle, "ipmi", vals, mycleanup, NULL);
@@ -1821,123 +1857,119 @@ void orcm_sensor_ipmi_get_device_power_state(uchar in, char* str)
     }
 }
 
-void orcm_sensor_ipmi_exec_call(ipmi_capsule_t *cap)
+/* store one sensor reading in the capsule if its SDR matches the
+ * requested sensor list or group - returns true if it was kept */
+static bool ipmi_keep_reading(ipmi_capsule_t *cap, unsigned char *sdrbuf,
+                              unsigned char *reading)
+{
+    char tag[17];
+    char *typestr;
+    int n = cap->prop.total_metrics;
+
+    strncpy(tag, (char *)&sdrbuf[48], 16);
+    tag[16] = 0;
+    if (!orcm_sensor_ipmi_label_found(tag) &&
+        (NULL == mca_sensor_ipmi_component.sensor_group ||
+         NULL == strcasestr(tag, mca_sensor_ipmi_component.sensor_group))) {
+        return false;
+    }
+    typestr = get_unit_type(sdrbuf[20], sdrbuf[21], sdrbuf[22], 0);
+    cap->prop.collection_metrics[n] = RawToFloat(reading[0], sdrbuf);
+    strncpy(cap->prop.collection_metrics_units[n], typestr, sizeof(cap->prop.collection_metrics_units[n]));
+    strncpy(cap->prop.metric_label[n], tag, sizeof(cap->prop.metric_label[n]));
+    cap->prop.total_metrics++;
+    return true;
+}
+
+/* Query one BMC. The device id rarely changes, so it is only read
+ * until it succeeds once, and the full SDRs of the requested sensors
+ * are cached so later polls only read those sensors instead of
+ * walking the BMC's whole SDR repository. Nothing here reports
+ * errors - the failing step is returned in stage so the caller can
+ * weigh it against the BMC's circuit first */
+int orcm_sensor_ipmi_query_host(orcm_sensor_hosts_t *host, int *stage)
 {
+    ipmi_capsule_t *cap = &host->capsule;
     char addr[16];
-    int ret = 0;
+    int ret, i, rc = 0;
     unsigned char idata[4], rdata[256];
     unsigned char ccode;
     int rlen = 256;
     char fdebug = 0;
-    /* ipmi_capsule_t *cap = (ipmi_capsule_t*)(thread_param); */
     device_id_t devid;
     acpi_power_state_t pwr_state;
-
-    char tag[17];
-    unsigned char snum = 0;
     unsigned char reading[4];       /* Stores the individual sensor reading */
-    double val;
-    char *typestr;                  /* Stores the individual sensor unit */
     unsigned short int id = 0;
     unsigned char sdrbuf[SDR_SZ];
-    unsigned char *sdrlist;
-    char *error_string;
-    int sensor_count = 0;
-
-    char sys_pwr_state_str[16], dev_pwr_state_str[16];
+    unsigned char *sdrlist, *sdrs;
     char test[16], test1[16];
+    char bmc_rev[16], ipmi_ver[16], man_id[16];
+
+    *stage = IPMI_QUERY_OK;
+
+    /* keep the cached device id across the reset of the properties */
+    memcpy(bmc_rev, cap->prop.bmc_rev, sizeof(bmc_rev));
+    memcpy(ipmi_ver, cap->prop.ipmi_ver, sizeof(ipmi_ver));
+    memcpy(man_id, cap->prop.man_id, sizeof(man_id));
+    memset(&cap->prop, 0, sizeof(cap->prop));
+    if (host->have_devid) {
+        memcpy(cap->prop.bmc_rev, bmc_rev, sizeof(bmc_rev));
+        memcpy(cap->prop.ipmi_ver, ipmi_ver, sizeof(ipmi_ver));
+        memcpy(cap->prop.man_id, man_id, sizeof(man_id));
+    }
 
-    memset(rdata,0xff,256);
-    memset(idata,0xff,4);
-    if (cap->capability[BMC_REV] & cap->capability[IPMI_VER])
-    {
-        ret = set_lan_options(cap->node.bmc_ip, cap->node.user, cap->node.pasw, cap->node.auth, cap->node.priv, cap->node.ciph, &addr, 16);
-        if(0 == ret)
-        {
-            ret = ipmi_cmd_mc(GET_DEVICE_ID, idata, 0, rdata, &rlen, &ccode, fdebug);
-            if(0 == ret)
-            {
-                ipmi_close();
-                memcpy(&devid.raw, rdata, sizeof(devid));
-
-                /*  Pack the BMC FW Rev */
-                sprintf(test,"%x", devid.bits.fw_rev_1&0x7F);
-                sprintf(test1,"%x", devid.bits.fw_rev_2&0xFF);
-                strcat(test,".");
-                strcat(test,test1);
-                strncpy(cap->prop.bmc_rev, test, sizeof(test));
-
-                /*  Pack the IPMI VER */
-                sprintf(test,"%x", devid.bits.ipmi_ver&0xF);
-                sprintf(test1,"%x", devid.bits.ipmi_ver&0xF0);
-                strcat(test,".");
-                strcat(test,test1);
-                strncpy(cap->prop.ipmi_ver, test, sizeof(test));
-
-                /*  Pack the Manufacturer ID */
-                sprintf(test,"%02x", devid.bits.manufacturer_id[1]);
-                sprintf(test1,"%02x", devid.bits.manufacturer_id[0]);
-                strcat(test,test1);
-                strncpy(cap->prop.man_id, test, sizeof(test));
-            }
-
-            else {
-                /*disable_ipmi = 1;*/
-                error_string = decode_rv(ret);
-                orte_show_help("help-orcm-sensor-ipmi.txt", "ipmi-cmd-mc-fail",
-                           true, orte_process_info.nodename, 
-                           orte_process_info.nodename, cap->node.bmc_ip,
-                           cap->node.user, cap->node.pasw, cap->node.auth,
-                           cap->node.priv, cap->node.ciph, error_string);
-            }
-        }
-
-        else {
-            error_string = decode_rv(ret);
-            orte_show_help("help-orcm-sensor-ipmi.txt", "ipmi-set-lan-fail",
-                           true, orte_process_info.nodename,
-                           orte_process_info.nodename, cap->node.bmc_ip,
-                           cap->node.user, cap->node.pasw, cap->node.auth,
-                           cap->node.priv, cap->node.ciph, error_string);
-        }
+    if (0 != (ret = set_lan_options(cap->node.bmc_ip, cap->node.user, cap->node.pasw,
+                                    cap->node.auth, cap->node.priv, cap->node.ciph, &addr, 16))) {
+        *stage = IPMI_QUERY_SET_LAN;
+        return ret;
     }
 
-    if  (cap->capability[SYS_POWER_STATE] & cap->capability[DEV_POWER_STATE])
-    {
+    if (!host->have_devid && cap->capability[BMC_REV] & cap->capability[IPMI_VER]) {
         memset(rdata,0xff,256);
         memset(idata,0xff,4);
-        ret = set_lan_options(cap->node.bmc_ip, cap->node.user, cap->node.pasw, cap->node.auth, cap->node.priv, cap->node.ciph, &addr, 16);
-        if(0 == ret)
-        {
-            ret = ipmi_cmd_mc(GET_ACPI_POWER, idata, 0, rdata, &rlen, &ccode, fdebug);
-            if(0 == ret)
-            {
-                ipmi_close();
-                memcpy(&pwr_state.raw, rdata, sizeof(pwr_state));
-                orcm_sensor_ipmi_get_system_power_state(pwr_state.bits.sys_power_state, sys_pwr_state_str);
-                orcm_sensor_ipmi_get_device_power_state(pwr_state.bits.dev_power_state, dev_pwr_state_str);
-                /* Copy all retrieved information in a global buffer */
-                memcpy(cap->prop.sys_power_state,sys_pwr_state_str,sizeof(sys_pwr_state_str));
-                memcpy(cap->prop.dev_power_state,dev_pwr_state_str,sizeof(dev_pwr_state_str));
-            }
-
-            else {
-                error_string = decode_rv(ret);
-                orte_show_help("help-orcm-sensor-ipmi.txt", "ipmi-cmd-mc-fail",
-                           true, orte_process_info.nodename,
-                           orte_process_info.nodename, cap->node.bmc_ip,
-                           cap->node.user, cap->node.pasw, cap->node.auth,
-                           cap->node.priv, cap->node.ciph, error_string);
-            }
+        rlen = 256;
+        ret = ipmi_cmd_mc(GET_DEVICE_ID, idata, 0, rdata, &rlen, &ccode, fdebug);
+        if (0 == ret) {
+            memcpy(&devid.raw, rdata, sizeof(devid));
+
+            /*  Pack the BMC FW Rev */
+            sprintf(test,"%x", devid.bits.fw_rev_1&0x7F);
+            sprintf(test1,"%x", devid.bits.fw_rev_2&0xFF);
+            strcat(test,".");
+            strcat(test,test1);
+            strncpy(cap->prop.bmc_rev, test, sizeof(test));
+
+            /*  Pack the IPMI VER */
+            sprintf(test,"%x", devid.bits.ipmi_ver&0xF);
+            sprintf(test1,"%x", devid.bits.ipmi_ver&0xF0);
+            strcat(test,".");
+            strcat(test,test1);
+            strncpy(cap->prop.ipmi_ver, test, sizeof(test));
+
+            /*  Pack the Manufacturer ID */
+            sprintf(test,"%02x", devid.bits.manufacturer_id[1]);
+            sprintf(test1,"%02x", devid.bits.manufacturer_id[0]);
+            strcat(test,test1);
+            strncpy(cap->prop.man_id, test, sizeof(test));
+            host->have_devid = true;
+        } else {
+            *stage = IPMI_QUERY_CMD_MC;
+            rc = ret;
         }
+    }
 
-        else {
-            error_string = decode_rv(ret);
-            orte_show_help("help-orcm-sensor-ipmi.txt", "ipmi-set-lan-fail",
-                           true, orte_process_info.nodename,
-                           orte_process_info.nodename, cap->node.bmc_ip,
-                           cap->node.user, cap->node.pasw, cap->node.auth,
-                           cap->node.priv, cap->node.ciph, error_string);
+    if (cap->capability[SYS_POWER_STATE] & cap->capability[DEV_POWER_STATE]) {
+        memset(rdata,0xff,256);
+        memset(idata,0xff,4);
+        rlen = 256;
+        ret = ipmi_cmd_mc(GET_ACPI_POWER, idata, 0, rdata, &rlen, &ccode, fdebug);
+        if (0 == ret) {
+            memcpy(&pwr_state.raw, rdata, sizeof(pwr_state));
+            orcm_sensor_ipmi_get_system_power_state(pwr_state.bits.sys_power_state, cap->prop.sys_power_state);
+            orcm_sensor_ipmi_get_device_power_state(pwr_state.bits.dev_power_state, cap->prop.dev_power_state);
+        } else if (IPMI_QUERY_OK == *stage) {
+            *stage = IPMI_QUERY_CMD_MC;
+            rc = ret;
         }
     }
 
@@ -1947,78 +1979,50 @@ void orcm_sensor_ipmi_exec_call(ipmi_capsule_t *cap)
     * These files are not part of the libipmiutil and needs to be build along with the IPMI Plugin
     * No licensing issues since they are released under FreeBSD
     */ 
-    memset(rdata,0xff,256);
-    memset(idata,0xff,4);
-    ret = set_lan_options(cap->node.bmc_ip, cap->node.user, cap->node.pasw, cap->node.auth, cap->node.priv, cap->node.ciph, &addr, 16);
-    if(ret)
-    {
-        error_string = decode_rv(ret);
-        orte_show_help("help-orcm-sensor-ipmi.txt", "ipmi-set-lan-fail",
-                           true, orte_process_info.nodename,
-                           orte_process_info.nodename, cap->node.bmc_ip,
-                           cap->node.user, cap->node.pasw, cap->node.auth,
-                           cap->node.priv, cap->node.ciph, error_string);
-        return;
-    } else {
-        ret = get_sdr_cache(&sdrlist);
-        if (ret) {
-            error_string = decode_rv(ret);
-            orte_show_help("help-orcm-sensor-ipmi.txt", "ipmi-get-sdr-fail",
-                           true, orte_process_info.nodename,
-                           orte_process_info.nodename, cap->node.bmc_ip,
-                           cap->node.user, cap->node.pasw, cap->node.auth,
-                           cap->node.priv, cap->node.ciph, error_string);
-            return;
-        } else {
-            while(find_sdr_next(sdrbuf,sdrlist,id) == 0)
-            {
-                id = sdrbuf[0] + (sdrbuf[1] << 8); /* this SDR id */
-                if (sdrbuf[3] != 0x01) continue; /* full SDR */
-                strncpy(tag,(char *)&sdrbuf[48],16);
-                tag[16] = 0;
-                snum = sdrbuf[7];
-                ret = GetSensorReading(snum, sdrbuf, reading);
-                if (ret == 0)
-                {
-                    val = RawToFloat(reading[0], sdrbuf);
-                    typestr = get_unit_type( sdrbuf[20], sdrbuf[21], sdrbuf[22],0);
-                    if(orcm_sensor_ipmi_label_found(tag))
-                    {
-                        /*opal_output(0, "Found Sensor Label matching:%s",tag);*/
-                        /*  Pack the Sensor Metric */
-                        cap->prop.collection_metrics[sensor_count]=val;
-                        strncpy(cap->prop.collection_metrics_units[sensor_count],typestr,sizeof(cap->prop.collection_metrics_units[sensor_count]));
-                        strncpy(cap->prop.metric_label[sensor_count],tag,sizeof(cap->prop.metric_label[sensor_count]));
-                        sensor_count++;
-                    } else if(NULL!=mca_sensor_ipmi_component.sensor_group)
-                    {
-                        if(NULL!=strcasestr(tag, mca_sensor_ipmi_component.sensor_group))
-                        {
-                            /*opal_output(0, "Found Sensor Label '%s' matching group:%s", tag, mca_sensor_ipmi_component.sensor_group);*/
-                            /*  Pack the Sensor Metric */
-                            cap->prop.collection_metrics[sensor_count]=val;
-                            strncpy(cap->prop.collection_metrics_units[sensor_count],typestr,sizeof(cap->prop.collection_metrics_units[sensor_count]));
-                            strncpy(cap->prop.metric_label[sensor_count],tag,sizeof(cap->prop.metric_label[sensor_count]));
-                            sensor_count++;
-                        }
-                    }
-                    if (sensor_count == TOTAL_FLOAT_METRICS)
-                    {
-                        opal_output(0, "Max 'sensor' sampling reached for IPMI Plugin: %d",
-                            sensor_count);
-                        break;
-                    }
-                } else {
-                    val = 0;
-                    typestr = "na";
-                    /*opal_output(0, "%04x: get sensor %x reading ret = %d\n",id,snum,ret);*/
-                }
-                memset(sdrbuf,0,SDR_SZ);
+    if (0 < host->nsdrs && host->sdr_sweeps < mca_sensor_ipmi_component.sdr_refresh) {
+        /* read just the cached sensors */
+        host->sdr_sweeps++;
+        for (i=0; i < host->nsdrs; i++) {
+            memcpy(sdrbuf, host->sdrs + i * SDR_SZ, SDR_SZ);
+            if (0 == GetSensorReading(sdrbuf[7], sdrbuf, reading)) {
+                ipmi_keep_reading(cap, sdrbuf, reading);
             }
-            free_sdr_cache(sdrlist);
-            cap->prop.total_metrics = sensor_count;
         }
         ipmi_close();
-        /* End: gathering SDRs */
+        return rc;
+    }
+
+    if (0 != (ret = get_sdr_cache(&sdrlist))) {
+        ipmi_close();
+        *stage = IPMI_QUERY_GET_SDR;
+        return ret;
+    }
+    sdrs = (unsigned char*)malloc(TOTAL_FLOAT_METRICS * SDR_SZ);
+    host->nsdrs = 0;
+    while (find_sdr_next(sdrbuf,sdrlist,id) == 0) {
+        id = sdrbuf[0] + (sdrbuf[1] << 8); /* this SDR id */
+        if (sdrbuf[3] != 0x01) continue; /* full SDR */
+        if (0 == GetSensorReading(sdrbuf[7], sdrbuf, reading) &&
+            ipmi_keep_reading(cap, sdrbuf, reading) && NULL != sdrs) {
+            memcpy(sdrs + host->nsdrs * SDR_SZ, sdrbuf, SDR_SZ);
+            host->nsdrs++;
+        }
+        if (cap->prop.total_metrics == TOTAL_FLOAT_METRICS) {
+            opal_output(0, "Max 'sensor' sampling reached for IPMI Plugin: %d",
+                        cap->prop.total_metrics);
+            break;
+        }
+        memset(sdrbuf,0,SDR_SZ);
+    }
+    free_sdr_cache(sdrlist);
+    ipmi_close();
+    /* End: gathering SDRs */
+
+    if (NULL != host->sdrs) {
+        free(host->sdrs);
     }
+    host->sdrs = sdrs;
+    host->sdr_bytes = host->nsdrs * SDR_SZ;
+    host->sdr_sweeps = 0;
+    return rc;
 }
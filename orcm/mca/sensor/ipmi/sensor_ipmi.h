@@ -34,6 +34,11 @@ typedef struct {
     char *sensor_group;
     bool use_progress_thread;
     int sample_rate;
+    int sweep_timeout;      /* seconds a sweep may spend polling BMCs */
+    int bmc_timeout;        /* seconds before a BMC poll counts as failed */
+    int breaker_threshold;  /* consecutive failures that open a BMC's circuit */
+    int breaker_cooldown;   /* seconds an open circuit skips the BMC */
+    int sdr_refresh;        /* polls between rereads of a BMC's SDR repository */
 } orcm_sensor_ipmi_component_t;
 
 struct ipmi_properties *first_node;
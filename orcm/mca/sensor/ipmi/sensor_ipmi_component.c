@@ -133,6 +133,46 @@ static int ipmi_component_register(void)
                                            OPAL_INFO_LVL_9,
                                            MCA_BASE_VAR_SCOPE_READONLY,
                                            &mca_sensor_ipmi_component.sample_rate);
+
+    mca_sensor_ipmi_component.sweep_timeout = 30;
+    (void) mca_base_component_var_register(c, "sweep_timeout",
+                                           "Seconds an aggregator may spend polling its BMCs in one sample - the BMCs not reached are polled first in the next (0 = no limit)",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_sensor_ipmi_component.sweep_timeout);
+
+    mca_sensor_ipmi_component.bmc_timeout = 5;
+    (void) mca_base_component_var_register(c, "bmc_timeout",
+                                           "Seconds a BMC may take to answer a poll before the poll counts as failed (0 = no limit)",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_sensor_ipmi_component.bmc_timeout);
+
+    mca_sensor_ipmi_component.breaker_threshold = 3;
+    (void) mca_base_component_var_register(c, "breaker_threshold",
+                                           "Consecutive failed polls after which a BMC is skipped (0 = never skip)",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_sensor_ipmi_component.breaker_threshold);
+
+    mca_sensor_ipmi_component.breaker_cooldown = 300;
+    (void) mca_base_component_var_register(c, "breaker_cooldown",
+                                           "Seconds a failing BMC is skipped before it is tried again",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_sensor_ipmi_component.breaker_cooldown);
+
+    mca_sensor_ipmi_component.sdr_refresh = 60;
+    (void) mca_base_component_var_register(c, "sdr_refresh",
+                                           "Number of polls between rereads of a BMC's SDR repository (0 = reread on every poll)",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_sensor_ipmi_component.sdr_refresh);
   
     return ORCM_SUCCESS;
 }
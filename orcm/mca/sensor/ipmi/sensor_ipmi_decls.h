@@ -111,8 +111,26 @@ typedef struct {
 typedef struct _orcm_sensor_hosts_t {
     opal_list_item_t super;
     ipmi_capsule_t  capsule;
+    /* polling state kept by the aggregator */
+    bool fresh;             /* capsule.prop holds data from the latest sweep */
+    int failures;           /* consecutive failed polls */
+    time_t retry_at;        /* circuit open - skip this BMC until then */
+    bool have_devid;        /* bmc_rev, ipmi_ver and man_id are cached in prop */
+    int nsdrs;              /* cached full SDRs of the requested sensors */
+    size_t sdr_bytes;
+    int sdr_sweeps;         /* polls since the SDR cache was filled */
+    unsigned char *sdrs;
 }orcm_sensor_hosts_t;
 
+/* step at which a BMC query failed */
+typedef enum {
+    IPMI_QUERY_OK = 0,
+    IPMI_QUERY_SET_LAN,
+    IPMI_QUERY_CMD_MC,
+    IPMI_QUERY_GET_SDR,
+    IPMI_QUERY_TIMEOUT
+} ipmi_query_stage_t;
+
 // List of all properties to be scanned by the IPMI Plugin
 // This total number should correspond to the value TOTAL_PROPERTIES_PER_NODE!!
 typedef enum {
@@ -142,7 +160,8 @@ int orcm_sensor_ipmi_get_bmc_cred(orcm_sensor_hosts_t *host);
 int orcm_sensor_ipmi_found(char *nodename, opal_list_t *host_list);
 unsigned int orcm_sensor_ipmi_counthosts(void);
 int orcm_sensor_ipmi_addhost(char *nodename, char *host_ip, char *bmc_ip, opal_list_t * host_list);
-void orcm_sensor_ipmi_exec_call(ipmi_capsule_t *cap);
+int orcm_sensor_ipmi_query_host(orcm_sensor_hosts_t *host, int *stage);
+void orcm_sensor_ipmi_poll_hosts(opal_list_t *hosts);
 int orcm_sensor_ipmi_label_found(char * tag);
 int orcm_sensor_get_fru_inv(orcm_sensor_hosts_t *host);
 int orcm_sensor_get_fru_data(int id, long int fru_area, orcm_sensor_hosts_t *host);
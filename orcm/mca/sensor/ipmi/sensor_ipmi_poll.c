@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* BMC polling for the aggregator. ipmiutil keeps its LAN session in
+ * globals, so the library can neither be driven from several threads
+ * at once nor safely from a child forked by the threaded daemon, and
+ * the BMCs are polled one after the other from the sensor thread.
+ * That keeps a sweep at the sum of the BMCs' latencies, so it is
+ * bounded instead: a BMC that takes longer than bmc_timeout seconds
+ * to answer counts as failed, a BMC that keeps failing has its
+ * circuit opened and is left out of the sweeps for breaker_cooldown
+ * seconds, and a sweep stops starting new polls after sweep_timeout
+ * seconds - the BMCs it did not reach are polled first next time.
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#include <string.h>
+#include <time.h>
+
+#define HAVE_HWLOC_DIFF  // protect the hwloc diff.h file from ipmicmd.h conflict
+#include "orcm/mca/sensor/base/base.h"
+#include "orcm/mca/sensor/base/sensor_private.h"
+#include "orcm/runtime/orcm_globals.h"
+
+#include "orte/util/show_help.h"
+#include "orte/mca/errmgr/errmgr.h"
+
+#include "sensor_ipmi.h"
+
+/* where the next sweep starts, so a sweep cut short by
+ * sweep_timeout picks up with the BMCs it did not reach */
+static int sweep_next = 0;
+
+static void report_failure(orcm_sensor_hosts_t *host, int rc, int stage)
+{
+    ipmi_capsule_t *cap = &host->capsule;
+    char *error_string;
+
+    if (IPMI_QUERY_TIMEOUT == stage) {
+        orte_show_help("help-orcm-sensor-ipmi.txt", "ipmi-bmc-timeout",
+                       true, orte_process_info.nodename, cap->node.name,
+                       cap->node.bmc_ip, mca_sensor_ipmi_component.bmc_timeout);
+        return;
+    }
+    error_string = decode_rv(rc);
+    orte_show_help("help-orcm-sensor-ipmi.txt",
+                   (IPMI_QUERY_SET_LAN == stage) ? "ipmi-set-lan-fail" :
+                   (IPMI_QUERY_GET_SDR == stage) ? "ipmi-get-sdr-fail" : "ipmi-cmd-mc-fail",
+                   true, orte_process_info.nodename,
+                   cap->node.name, cap->node.bmc_ip,
+                   cap->node.user, cap->node.pasw, cap->node.auth,
+                   cap->node.priv, cap->node.ciph, error_string);
+}
+
+/* update the host's circuit with the outcome of a poll */
+static void poll_done(orcm_sensor_hosts_t *host, int rc, int stage)
+{
+    if (IPMI_QUERY_SET_LAN != stage && IPMI_QUERY_GET_SDR != stage &&
+        IPMI_QUERY_TIMEOUT != stage) {
+        /* the BMC answered, even if one of the commands failed */
+        host->fresh = true;
+        if (mca_sensor_ipmi_component.breaker_threshold <= host->failures &&
+            0 < mca_sensor_ipmi_component.breaker_threshold) {
+            opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
+                                "%s sensor:ipmi: BMC %s of %s is answering again",
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                                host->capsule.node.bmc_ip, host->capsule.node.name);
+        }
+        host->failures = 0;
+        if (IPMI_QUERY_OK != stage) {
+            report_failure(host, rc, stage);
+        }
+        return;
+    }
+
+    host->fresh = false;
+    host->failures++;
+    if (0 < mca_sensor_ipmi_component.breaker_threshold &&
+        mca_sensor_ipmi_component.breaker_threshold <= host->failures) {
+        /* open (or re-open, after a failed trial poll) the circuit */
+        host->retry_at = time(NULL) + mca_sensor_ipmi_component.breaker_cooldown;
+        if (mca_sensor_ipmi_component.breaker_threshold == host->failures) {
+            orte_show_help("help-orcm-sensor-ipmi.txt", "ipmi-breaker-open",
+                           true, orte_process_info.nodename, host->capsule.node.name,
+                           host->capsule.node.bmc_ip, host->failures,
+                           mca_sensor_ipmi_component.breaker_cooldown);
+        }
+        return;
+    }
+    report_failure(host, rc, stage);
+}
+
+/* the BMC's circuit is open - leave it out of this sweep */
+static bool poll_skip(orcm_sensor_hosts_t *host, time_t now)
+{
+    return (0 < mca_sensor_ipmi_component.breaker_threshold &&
+            mca_sensor_ipmi_component.breaker_threshold <= host->failures &&
+            now < host->retry_at);
+}
+
+void orcm_sensor_ipmi_poll_hosts(opal_list_t *hosts)
+{
+    orcm_sensor_hosts_t *host, **todo;
+    int ntodo = 0, i, n, rc, stage;
+    time_t now = time(NULL), start, deadline;
+
+    todo = (orcm_sensor_hosts_t**)malloc(opal_list_get_size(hosts) * sizeof(orcm_sensor_hosts_t*));
+    if (NULL == todo) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+        return;
+    }
+    OPAL_LIST_FOREACH(host, hosts, orcm_sensor_hosts_t) {
+        host->fresh = false;
+        if (poll_skip(host, now)) {
+            opal_output_verbose(5, orcm_sensor_base_framework.framework_output,
+                                "%s sensor:ipmi: skipping BMC %s of %s for %d more sec",
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), host->capsule.node.bmc_ip,
+                                host->capsule.node.name, (int)(host->retry_at - now));
+            continue;
+        }
+        todo[ntodo++] = host;
+    }
+    if (0 == ntodo) {
+        free(todo);
+        return;
+    }
+
+    deadline = now + mca_sensor_ipmi_component.sweep_timeout;
+    for (n=0; n < ntodo; n++) {
+        i = (sweep_next + n) % ntodo;
+        if (0 < n && 0 < mca_sensor_ipmi_component.sweep_timeout &&
+            deadline <= time(NULL)) {
+            opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
+                                "%s sensor:ipmi: sweep out of time - %d of %d BMCs left for the next one",
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), ntodo - n, ntodo);
+            break;
+        }
+        start = time(NULL);
+        rc = orcm_sensor_ipmi_query_host(todo[i], &stage);
+        if (0 < mca_sensor_ipmi_component.bmc_timeout &&
+            mca_sensor_ipmi_component.bmc_timeout < time(NULL) - start) {
+            /* too slow to be worth waiting for - the breaker takes it
+             * out of the sweeps if it stays that way */
+            stage = IPMI_QUERY_TIMEOUT;
+        }
+        poll_done(todo[i], rc, stage);
+    }
+    sweep_next = (sweep_next + n) % ntodo;
+    free(todo);
+}
@@ -83,6 +83,7 @@ int init_done=0;
 
 static orcm_sensor_sampler_t *nodepower_sampler = NULL;
 static orcm_sensor_nodepower_t orcm_sensor_nodepower;
+static orcm_sensor_schema_t *nodepower_schema = NULL;
 node_power_data _node_power, node_power;
 
 /*
@@ -180,6 +181,22 @@ static int init(void)
 
 static void finalize(void)
 {
+    if (NULL != nodepower_schema) {
+        OBJ_RELEASE(nodepower_schema);
+    }
+}
+
+/* build the sample schema - a single reading, the node's power */
+static int nodepower_build_schema(void)
+{
+    char *label = "nodepower", *unit = "W";
+
+    nodepower_schema = orcm_sensor_base_schema_register("nodepower", 1,
+                                                        &label, &unit, OPAL_FLOAT);
+    if (NULL == nodepower_schema) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    return ORCM_SUCCESS;
 }
 
 /*
@@ -308,7 +325,6 @@ static void collect_sample(orcm_sensor_sampler_t *sampler)
     int ret;
     char *freq;
     opal_buffer_t data, *bptr;
-    bool packed;
 
     unsigned long val1, val2;
     float node_power_cur;
@@ -406,54 +422,45 @@ static void collect_sample(orcm_sensor_sampler_t *sampler)
     _readein.readein_b_accu_prev=_readein.readein_b_accu_curr;
     _readein.readein_b_cnt_prev=_readein.readein_b_cnt_curr;
 
+    if (NULL == nodepower_schema &&
+        ORCM_SUCCESS != (ret = nodepower_build_schema())) {
+        ORTE_ERROR_LOG(ret);
+        return;
+    }
+    if (_readein.ipmi_calls <=2){
+        node_power_cur=0.0;
+    } else{
+        node_power_cur=(float)(node_power.node_power.cur);
+    }
+
     /* prep to store the results */
     OBJ_CONSTRUCT(&data, opal_buffer_t);
-    packed = false;
 
     /* pack our name */
     freq = strdup("nodepower");
     if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &freq, 1, OPAL_STRING))) {
         ORTE_ERROR_LOG(ret);
         OBJ_DESTRUCT(&data);
+        free(freq);
         return;
     }
     free(freq);
 
-    /* store our hostname */
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &orte_process_info.nodename, 1, OPAL_STRING))) {
+    /* pack the schema-encoded sample */
+    if (ORCM_SUCCESS != (ret = orcm_sensor_base_pack_sample(&data, nodepower_schema,
+                                                            &_tv.tv_curr, &node_power_cur))) {
         ORTE_ERROR_LOG(ret);
         OBJ_DESTRUCT(&data);
         return;
     }
 
-    /* get the sample time */
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &(_tv.tv_curr), 1, OPAL_TIMEVAL))) {
-        ORTE_ERROR_LOG(ret);
-        OBJ_DESTRUCT(&data);
-        return;
-    }
-
-    if (_readein.ipmi_calls <=2){
-        node_power_cur=0.0;
-    } else{
-        node_power_cur=(float)(node_power.node_power.cur);
-    }
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &node_power_cur, 1, OPAL_FLOAT))) {
+    /* xfer the data for transmission */
+    bptr = &data;
+    if (OPAL_SUCCESS != (ret = opal_dss.pack(&sampler->bucket, &bptr, 1, OPAL_BUFFER))) {
         ORTE_ERROR_LOG(ret);
         OBJ_DESTRUCT(&data);
         return;
     }
-    packed=true;
-
-    /* xfer the data for transmission */
-    if (packed) {
-        bptr = &data;
-        if (OPAL_SUCCESS != (ret = opal_dss.pack(&sampler->bucket, &bptr, 1, OPAL_BUFFER))) {
-            ORTE_ERROR_LOG(ret);
-            OBJ_DESTRUCT(&data);
-            return;
-        }
-    }
     OBJ_DESTRUCT(&data);
 }
 
@@ -472,44 +479,36 @@ static void mycleanup(int dbhandle, int status,
 static void nodepower_log(opal_buffer_t *sample)
 {
     char *hostname=NULL;
+    orcm_sensor_schema_t *schema;
     int rc;
-    int32_t n;
     opal_list_t *vals;
     opal_value_t *kv;
     int sensor_not_avail=0;
     struct timeval tv_curr;
 
-    float node_power_cur;
+    float *node_power_cur;
     char time_str[40];
 
     if (!log_enabled) {
         return;
     }
 
-    /* unpack the host this came from */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &hostname, &n, OPAL_STRING))) {
-        ORTE_ERROR_LOG(rc);
-        return;
-    }
-
-    /* unpack timestamp */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &tv_curr, &n, OPAL_TIMEVAL))) {
-        ORTE_ERROR_LOG(rc);
+    /* unpack the schema-encoded sample */
+    if (ORCM_SUCCESS != (rc = orcm_sensor_base_unpack_sample(sample, &hostname, &schema,
+                                                             &tv_curr, (void**)&node_power_cur))) {
+        if (ORCM_ERR_NOT_FOUND != rc) {
+            ORTE_ERROR_LOG(rc);
+        }
         return;
     }
-
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &node_power_cur, &n, OPAL_FLOAT))) {
-        ORTE_ERROR_LOG(rc);
-        return;
+    if (1 != schema->nmetrics) {
+        ORTE_ERROR_LOG(ORCM_ERR_BAD_PARAM);
+        goto cleanup;
     }
 
     opal_output_verbose(3, orcm_sensor_base_framework.framework_output,
                         "%s Received freq log from host %s",
-                        ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                        (NULL == hostname) ? "NULL" : hostname);
+                        ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), hostname);
 
     /* xfr to storage */
     vals = OBJ_NEW(opal_list_t);
@@ -532,41 +531,36 @@ static void nodepower_log(opal_buffer_t *sample)
     kv = OBJ_NEW(opal_value_t);
     kv->key = strdup("hostname");
     kv->type = OPAL_STRING;
-    if (hostname==NULL){
-      kv->data.string = strdup("NULL");
-    } else {
-      kv->data.string = strdup(hostname);
-    }
+    kv->data.string = strdup(hostname);
     opal_list_append(vals, &kv->super);
 
-    kv = OBJ_NEW(opal_value_t);
-    kv->key=strdup("nodepower:W");
-    kv->type=OPAL_FLOAT;
-    kv->data.fval=node_power_cur;
-    if ((node_power_cur==(float)(-1.0)) || (node_power_cur==(float)(0.0))){
+    if ((node_power_cur[0]==(float)(-1.0)) || (node_power_cur[0]==(float)(0.0))){
         sensor_not_avail=1;
     } else {
+        kv = OBJ_NEW(opal_value_t);
+        asprintf(&kv->key, "%s:%s", schema->labels[0],
+                 (NULL == schema->units[0]) ? "" : schema->units[0]);
+        kv->type=OPAL_FLOAT;
+        kv->data.fval=node_power_cur[0];
         opal_list_append(vals, &kv->super);
     }
 
-/*
- *
-don't send as a string. send it as a time_val.
-take advantage of existing time_val field of opal_value_t
- *
- */
+    /* hand the values to any analytics subscribed to them */
+    orcm_sensor_base_publish("nodepower", vals);
+
     /* store it */
-    if (0 <= orcm_sensor_base.dbhandle) {
-        if (!sensor_not_avail){
-            orcm_db.store(orcm_sensor_base.dbhandle, "nodepower", vals, mycleanup, NULL);
-        }
+    if (0 <= orcm_sensor_base.dbhandle && !sensor_not_avail) {
+        orcm_db.store(orcm_sensor_base.dbhandle, "nodepower", vals, mycleanup, NULL);
     } else {
         OPAL_LIST_RELEASE(vals);
     }
 
-    if (NULL != hostname) {
-        free(hostname);
+ cleanup:
+    OBJ_RELEASE(schema);
+    if (NULL != node_power_cur) {
+        free(node_power_cur);
     }
+    free(hostname);
 }
 
 static void nodepower_set_sample_rate(int sample_rate)
@@ -22,6 +22,9 @@
 #ifdef HAVE_TIME_H
 #include <time.h>
 #endif
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
 #ifdef HAVE_DIRENT_H
 #include <dirent.h>
 #endif  /* HAVE_DIRENT_H */
@@ -37,6 +40,7 @@
 #include "opal_stdint.h"
 #include "opal/class/opal_list.h"
 #include "opal/dss/dss.h"
+#include "opal/util/argv.h"
 #include "opal/util/os_path.h"
 #include "opal/util/output.h"
 
@@ -103,6 +107,7 @@ OBJ_CLASS_INSTANCE(corepwr_tracker_t,
 
 static bool log_enabled = true;
 static opal_list_t tracking;
+static orcm_sensor_schema_t *pwr_schema = NULL;
 
 static int read_msr(int fd, long long *value, int offset)
 {
@@ -214,6 +219,9 @@ static int init(void)
 
 static void finalize(void)
 {
+    if (NULL != pwr_schema) {
+        OBJ_RELEASE(pwr_schema);
+    }
     OPAL_LIST_DESTRUCT(&tracking);
 }
 
@@ -231,22 +239,43 @@ static void stop(orte_jobid_t jobid)
     return;
 }
 
+/* (re)build the sample schema from the current tracker list */
+static int pwr_build_schema(void)
+{
+    corepwr_tracker_t *trk;
+    char **labels = NULL, *label;
+    int32_t ncores = 0;
+
+    if (NULL != pwr_schema) {
+        OBJ_RELEASE(pwr_schema);
+    }
+    OPAL_LIST_FOREACH(trk, &tracking, corepwr_tracker_t) {
+        asprintf(&label, "core%d", trk->core);
+        opal_argv_append(&ncores, &labels, label);
+        free(label);
+    }
+    pwr_schema = orcm_sensor_base_schema_register("pwr", ncores,
+                                                  labels, NULL, OPAL_FLOAT);
+    opal_argv_free(labels);
+    if (NULL == pwr_schema) {
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    return ORCM_SUCCESS;
+}
+
 static void pwr_sample(orcm_sensor_sampler_t *sampler)
 {
     corepwr_tracker_t *trk, *nxt;
     opal_buffer_t data, *bptr;
     int32_t ncores;
-    time_t now;
-    char time_str[40];
-    char *timestamp_str;
+    struct timeval now;
     long long value;
     int fd, ret;
-    float power;
+    float *power;
     char *temp;
-    bool packed;
-    struct tm *sample_time;
+    bool changed = false;
 
-    if (0 == opal_list_get_size(&tracking) && !mca_sensor_pwr_component.test) {
+    if (0 == opal_list_get_size(&tracking)) {
         return;
     }
 
@@ -254,97 +283,90 @@ static void pwr_sample(orcm_sensor_sampler_t *sampler)
                         "%s sampling power",
                         ORTE_NAME_PRINT(ORTE_PROC_MY_NAME));
 
+    /* get the sample time */
+    gettimeofday(&now, NULL);
+
+    power = (float*)malloc(opal_list_get_size(&tracking) * sizeof(float));
+    if (NULL == power) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+        return;
+    }
+    ncores = 0;
+    OPAL_LIST_FOREACH_SAFE(trk, nxt, &tracking, corepwr_tracker_t) {
+        if (mca_sensor_pwr_component.test) {
+            power[ncores++] = 1.2345;
+            continue;
+        }
+        if (0 >= (fd = open(trk->file, O_RDONLY))) {
+            /* disable this one - cannot read the file */
+            opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
+                                "%s access denied to pwr file %s - removing it",
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                                trk->file);
+            opal_list_remove_item(&tracking, &trk->super);
+            OBJ_RELEASE(trk);
+            changed = true;
+            continue;
+        }
+        if (ORCM_SUCCESS != read_msr(fd, &value, MSR_PKG_POWER_INFO)) {
+            /* disable this one - cannot read the file */
+            opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
+                                "%s failed to read pwr file %s - removing it",
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                                trk->file);
+            opal_list_remove_item(&tracking, &trk->super);
+            OBJ_RELEASE(trk);
+            close(fd);
+            changed = true;
+            continue;
+        }
+        power[ncores++] = trk->units * (double)(value & 0x7fff);
+        close(fd);
+    }
+
+    /* the set of cores changed, so the old schema no longer applies */
+    if (changed || NULL == pwr_schema) {
+        if (ORCM_SUCCESS != (ret = pwr_build_schema())) {
+            ORTE_ERROR_LOG(ret);
+            free(power);
+            return;
+        }
+    }
+    if (0 == ncores) {
+        free(power);
+        return;
+    }
+
     /* prep to store the results */
     OBJ_CONSTRUCT(&data, opal_buffer_t);
-    packed = false;
 
     /* pack our name */
     temp = strdup("pwr");
     if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &temp, 1, OPAL_STRING))) {
         ORTE_ERROR_LOG(ret);
         OBJ_DESTRUCT(&data);
+        free(temp);
+        free(power);
         return;
     }
     free(temp);
 
-    /* store our hostname */
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &orte_process_info.nodename, 1, OPAL_STRING))) {
-        ORTE_ERROR_LOG(ret);
-        OBJ_DESTRUCT(&data);
-        return;
-    }
-
-    /* store the number of cores */
-    ncores = (int32_t)opal_list_get_size(&tracking);
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &ncores, 1, OPAL_INT32))) {
+    /* pack the schema-encoded sample */
+    ret = orcm_sensor_base_pack_sample(&data, pwr_schema, &now, power);
+    free(power);
+    if (ORCM_SUCCESS != ret) {
         ORTE_ERROR_LOG(ret);
         OBJ_DESTRUCT(&data);
         return;
     }
 
-    /* get the sample time */
-    now = time(NULL);
-    /* pass the time along as a simple string */
-    sample_time = localtime(&now);
-    if (NULL == sample_time) {
-        ORTE_ERROR_LOG(OPAL_ERR_BAD_PARAM);
-        return;
-    }
-    strftime(time_str, sizeof(time_str), "%F %T%z", sample_time);
-    asprintf(&timestamp_str, "%s", time_str);
-    if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &timestamp_str, 1, OPAL_STRING))) {
+    /* xfer the data for transmission */
+    bptr = &data;
+    if (OPAL_SUCCESS != (ret = opal_dss.pack(&sampler->bucket, &bptr, 1, OPAL_BUFFER))) {
         ORTE_ERROR_LOG(ret);
         OBJ_DESTRUCT(&data);
-        free(timestamp_str);
         return;
     }
-    free(timestamp_str);
-
-    OPAL_LIST_FOREACH_SAFE(trk, nxt, &tracking, corepwr_tracker_t) {
-        if (mca_sensor_pwr_component.test) {
-            power = 1.2345;
-        } else {
-            if (0 >= (fd = open(trk->file, O_RDONLY))) {
-                /* disable this one - cannot read the file */
-                opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
-                                    "%s access denied to pwr file %s - removing it",
-                                    ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                    trk->file);
-                opal_list_remove_item(&tracking, &trk->super);
-                OBJ_RELEASE(trk);
-                continue;
-            }
-            if (ORCM_SUCCESS != read_msr(fd, &value, MSR_PKG_POWER_INFO)) {
-                /* disable this one - cannot read the file */
-                opal_output_verbose(2, orcm_sensor_base_framework.framework_output,
-                                    "%s failed to read pwr file %s - removing it",
-                                    ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                    trk->file);
-                opal_list_remove_item(&tracking, &trk->super);
-                OBJ_RELEASE(trk);
-                close(fd);
-                continue;
-            }
-            power = trk->units * (double)(value & 0x7fff);
-            close(fd);
-        }
-        if (OPAL_SUCCESS != (ret = opal_dss.pack(&data, &power, 1, OPAL_FLOAT))) {
-            ORTE_ERROR_LOG(ret);
-            OBJ_DESTRUCT(&data);
-            return;
-        }
-        packed = true;
-    }
-
-    /* xfer the data for transmission */
-    if (packed) {
-        bptr = &data;
-        if (OPAL_SUCCESS != (ret = opal_dss.pack(&sampler->bucket, &bptr, 1, OPAL_BUFFER))) {
-            ORTE_ERROR_LOG(ret);
-            OBJ_DESTRUCT(&data);
-            return;
-        }
-    }
     OBJ_DESTRUCT(&data);
 }
 
@@ -360,82 +382,60 @@ static void mycleanup(int dbhandle, int status,
 static void pwr_log(opal_buffer_t *sample)
 {
     char *hostname=NULL;
-    char *sampletime;
+    orcm_sensor_schema_t *schema;
+    struct timeval sampletime;
+    float *values;
     int rc;
-    int32_t n, ncores;
     opal_list_t *vals;
     opal_value_t *kv;
-    float fval;
-    int i;
+    int32_t i;
 
     if (!log_enabled) {
         return;
     }
 
-    /* unpack the host this came from */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &hostname, &n, OPAL_STRING))) {
-        ORTE_ERROR_LOG(rc);
-        return;
-    }
-    /* and the number of cores on that host */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &ncores, &n, OPAL_INT32))) {
-        ORTE_ERROR_LOG(rc);
-        return;
-    }
-
-    /* sample time */
-    n=1;
-    if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &sampletime, &n, OPAL_STRING))) {
-        ORTE_ERROR_LOG(rc);
+    /* unpack the schema-encoded sample */
+    if (ORCM_SUCCESS != (rc = orcm_sensor_base_unpack_sample(sample, &hostname, &schema,
+                                                             &sampletime, (void**)&values))) {
+        if (ORCM_ERR_NOT_FOUND != rc) {
+            ORTE_ERROR_LOG(rc);
+        }
         return;
     }
 
     opal_output_verbose(3, orcm_sensor_base_framework.framework_output,
                         "%s Received power log from host %s with %d cores",
                         ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                        (NULL == hostname) ? "NULL" : hostname, ncores);
+                        hostname, schema->nmetrics);
 
     /* xfr to storage */
     vals = OBJ_NEW(opal_list_t);
 
     /* load the sample time at the start */
-    if (NULL == sampletime) {
-        ORTE_ERROR_LOG(OPAL_ERR_BAD_PARAM);
-        return;
-    }
     kv = OBJ_NEW(opal_value_t);
     kv->key = strdup("ctime");
-    kv->type = OPAL_STRING;
-    kv->data.string = strdup(sampletime);
-    free(sampletime);
+    kv->type = OPAL_TIMEVAL;
+    kv->data.tv = sampletime;
     opal_list_append(vals, &kv->super);
 
     /* load the hostname */
-    if (NULL == hostname) {
-        ORTE_ERROR_LOG(OPAL_ERR_BAD_PARAM);
-        return;
-    }
     kv = OBJ_NEW(opal_value_t);
     kv->key = strdup("hostname");
     kv->type = OPAL_STRING;
     kv->data.string = strdup(hostname);
     opal_list_append(vals, &kv->super);
 
-    for (i=0; i < ncores; i++) {
+    for (i=0; i < schema->nmetrics; i++) {
         kv = OBJ_NEW(opal_value_t);
-        asprintf(&kv->key, "core%d", i);
+        kv->key = strdup(schema->labels[i]);
         kv->type = OPAL_FLOAT;
-        n=1;
-        if (OPAL_SUCCESS != (rc = opal_dss.unpack(sample, &fval, &n, OPAL_FLOAT))) {
-            ORTE_ERROR_LOG(rc);
-            goto cleanup;
-        }
-        kv->data.fval = fval;
+        kv->data.fval = values[i];
         opal_list_append(vals, &kv->super);
     }
 
+    /* hand the values to any analytics subscribed to them */
+    orcm_sensor_base_publish("pwr", vals);
+
     /* store it */
     if (0 <= orcm_sensor_base.dbhandle) {
         /* the database framework will release the values */
@@ -445,11 +445,11 @@ static void pwr_log(opal_buffer_t *sample)
         OPAL_LIST_RELEASE(vals);
     }
 
- cleanup:
-    if (NULL != hostname) {
-        free(hostname);
+    OBJ_RELEASE(schema);
+    if (NULL != values) {
+        free(values);
     }
-
+    free(hostname);
 }
 
 
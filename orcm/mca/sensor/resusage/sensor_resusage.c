@@ -476,6 +476,9 @@ static void res_log(opal_buffer_t *sample)
         kv->data.fval = nst->la15;
         opal_list_append(vals, &kv->super);
 
+        /* hand the values to any analytics subscribed to them */
+        orcm_sensor_base_publish("nodestats", vals);
+
         /* store it */
         if (0 <= orcm_sensor_base.dbhandle) {
             orcm_db.store(orcm_sensor_base.dbhandle, "nodestats", vals, mycleanup, NULL);
@@ -1697,6 +1697,9 @@ static void sigar_log(opal_buffer_t *sample)
         opal_list_append(vals, &kv->super);
 
     }
+    /* hand the values to any analytics subscribed to them */
+    orcm_sensor_base_publish("sigar", vals);
+
     /* store it */
     if ((0 <= orcm_sensor_base.dbhandle) & (true == data_avail)) {
         orcm_db.store(orcm_sensor_base.dbhandle, "sigar", vals, mycleanup, NULL);
@@ -1814,6 +1817,9 @@ static void sigar_log(opal_buffer_t *sample)
         kv->data.int64 = int64;
         opal_list_append(vals, &kv->super);
 
+        /* hand the values to any analytics subscribed to them */
+        orcm_sensor_base_publish("procstat", vals);
+
         /* store it */
         if (0 <= orcm_sensor_base.dbhandle) {
             orcm_db.store(orcm_sensor_base.dbhandle, "procstat", vals, mycleanup, NULL);
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Measure opal_dss pack and unpack of 16, 32 and 64-bit integer
+ * arrays with each byte order conversion kernel the host supports,
+ * and with the copy used in homogeneous mode. Every round trip is
+ * checked against the input.
+ *
+ *   dss_bench [number of values ...]
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "opal/dss/dss.h"
+#include "opal/dss/dss_internal.h"
+#include "orte/mca/errmgr/errmgr.h"
+
+#include "orcm/runtime/runtime.h"
+
+#define NUM_REPS 20
+
+/* a multiple of every vector width, and an odd count so the
+ * scalar tail of each kernel is round trip checked as well */
+static const int32_t counts[] = {1000000, 1000003, -1};
+
+static float elapsed(struct timeval *start, struct timeval *end)
+{
+    return ((end->tv_sec - start->tv_sec)*1000000 + end->tv_usec - start->tv_usec) / 1000000.0;
+}
+
+static int run(const char *kernel, opal_data_type_t type, size_t width,
+               void *src, void *dst, int32_t nvals)
+{
+    opal_buffer_t buf;
+    struct timeval tv_start, tv_mid, tv_end;
+    float tpack = 0, tunpack = 0;
+    int32_t n;
+    int r, rc;
+
+    for (r=0; r < NUM_REPS; r++) {
+        OBJ_CONSTRUCT(&buf, opal_buffer_t);
+        gettimeofday(&tv_start, 0);
+        if (OPAL_SUCCESS != (rc = opal_dss.pack(&buf, src, nvals, type))) {
+            ORTE_ERROR_LOG(rc);
+            OBJ_DESTRUCT(&buf);
+            return rc;
+        }
+        gettimeofday(&tv_mid, 0);
+        n = nvals;
+        if (OPAL_SUCCESS != (rc = opal_dss.unpack(&buf, dst, &n, type))) {
+            ORTE_ERROR_LOG(rc);
+            OBJ_DESTRUCT(&buf);
+            return rc;
+        }
+        gettimeofday(&tv_end, 0);
+        OBJ_DESTRUCT(&buf);
+        tpack += elapsed(&tv_start, &tv_mid);
+        tunpack += elapsed(&tv_mid, &tv_end);
+    }
+    if (n != nvals || 0 != memcmp(src, dst, nvals * width)) {
+        fprintf(stderr, "%s: int%d round trip MISMATCH\n", kernel, (int)(8 * width));
+        return ORCM_ERROR;
+    }
+    fprintf(stderr, "%-7s int%-3d pack %8.1f MB/s  unpack %8.1f MB/s\n",
+            kernel, (int)(8 * width),
+            (NUM_REPS * nvals * width) / tpack / 1.0e6,
+            (NUM_REPS * nvals * width) / tunpack / 1.0e6);
+    return ORCM_SUCCESS;
+}
+
+static int run_count(int32_t nvals)
+{
+    const char *kernels[] = {"scalar", "ssse3", "avx2", "copy", NULL};
+    const opal_data_type_t types[] = {OPAL_INT16, OPAL_INT32, OPAL_INT64};
+    const size_t widths[] = {2, 4, 8};
+    unsigned char *src, *dst;
+    size_t i;
+    int k, t, rc;
+
+    src = (unsigned char*)malloc(nvals * sizeof(uint64_t));
+    dst = (unsigned char*)malloc(nvals * sizeof(uint64_t));
+    if (NULL == src || NULL == dst) {
+        ORTE_ERROR_LOG(ORCM_ERR_OUT_OF_RESOURCE);
+        free(src);
+        free(dst);
+        return ORCM_ERR_OUT_OF_RESOURCE;
+    }
+    for (i=0; i < nvals * sizeof(uint64_t); i++) {
+        src[i] = (unsigned char)(i * 131 + 7);
+    }
+    fprintf(stderr, "%d values, %d round trips each\n", nvals, NUM_REPS);
+
+    rc = ORCM_SUCCESS;
+    for (k=0; NULL != kernels[k] && ORCM_SUCCESS == rc; k++) {
+        if (OPAL_SUCCESS != opal_dss_swap_select(kernels[k])) {
+            fprintf(stderr, "%-7s not supported on this host\n", kernels[k]);
+            continue;
+        }
+        for (t=0; t < 3 && ORCM_SUCCESS == rc; t++) {
+            rc = run(kernels[k], types[t], widths[t], src, dst, nvals);
+        }
+    }
+
+    free(src);
+    free(dst);
+    return rc;
+}
+
+int main(int argc, char **argv)
+{
+    int i, rc;
+
+    if (ORCM_SUCCESS != (rc = orcm_init(ORCM_TOOL))) {
+        fprintf(stderr, "Failed orcm_init\n");
+        exit(1);
+    }
+
+    if (1 < argc) {
+        for (i = 1; i < argc && ORCM_SUCCESS == rc; i++) {
+            rc = run_count((int32_t)strtol(argv[i], NULL, 10));
+        }
+    } else {
+        for (i = 0; 0 < counts[i] && ORCM_SUCCESS == rc; i++) {
+            rc = run_count(counts[i]);
+        }
+    }
+
+    /* put back what the DSS chose at open */
+    opal_dss_swap_select(NULL);
+    orcm_finalize();
+    return (ORCM_SUCCESS == rc) ? 0 : 1;
+}
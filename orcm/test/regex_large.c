@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014      Intel, Inc. All rights reserved.
+ * Copyright (c) 2014-2015 Intel, Inc. All rights reserved.
  * $COPYRIGHT$
  *
  * Additional copyrights may follow
@@ -7,59 +7,176 @@
  * $HEADER$
  */
 
+/* Time the node regex and nodeset operations on large clusters:
+ * compress a list of node names into a regex, expand it again,
+ * look names up in the resulting nodeset and combine two sets,
+ * for each cluster size given - 10k, 100k and 1M nodes by default.
+ * Each name list has a couple of holes and a few login nodes in
+ * it, so it is not a single range.
+ *
+ *   regex_large [number of nodes ...]
+ */
+
 #include "orcm_config.h"
+#include "orcm/constants.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
+#include <sys/time.h>
 
+#include "opal/util/argv.h"
 #include "orte/util/proc_info.h"
 #include "orte/mca/errmgr/errmgr.h"
+#include "orte/util/regex.h"
 
-#include "orcm/util/regex.h"
 #include "orcm/runtime/runtime.h"
 
-int main(int argc, char **argv)
+#define LOOKUPS 100000
+
+static const long sizes[] = {10000, 100000, 1000000, -1};
+
+static float elapsed(struct timeval *start, struct timeval *end)
+{
+    return ((end->tv_sec - start->tv_sec)*1000000 + end->tv_usec - start->tv_usec) / 1000000.0;
+}
+
+static char* node_list(long numnodes)
+{
+    char *nodes, *p;
+    long i;
+
+    /* "nodeNNNNNNN," at most, plus the login nodes */
+    if (NULL == (nodes = (char*)malloc(numnodes * 13 + 64))) {
+        return NULL;
+    }
+    p = nodes;
+    for (i = 1; i <= numnodes; i++) {
+        if (i == numnodes / 3 || i == 2 * numnodes / 3) {
+            continue;
+        }
+        p += sprintf(p, "node%07ld,", i);
+    }
+    strcpy(p, "login1,login2,login3");
+    return nodes;
+}
+
+static int run(long numnodes)
 {
+    struct timeval tv_start, tv_end;
+    orte_nodeset_t set, other;
+    char *nodes, *regex = NULL, **names = NULL, name[32];
+    long i, hits = 0;
     int rc;
-    char *regex;
-    char *nodes=NULL;
-    long numnodes, i;
-    struct timeval tv_start, tv_start2, tv_end;
-    float elapsed=0;
-    
-    if (argc < 1 || NULL == argv[1]) {
-        fprintf(stderr, "usage: regex_large <number of nodes>\n");
-        return 1;
+
+    if (NULL == (nodes = node_list(numnodes))) {
+        ORTE_ERROR_LOG(ORTE_ERR_OUT_OF_RESOURCE);
+        return ORTE_ERR_OUT_OF_RESOURCE;
     }
+    OBJ_CONSTRUCT(&set, orte_nodeset_t);
+    OBJ_CONSTRUCT(&other, orte_nodeset_t);
+    fprintf(stderr, "%ld nodes\n", numnodes);
 
     gettimeofday(&tv_start, 0);
+    rc = orte_regex_create(nodes, &regex);
+    gettimeofday(&tv_end, 0);
+    if (ORTE_SUCCESS != rc) {
+        ORTE_ERROR_LOG(rc);
+        goto cleanup;
+    }
+    fprintf(stderr, "  create     %10.6f sec  %s\n", elapsed(&tv_start, &tv_end),
+            (80 < strlen(regex)) ? "" : regex);
 
-    numnodes = strtol(argv[1], '\0', 10);
-    for (i = 1; i <= numnodes; i++) {
-        if (1 == i) {
-            asprintf(&nodes, "node%05ld", i);
-        } else {
-            asprintf(&nodes, "%s,node%05ld",nodes, i);
+    gettimeofday(&tv_start, 0);
+    rc = orte_regex_extract_node_names(regex, &names);
+    gettimeofday(&tv_end, 0);
+    if (ORTE_SUCCESS != rc) {
+        ORTE_ERROR_LOG(rc);
+        goto cleanup;
+    }
+    fprintf(stderr, "  extract    %10.6f sec  %d names\n", elapsed(&tv_start, &tv_end),
+            opal_argv_count(names));
+
+    gettimeofday(&tv_start, 0);
+    rc = orte_regex_extract_nodeset(regex, &set);
+    gettimeofday(&tv_end, 0);
+    if (ORTE_SUCCESS != rc) {
+        ORTE_ERROR_LOG(rc);
+        goto cleanup;
+    }
+    fprintf(stderr, "  nodeset    %10.6f sec  %lu names\n", elapsed(&tv_start, &tv_end),
+            (unsigned long)orte_nodeset_count(&set));
+
+    srandom(7);
+    orte_nodeset_sort(&set);
+    gettimeofday(&tv_start, 0);
+    for (i = 0; i < LOOKUPS; i++) {
+        snprintf(name, sizeof(name), "node%07ld", 1 + random() % (numnodes + 10));
+        if (orte_nodeset_contains(&set, name)) {
+            hits++;
         }
     }
-    
-    gettimeofday(&tv_start2, 0);
-    
-    if (ORCM_SUCCESS != (rc = orcm_regex_create(nodes, &regex))) {
+    gettimeofday(&tv_end, 0);
+    fprintf(stderr, "  contains   %10.1f ns/lookup  %ld of %d found\n",
+            elapsed(&tv_start, &tv_end) * 1.0e9 / LOOKUPS, hits, LOOKUPS);
+
+    /* the upper half, and the lower half with every tenth node gone */
+    orte_nodeset_add_range(&other, "node", 7, "", numnodes / 2, numnodes);
+    for (i = 1; i < numnodes / 2; i++) {
+        if (0 != i % 10) {
+            orte_nodeset_add_range(&other, "node", 7, "", i, i);
+        }
+    }
+    gettimeofday(&tv_start, 0);
+    rc = orte_nodeset_intersect(&set, &other);
+    gettimeofday(&tv_end, 0);
+    if (ORTE_SUCCESS != rc) {
         ORTE_ERROR_LOG(rc);
-    } else {
-        fprintf(stderr, "REGEX: %s\n", regex);
-        free(regex);
+        goto cleanup;
     }
-    
+    fprintf(stderr, "  intersect  %10.6f sec  %lu names\n", elapsed(&tv_start, &tv_end),
+            (unsigned long)orte_nodeset_count(&set));
+
+    gettimeofday(&tv_start, 0);
+    rc = orte_nodeset_union(&set, &other);
     gettimeofday(&tv_end, 0);
-    elapsed = (tv_end.tv_sec-tv_start2.tv_sec)*1000000 + tv_end.tv_usec-tv_start2.tv_usec;
-    elapsed = elapsed/1000000;
-    fprintf(stderr, "regex elapsed time: %g sec\n", elapsed);
-    elapsed = (tv_end.tv_sec-tv_start.tv_sec)*1000000 + tv_end.tv_usec-tv_start.tv_usec;
-    elapsed = elapsed/1000000;
-    fprintf(stderr, "total elapsed time: %g sec\n", elapsed);
-
-    
-    return 0;
-}
\ No newline at end of file
+    if (ORTE_SUCCESS != rc) {
+        ORTE_ERROR_LOG(rc);
+        goto cleanup;
+    }
+    fprintf(stderr, "  union      %10.6f sec  %lu names\n", elapsed(&tv_start, &tv_end),
+            (unsigned long)orte_nodeset_count(&set));
+
+cleanup:
+    OBJ_DESTRUCT(&set);
+    OBJ_DESTRUCT(&other);
+    opal_argv_free(names);
+    if (NULL != regex) {
+        free(regex);
+    }
+    free(nodes);
+    return rc;
+}
+
+int main(int argc, char **argv)
+{
+    int i, rc;
+
+    if (ORCM_SUCCESS != (rc = orcm_init(ORCM_TOOL))) {
+        fprintf(stderr, "Failed orcm_init\n");
+        exit(1);
+    }
+
+    if (1 < argc) {
+        for (i = 1; i < argc && ORTE_SUCCESS == rc; i++) {
+            rc = run(strtol(argv[i], NULL, 10));
+        }
+    } else {
+        for (i = 0; 0 < sizes[i] && ORTE_SUCCESS == rc; i++) {
+            rc = run(sizes[i]);
+        }
+    }
+
+    orcm_finalize();
+    return (ORTE_SUCCESS == rc) ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Replay a message trace through routed/orcm on a simulated 3-level
+ * system - rows of racks of nodes, 50k daemons by default - from the
+ * point of view of a row and a rack controller, and compare each
+ * lookup against the walk of the children's relatives bitmaps that
+ * get_route used to do. The trace mixes heartbeats going up to the
+ * scheduler with xcast traffic down to random daemons.
+ *
+ * Run with "-mca routed orcm" so that module is the one selected.
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "opal/dss/dss.h"
+#include "opal/class/opal_list.h"
+#include "opal/class/opal_bitmap.h"
+#include "orte/mca/errmgr/errmgr.h"
+#include "orte/mca/routed/routed.h"
+#include "orte/mca/routed/routed_types.h"
+#include "orte/util/proc_info.h"
+#include "orte/runtime/orte_globals.h"
+
+#include "orcm/runtime/runtime.h"
+#include "orcm/runtime/orcm_globals.h"
+
+#define NUM_MSGS 2000000
+
+static int nrows = 10, nracks = 50, nnodes = 100;
+
+/* vpids: 0 scheduler, 1 cluster controller, then each row
+ * controller followed by its racks, each rack controller followed
+ * by its nodes */
+static orte_vpid_t row_vpid(int r)
+{
+    return 2 + r * (1 + nracks * (1 + nnodes));
+}
+
+static orte_vpid_t rack_vpid(int r, int k)
+{
+    return row_vpid(r) + 1 + k * (1 + nnodes);
+}
+
+static opal_buffer_t* build_cluster(orte_jobid_t job)
+{
+    opal_buffer_t *ndat, *sched, *row, *rack;
+    orte_process_name_t name;
+    int32_t r, k, n;
+
+    ndat = OBJ_NEW(opal_buffer_t);
+    name.jobid = job;
+
+    sched = OBJ_NEW(opal_buffer_t);
+    name.vpid = 0;
+    opal_dss.pack(sched, &name, 1, ORTE_NAME);
+    opal_dss.pack(ndat, &sched, 1, OPAL_BUFFER);
+    OBJ_RELEASE(sched);
+
+    name.vpid = 1;
+    opal_dss.pack(ndat, &name, 1, ORTE_NAME);
+    opal_dss.pack(ndat, &nrows, 1, OPAL_INT32);
+    for (r=0; r < nrows; r++) {
+        row = OBJ_NEW(opal_buffer_t);
+        opal_dss.pack(row, &nracks, 1, OPAL_INT32);
+        name.vpid = row_vpid(r);
+        opal_dss.pack(row, &name, 1, ORTE_NAME);
+        for (k=0; k < nracks; k++) {
+            rack = OBJ_NEW(opal_buffer_t);
+            name.vpid = rack_vpid(r, k);
+            opal_dss.pack(rack, &name, 1, ORTE_NAME);
+            for (n=0; n < nnodes; n++) {
+                name.vpid = rack_vpid(r, k) + 1 + n;
+                opal_dss.pack(rack, &name, 1, ORTE_NAME);
+            }
+            opal_dss.pack(row, &rack, 1, OPAL_BUFFER);
+            OBJ_RELEASE(rack);
+        }
+        opal_dss.pack(ndat, &row, 1, OPAL_BUFFER);
+        OBJ_RELEASE(row);
+    }
+    return ndat;
+}
+
+/* the children a controller at (row, rack) has, as init_routes
+ * builds them - rack < 0 for a row controller */
+static void build_children(opal_list_t *children, int r, int k)
+{
+    orte_routed_tree_t *child;
+    orte_vpid_t total = row_vpid(nrows);
+    int j, n;
+
+    if (k < 0) {
+        for (j=0; j < nracks; j++) {
+            child = OBJ_NEW(orte_routed_tree_t);
+            child->vpid = rack_vpid(r, j);
+            opal_bitmap_init(&child->relatives, total);
+            for (n=0; n < nnodes; n++) {
+                opal_bitmap_set_bit(&child->relatives, child->vpid + 1 + n);
+            }
+            opal_list_append(children, &child->super);
+        }
+    } else {
+        for (n=0; n < nnodes; n++) {
+            child = OBJ_NEW(orte_routed_tree_t);
+            child->vpid = rack_vpid(r, k) + 1 + n;
+            opal_bitmap_init(&child->relatives, total);
+            opal_list_append(children, &child->super);
+        }
+    }
+}
+
+/* get_route for an aggregator before the next-hop table */
+static orte_vpid_t walk_route(opal_list_t *children, orte_vpid_t target)
+{
+    orte_routed_tree_t *child;
+
+    if (target == ORTE_PROC_MY_NAME->vpid) {
+        return target;
+    }
+    OPAL_LIST_FOREACH(child, children, orte_routed_tree_t) {
+        if (child->vpid == target) {
+            return target;
+        }
+        if (opal_bitmap_is_set_bit(&child->relatives, target)) {
+            return child->vpid;
+        }
+    }
+    return ORTE_PROC_MY_PARENT->vpid;
+}
+
+static float elapsed(struct timeval *start, struct timeval *end)
+{
+    return ((end->tv_sec - start->tv_sec)*1000000 + end->tv_usec - start->tv_usec) / 1000000.0;
+}
+
+static int run(const char *label, orte_vpid_t me, int r, int k,
+               orte_vpid_t *trace, int ntrace)
+{
+    orte_process_name_t target, hop;
+    opal_list_t children;
+    opal_buffer_t *ndat;
+    struct timeval tv_start, tv_mid, tv_end;
+    orte_vpid_t sum = 0;
+    int i, rc;
+
+    ORTE_PROC_MY_NAME->vpid = me;
+    orte_routed.initialize();
+    ndat = build_cluster(ORTE_PROC_MY_NAME->jobid);
+    rc = orte_routed.init_routes(ORTE_PROC_MY_NAME->jobid, ndat);
+    OBJ_RELEASE(ndat);
+    if (ORTE_SUCCESS != rc) {
+        ORTE_ERROR_LOG(rc);
+        orte_routed.finalize();
+        return rc;
+    }
+    OBJ_CONSTRUCT(&children, opal_list_t);
+    build_children(&children, r, k);
+
+    target.jobid = ORTE_PROC_MY_NAME->jobid;
+    for (i=0; i < ntrace; i++) {
+        target.vpid = trace[i];
+        hop = orte_routed.get_route(&target);
+        if (hop.vpid != walk_route(&children, trace[i])) {
+            fprintf(stderr, "%s: route to %u MISMATCH: %u != %u\n", label,
+                    trace[i], hop.vpid, walk_route(&children, trace[i]));
+            rc = ORCM_ERROR;
+            goto done;
+        }
+    }
+
+    gettimeofday(&tv_start, 0);
+    for (i=0; i < ntrace; i++) {
+        sum += walk_route(&children, trace[i]);
+    }
+    gettimeofday(&tv_mid, 0);
+    for (i=0; i < ntrace; i++) {
+        target.vpid = trace[i];
+        sum -= orte_routed.get_route(&target).vpid;
+    }
+    gettimeofday(&tv_end, 0);
+
+    fprintf(stderr, "%-14s %3d children  walk %8.1f ns/msg  table %8.1f ns/msg%s\n",
+            label, (int)opal_list_get_size(&children),
+            elapsed(&tv_start, &tv_mid) * 1.0e9 / ntrace,
+            elapsed(&tv_mid, &tv_end) * 1.0e9 / ntrace,
+            (0 == sum) ? "" : "  (checksum differs)");
+
+done:
+    OPAL_LIST_DESTRUCT(&children);
+    orte_routed.finalize();
+    return rc;
+}
+
+int main(int argc, char **argv)
+{
+    orte_vpid_t *trace, total;
+    orte_process_name_t my_name, my_parent;
+    orte_proc_type_t saved_type;
+    bool saved_routing;
+    int i, rc;
+
+    if (1 < argc) {
+        nrows = (int)strtol(argv[1], NULL, 10);
+    }
+    if (2 < argc) {
+        nracks = (int)strtol(argv[2], NULL, 10);
+    }
+    if (3 < argc) {
+        nnodes = (int)strtol(argv[3], NULL, 10);
+    }
+
+    if (ORCM_SUCCESS != (rc = orcm_init(ORCM_TOOL))) {
+        fprintf(stderr, "Failed orcm_init\n");
+        exit(1);
+    }
+    total = row_vpid(nrows);
+    fprintf(stderr, "%d rows x %d racks x %d nodes = %u daemons, %d messages\n",
+            nrows, nracks, nnodes, total, NUM_MSGS);
+
+    /* half heartbeats heading up, half xcast traffic to anyone */
+    trace = (orte_vpid_t*)malloc(NUM_MSGS * sizeof(orte_vpid_t));
+    srandom(7);
+    for (i=0; i < NUM_MSGS; i++) {
+        trace[i] = (0 == i % 2) ? 0 : (orte_vpid_t)(random() % total);
+    }
+
+    /* act as an aggregator in the simulated system */
+    my_name = *ORTE_PROC_MY_NAME;
+    my_parent = *ORTE_PROC_MY_PARENT;
+    saved_type = orte_process_info.proc_type;
+    saved_routing = orte_routing_is_enabled;
+    orte_process_info.proc_type = ORCM_AGGREGATOR;
+    orte_process_info.num_procs = total;
+    orte_routing_is_enabled = true;
+    ORTE_PROC_MY_NAME->jobid = 1;
+
+    rc = run("row ctlr", row_vpid(nrows / 2), nrows / 2, -1, trace, NUM_MSGS);
+    if (ORCM_SUCCESS == rc) {
+        rc = run("rack ctlr", rack_vpid(nrows / 2, nracks / 2), nrows / 2, nracks / 2,
+                 trace, NUM_MSGS);
+    }
+
+    *ORTE_PROC_MY_NAME = my_name;
+    *ORTE_PROC_MY_PARENT = my_parent;
+    orte_process_info.proc_type = saved_type;
+    orte_routing_is_enabled = saved_routing;
+    free(trace);
+    orcm_finalize();
+    return (ORCM_SUCCESS == rc) ? 0 : 1;
+}
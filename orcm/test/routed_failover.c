@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Kill a rack controller in a simulated system - rows of racks of
+ * nodes, as routed_bench lays them out - and check that routed/orcm
+ * heals around it: each orphaned node fails over to the next rack
+ * in its row, the row controller reaches the orphans directly, and
+ * that rack routes to them once they connect. The routed module is
+ * re-initialized as each of those daemons in turn.
+ *
+ * The heartbeats the orphans sample while their parent is dead are
+ * then played against the failover each of them took, holding up
+ * to backlog beats as sensor/heartbeat does, to report how many
+ * are lost and how long each node goes unheard.
+ *
+ * Run with "-mca routed orcm" so that module is the one selected:
+ *   routed_failover [rows racks nodes rate-msec detect-msec backlog]
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "opal/dss/dss.h"
+#include "orte/mca/errmgr/errmgr.h"
+#include "orte/mca/routed/routed.h"
+#include "orte/util/proc_info.h"
+#include "orte/runtime/orte_globals.h"
+
+#include "orcm/runtime/runtime.h"
+#include "orcm/runtime/orcm_globals.h"
+
+#define RUN_MSEC 60000
+
+static int nrows = 2, nracks = 4, nnodes = 16;
+
+static orte_vpid_t row_vpid(int r)
+{
+    return 2 + r * (1 + nracks * (1 + nnodes));
+}
+
+static orte_vpid_t rack_vpid(int r, int k)
+{
+    return row_vpid(r) + 1 + k * (1 + nnodes);
+}
+
+static opal_buffer_t* build_cluster(orte_jobid_t job)
+{
+    opal_buffer_t *ndat, *sched, *row, *rack;
+    orte_process_name_t name;
+    int32_t r, k, n;
+
+    ndat = OBJ_NEW(opal_buffer_t);
+    name.jobid = job;
+
+    sched = OBJ_NEW(opal_buffer_t);
+    name.vpid = 0;
+    opal_dss.pack(sched, &name, 1, ORTE_NAME);
+    opal_dss.pack(ndat, &sched, 1, OPAL_BUFFER);
+    OBJ_RELEASE(sched);
+
+    name.vpid = 1;
+    opal_dss.pack(ndat, &name, 1, ORTE_NAME);
+    opal_dss.pack(ndat, &nrows, 1, OPAL_INT32);
+    for (r=0; r < nrows; r++) {
+        row = OBJ_NEW(opal_buffer_t);
+        opal_dss.pack(row, &nracks, 1, OPAL_INT32);
+        name.vpid = row_vpid(r);
+        opal_dss.pack(row, &name, 1, ORTE_NAME);
+        for (k=0; k < nracks; k++) {
+            rack = OBJ_NEW(opal_buffer_t);
+            name.vpid = rack_vpid(r, k);
+            opal_dss.pack(rack, &name, 1, ORTE_NAME);
+            for (n=0; n < nnodes; n++) {
+                name.vpid = rack_vpid(r, k) + 1 + n;
+                opal_dss.pack(rack, &name, 1, ORTE_NAME);
+            }
+            opal_dss.pack(row, &rack, 1, OPAL_BUFFER);
+            OBJ_RELEASE(rack);
+        }
+        opal_dss.pack(ndat, &row, 1, OPAL_BUFFER);
+        OBJ_RELEASE(row);
+    }
+    return ndat;
+}
+
+/* bring the routed module up as the given daemon */
+static int become(orte_vpid_t me, orte_proc_type_t type)
+{
+    opal_buffer_t *ndat;
+    int rc;
+
+    orte_routed.finalize();
+    orte_process_info.proc_type = type;
+    ORTE_PROC_MY_NAME->vpid = me;
+    ORTE_PROC_MY_PARENT->jobid = ORTE_PROC_MY_NAME->jobid;
+    ORTE_PROC_MY_PARENT->vpid = ORTE_VPID_INVALID;
+    orte_routed.initialize();
+    ndat = build_cluster(ORTE_PROC_MY_NAME->jobid);
+    rc = orte_routed.init_routes(ORTE_PROC_MY_NAME->jobid, ndat);
+    OBJ_RELEASE(ndat);
+    if (ORTE_SUCCESS != rc) {
+        ORTE_ERROR_LOG(rc);
+    }
+    return rc;
+}
+
+static orte_vpid_t route_to(orte_vpid_t vpid)
+{
+    orte_process_name_t target;
+
+    target.jobid = ORTE_PROC_MY_NAME->jobid;
+    target.vpid = vpid;
+    return orte_routed.get_route(&target).vpid;
+}
+
+int main(int argc, char **argv)
+{
+    orte_process_name_t my_name, my_parent, dead, node;
+    orte_proc_type_t saved_type;
+    bool saved_routing;
+    orte_vpid_t victim, sibling, total, *newparent;
+    int rate = 1000, detect = 5000, backlog = 32;
+    int r, k, n, t, held, rc = ORCM_SUCCESS;
+    long taken = 0, delivered = 0, replayed = 0, lost = 0;
+    int gap, worst = 0;
+    double gaps = 0;
+
+    if (1 < argc) {
+        nrows = (int)strtol(argv[1], NULL, 10);
+    }
+    if (2 < argc) {
+        nracks = (int)strtol(argv[2], NULL, 10);
+    }
+    if (3 < argc) {
+        nnodes = (int)strtol(argv[3], NULL, 10);
+    }
+    if (4 < argc) {
+        rate = (int)strtol(argv[4], NULL, 10);
+    }
+    if (5 < argc) {
+        detect = (int)strtol(argv[5], NULL, 10);
+    }
+    if (6 < argc) {
+        backlog = (int)strtol(argv[6], NULL, 10);
+    }
+    if (nracks < 2 || rate <= 0) {
+        fprintf(stderr, "need at least 2 racks a row and a positive rate\n");
+        exit(1);
+    }
+
+    if (ORCM_SUCCESS != (rc = orcm_init(ORCM_TOOL))) {
+        fprintf(stderr, "Failed orcm_init\n");
+        exit(1);
+    }
+    total = row_vpid(nrows);
+    r = nrows / 2;
+    k = nracks / 2;
+    victim = rack_vpid(r, k);
+    sibling = rack_vpid(r, (k + 1) % nracks);
+    fprintf(stderr, "%d rows x %d racks x %d nodes = %u daemons - killing rack ctlr %u\n",
+            nrows, nracks, nnodes, total, victim);
+
+    my_name = *ORTE_PROC_MY_NAME;
+    my_parent = *ORTE_PROC_MY_PARENT;
+    saved_type = orte_process_info.proc_type;
+    saved_routing = orte_routing_is_enabled;
+    orte_process_info.num_procs = total;
+    orte_routing_is_enabled = true;
+    ORTE_PROC_MY_NAME->jobid = 1;
+    dead.jobid = 1;
+    dead.vpid = victim;
+    newparent = (orte_vpid_t*)malloc(nnodes * sizeof(orte_vpid_t));
+
+    /* each orphan loses its lifeline and picks its backup */
+    for (n=0; n < nnodes && ORCM_SUCCESS == rc; n++) {
+        if (ORTE_SUCCESS != (rc = become(victim + 1 + n, ORCM_DAEMON))) {
+            break;
+        }
+        if (ORTE_PROC_MY_PARENT->vpid != victim) {
+            fprintf(stderr, "node %u: parent %u, not %u\n", victim + 1 + n,
+                    ORTE_PROC_MY_PARENT->vpid, victim);
+            rc = ORCM_ERROR;
+        } else if (ORTE_SUCCESS != orte_routed.route_lost(&dead)) {
+            fprintf(stderr, "node %u: no backup for %u\n", victim + 1 + n, victim);
+            rc = ORCM_ERROR;
+        } else if (route_to(0) != sibling) {
+            fprintf(stderr, "node %u: failed over to %u, not %u\n", victim + 1 + n,
+                    route_to(0), sibling);
+            rc = ORCM_ERROR;
+        }
+        newparent[n] = ORTE_PROC_MY_PARENT->vpid;
+    }
+
+    /* the row controller goes straight to the orphans */
+    if (ORCM_SUCCESS == rc && ORTE_SUCCESS == (rc = become(row_vpid(r), ORCM_AGGREGATOR))) {
+        orte_routed.route_lost(&dead);
+        for (n=0; n < nnodes; n++) {
+            if (route_to(victim + 1 + n) != victim + 1 + n) {
+                fprintf(stderr, "row ctlr: route to orphan %u via %u\n",
+                        victim + 1 + n, route_to(victim + 1 + n));
+                rc = ORCM_ERROR;
+            }
+            if (route_to(sibling + 1 + n) != sibling) {
+                fprintf(stderr, "row ctlr: route to %u moved to %u\n",
+                        sibling + 1 + n, route_to(sibling + 1 + n));
+                rc = ORCM_ERROR;
+            }
+        }
+    }
+
+    /* and the sibling adopts them as they connect */
+    if (ORCM_SUCCESS == rc && ORTE_SUCCESS == (rc = become(sibling, ORCM_AGGREGATOR))) {
+        node.jobid = 1;
+        for (n=0; n < nnodes; n++) {
+            node.vpid = victim + 1 + n;
+            if (route_to(node.vpid) != ORTE_PROC_MY_PARENT->vpid) {
+                fprintf(stderr, "sibling: route to %u via %u before it failed over\n",
+                        node.vpid, route_to(node.vpid));
+                rc = ORCM_ERROR;
+            }
+            orte_routed.update_route(&node, &node);
+            if (route_to(node.vpid) != node.vpid) {
+                fprintf(stderr, "sibling: lost foster %u on connect\n", node.vpid);
+                rc = ORCM_ERROR;
+            }
+        }
+        if (route_to(row_vpid(r)) != ORTE_PROC_MY_PARENT->vpid) {
+            fprintf(stderr, "sibling: routing upward broke\n");
+            rc = ORCM_ERROR;
+        }
+    }
+
+    /* play the orphans' heartbeats: the rack dies at time 0, each
+     * node hears of it detect msec later and fails over, and beats
+     * sent in between are held - up to backlog of them - and
+     * replayed behind the first beat to the new parent */
+    if (ORCM_SUCCESS == rc) {
+        for (n=0; n < nnodes; n++) {
+            held = 0;
+            gap = -1;
+            /* stagger the nodes' sample phase across the period */
+            for (t = (n * rate) / nnodes; t < RUN_MSEC; t += rate) {
+                taken++;
+                if (t < detect) {
+                    if (held == backlog) {
+                        lost++;
+                    } else {
+                        held++;
+                    }
+                    continue;
+                }
+                if (gap < 0) {
+                    gap = t;
+                    replayed += held;
+                    delivered += held;
+                }
+                delivered++;
+            }
+            if (gap < 0) {
+                gap = RUN_MSEC;
+            }
+            gaps += gap;
+            if (worst < gap) {
+                worst = gap;
+            }
+        }
+        fprintf(stderr, "beats every %d msec, failure detected in %d msec, backlog %d\n",
+                rate, detect, backlog);
+        fprintf(stderr, "%ld beats taken, %ld delivered (%ld replayed), %ld lost (%.2f%%)\n",
+                taken, delivered, replayed, lost, 100.0 * lost / taken);
+        fprintf(stderr, "time unheard: mean %.0f msec, worst %d msec\n",
+                gaps / nnodes, worst);
+    }
+
+    orte_routed.finalize();
+    *ORTE_PROC_MY_NAME = my_name;
+    *ORTE_PROC_MY_PARENT = my_parent;
+    orte_process_info.proc_type = saved_type;
+    orte_routing_is_enabled = saved_routing;
+    orte_routed.initialize();
+    free(newparent);
+    orcm_finalize();
+    return (ORCM_SUCCESS == rc) ? 0 : 1;
+}
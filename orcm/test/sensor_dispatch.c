@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Measure how fast an aggregator can resolve incoming sensor
+ * buffers to the module that logs them, comparing the per-name
+ * strcmp scan with the interned component ids carried in the
+ * heartbeat. Each simulated daemon announces its own id table,
+ * which is translated once to local ids as recv_beats does.
+ */
+
+#include "orcm_config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "opal/mca/base/base.h"
+#include "orte/mca/errmgr/errmgr.h"
+
+#include "orcm/runtime/runtime.h"
+#include "orcm/mca/sensor/base/base.h"
+#include "orcm/mca/sensor/base/sensor_private.h"
+
+#define NUM_BEATS 10
+
+/* the dispatch loop before component ids were interned */
+static orcm_sensor_active_module_t* scan_modules(char *comp)
+{
+    orcm_sensor_active_module_t *i_module;
+    int i;
+
+    for (i=0; i < orcm_sensor_base.modules.size; i++) {
+        if (NULL == (i_module = (orcm_sensor_active_module_t*)opal_pointer_array_get_item(&orcm_sensor_base.modules, i))) {
+            continue;
+        }
+        if (0 == strcmp(comp, i_module->component->base_version.mca_component_name)) {
+            return i_module;
+        }
+    }
+    return NULL;
+}
+
+static float elapsed(struct timeval *start, struct timeval *end)
+{
+    return ((end->tv_sec - start->tv_sec)*1000000 + end->tv_usec - start->tv_usec) / 1000000.0;
+}
+
+int main(int argc, char **argv)
+{
+    int rc;
+    long numdaemons = 10000, d, b;
+    int ncomps = 0, i, j, id;
+    char **names = NULL;
+    int **tables;
+    orcm_sensor_active_module_t *i_module;
+    volatile long found = 0;
+    struct timeval tv_start, tv_end;
+    float t;
+
+    if (1 < argc) {
+        numdaemons = strtol(argv[1], NULL, 10);
+    }
+
+    if (ORCM_SUCCESS != (rc = orcm_init(ORCM_TOOL))) {
+        fprintf(stderr, "Failed orcm_init\n");
+        exit(1);
+    }
+    if (OPAL_SUCCESS != (rc = mca_base_framework_open(&orcm_sensor_base_framework, 0)) ||
+        ORCM_SUCCESS != (rc = orcm_sensor_base_select())) {
+        ORTE_ERROR_LOG(rc);
+        orcm_finalize();
+        return 1;
+    }
+
+    for (i=0; i < orcm_sensor_base.modules.size; i++) {
+        if (NULL == (i_module = (orcm_sensor_active_module_t*)opal_pointer_array_get_item(&orcm_sensor_base.modules, i))) {
+            continue;
+        }
+        names = (char**)realloc(names, (ncomps+1) * sizeof(char*));
+        names[ncomps++] = i_module->component->base_version.mca_component_name;
+    }
+    if (0 == ncomps) {
+        fprintf(stderr, "no active sensor modules\n");
+        orcm_finalize();
+        return 1;
+    }
+    fprintf(stderr, "%d active sensors, %ld daemons, %d beats each\n",
+            ncomps, numdaemons, NUM_BEATS);
+
+    /* every daemon announces its components in a different order,
+     * so the aggregator keeps a translation table per daemon */
+    tables = (int**)malloc(numdaemons * sizeof(int*));
+    gettimeofday(&tv_start, 0);
+    for (d=0; d < numdaemons; d++) {
+        tables[d] = (int*)malloc(ncomps * sizeof(int));
+        for (j=0; j < ncomps; j++) {
+            tables[d][j] = orcm_sensor_base_component_id(names[(j + d) % ncomps]);
+        }
+    }
+    gettimeofday(&tv_end, 0);
+    fprintf(stderr, "id table setup: %g sec\n", elapsed(&tv_start, &tv_end));
+
+    /* linear scan by name */
+    gettimeofday(&tv_start, 0);
+    for (b=0; b < NUM_BEATS; b++) {
+        for (d=0; d < numdaemons; d++) {
+            for (j=0; j < ncomps; j++) {
+                if (NULL != scan_modules(names[(j + d) % ncomps])) {
+                    found++;
+                }
+            }
+        }
+    }
+    gettimeofday(&tv_end, 0);
+    t = elapsed(&tv_start, &tv_end);
+    fprintf(stderr, "name scan:   %g sec, %g dispatches/sec\n",
+            t, (NUM_BEATS * numdaemons * ncomps) / t);
+
+    /* interned ids */
+    gettimeofday(&tv_start, 0);
+    for (b=0; b < NUM_BEATS; b++) {
+        for (d=0; d < numdaemons; d++) {
+            for (j=0; j < ncomps; j++) {
+                id = tables[d][j];
+                if (NULL != opal_pointer_array_get_item(&orcm_sensor_base.modules, id)) {
+                    found++;
+                }
+            }
+        }
+    }
+    gettimeofday(&tv_end, 0);
+    t = elapsed(&tv_start, &tv_end);
+    fprintf(stderr, "interned id: %g sec, %g dispatches/sec\n",
+            t, (NUM_BEATS * numdaemons * ncomps) / t);
+
+    for (d=0; d < numdaemons; d++) {
+        free(tables[d]);
+    }
+    free(tables);
+    free(names);
+    (void)mca_base_framework_close(&orcm_sensor_base_framework);
+    orcm_finalize();
+    return 0;
+}
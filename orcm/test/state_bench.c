@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2015      Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/* Drive proc state transitions through the state machine with more
+ * and more states defined, as components register their own, and
+ * report the cost of each transition - activation plus dispatch of
+ * its event - next to the walk of the state list that activation
+ * used to do to find its callback. The transition cost should not
+ * grow with the number of states.
+ *
+ *   state_bench [transitions]
+ */
+
+#include "orcm_config.h"
+#include "orcm/constants.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "opal/class/opal_list.h"
+#include "opal/mca/event/event.h"
+#include "orte/mca/errmgr/errmgr.h"
+#include "orte/mca/state/state.h"
+#include "orte/runtime/orte_globals.h"
+
+#include "orcm/runtime/runtime.h"
+
+#define BATCH 1000
+
+static const int sizes[] = {8, 64, 256, 900, -1};
+static long fired = 0;
+
+static void transition(int fd, short args, void *cbdata)
+{
+    orte_state_caddy_t *caddy = (orte_state_caddy_t*)cbdata;
+
+    fired++;
+    OBJ_RELEASE(caddy);
+}
+
+/* find a state's callback as activate_proc_state used to */
+static orte_state_t* walk_states(orte_proc_state_t state)
+{
+    opal_list_item_t *itm, *any = NULL;
+    orte_state_t *s;
+
+    for (itm = opal_list_get_first(&orte_proc_states);
+         itm != opal_list_get_end(&orte_proc_states);
+         itm = opal_list_get_next(itm)) {
+        s = (orte_state_t*)itm;
+        if (s->proc_state == ORTE_PROC_STATE_ANY) {
+            any = itm;
+        }
+        if (s->proc_state == state) {
+            return s;
+        }
+    }
+    return (orte_state_t*)any;
+}
+
+static float elapsed(struct timeval *start, struct timeval *end)
+{
+    return ((end->tv_sec - start->tv_sec)*1000000 + end->tv_usec - start->tv_usec) / 1000000.0;
+}
+
+int main(int argc, char **argv)
+{
+    orte_process_name_t name;
+    orte_proc_state_t *trace;
+    struct timeval tv_start, tv_mid, tv_end;
+    long ntrans = 1000000, i, j, sum = 0;
+    int nstates = 0, z, rc = ORCM_SUCCESS;
+
+    if (1 < argc) {
+        ntrans = strtol(argv[1], NULL, 10);
+    }
+    if (ORCM_SUCCESS != (rc = orcm_init(ORCM_TOOL))) {
+        fprintf(stderr, "Failed orcm_init\n");
+        exit(1);
+    }
+    trace = (orte_proc_state_t*)malloc(ntrans * sizeof(orte_proc_state_t));
+    name = *ORTE_PROC_MY_NAME;
+    srandom(7);
+
+    for (z=0; 0 < sizes[z] && ORCM_SUCCESS == rc; z++) {
+        /* define more states - the bench owns those above DYNAMIC */
+        for (; nstates < sizes[z]; nstates++) {
+            if (ORTE_SUCCESS != (rc = orte_state.add_proc_state(ORTE_PROC_STATE_DYNAMIC + nstates,
+                                                                transition, ORTE_SYS_PRI))) {
+                ORTE_ERROR_LOG(rc);
+                break;
+            }
+        }
+        if (ORTE_SUCCESS != rc) {
+            break;
+        }
+        for (i=0; i < ntrans; i++) {
+            trace[i] = ORTE_PROC_STATE_DYNAMIC + random() % nstates;
+        }
+
+        gettimeofday(&tv_start, 0);
+        for (i=0; i < ntrans; i++) {
+            sum += (NULL == walk_states(trace[i])) ? 0 : 1;
+        }
+        gettimeofday(&tv_mid, 0);
+        fired = 0;
+        for (i=0; i < ntrans; i += BATCH) {
+            for (j=i; j < ntrans && j < i + BATCH; j++) {
+                orte_state.activate_proc_state(&name, trace[j]);
+            }
+            while (fired < j) {
+                opal_event_loop(orte_event_base, OPAL_EVLOOP_NONBLOCK);
+            }
+        }
+        gettimeofday(&tv_end, 0);
+
+        fprintf(stderr, "%4d states  walk %8.1f ns/lookup  transition %8.1f ns  (%.0f/sec)%s\n",
+                (int)opal_list_get_size(&orte_proc_states),
+                elapsed(&tv_start, &tv_mid) * 1.0e9 / ntrans,
+                elapsed(&tv_mid, &tv_end) * 1.0e9 / ntrans,
+                ntrans / elapsed(&tv_mid, &tv_end),
+                (sum == ntrans * (z + 1)) ? "" : "  (walk missed states)");
+    }
+
+    for (i=0; i < nstates; i++) {
+        orte_state.remove_proc_state(ORTE_PROC_STATE_DYNAMIC + i);
+    }
+    free(trace);
+    orcm_finalize();
+    return (ORCM_SUCCESS == rc) ? 0 : 1;
+}
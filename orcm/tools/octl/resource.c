@@ -32,19 +32,17 @@
 typedef struct {
     opal_list_item_t super;
     orcm_node_t template;
-    char** resources;
+    orte_nodeset_t resources;
 } orcm_resource_container_t;
 static void resourcecon(orcm_resource_container_t *p)
 {
     OBJ_CONSTRUCT(&p->template, orcm_node_t);
-    p->resources = NULL;
+    OBJ_CONSTRUCT(&p->resources, orte_nodeset_t);
 }
 static void resourcedes(orcm_resource_container_t *p)
 {
     OBJ_DESTRUCT(&p->template);
-    if (NULL != p->resources) {
-        opal_argv_free(p->resources);
-    }
+    OBJ_DESTRUCT(&p->resources);
 }
 OBJ_CLASS_INSTANCE(orcm_resource_container_t,
                    opal_list_item_t,
@@ -58,7 +56,6 @@ int orcm_octl_resource_status(char **argv)
     orcm_node_t **nodes;
     orcm_resource_container_t *container;
     char *regexp;
-    char *nodelist;
     orte_rml_recv_cb_t xfer;
     opal_buffer_t *buf;
     int rc, i, n, num_nodes;
@@ -136,8 +133,7 @@ int orcm_octl_resource_status(char **argv)
             OPAL_LIST_FOREACH(container, &containers, orcm_resource_container_t) {
                 if (container->template.scd_state == nodes[i]->scd_state &&
                     container->template.state == nodes[i]->state) {
-                    opal_argv_append_nosize(&container->resources,
-                                            nodes[i]->name);
+                    orte_nodeset_add(&container->resources, nodes[i]->name);
                     found = true;
                 }
             }
@@ -145,7 +141,7 @@ int orcm_octl_resource_status(char **argv)
                 container = OBJ_NEW(orcm_resource_container_t);
                 container->template.scd_state = nodes[i]->scd_state;
                 container->template.state = nodes[i]->state;
-                opal_argv_append_nosize(&container->resources, nodes[i]->name);
+                orte_nodeset_add(&container->resources, nodes[i]->name);
                 opal_list_append(&containers, &container->super);
             }
         }
@@ -154,12 +150,11 @@ int orcm_octl_resource_status(char **argv)
         /* print out nodes by containter
          * since they all have the same attributes in the container,
          * we can combine the node list by using regex and list this unique
-         * combination of attributes just once 
-         * may need to sort at some point, but for now scheduler gives us
-         * nodes in sorted order */
+         * combination of attributes just once - sorted, so the
+         * ranges merge whatever order the scheduler sent them in */
         OPAL_LIST_FOREACH(container, &containers, orcm_resource_container_t) {
-            nodelist = opal_argv_join(container->resources, ',');
-            if (ORTE_SUCCESS != (rc = orte_regex_create(nodelist, &regexp))) {
+            orte_nodeset_sort(&container->resources);
+            if (ORTE_SUCCESS != (rc = orte_regex_create_nodeset(&container->resources, &regexp))) {
                 ORTE_ERROR_LOG(rc);
                 OPAL_LIST_DESTRUCT(&containers);
                 OBJ_DESTRUCT(&xfer);
@@ -176,7 +171,6 @@ int orcm_octl_resource_status(char **argv)
                        orcm_node_state_to_char(container->template.state),
                        orcm_scd_node_state_to_str(container->template.scd_state));
             }
-            free(nodelist);
             free(regexp);
         }
         OPAL_LIST_DESTRUCT(&containers);
@@ -75,21 +75,21 @@ void orte_notifier_base_event(int sd, short args, void *cbdata)
     
     /* if no modules are active, then there is nothing to do */
     if (0 == opal_list_get_size(&orte_notifier_base.modules)) {
-        return;
+        goto cleanup;
     }
 
     /* check if the severity is >= severity level set for
      * reporting - note that the severity enum value goes up
      * as severity goes down */
     if (orte_notifier_base.severity_level < req->severity ) {
-        return;
+        goto cleanup;
     }
 
     orte_notifier_base_identify_modules(&modules, req);
 
     /* no modules selected then nothing to do */
     if (NULL == modules) {
-        return;
+        goto cleanup;
     }
 
     for (i=0; NULL != modules[i]; i++) {
@@ -100,6 +100,12 @@ void orte_notifier_base_event(int sd, short args, void *cbdata)
         }
     }
     opal_argv_free(modules);
+
+ cleanup:
+    /* the request owns the message and action of a system event */
+    free((char*)req->msg);
+    free((char*)req->action);
+    OBJ_RELEASE(req);
 }
 
 void orte_notifier_base_report(int sd, short args, void *cbdata)
@@ -167,6 +167,8 @@ typedef void (*orte_notifier_base_module_report_fn_t)(orte_notifier_request_t *r
         opal_event_active(&(_n)->ev, OPAL_EV_WRITE, 1);                 \
     } while(0);
 
+/* the message and action of a system event must be malloc'd (the
+ * action may be NULL) - they are freed once the event is delivered */
 #define ORTE_NOTIFIER_SYSTEM_EVENT(s, m, a)                             \
     do {                                                                \
         orte_notifier_request_t *_n;                                    \
@@ -11,6 +11,7 @@
 #include "orte/constants.h"
 
 #include <stddef.h>
+#include <string.h>
 #ifdef HAVE_TIME_H
 #include <time.h>
 #endif
@@ -90,9 +91,194 @@ orte_routed_module_t orte_routed_orcm_module = {
 static orte_process_name_t *lifeline=NULL;
 static opal_list_t my_children;  // orte_routed_tree_t's
 
+/* next hop toward each daemon vpid: the vpid itself if it is
+ * directly connected to us, the child it sits beneath, or
+ * ORTE_VPID_INVALID to go up through our parent. Built from
+ * my_children by init_routes so aggregators route in O(1) */
+static orte_vpid_t *hops = NULL;
+static orte_vpid_t nhops = 0;
+
+/* failover: the aggregators we re-parent to, in order, if our
+ * parent dies - for a compute node the next rack controller in
+ * its row comes first, then the row and cluster controllers and
+ * the scheduler. A rack controller adopts the nodes of the rack
+ * before it in the row (its fosters) as they connect to it */
+#define ORCM_ROUTED_MAX_BACKUPS 4
+static orte_process_name_t backups[ORCM_ROUTED_MAX_BACKUPS];
+static int nbackups = 0;
+static int next_backup = 0;
+static opal_bitmap_t fosters;
+
+/* the racks of a row while init_routes reads it: the controller,
+ * or ORTE_VPID_INVALID, and where its nodes start in plan_nodes */
+typedef struct {
+    orte_vpid_t ctlr;
+    int32_t first;
+    int32_t nnodes;
+} plan_rack_t;
+static plan_rack_t *plan_racks = NULL;
+static int32_t plan_nracks = 0;
+static orte_vpid_t *plan_nodes = NULL;
+static int32_t plan_nnodes = 0, plan_anodes = 0;
+
+static int hops_grow(orte_vpid_t n)
+{
+    orte_vpid_t *tmp, v;
+
+    if (n <= nhops) {
+        return ORTE_SUCCESS;
+    }
+    if (NULL == (tmp = (orte_vpid_t*)realloc(hops, n * sizeof(orte_vpid_t)))) {
+        return ORTE_ERR_OUT_OF_RESOURCE;
+    }
+    for (v=nhops; v < n; v++) {
+        tmp[v] = ORTE_VPID_INVALID;
+    }
+    hops = tmp;
+    nhops = n;
+    return ORTE_SUCCESS;
+}
+
+/* the next hop as the routing tree defines it */
+static orte_vpid_t tree_hop(orte_vpid_t vpid)
+{
+    orte_routed_tree_t *child;
+
+    OPAL_LIST_FOREACH(child, &my_children, orte_routed_tree_t) {
+        if (child->vpid == vpid ||
+            opal_bitmap_is_set_bit(&child->relatives, vpid)) {
+            return child->vpid;
+        }
+    }
+    return ORTE_VPID_INVALID;
+}
+
+static int build_hops(void)
+{
+    orte_routed_tree_t *child;
+    orte_vpid_t n = orte_process_info.num_procs, v;
+    uint64_t bits;
+    int w, b, rc;
+
+    free(hops);
+    hops = NULL;
+    nhops = 0;
+    OPAL_LIST_FOREACH(child, &my_children, orte_routed_tree_t) {
+        if (n <= child->vpid) {
+            n = child->vpid + 1;
+        }
+        if (n < (orte_vpid_t)child->relatives.array_size * 64) {
+            n = child->relatives.array_size * 64;
+        }
+    }
+    if (ORTE_SUCCESS != (rc = hops_grow(n))) {
+        return rc;
+    }
+    /* the first child claiming a vpid wins, as in a walk of the list */
+    OPAL_LIST_FOREACH_REV(child, &my_children, orte_routed_tree_t) {
+        for (w=0; w < child->relatives.array_size; w++) {
+            if (0 == (bits = child->relatives.bitmap[w])) {
+                continue;
+            }
+            for (b=0; b < 64; b++) {
+                if (bits & ((uint64_t)1 << b)) {
+                    v = (orte_vpid_t)w * 64 + b;
+                    hops[v] = child->vpid;
+                }
+            }
+        }
+        hops[child->vpid] = child->vpid;
+    }
+    return ORTE_SUCCESS;
+}
+
+static void add_backup(orte_vpid_t vpid)
+{
+    int i;
+
+    if (ORTE_VPID_INVALID == vpid || ORTE_PROC_MY_NAME->vpid == vpid ||
+        ORTE_PROC_MY_PARENT->vpid == vpid || ORCM_ROUTED_MAX_BACKUPS <= nbackups) {
+        return;
+    }
+    for (i=0; i < nbackups; i++) {
+        if (backups[i].vpid == vpid) {
+            return;
+        }
+    }
+    backups[nbackups].jobid = ORTE_PROC_MY_NAME->jobid;
+    backups[nbackups].vpid = vpid;
+    nbackups++;
+}
+
+static int plan_add_node(orte_vpid_t vpid)
+{
+    orte_vpid_t *tmp;
+    int32_t n;
+
+    if (plan_nnodes == plan_anodes) {
+        n = (0 == plan_anodes) ? 128 : 2 * plan_anodes;
+        if (NULL == (tmp = (orte_vpid_t*)realloc(plan_nodes, n * sizeof(orte_vpid_t)))) {
+            return ORTE_ERR_OUT_OF_RESOURCE;
+        }
+        plan_nodes = tmp;
+        plan_anodes = n;
+    }
+    plan_nodes[plan_nnodes++] = vpid;
+    return ORTE_SUCCESS;
+}
+
+/* the next rack in the row after rack k that has a controller,
+ * wrapping around, or -1 if there is no other */
+static int32_t plan_next_rack(int32_t k, int32_t step)
+{
+    int32_t j;
+
+    for (j = (k + step + plan_nracks) % plan_nracks; j != k;
+         j = (j + step + plan_nracks) % plan_nracks) {
+        if (ORTE_VPID_INVALID != plan_racks[j].ctlr) {
+            return j;
+        }
+    }
+    return -1;
+}
+
+/* work out our failover plan once init_routes has read the row we
+ * are in - my_rack is the rack we are in or control, -1 for the
+ * row controller, and up[] are the present aggregators above the
+ * racks from the row controller on up */
+static int plan_row(int32_t my_rack, bool i_am_rack_ctlr,
+                    orte_vpid_t *up, int nup)
+{
+    int32_t k, n;
+    int i;
+
+    nbackups = 0;
+    next_backup = 0;
+    if (0 <= my_rack && !i_am_rack_ctlr &&
+        ORTE_VPID_INVALID != plan_racks[my_rack].ctlr &&
+        0 <= (k = plan_next_rack(my_rack, 1))) {
+        add_backup(plan_racks[k].ctlr);
+    }
+    for (i=0; i < nup; i++) {
+        add_backup(up[i]);
+    }
+
+    if (i_am_rack_ctlr && 0 <= (k = plan_next_rack(my_rack, -1))) {
+        if (OPAL_SUCCESS != opal_bitmap_init(&fosters, orte_process_info.num_procs)) {
+            return ORTE_ERR_OUT_OF_RESOURCE;
+        }
+        for (n=0; n < plan_racks[k].nnodes; n++) {
+            opal_bitmap_set_bit(&fosters, plan_nodes[plan_racks[k].first + n]);
+        }
+    }
+    return ORTE_SUCCESS;
+}
+
 static int init(void)
 {
     lifeline = NULL;
+    nbackups = 0;
+    next_backup = 0;
     
     if (ORTE_PROC_IS_TOOL) {
         return ORTE_SUCCESS;
@@ -102,6 +288,7 @@ static int init(void)
      * told about
      */
     OBJ_CONSTRUCT(&my_children, opal_list_t);
+    OBJ_CONSTRUCT(&fosters, opal_bitmap_t);
 
     return ORTE_SUCCESS;
 }
@@ -110,24 +297,58 @@ static int finalize(void)
 {
     if (!ORTE_PROC_IS_TOOL) {
         OPAL_LIST_DESTRUCT(&my_children);
+        OBJ_DESTRUCT(&fosters);
     }
+    free(hops);
+    hops = NULL;
+    nhops = 0;
+    free(plan_racks);
+    plan_racks = NULL;
+    plan_nracks = 0;
+    free(plan_nodes);
+    plan_nodes = NULL;
+    plan_nnodes = plan_anodes = 0;
 
     return ORTE_SUCCESS;
 }
 
 static int delete_route(orte_process_name_t *proc)
 {
-    /* There is nothing to do here. The routes will be
-     * redefined when we update the routing tree
-     */
-    
+    /* fall back to whatever the routing tree says */
+    if (!ORTE_PROC_IS_TOOL && proc->jobid == ORTE_PROC_MY_NAME->jobid &&
+        proc->vpid < nhops) {
+        hops[proc->vpid] = tree_hop(proc->vpid);
+    }
     return ORTE_SUCCESS;
 }
 
 static int update_route(orte_process_name_t *target,
                         orte_process_name_t *route)
 {
-    /* nothing to do here */
+    /* everything outside our subtree goes up through our parent,
+     * so only a new way into the subtree - a daemon that connected
+     * to us directly, or one now reached through another of our
+     * children - changes anything. The exception is a foster that
+     * failed over to us and connected in */
+    if (ORTE_PROC_IS_TOOL || target->jobid != ORTE_PROC_MY_NAME->jobid ||
+        route->jobid != ORTE_PROC_MY_NAME->jobid) {
+        return ORTE_SUCCESS;
+    }
+    if (route->vpid == target->vpid &&
+        opal_bitmap_is_set_bit(&fosters, target->vpid)) {
+        if (ORTE_SUCCESS != hops_grow(target->vpid + 1)) {
+            return ORTE_ERR_OUT_OF_RESOURCE;
+        }
+        hops[target->vpid] = target->vpid;
+        return ORTE_SUCCESS;
+    }
+    if (target->vpid >= nhops || ORTE_VPID_INVALID == hops[target->vpid]) {
+        return ORTE_SUCCESS;
+    }
+    if (route->vpid == target->vpid ||
+        (route->vpid < nhops && hops[route->vpid] == route->vpid)) {
+        hops[target->vpid] = route->vpid;
+    }
     return ORTE_SUCCESS;
 }
 
@@ -135,7 +356,7 @@ static int update_route(orte_process_name_t *target,
 static orte_process_name_t get_route(orte_process_name_t *target)
 {
     orte_process_name_t *ret, daemon;
-    orte_routed_tree_t *child;
+    orte_vpid_t hop;
 
     /* if I am a tool */
     if (ORTE_PROC_IS_TOOL) {
@@ -186,19 +407,16 @@ static orte_process_name_t get_route(orte_process_name_t *target)
      * this will be a direct route as the compute nodes
      * directly connect to me (for now).
      */
-    OPAL_LIST_FOREACH(child, &my_children, orte_routed_tree_t) {
-        if (child->vpid == target->vpid) {
+    if (target->vpid < nhops && ORTE_VPID_INVALID != (hop = hops[target->vpid])) {
+        if (hop == target->vpid) {
             /* the child is the target - send it directly there */
             ret = target;
-            goto found;
-        }
-        /* otherwise, see if the target is below the child */
-        if (opal_bitmap_is_set_bit(&child->relatives, target->vpid)) {
-            /* yep - we need to step through this child */
-            daemon.vpid = child->vpid;
+        } else {
+            /* we need to step through this child */
+            daemon.vpid = hop;
             ret = &daemon;
-            goto found;
         }
+        goto found;
     }
 
     /* if we get here, then the target is not beneath
@@ -231,6 +449,11 @@ static int init_routes(orte_jobid_t job, opal_buffer_t *ndat)
     bool i_am_cluster_ctlr = false;
     bool i_am_row_ctlr = false;
     bool i_am_rack_ctlr = false;
+    bool in_row, rack_ctlr_in_row;
+    int32_t my_rack;
+    orte_vpid_t up[3];
+    int nup;
+    plan_rack_t *tmp;
     orte_routed_tree_t *child = NULL;
 
     if (NULL == ndat || job != ORTE_PROC_MY_NAME->jobid) {
@@ -318,6 +541,10 @@ static int init_routes(orte_jobid_t job, opal_buffer_t *ndat)
     for (i=0; i < nrows; i++) {
         i_am_row_ctlr = false;
         row_ctlr_present = false;
+        in_row = false;
+        rack_ctlr_in_row = false;
+        my_rack = -1;
+        plan_nnodes = 0;
         cnt = 1;
         if (OPAL_SUCCESS != (rc = opal_dss.unpack(ndat, &row, &cnt, OPAL_BUFFER))) {
             ORTE_ERROR_LOG(rc);
@@ -329,6 +556,14 @@ static int init_routes(orte_jobid_t job, opal_buffer_t *ndat)
             ORTE_ERROR_LOG(rc);
             return rc;
         }
+        if (plan_nracks < nracks) {
+            if (NULL == (tmp = (plan_rack_t*)realloc(plan_racks, nracks * sizeof(plan_rack_t)))) {
+                ORTE_ERROR_LOG(ORTE_ERR_OUT_OF_RESOURCE);
+                return ORTE_ERR_OUT_OF_RESOURCE;
+            }
+            plan_racks = tmp;
+        }
+        plan_nracks = nracks;
         /* get the name of the row controller */
         cnt = 1;
         if (OPAL_SUCCESS != (rc = opal_dss.unpack(row, &row_name, &cnt, ORTE_NAME))) {
@@ -362,6 +597,7 @@ static int init_routes(orte_jobid_t job, opal_buffer_t *ndat)
                 row_name.vpid == ORTE_PROC_MY_NAME->vpid) {
                 /* it's me - so the rack controllers in this row will be my direct children */
                 i_am_row_ctlr = true;
+                in_row = true;
                 /* point my parent at the cluster controller, if it is around */
                 if (cluster_ctlr_present) {
                     ORTE_PROC_MY_PARENT->jobid = cluster_name.jobid;
@@ -433,6 +669,9 @@ static int init_routes(orte_jobid_t job, opal_buffer_t *ndat)
                     rack_name.vpid == ORTE_PROC_MY_NAME->vpid) {
                     /* it's me - so the daemons in this rack will be my direct children */
                     i_am_rack_ctlr = true;
+                    rack_ctlr_in_row = true;
+                    in_row = true;
+                    my_rack = j;
                     /* point my parent at the row controller, if present */
                     if (row_ctlr_present) {
                         ORTE_PROC_MY_PARENT->jobid = row_name.jobid;
@@ -463,10 +702,17 @@ static int init_routes(orte_jobid_t job, opal_buffer_t *ndat)
                                 ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), j,
                                 ORTE_NAME_PRINT(&rack_name));
 
+            plan_racks[j].ctlr = rack_ctlr_present ? rack_name.vpid : ORTE_VPID_INVALID;
+            plan_racks[j].first = plan_nnodes;
+
             /* we don't need the number of nodes in the rack - the rack buffer
              * was just packed with names, so read them until the end */
             cnt = 1;
             while (OPAL_SUCCESS == (rc = opal_dss.unpack(rack, &name, &cnt, ORTE_NAME))) {
+                if (ORTE_SUCCESS != (rc = plan_add_node(name.vpid))) {
+                    ORTE_ERROR_LOG(rc);
+                    return rc;
+                }
                 if (i_am_rack_ctlr ||
                     (i_am_row_ctlr && !rack_ctlr_present) ||
                     (i_am_cluster_ctlr && !row_ctlr_present && !rack_ctlr_present) ||
@@ -522,6 +768,8 @@ static int init_routes(orte_jobid_t job, opal_buffer_t *ndat)
                                         ORTE_NAME_PRINT(ORTE_PROC_MY_PARENT));
                     /* set the lifeline */
                     lifeline = ORTE_PROC_MY_PARENT;
+                    in_row = true;
+                    my_rack = j;
                 }
                 cnt = 1;
             }
@@ -529,8 +777,43 @@ static int init_routes(orte_jobid_t job, opal_buffer_t *ndat)
                 ORTE_ERROR_LOG(rc);
                 return rc;
             }
+            plan_racks[j].nnodes = plan_nnodes - plan_racks[j].first;
+        }
+
+        /* if we are in this row, work out where to go should our
+         * parent - or one of our children - die */
+        if (in_row) {
+            nup = 0;
+            if (row_ctlr_present) {
+                up[nup++] = row_name.vpid;
+            }
+            if (cluster_ctlr_present) {
+                up[nup++] = cluster_name.vpid;
+            }
+            if (sched_present) {
+                up[nup++] = sched_name.vpid;
+            }
+            if (ORTE_SUCCESS != (rc = plan_row(my_rack, rack_ctlr_in_row, up, nup))) {
+                ORTE_ERROR_LOG(rc);
+                return rc;
+            }
+            opal_output_verbose(5, orte_routed_base_framework.framework_output,
+                                "%s init_routes: %d backup parents, first %s",
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), nbackups,
+                                (0 < nbackups) ? ORTE_NAME_PRINT(&backups[0]) : "NONE");
         }
     }
+    free(plan_racks);
+    plan_racks = NULL;
+    plan_nracks = 0;
+    free(plan_nodes);
+    plan_nodes = NULL;
+    plan_nnodes = plan_anodes = 0;
+
+    if (ORTE_SUCCESS != (rc = build_hops())) {
+        ORTE_ERROR_LOG(rc);
+        return rc;
+    }
 
     if (4 < opal_output_get_verbosity(orte_routed_base_framework.framework_output)) {
         opal_output(0, "%s FINAL ROUTING PLAN: Parent %d #children %d",
@@ -553,6 +836,8 @@ static int route_lost(const orte_process_name_t *route)
 {
     char *ctmp;
     time_t now;
+    orte_vpid_t v;
+    int n = 0;
 
     OPAL_OUTPUT_VERBOSE((2, orte_routed_base_framework.framework_output,
                          "%s route to %s lost",
@@ -599,12 +884,44 @@ static int route_lost(const orte_process_name_t *route)
                              "%s routed:orcm: Connection to lifeline %s lost",
                              ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
                              ORTE_NAME_PRINT(lifeline)));
+        /* re-parent to the next backup - the lifeline follows
+         * our parent, and the new parent adds us to its routes
+         * when we connect */
+        if (next_backup < nbackups) {
+            *ORTE_PROC_MY_PARENT = backups[next_backup++];
+            opal_output_verbose(1, orte_routed_base_framework.framework_output,
+                                "%s routed:orcm: failing over from %s to %s",
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                                ORTE_NAME_PRINT(route),
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_PARENT));
+            return ORTE_SUCCESS;
+        }
+        /* if we can't find a replacement, then error */
         return ORTE_ERR_FATAL;
     } else {
-    /* if this is someone under me, then just record it */
+    /* if this is someone under me, then just record it - and if
+     * it had connected to us out of turn, go back to the route
+     * the tree gives it */
+        if (route->vpid < nhops && hops[route->vpid] == route->vpid) {
+            hops[route->vpid] = tree_hop(route->vpid);
+        }
+        /* if it was an aggregator, those beneath it are failing
+         * over to its backups - until they connect in, reach them
+         * directly rather than through whoever adopts them */
+        for (v=0; v < nhops; v++) {
+            if (hops[v] == route->vpid && v != route->vpid) {
+                hops[v] = v;
+                n++;
+            }
+        }
+        if (0 < n) {
+            opal_output_verbose(1, orte_routed_base_framework.framework_output,
+                                "%s routed:orcm: %d daemons beneath %s now reached directly",
+                                ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), n,
+                                ORTE_NAME_PRINT(route));
+        }
         return ORTE_SUCCESS;
     }
-    /* if we can't find a replacement, then error */
 }
 
 static bool route_is_defined(const orte_process_name_t *target)
@@ -13,8 +13,11 @@
 #include "orte_config.h"
 #include "orte/constants.h"
 
+#include <string.h>
+
 #include "opal/class/opal_list.h"
 #include "opal/mca/event/event.h"
+#include "opal/threads/mutex.h"
 
 #include "orte/runtime/orte_globals.h"
 #include "orte/mca/errmgr/errmgr.h"
@@ -27,66 +30,205 @@
 #include "orte/mca/state/base/base.h"
 #include "orte/mca/state/base/state_private.h"
 
+/* Dispatch tables for the state machines.
+ *
+ * Each table indexes the states defined on its list by value, so
+ * activating a state costs the same however many are defined. It
+ * is rebuilt as soon as a state is added or removed. States can be
+ * activated from any thread, so the lists and tables are only
+ * touched under state_lock. The components also empty the lists
+ * themselves when they finalize, so a change in the list's size
+ * still has the table rebuilt on the next activation. States at or
+ * above ORTE_STATE_TABLE_MAX, such as the ANY states, aren't indexed
+ * and are looked up on the list.
+ */
+#define ORTE_STATE_TABLE_MAX    1024
+
+typedef struct {
+    orte_state_t **slots;
+    int nslots;
+    orte_state_t *any;
+    orte_state_t *error;
+    size_t nstates;         /* size of the list when built */
+    bool stale;
+} orte_state_table_t;
+
+static orte_state_table_t job_table = {NULL, 0, NULL, NULL, 0, true};
+static orte_state_table_t proc_table = {NULL, 0, NULL, NULL, 0, true};
+static opal_mutex_t state_lock;
+
+static int build_table(orte_state_table_t *table, opal_list_t *states, bool job)
+{
+    orte_state_t *st;
+    long value;
+    int n;
+
+    n = 0;
+    OPAL_LIST_FOREACH(st, states, orte_state_t) {
+        value = job ? (long)st->job_state : (long)st->proc_state;
+        if (0 <= value && value < ORTE_STATE_TABLE_MAX && n <= value) {
+            n = value + 1;
+        }
+    }
+    if (n > table->nslots) {
+        free(table->slots);
+        table->nslots = 0;
+        if (NULL == (table->slots = (orte_state_t**)malloc(n * sizeof(orte_state_t*)))) {
+            return ORTE_ERR_OUT_OF_RESOURCE;
+        }
+        table->nslots = n;
+    }
+    if (0 < table->nslots) {
+        memset(table->slots, 0, table->nslots * sizeof(orte_state_t*));
+    }
+    table->any = NULL;
+    table->error = NULL;
+    /* the first definition of a state is the one that fires, and
+     * the last of the ANY and ERROR states is the default */
+    OPAL_LIST_FOREACH(st, states, orte_state_t) {
+        value = job ? (long)st->job_state : (long)st->proc_state;
+        if (job ? (ORTE_JOB_STATE_ANY == st->job_state) :
+            (ORTE_PROC_STATE_ANY == st->proc_state)) {
+            table->any = st;
+        }
+        if (job ? (ORTE_JOB_STATE_ERROR == st->job_state) :
+            (ORTE_PROC_STATE_ERROR == st->proc_state)) {
+            table->error = st;
+        }
+        if (0 <= value && value < table->nslots && NULL == table->slots[value]) {
+            table->slots[value] = st;
+        }
+    }
+    table->nstates = opal_list_get_size(states);
+    table->stale = false;
+    return ORTE_SUCCESS;
+}
+
+/* rebuild a table after its list changed - called with state_lock held */
+static void rebuild_table(orte_state_table_t *table, opal_list_t *states, bool job)
+{
+    if (ORTE_SUCCESS != build_table(table, states, job)) {
+        /* fall back to searching the list */
+        table->stale = true;
+    }
+}
+
+/* the definition of a state, else NULL - called with state_lock held */
+static orte_state_t* lookup_state(orte_state_table_t *table, opal_list_t *states,
+                                  bool job, long value)
+{
+    orte_state_t *st;
+
+    if (table->stale || table->nstates != opal_list_get_size(states)) {
+        rebuild_table(table, states, job);
+    }
+    if (!table->stale && 0 <= value && value < ORTE_STATE_TABLE_MAX) {
+        return (value < table->nslots) ? table->slots[value] : NULL;
+    }
+    OPAL_LIST_FOREACH(st, states, orte_state_t) {
+        if ((job ? (long)st->job_state : (long)st->proc_state) == value) {
+            return st;
+        }
+    }
+    return NULL;
+}
+
+/* the ANY or ERROR definition a state defaults to - called with
+ * state_lock held */
+static orte_state_t* default_state(orte_state_table_t *table, opal_list_t *states,
+                                   bool job, bool is_error)
+{
+    orte_state_t *st, *any = NULL, *error = NULL;
+
+    if (!table->stale) {
+        any = table->any;
+        error = table->error;
+    } else {
+        OPAL_LIST_FOREACH(st, states, orte_state_t) {
+            if (job ? (ORTE_JOB_STATE_ANY == st->job_state) :
+                (ORTE_PROC_STATE_ANY == st->proc_state)) {
+                any = st;
+            }
+            if (job ? (ORTE_JOB_STATE_ERROR == st->job_state) :
+                (ORTE_PROC_STATE_ERROR == st->proc_state)) {
+                error = st;
+            }
+        }
+    }
+    return (is_error && NULL != error) ? error : any;
+}
+
+void orte_state_base_init_dispatch(void)
+{
+    OBJ_CONSTRUCT(&state_lock, opal_mutex_t);
+}
+
+void orte_state_base_release_dispatch(void)
+{
+    free(job_table.slots);
+    free(proc_table.slots);
+    memset(&job_table, 0, sizeof(job_table));
+    memset(&proc_table, 0, sizeof(proc_table));
+    job_table.stale = true;
+    proc_table.stale = true;
+    OBJ_DESTRUCT(&state_lock);
+}
+
 void orte_state_base_activate_job_state(orte_job_t *jdata,
                                         orte_job_state_t state)
 {
-    opal_list_item_t *itm, *any=NULL, *error=NULL;
     orte_state_t *s;
     orte_state_caddy_t *caddy;
+    orte_state_cbfunc_t cbfunc = NULL;
+    int priority = 0;
+    bool found = false;
 
-    for (itm = opal_list_get_first(&orte_job_states);
-         itm != opal_list_get_end(&orte_job_states);
-         itm = opal_list_get_next(itm)) {
-        s = (orte_state_t*)itm;
-        if (s->job_state == ORTE_JOB_STATE_ANY) {
-            /* save this place */
-            any = itm;
-        }
-        if (s->job_state == ORTE_JOB_STATE_ERROR) {
-            error = itm;
-        }
-        if (s->job_state == state) {
+    opal_mutex_lock(&state_lock);
+    if (NULL != (s = lookup_state(&job_table, &orte_job_states, true, state))) {
+        found = true;
+    } else {
+        /* the state wasn't found, so execute the default
+         * handler if it is defined
+         */
+        s = default_state(&job_table, &orte_job_states, true,
+                          ORTE_JOB_STATE_ERROR < state);
+    }
+    if (NULL != s) {
+        cbfunc = s->cbfunc;
+        priority = s->priority;
+    }
+    opal_mutex_unlock(&state_lock);
+
+    if (found) {
+        OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
+                             "%s ACTIVATING JOB %s STATE %s PRI %d",
+                             ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                             (NULL == jdata) ? "NULL" : ORTE_JOBID_PRINT(jdata->jobid),
+                             orte_job_state_to_str(state), priority));
+        if (NULL == cbfunc) {
             OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
-                                 "%s ACTIVATING JOB %s STATE %s PRI %d",
+                                 "%s NULL CBFUNC FOR JOB %s STATE %s",
                                  ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                 (NULL == jdata) ? "NULL" : ORTE_JOBID_PRINT(jdata->jobid),
-                                 orte_job_state_to_str(state), s->priority));
-            if (NULL == s->cbfunc) {
-                OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
-                                     "%s NULL CBFUNC FOR JOB %s STATE %s",
-                                     ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                     (NULL == jdata) ? "ALL" : ORTE_JOBID_PRINT(jdata->jobid),
-                                     orte_job_state_to_str(state)));
-                return;
-            }
-            caddy = OBJ_NEW(orte_state_caddy_t);
-            if (NULL != jdata) {
-                caddy->jdata = jdata;
-                caddy->job_state = state;
-                OBJ_RETAIN(jdata);
-            }
-            opal_event_set(orte_event_base, &caddy->ev, -1, OPAL_EV_WRITE, s->cbfunc, caddy);
-            opal_event_set_priority(&caddy->ev, s->priority);
-            opal_event_active(&caddy->ev, OPAL_EV_WRITE, 1);
+                                 (NULL == jdata) ? "ALL" : ORTE_JOBID_PRINT(jdata->jobid),
+                                 orte_job_state_to_str(state)));
             return;
         }
-    }
-    /* if we get here, then the state wasn't found, so execute
-     * the default handler if it is defined
-     */
-    if (ORTE_JOB_STATE_ERROR < state && NULL != error) {
-        s = (orte_state_t*)error;
-    } else if (NULL != any) {
-        s = (orte_state_t*)any;
     } else {
+        if (NULL == s) {
+            OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
+                                 "ACTIVATE: ANY STATE NOT FOUND"));
+            return;
+        }
+        if (NULL == cbfunc) {
+            OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
+                                 "ACTIVATE: ANY STATE HANDLER NOT DEFINED"));
+            return;
+        }
         OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
-                             "ACTIVATE: ANY STATE NOT FOUND"));
-        return;
-    }
-    if (NULL == s->cbfunc) {
-        OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
-                             "ACTIVATE: ANY STATE HANDLER NOT DEFINED"));
-        return;
+                             "%s ACTIVATING JOB %s STATE %s PRI %d",
+                             ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                             (NULL == jdata) ? "NULL" : ORTE_JOBID_PRINT(jdata->jobid),
+                             orte_job_state_to_str(state), priority));
     }
     caddy = OBJ_NEW(orte_state_caddy_t);
     if (NULL != jdata) {
@@ -94,13 +236,8 @@ void orte_state_base_activate_job_state(orte_job_t *jdata,
         caddy->job_state = state;
         OBJ_RETAIN(jdata);
     }
-            OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
-                                 "%s ACTIVATING JOB %s STATE %s PRI %d",
-                                 ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                 (NULL == jdata) ? "NULL" : ORTE_JOBID_PRINT(jdata->jobid),
-                                 orte_job_state_to_str(state), s->priority));
-    opal_event_set(orte_event_base, &caddy->ev, -1, OPAL_EV_WRITE, s->cbfunc, caddy);
-    opal_event_set_priority(&caddy->ev, s->priority);
+    opal_event_set(orte_event_base, &caddy->ev, -1, OPAL_EV_WRITE, cbfunc, caddy);
+    opal_event_set_priority(&caddy->ev, priority);
     opal_event_active(&caddy->ev, OPAL_EV_WRITE, 1);
 }
 
@@ -112,6 +249,7 @@ int orte_state_base_add_job_state(orte_job_state_t state,
     opal_list_item_t *item;
     orte_state_t *st;
 
+    opal_mutex_lock(&state_lock);
     /* check for uniqueness */
     for (item = opal_list_get_first(&orte_job_states);
          item != opal_list_get_end(&orte_job_states);
@@ -121,6 +259,7 @@ int orte_state_base_add_job_state(orte_job_state_t state,
             OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
                                  "DUPLICATE STATE DEFINED: %s",
                                  orte_job_state_to_str(state)));
+            opal_mutex_unlock(&state_lock);
             return ORTE_ERR_BAD_PARAM;
         }
     }
@@ -130,6 +269,8 @@ int orte_state_base_add_job_state(orte_job_state_t state,
     st->cbfunc = cbfunc;
     st->priority = priority;
     opal_list_append(&orte_job_states, &(st->super));
+    rebuild_table(&job_table, &orte_job_states, true);
+    opal_mutex_unlock(&state_lock);
 
     return ORTE_SUCCESS;
 }
@@ -140,12 +281,14 @@ int orte_state_base_set_job_state_callback(orte_job_state_t state,
     opal_list_item_t *item;
     orte_state_t *st;
 
+    opal_mutex_lock(&state_lock);
     for (item = opal_list_get_first(&orte_job_states);
          item != opal_list_get_end(&orte_job_states);
          item = opal_list_get_next(item)) {
         st = (orte_state_t*)item;
         if (st->job_state == state) {
             st->cbfunc = cbfunc;
+            opal_mutex_unlock(&state_lock);
             return ORTE_SUCCESS;
         }
     }
@@ -156,6 +299,8 @@ int orte_state_base_set_job_state_callback(orte_job_state_t state,
     st->cbfunc = cbfunc;
     st->priority = ORTE_SYS_PRI;
     opal_list_append(&orte_job_states, &(st->super));
+    rebuild_table(&job_table, &orte_job_states, true);
+    opal_mutex_unlock(&state_lock);
 
     return ORTE_SUCCESS;
 }
@@ -166,15 +311,18 @@ int orte_state_base_set_job_state_priority(orte_job_state_t state,
     opal_list_item_t *item;
     orte_state_t *st;
 
+    opal_mutex_lock(&state_lock);
     for (item = opal_list_get_first(&orte_job_states);
          item != opal_list_get_end(&orte_job_states);
          item = opal_list_get_next(item)) {
         st = (orte_state_t*)item;
         if (st->job_state == state) {
             st->priority = priority;
+            opal_mutex_unlock(&state_lock);
             return ORTE_SUCCESS;
         }
     }
+    opal_mutex_unlock(&state_lock);
     return ORTE_ERR_NOT_FOUND;
 }
 
@@ -183,6 +331,7 @@ int orte_state_base_remove_job_state(orte_job_state_t state)
     opal_list_item_t *item;
     orte_state_t *st;
 
+    opal_mutex_lock(&state_lock);
     for (item = opal_list_get_first(&orte_job_states);
          item != opal_list_get_end(&orte_job_states);
          item = opal_list_get_next(item)) {
@@ -190,9 +339,12 @@ int orte_state_base_remove_job_state(orte_job_state_t state)
         if (st->job_state == state) {
             opal_list_remove_item(&orte_job_states, item);
             OBJ_RELEASE(item);
+            rebuild_table(&job_table, &orte_job_states, true);
+            opal_mutex_unlock(&state_lock);
             return ORTE_SUCCESS;
         }
     }
+    opal_mutex_unlock(&state_lock);
     return ORTE_ERR_NOT_FOUND;
 }
 
@@ -217,71 +369,64 @@ void orte_state_base_print_job_state_machine(void)
 void orte_state_base_activate_proc_state(orte_process_name_t *proc,
                                          orte_proc_state_t state)
 {
-    opal_list_item_t *itm, *any=NULL, *error=NULL;
     orte_state_t *s;
     orte_state_caddy_t *caddy;
+    orte_state_cbfunc_t cbfunc = NULL;
+    int priority = 0;
+    bool found = false;
 
-    for (itm = opal_list_get_first(&orte_proc_states);
-         itm != opal_list_get_end(&orte_proc_states);
-         itm = opal_list_get_next(itm)) {
-        s = (orte_state_t*)itm;
-        if (s->proc_state == ORTE_PROC_STATE_ANY) {
-            /* save this place */
-            any = itm;
-        }
-        if (s->proc_state == ORTE_PROC_STATE_ERROR) {
-            error = itm;
-        }
-        if (s->proc_state == state) {
+    opal_mutex_lock(&state_lock);
+    if (NULL != (s = lookup_state(&proc_table, &orte_proc_states, false, state))) {
+        found = true;
+    } else {
+        /* the state wasn't found, so execute the default
+         * handler if it is defined
+         */
+        s = default_state(&proc_table, &orte_proc_states, false,
+                          ORTE_PROC_STATE_ERROR < state);
+    }
+    if (NULL != s) {
+        cbfunc = s->cbfunc;
+        priority = s->priority;
+    }
+    opal_mutex_unlock(&state_lock);
+
+    if (found) {
+        OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
+                             "%s ACTIVATING PROC %s STATE %s PRI %d",
+                             ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                             ORTE_NAME_PRINT(proc),
+                             orte_proc_state_to_str(state), priority));
+        if (NULL == cbfunc) {
             OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
-                                 "%s ACTIVATING PROC %s STATE %s PRI %d",
+                                 "%s NULL CBFUNC FOR PROC %s STATE %s",
                                  ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
                                  ORTE_NAME_PRINT(proc),
-                                 orte_proc_state_to_str(state), s->priority));
-            if (NULL == s->cbfunc) {
-                OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
-                                     "%s NULL CBFUNC FOR PROC %s STATE %s",
-                                     ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                     ORTE_NAME_PRINT(proc),
-                                     orte_proc_state_to_str(state)));
-                return;
-            }
-            caddy = OBJ_NEW(orte_state_caddy_t);
-            caddy->name = *proc;
-            caddy->proc_state = state;
-            opal_event_set(orte_event_base, &caddy->ev, -1, OPAL_EV_WRITE, s->cbfunc, caddy);
-            opal_event_set_priority(&caddy->ev, s->priority);
-            opal_event_active(&caddy->ev, OPAL_EV_WRITE, 1);
+                                 orte_proc_state_to_str(state)));
             return;
         }
-    }
-    /* if we get here, then the state wasn't found, so execute
-     * the default handler if it is defined
-     */
-    if (ORTE_PROC_STATE_ERROR < state && NULL != error) {
-        s = (orte_state_t*)error;
-    } else if (NULL != any) {
-        s = (orte_state_t*)any;
     } else {
+        if (NULL == s) {
+            OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
+                                 "INCREMENT: ANY STATE NOT FOUND"));
+            return;
+        }
+        if (NULL == cbfunc) {
+            OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
+                                 "ACTIVATE: ANY STATE HANDLER NOT DEFINED"));
+            return;
+        }
         OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
-                             "INCREMENT: ANY STATE NOT FOUND"));
-        return;
-    }
-    if (NULL == s->cbfunc) {
-        OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
-                             "ACTIVATE: ANY STATE HANDLER NOT DEFINED"));
-        return;
+                             "%s ACTIVATING PROC %s STATE %s PRI %d",
+                             ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
+                             ORTE_NAME_PRINT(proc),
+                             orte_proc_state_to_str(state), priority));
     }
     caddy = OBJ_NEW(orte_state_caddy_t);
     caddy->name = *proc;
     caddy->proc_state = state;
-            OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
-                                 "%s ACTIVATING PROC %s STATE %s PRI %d",
-                                 ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
-                                 ORTE_NAME_PRINT(proc),
-                                 orte_proc_state_to_str(state), s->priority));
-    opal_event_set(orte_event_base, &caddy->ev, -1, OPAL_EV_WRITE, s->cbfunc, caddy);
-    opal_event_set_priority(&caddy->ev, s->priority);
+    opal_event_set(orte_event_base, &caddy->ev, -1, OPAL_EV_WRITE, cbfunc, caddy);
+    opal_event_set_priority(&caddy->ev, priority);
     opal_event_active(&caddy->ev, OPAL_EV_WRITE, 1);
 }
 
@@ -292,6 +437,7 @@ int orte_state_base_add_proc_state(orte_proc_state_t state,
     opal_list_item_t *item;
     orte_state_t *st;
 
+    opal_mutex_lock(&state_lock);
     /* check for uniqueness */
     for (item = opal_list_get_first(&orte_proc_states);
          item != opal_list_get_end(&orte_proc_states);
@@ -301,6 +447,7 @@ int orte_state_base_add_proc_state(orte_proc_state_t state,
             OPAL_OUTPUT_VERBOSE((1, orte_state_base_framework.framework_output,
                                  "DUPLICATE STATE DEFINED: %s",
                                  orte_proc_state_to_str(state)));
+            opal_mutex_unlock(&state_lock);
             return ORTE_ERR_BAD_PARAM;
         }
     }
@@ -310,6 +457,8 @@ int orte_state_base_add_proc_state(orte_proc_state_t state,
     st->cbfunc = cbfunc;
     st->priority = priority;
     opal_list_append(&orte_proc_states, &(st->super));
+    rebuild_table(&proc_table, &orte_proc_states, false);
+    opal_mutex_unlock(&state_lock);
 
     return ORTE_SUCCESS;
 }
@@ -320,15 +469,18 @@ int orte_state_base_set_proc_state_callback(orte_proc_state_t state,
     opal_list_item_t *item;
     orte_state_t *st;
 
+    opal_mutex_lock(&state_lock);
     for (item = opal_list_get_first(&orte_proc_states);
          item != opal_list_get_end(&orte_proc_states);
          item = opal_list_get_next(item)) {
         st = (orte_state_t*)item;
         if (st->proc_state == state) {
             st->cbfunc = cbfunc;
+            opal_mutex_unlock(&state_lock);
             return ORTE_SUCCESS;
         }
     }
+    opal_mutex_unlock(&state_lock);
     return ORTE_ERR_NOT_FOUND;
 }
 
@@ -338,15 +490,18 @@ int orte_state_base_set_proc_state_priority(orte_proc_state_t state,
     opal_list_item_t *item;
     orte_state_t *st;
 
+    opal_mutex_lock(&state_lock);
     for (item = opal_list_get_first(&orte_proc_states);
          item != opal_list_get_end(&orte_proc_states);
          item = opal_list_get_next(item)) {
         st = (orte_state_t*)item;
         if (st->proc_state == state) {
             st->priority = priority;
+            opal_mutex_unlock(&state_lock);
             return ORTE_SUCCESS;
         }
     }
+    opal_mutex_unlock(&state_lock);
     return ORTE_ERR_NOT_FOUND;
 }
 
@@ -355,6 +510,7 @@ int orte_state_base_remove_proc_state(orte_proc_state_t state)
     opal_list_item_t *item;
     orte_state_t *st;
 
+    opal_mutex_lock(&state_lock);
     for (item = opal_list_get_first(&orte_proc_states);
          item != opal_list_get_end(&orte_proc_states);
          item = opal_list_get_next(item)) {
@@ -362,9 +518,12 @@ int orte_state_base_remove_proc_state(orte_proc_state_t state)
         if (st->proc_state == state) {
             opal_list_remove_item(&orte_proc_states, item);
             OBJ_RELEASE(item);
+            rebuild_table(&proc_table, &orte_proc_states, false);
+            opal_mutex_unlock(&state_lock);
             return ORTE_SUCCESS;
         }
     }
+    opal_mutex_unlock(&state_lock);
     return ORTE_ERR_NOT_FOUND;
 }
 
@@ -50,6 +50,7 @@ static int orte_state_base_close(void)
     if (NULL != orte_state.finalize) {
         orte_state.finalize();
     }
+    orte_state_base_release_dispatch();
 
     return mca_base_framework_components_close(&orte_state_base_framework, NULL);
 }
@@ -60,6 +61,8 @@ static int orte_state_base_close(void)
  *    */
 static int orte_state_base_open(mca_base_open_flag_t flags)
 {
+    orte_state_base_init_dispatch();
+
     /* Open up all available components */
     return mca_base_framework_components_open(&orte_state_base_framework, flags);
 }
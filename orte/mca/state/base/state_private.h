@@ -69,6 +69,10 @@ ORTE_DECLSPEC int orte_state_base_remove_proc_state(orte_proc_state_t state);
 
 ORTE_DECLSPEC void orte_util_print_proc_state_machine(void);
 
+/* setup and free the tables activations are dispatched through */
+ORTE_DECLSPEC void orte_state_base_init_dispatch(void);
+ORTE_DECLSPEC void orte_state_base_release_dispatch(void);
+
 /* common state processing functions */
 ORTE_DECLSPEC void orte_state_base_local_launch_complete(int fd, short argc, void *cbdata);
 ORTE_DECLSPEC void orte_state_base_cleanup_job(int fd, short argc, void *cbdata);
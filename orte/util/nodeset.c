@@ -0,0 +1,545 @@
+/*
+ * Copyright (c) 2015      Intel, Inc.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "orte_config.h"
+#include "orte/constants.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+
+#include "opal/util/argv.h"
+
+#include "orte/util/nodeset.h"
+
+#define GROUP_IS_NAME(g)    ((g)->num_digits < 0)
+#define RANGE_END(r)        ((long)(r)->start + (r)->cnt)   /* one past the last */
+
+/* split a name into its alphabetic prefix, number and suffix -
+ * false if it has no such form and has to be kept whole */
+static bool split_name(const char *name, size_t *plen, int *num_digits,
+                       int *num, const char **suffix)
+{
+    size_t i, d;
+    long v = 0;
+
+    for (i=0; isalpha((unsigned char)name[i]); i++);
+    for (d=i; isdigit((unsigned char)name[d]); d++) {
+        v = 10 * v + (name[d] - '0');
+        if (INT_MAX < v) {
+            return false;
+        }
+    }
+    if (d == i) {
+        return false;
+    }
+    *plen = i;
+    *num_digits = (int)(d - i);
+    *num = (int)v;
+    *suffix = &name[d];
+    for (; '\0' != name[d]; d++) {
+        if (!isalnum((unsigned char)name[d])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool group_matches(orte_nodeset_group_t *g, const char *prefix, size_t plen,
+                          int num_digits, const char *suffix)
+{
+    return g->num_digits == num_digits && 0 == strncmp(g->prefix, prefix, plen) &&
+        '\0' == g->prefix[plen] && 0 == strcmp(g->suffix, suffix);
+}
+
+static int find_group(orte_nodeset_t *set, const char *prefix, size_t plen,
+                      int num_digits, const char *suffix)
+{
+    int i;
+
+    if (set->last < set->ngroups &&
+        group_matches(&set->groups[set->last], prefix, plen, num_digits, suffix)) {
+        return set->last;
+    }
+    for (i=0; i < set->ngroups; i++) {
+        if (group_matches(&set->groups[i], prefix, plen, num_digits, suffix)) {
+            set->last = i;
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int new_group(orte_nodeset_t *set, const char *prefix, size_t plen,
+                     int num_digits, const char *suffix)
+{
+    orte_nodeset_group_t *g;
+    int n;
+
+    if (set->ngroups == set->size) {
+        n = (0 == set->size) ? 8 : 2 * set->size;
+        if (NULL == (g = (orte_nodeset_group_t*)realloc(set->groups,
+                                                        n * sizeof(orte_nodeset_group_t)))) {
+            return -1;
+        }
+        set->groups = g;
+        set->size = n;
+    }
+    g = &set->groups[set->ngroups];
+    memset(g, 0, sizeof(*g));
+    g->num_digits = num_digits;
+    g->sorted = true;
+    if (NULL == (g->prefix = (char*)malloc(plen + 1)) ||
+        NULL == (g->suffix = strdup(suffix))) {
+        free(g->prefix);
+        return -1;
+    }
+    memcpy(g->prefix, prefix, plen);
+    g->prefix[plen] = '\0';
+    set->last = set->ngroups;
+    return set->ngroups++;
+}
+
+static void free_group(orte_nodeset_group_t *g)
+{
+    free(g->prefix);
+    free(g->suffix);
+    free(g->ranges);
+}
+
+static int grow_ranges(orte_nodeset_group_t *g, int n)
+{
+    orte_nodeset_range_t *r;
+
+    if (n <= g->size) {
+        return ORTE_SUCCESS;
+    }
+    if (n < 2 * g->size) {
+        n = 2 * g->size;
+    }
+    if (n < 4) {
+        n = 4;
+    }
+    if (NULL == (r = (orte_nodeset_range_t*)realloc(g->ranges, n * sizeof(orte_nodeset_range_t)))) {
+        return ORTE_ERR_OUT_OF_RESOURCE;
+    }
+    g->ranges = r;
+    g->size = n;
+    return ORTE_SUCCESS;
+}
+
+/* append start..end to the group, extending its last interval if
+ * they follow on from it */
+static int append_range(orte_nodeset_group_t *g, int start, int end)
+{
+    orte_nodeset_range_t *r;
+    int rc;
+
+    if (0 < g->nranges) {
+        r = &g->ranges[g->nranges - 1];
+        if (start == RANGE_END(r)) {
+            r->cnt += end - start + 1;
+            return ORTE_SUCCESS;
+        }
+        if (start < RANGE_END(r)) {
+            g->sorted = false;
+        }
+    }
+    if (ORTE_SUCCESS != (rc = grow_ranges(g, g->nranges + 1))) {
+        return rc;
+    }
+    g->ranges[g->nranges].start = start;
+    g->ranges[g->nranges].cnt = end - start + 1;
+    g->nranges++;
+    return ORTE_SUCCESS;
+}
+
+int orte_nodeset_add(orte_nodeset_t *set, const char *name)
+{
+    const char *suffix;
+    size_t plen;
+    int num_digits, num, g;
+
+    if (NULL == name || '\0' == *name) {
+        return ORTE_SUCCESS;
+    }
+    if (!split_name(name, &plen, &num_digits, &num, &suffix)) {
+        /* kept whole, in its place */
+        if (0 > new_group(set, name, strlen(name), -1, "")) {
+            return ORTE_ERR_OUT_OF_RESOURCE;
+        }
+        return ORTE_SUCCESS;
+    }
+    if (0 > (g = find_group(set, name, plen, num_digits, suffix)) &&
+        0 > (g = new_group(set, name, plen, num_digits, suffix))) {
+        return ORTE_ERR_OUT_OF_RESOURCE;
+    }
+    return append_range(&set->groups[g], num, num);
+}
+
+int orte_nodeset_add_list(orte_nodeset_t *set, const char *nodelist)
+{
+    char name[256], *tmp;
+    const char *p, *comma;
+    size_t len;
+    int rc;
+
+    for (p = nodelist; NULL != p; p = (NULL == comma) ? NULL : comma + 1) {
+        comma = strchr(p, ',');
+        len = (NULL == comma) ? strlen(p) : (size_t)(comma - p);
+        if (len < sizeof(name)) {
+            memcpy(name, p, len);
+            name[len] = '\0';
+            rc = orte_nodeset_add(set, name);
+        } else {
+            if (NULL == (tmp = (char*)malloc(len + 1))) {
+                return ORTE_ERR_OUT_OF_RESOURCE;
+            }
+            memcpy(tmp, p, len);
+            tmp[len] = '\0';
+            rc = orte_nodeset_add(set, tmp);
+            free(tmp);
+        }
+        if (ORTE_SUCCESS != rc) {
+            return rc;
+        }
+    }
+    return ORTE_SUCCESS;
+}
+
+int orte_nodeset_add_range(orte_nodeset_t *set, const char *prefix,
+                           int num_digits, const char *suffix,
+                           int start, int end)
+{
+    size_t plen;
+    int g;
+
+    if (NULL == prefix) {
+        prefix = "";
+    }
+    if (NULL == suffix) {
+        suffix = "";
+    }
+    if (num_digits < 0 || start < 0 || end < start) {
+        return ORTE_ERR_BAD_PARAM;
+    }
+    plen = strlen(prefix);
+    if (0 > (g = find_group(set, prefix, plen, num_digits, suffix)) &&
+        0 > (g = new_group(set, prefix, plen, num_digits, suffix))) {
+        return ORTE_ERR_OUT_OF_RESOURCE;
+    }
+    return append_range(&set->groups[g], start, end);
+}
+
+size_t orte_nodeset_count(orte_nodeset_t *set)
+{
+    orte_nodeset_group_t *g;
+    size_t n = 0;
+    int i, j;
+
+    for (i=0; i < set->ngroups; i++) {
+        g = &set->groups[i];
+        if (GROUP_IS_NAME(g)) {
+            n++;
+            continue;
+        }
+        for (j=0; j < g->nranges; j++) {
+            n += g->ranges[j].cnt;
+        }
+    }
+    return n;
+}
+
+int orte_nodeset_names(orte_nodeset_t *set, char ***names)
+{
+    orte_nodeset_group_t *g;
+    char **argv;
+    size_t n, len;
+    int argc, i, j, k, v;
+
+    argc = opal_argv_count(*names);
+    n = orte_nodeset_count(set);
+    if (NULL == (argv = (char**)realloc(*names, (argc + n + 1) * sizeof(char*)))) {
+        return ORTE_ERR_OUT_OF_RESOURCE;
+    }
+    *names = argv;
+    argv[argc] = NULL;
+
+    for (i=0; i < set->ngroups; i++) {
+        g = &set->groups[i];
+        if (GROUP_IS_NAME(g)) {
+            if (NULL == (argv[argc] = strdup(g->prefix))) {
+                return ORTE_ERR_OUT_OF_RESOURCE;
+            }
+            argv[++argc] = NULL;
+            continue;
+        }
+        /* room for the widest number in the group */
+        len = strlen(g->prefix) + strlen(g->suffix) + 12 +
+            ((12 < g->num_digits) ? g->num_digits : 0);
+        for (j=0; j < g->nranges; j++) {
+            for (k=0, v = g->ranges[j].start; k < g->ranges[j].cnt; k++, v++) {
+                if (NULL == (argv[argc] = (char*)malloc(len))) {
+                    return ORTE_ERR_OUT_OF_RESOURCE;
+                }
+                snprintf(argv[argc], len, "%s%0*d%s", g->prefix, g->num_digits, v, g->suffix);
+                argv[++argc] = NULL;
+            }
+        }
+    }
+    return ORTE_SUCCESS;
+}
+
+static int range_cmp(const void *a, const void *b)
+{
+    const orte_nodeset_range_t *ra = (const orte_nodeset_range_t*)a;
+    const orte_nodeset_range_t *rb = (const orte_nodeset_range_t*)b;
+
+    return (ra->start < rb->start) ? -1 : (ra->start > rb->start);
+}
+
+/* coalesce sorted ranges that overlap or touch */
+static void merge_ranges(orte_nodeset_group_t *g)
+{
+    int i, n;
+    long end;
+
+    if (0 == g->nranges) {
+        return;
+    }
+    for (i=1, n=0; i < g->nranges; i++) {
+        end = RANGE_END(&g->ranges[n]);
+        if (g->ranges[i].start <= end) {
+            if (end < RANGE_END(&g->ranges[i])) {
+                g->ranges[n].cnt = (int)(RANGE_END(&g->ranges[i]) - g->ranges[n].start);
+            }
+        } else {
+            g->ranges[++n] = g->ranges[i];
+        }
+    }
+    g->nranges = n + 1;
+}
+
+static void remove_group(orte_nodeset_t *set, int i)
+{
+    free_group(&set->groups[i]);
+    memmove(&set->groups[i], &set->groups[i+1],
+            (set->ngroups - i - 1) * sizeof(orte_nodeset_group_t));
+    set->ngroups--;
+    set->last = 0;
+}
+
+static int find_name(orte_nodeset_t *set, const char *name, int before)
+{
+    int i;
+
+    for (i=0; i < before; i++) {
+        if (GROUP_IS_NAME(&set->groups[i]) && 0 == strcmp(set->groups[i].prefix, name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void orte_nodeset_sort(orte_nodeset_t *set)
+{
+    orte_nodeset_group_t *g;
+    int i;
+
+    for (i=0; i < set->ngroups; i++) {
+        g = &set->groups[i];
+        if (GROUP_IS_NAME(g)) {
+            /* names kept whole are few, so look for repeats directly */
+            if (0 <= find_name(set, g->prefix, i)) {
+                remove_group(set, i--);
+            }
+            continue;
+        }
+        if (!g->sorted) {
+            qsort(g->ranges, g->nranges, sizeof(orte_nodeset_range_t), range_cmp);
+            merge_ranges(g);
+            g->sorted = true;
+        }
+    }
+}
+
+bool orte_nodeset_contains(orte_nodeset_t *set, const char *name)
+{
+    orte_nodeset_group_t *g;
+    const char *suffix;
+    size_t plen;
+    int num_digits, num, i, lo, hi, mid;
+
+    if (NULL == name) {
+        return false;
+    }
+    orte_nodeset_sort(set);
+    if (!split_name(name, &plen, &num_digits, &num, &suffix)) {
+        return 0 <= find_name(set, name, set->ngroups);
+    }
+    if (0 > (i = find_group(set, name, plen, num_digits, suffix))) {
+        return false;
+    }
+    g = &set->groups[i];
+    /* the last range starting at or below num */
+    for (lo = 0, hi = g->nranges; lo < hi; ) {
+        mid = (lo + hi) / 2;
+        if (g->ranges[mid].start <= num) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0 < lo && num < RANGE_END(&g->ranges[lo - 1]);
+}
+
+static int copy_group(orte_nodeset_t *set, orte_nodeset_group_t *from)
+{
+    orte_nodeset_group_t *g;
+    int i, rc;
+
+    if (0 > (i = new_group(set, from->prefix, strlen(from->prefix),
+                           from->num_digits, from->suffix))) {
+        return ORTE_ERR_OUT_OF_RESOURCE;
+    }
+    g = &set->groups[i];
+    if (0 < from->nranges) {
+        if (ORTE_SUCCESS != (rc = grow_ranges(g, from->nranges))) {
+            return rc;
+        }
+        memcpy(g->ranges, from->ranges, from->nranges * sizeof(orte_nodeset_range_t));
+        g->nranges = from->nranges;
+    }
+    g->sorted = from->sorted;
+    return ORTE_SUCCESS;
+}
+
+int orte_nodeset_union(orte_nodeset_t *set, orte_nodeset_t *other)
+{
+    orte_nodeset_group_t *g, *og;
+    orte_nodeset_range_t *r;
+    int i, k, a, b, n, rc;
+
+    orte_nodeset_sort(set);
+    orte_nodeset_sort(other);
+    for (i=0; i < other->ngroups; i++) {
+        og = &other->groups[i];
+        if (GROUP_IS_NAME(og)) {
+            k = find_name(set, og->prefix, set->ngroups);
+        } else {
+            k = find_group(set, og->prefix, strlen(og->prefix), og->num_digits, og->suffix);
+        }
+        if (k < 0) {
+            if (ORTE_SUCCESS != (rc = copy_group(set, og))) {
+                return rc;
+            }
+            continue;
+        }
+        g = &set->groups[k];
+        if (0 == og->nranges) {
+            continue;
+        }
+        /* merge the two sorted interval lists */
+        n = g->nranges + og->nranges;
+        if (NULL == (r = (orte_nodeset_range_t*)malloc(n * sizeof(orte_nodeset_range_t)))) {
+            return ORTE_ERR_OUT_OF_RESOURCE;
+        }
+        for (a=0, b=0, n=0; a < g->nranges || b < og->nranges; n++) {
+            if (b == og->nranges ||
+                (a < g->nranges && g->ranges[a].start <= og->ranges[b].start)) {
+                r[n] = g->ranges[a++];
+            } else {
+                r[n] = og->ranges[b++];
+            }
+        }
+        free(g->ranges);
+        g->ranges = r;
+        g->nranges = n;
+        g->size = n;
+        merge_ranges(g);
+    }
+    return ORTE_SUCCESS;
+}
+
+int orte_nodeset_intersect(orte_nodeset_t *set, orte_nodeset_t *other)
+{
+    orte_nodeset_group_t *g, *og;
+    orte_nodeset_range_t *r;
+    long lo, hi;
+    int i, k, a, b, n;
+
+    orte_nodeset_sort(set);
+    orte_nodeset_sort(other);
+    for (i=0; i < set->ngroups; i++) {
+        g = &set->groups[i];
+        if (GROUP_IS_NAME(g)) {
+            if (0 > find_name(other, g->prefix, other->ngroups)) {
+                remove_group(set, i--);
+            }
+            continue;
+        }
+        if (0 > (k = find_group(other, g->prefix, strlen(g->prefix),
+                                g->num_digits, g->suffix))) {
+            remove_group(set, i--);
+            continue;
+        }
+        og = &other->groups[k];
+        /* the overlaps of the two sorted interval lists */
+        n = g->nranges + og->nranges;
+        if (NULL == (r = (orte_nodeset_range_t*)malloc(n * sizeof(orte_nodeset_range_t)))) {
+            return ORTE_ERR_OUT_OF_RESOURCE;
+        }
+        for (a=0, b=0, n=0; a < g->nranges && b < og->nranges; ) {
+            lo = (g->ranges[a].start < og->ranges[b].start) ? og->ranges[b].start : g->ranges[a].start;
+            hi = (RANGE_END(&g->ranges[a]) < RANGE_END(&og->ranges[b])) ?
+                RANGE_END(&g->ranges[a]) : RANGE_END(&og->ranges[b]);
+            if (RANGE_END(&g->ranges[a]) < RANGE_END(&og->ranges[b])) {
+                a++;
+            } else {
+                b++;
+            }
+            if (lo < hi) {
+                r[n].start = (int)lo;
+                r[n].cnt = (int)(hi - lo);
+                n++;
+            }
+        }
+        free(g->ranges);
+        g->ranges = r;
+        g->nranges = n;
+        g->size = n;
+        if (0 == n) {
+            remove_group(set, i--);
+        }
+    }
+    return ORTE_SUCCESS;
+}
+
+static void nodeset_construct(orte_nodeset_t *set)
+{
+    set->groups = NULL;
+    set->ngroups = 0;
+    set->size = 0;
+    set->last = 0;
+}
+static void nodeset_destruct(orte_nodeset_t *set)
+{
+    int i;
+
+    for (i=0; i < set->ngroups; i++) {
+        free_group(&set->groups[i]);
+    }
+    free(set->groups);
+}
+OBJ_CLASS_INSTANCE(orte_nodeset_t,
+                   opal_object_t,
+                   nodeset_construct,
+                   nodeset_destruct);
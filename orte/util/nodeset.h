@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2015      Intel, Inc.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/** @file:
+ *
+ * Compressed sets of node names.
+ *
+ * A nodeset holds names the way the regex writes them: names that
+ * share an alphabetic prefix, a digit field width and a suffix form
+ * a group, and each group keeps its node numbers as intervals - so
+ * a set of 100k "nodeNNNNNN" names is one group of a few intervals.
+ * Names that don't fit that form are kept whole, one group each.
+ *
+ * Names are added in order, and the set expands them - and the
+ * regex code writes them - in that order, as the order of a regex
+ * is the order of the nodes in it. Membership and the set
+ * operations need each group's intervals sorted, which
+ * orte_nodeset_sort does - they call it themselves - after which
+ * they cost O(intervals) rather than O(nodes).
+ */
+
+#ifndef _ORTE_NODESET_H_
+#define _ORTE_NODESET_H_
+
+#include "orte_config.h"
+
+#include "opal/class/opal_object.h"
+
+BEGIN_C_DECLS
+
+typedef struct {
+    int start;
+    int cnt;
+} orte_nodeset_range_t;
+
+typedef struct {
+    char *prefix;       /* the whole name if num_digits < 0 */
+    char *suffix;
+    int num_digits;
+    orte_nodeset_range_t *ranges;
+    int nranges;
+    int size;
+    bool sorted;        /* ranges ascending, apart and not touching */
+} orte_nodeset_group_t;
+
+typedef struct {
+    opal_object_t super;
+    orte_nodeset_group_t *groups;
+    int ngroups;
+    int size;
+    int last;           /* group the last name went into */
+} orte_nodeset_t;
+ORTE_DECLSPEC OBJ_CLASS_DECLARATION(orte_nodeset_t);
+
+/* add a node name, or a comma-separated list of them */
+ORTE_DECLSPEC int orte_nodeset_add(orte_nodeset_t *set, const char *name);
+ORTE_DECLSPEC int orte_nodeset_add_list(orte_nodeset_t *set, const char *nodelist);
+
+/* add the names prefix<start>suffix .. prefix<end>suffix, the
+ * numbers zero-padded to num_digits */
+ORTE_DECLSPEC int orte_nodeset_add_range(orte_nodeset_t *set, const char *prefix,
+                                         int num_digits, const char *suffix,
+                                         int start, int end);
+
+/* expand the set into an argv array of names */
+ORTE_DECLSPEC int orte_nodeset_names(orte_nodeset_t *set, char ***names);
+
+ORTE_DECLSPEC size_t orte_nodeset_count(orte_nodeset_t *set);
+
+/* sort each group's intervals and drop repeated names */
+ORTE_DECLSPEC void orte_nodeset_sort(orte_nodeset_t *set);
+
+ORTE_DECLSPEC bool orte_nodeset_contains(orte_nodeset_t *set, const char *name);
+
+/* set becomes its union or intersection with other - both end up sorted */
+ORTE_DECLSPEC int orte_nodeset_union(orte_nodeset_t *set, orte_nodeset_t *other);
+ORTE_DECLSPEC int orte_nodeset_intersect(orte_nodeset_t *set, orte_nodeset_t *other);
+
+END_C_DECLS
+#endif
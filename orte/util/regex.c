@@ -24,6 +24,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
+#include <stdarg.h>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
@@ -57,238 +59,140 @@
 
 #include "orte/util/regex.h"
 
-#define ORTE_MAX_NODE_PREFIX        50
+static int regex_parse_node_ranges(char *base, char *ranges, int num_digits, char *suffix,
+                                   orte_nodeset_t *nodes);
 
-static int regex_parse_node_ranges(char *base, char *ranges, int num_digits, char *suffix, char ***names);
-static int regex_parse_node_range(char *base, char *range, int num_digits, char *suffix, char ***names);
+/* text that grows as it is written */
+typedef struct {
+    char *base;
+    size_t used;
+    size_t size;
+} regex_text_t;
+
+static int text_add(regex_text_t *t, const char *fmt, ...)
+{
+    va_list ap;
+    char *tmp;
+    size_t n;
+    int len;
+
+    while (true) {
+        va_start(ap, fmt);
+        len = vsnprintf(t->base + t->used, t->size - t->used, fmt, ap);
+        va_end(ap);
+        if (len < 0) {
+            return ORTE_ERROR;
+        }
+        if ((size_t)len < t->size - t->used) {
+            t->used += len;
+            return ORTE_SUCCESS;
+        }
+        n = (0 == t->size) ? 256 : 2 * t->size;
+        while (n < t->used + len + 1) {
+            n *= 2;
+        }
+        if (NULL == (tmp = (char*)realloc(t->base, n))) {
+            return ORTE_ERR_OUT_OF_RESOURCE;
+        }
+        t->base = tmp;
+        t->size = n;
+    }
+}
 
 int orte_regex_create(char *nodelist, char **regexp)
 {
-    char *node;
-    char prefix[ORTE_MAX_NODE_PREFIX];
-    int i, j, len, startnum, nodenum, numdigits;
-    bool found, fullname;
-    char *suffix, *sfx;
-    orte_regex_node_t *ndreg;
-    orte_regex_range_t *range;
-    opal_list_t nodeids;
-    opal_list_item_t *item, *itm2;
-    char **regexargs = NULL, *tmp, *tmp2;
-    char *cptr;
+    orte_nodeset_t nodes;
+    int rc;
 
     /* define the default */
     *regexp = NULL;
 
-    cptr = strchr(nodelist, ',');
-    if (NULL == cptr) {
+    if (NULL == strchr(nodelist, ',')) {
         /* if there is only one node, don't bother */
         *regexp = strdup(nodelist);
         return ORTE_SUCCESS;
     }
 
-    /* setup the list of results */
-    OBJ_CONSTRUCT(&nodeids, opal_list_t);
+    OBJ_CONSTRUCT(&nodes, orte_nodeset_t);
+    if (ORTE_SUCCESS != (rc = orte_nodeset_add_list(&nodes, nodelist)) ||
+        ORTE_SUCCESS != (rc = orte_regex_create_nodeset(&nodes, regexp))) {
+        ORTE_ERROR_LOG(rc);
+    }
+    OBJ_DESTRUCT(&nodes);
+    return rc;
+}
 
-    /* cycle thru the array of nodenames */
-    node = nodelist;
-    while (NULL != (cptr = strchr(node, ',')) || 0 < strlen(node)) {
-        if (NULL != cptr) {
-            *cptr = '\0';
-        }
-        /* determine this node's prefix by looking for first non-alpha char */
-        fullname = false;
-        len = strlen(node);
-        startnum = -1;
-        memset(prefix, 0, ORTE_MAX_NODE_PREFIX);
-        numdigits = 0;
-        for (i=0, j=0; i < len; i++) {
-            if (!isalpha(node[i])) {
-                /* found a non-alpha char */
-                if (!isdigit(node[i])) {
-                    /* if it is anything but a digit, we just use
-                     * the entire name
-                     */
-                    fullname = true;
-                    break;
-                }
-                /* count the size of the numeric field - but don't
-                 * add the digits to the prefix
-                 */
-                numdigits++;
-                if (startnum < 0) {
-                    /* okay, this defines end of the prefix */
-                    startnum = i;
-                }
-                continue;
-            }
-            if (startnum < 0) {
-                prefix[j++] = node[i];
-            }
-        }
-        if (fullname || startnum < 0) {
-            /* can't compress this name - just add it to the list */
-            ndreg = OBJ_NEW(orte_regex_node_t);
-            ndreg->prefix = strdup(node);
-            opal_list_append(&nodeids, &ndreg->super);
-            /* move to the next posn */
-            if (NULL == cptr) {
-                break;
-            }
-            node = cptr + 1;
+int orte_regex_create_nodeset(orte_nodeset_t *nodes, char **regexp)
+{
+    orte_nodeset_group_t *g;
+    regex_text_t text;
+    int i, j, rc = ORTE_SUCCESS;
+
+    *regexp = NULL;
+    memset(&text, 0, sizeof(text));
+    if (ORTE_SUCCESS != (rc = text_add(&text, "%s", ""))) {
+        return rc;
+    }
+    for (i=0; ORTE_SUCCESS == rc && i < nodes->ngroups; i++) {
+        g = &nodes->groups[i];
+        if (0 <= g->num_digits && 0 == g->nranges) {
             continue;
         }
-        /* convert the digits and get any suffix */
-        nodenum = strtol(&node[startnum], &sfx, 10);
-        if (NULL != sfx) {
-            suffix = strdup(sfx);
-        } else {
-            suffix = NULL;
-        }
-        /* is this nodeid already on our list? */
-        found = false;
-        for (item = opal_list_get_first(&nodeids);
-             !found && item != opal_list_get_end(&nodeids);
-             item = opal_list_get_next(item)) {
-            ndreg = (orte_regex_node_t*)item;
-            if (0 < strlen(prefix) && NULL == ndreg->prefix) {
-                continue;
-            }
-            if (0 == strlen(prefix) && NULL != ndreg->prefix) {
-                continue;
-            }
-            if (0 < strlen(prefix) && NULL != ndreg->prefix
-                && 0 != strcmp(prefix, ndreg->prefix)) {
-                continue;
-            }
-            if (NULL == suffix && NULL != ndreg->suffix) {
-                continue;
-            }
-            if (NULL != suffix && NULL == ndreg->suffix) {
-                continue;
-            }
-            if (NULL != suffix && NULL != ndreg->suffix &&
-                0 != strcmp(suffix, ndreg->suffix)) {
-                continue;
-            }
-            if (numdigits != ndreg->num_digits) {
-                continue;
-            }
-            /* found a match - flag it */
-            found = true;
-            /* get the last range on this nodeid - we do this
-             * to preserve order
-             */
-            range = (orte_regex_range_t*)opal_list_get_last(&ndreg->ranges);
-            if (NULL == range) {
-                /* first range for this nodeid */
-                range = OBJ_NEW(orte_regex_range_t);
-                range->start = nodenum;
-                range->cnt = 1;
-                opal_list_append(&ndreg->ranges, &range->super);
-                break;
-            }
-            /* see if the node number is out of sequence */
-            if (nodenum != (range->start + range->cnt)) {
-                /* start a new range */
-                range = OBJ_NEW(orte_regex_range_t);
-                range->start = nodenum;
-                range->cnt = 1;
-                opal_list_append(&ndreg->ranges, &range->super);
-                break;
-            }
-            /* everything matches - just increment the cnt */
-            range->cnt++;
-            break;
-        }
-        if (!found) {
-            /* need to add it */
-            ndreg = OBJ_NEW(orte_regex_node_t);
-            if (0 < strlen(prefix)) {
-                ndreg->prefix = strdup(prefix);
-            }
-            if (NULL != suffix) {
-                ndreg->suffix = strdup(suffix);
-            }
-            ndreg->num_digits = numdigits;
-            opal_list_append(&nodeids, &ndreg->super);
-            /* record the first range for this nodeid - we took
-             * care of names we can't compress above
-             */
-            range = OBJ_NEW(orte_regex_range_t);
-            range->start = nodenum;
-            range->cnt = 1;
-            opal_list_append(&ndreg->ranges, &range->super);
-        }
-        if (NULL != suffix) {
-            free(suffix);
-        }
-        /* move to the next posn */
-        if (NULL == cptr) {
+        if (0 < text.used && ORTE_SUCCESS != (rc = text_add(&text, ","))) {
             break;
         }
-        node = cptr + 1;
-    }
-
-    /* begin constructing the regular expression */
-    while (NULL != (item = opal_list_remove_first(&nodeids))) {
-        ndreg = (orte_regex_node_t*)item;
-        
-        /* if no ranges, then just add the name */
-        if (0 == opal_list_get_size(&ndreg->ranges)) {
-            if (NULL != ndreg->prefix) {
-                /* solitary node */
-                asprintf(&tmp, "%s", ndreg->prefix);
-                opal_argv_append_nosize(&regexargs, tmp);
-                free(tmp);
-            }
-            OBJ_RELEASE(ndreg);
+        if (g->num_digits < 0) {
+            /* solitary node */
+            rc = text_add(&text, "%s", g->prefix);
             continue;
         }
         /* start the regex for this nodeid with the prefix */
-        if (NULL != ndreg->prefix) {
-            asprintf(&tmp, "%s[%d:", ndreg->prefix, ndreg->num_digits);
-        } else {
-            asprintf(&tmp, "[%d:", ndreg->num_digits);
-        }
+        rc = text_add(&text, "%s[%d:", g->prefix, g->num_digits);
         /* add the ranges */
-        while (NULL != (itm2 = opal_list_remove_first(&ndreg->ranges))) {
-            range = (orte_regex_range_t*)itm2;
-            if (1 == range->cnt) {
-                asprintf(&tmp2, "%s%d,", tmp, range->start);
+        for (j=0; ORTE_SUCCESS == rc && j < g->nranges; j++) {
+            if (1 == g->ranges[j].cnt) {
+                rc = text_add(&text, "%d,", g->ranges[j].start);
             } else {
-                asprintf(&tmp2, "%s%d-%d,", tmp, range->start, range->start + range->cnt - 1);
+                rc = text_add(&text, "%d-%d,", g->ranges[j].start,
+                              g->ranges[j].start + g->ranges[j].cnt - 1);
             }
-            free(tmp);
-            tmp = tmp2;
-            OBJ_RELEASE(range);
         }
-        /* replace the final comma */
-        tmp[strlen(tmp)-1] = ']';
-        if (NULL != ndreg->suffix) {
-            /* add in the suffix, if provided */
-            asprintf(&tmp2, "%s%s", tmp, ndreg->suffix);
-            free(tmp);
-            tmp = tmp2;
+        if (ORTE_SUCCESS == rc) {
+            /* replace the final comma, and add in any suffix */
+            text.base[--text.used] = '\0';
+            rc = text_add(&text, "]%s", g->suffix);
         }
-        opal_argv_append_nosize(&regexargs, tmp);
-        free(tmp);
-        OBJ_RELEASE(ndreg);
     }
-    
-    /* assemble final result */
-    *regexp = opal_argv_join(regexargs, ',');
-    /* cleanup */
-    opal_argv_free(regexargs);
+    if (ORTE_SUCCESS != rc) {
+        free(text.base);
+        return rc;
+    }
+    *regexp = text.base;
+    return ORTE_SUCCESS;
+}
 
-    OBJ_DESTRUCT(&nodeids);
+int orte_regex_extract_node_names(char *regexp, char ***names)
+{
+    orte_nodeset_t nodes;
+    int ret;
 
+    if (NULL == regexp) {
+        *names = NULL;
+        return ORTE_SUCCESS;
+    }
 
-    return ORTE_SUCCESS;
+    OBJ_CONSTRUCT(&nodes, orte_nodeset_t);
+    if (ORTE_SUCCESS == (ret = orte_regex_extract_nodeset(regexp, &nodes)) &&
+        ORTE_SUCCESS != (ret = orte_nodeset_names(&nodes, names))) {
+        ORTE_ERROR_LOG(ret);
+    }
+    OBJ_DESTRUCT(&nodes);
+    return ret;
 }
 
-int orte_regex_extract_node_names(char *regexp, char ***names)
+int orte_regex_extract_nodeset(char *regexp, orte_nodeset_t *nodes)
 {
-    int i, j, k, len, ret;
+    int i, j, k, len, ret = ORTE_SUCCESS;
     char *base;
     char *orig, *suffix;
     bool found_range = false;
@@ -296,7 +200,6 @@ int orte_regex_extract_node_names(char *regexp, char ***names)
     int num_digits;
 
     if (NULL == regexp) {
-        *names = NULL;
         return ORTE_SUCCESS;
     }
     
@@ -392,7 +295,7 @@ int orte_regex_extract_node_names(char *regexp, char ***names)
                                  ORTE_NAME_PRINT(ORTE_PROC_MY_NAME),
                                  base, base + i, suffix));
 
-            ret = regex_parse_node_ranges(base, base + i, num_digits, suffix, names);
+            ret = regex_parse_node_ranges(base, base + i, num_digits, suffix, nodes);
             if (NULL != suffix) {
                 free(suffix);
             }
@@ -409,7 +312,7 @@ int orte_regex_extract_node_names(char *regexp, char ***names)
             }
         } else {
             /* If we didn't find a range, just add the node */
-            if(ORTE_SUCCESS != (ret = opal_argv_append_nosize(names, base))) {
+            if(ORTE_SUCCESS != (ret = orte_nodeset_add(nodes, base))) {
                 ORTE_ERROR_LOG(ret);
                 free(orig);
                 return ret;
@@ -434,155 +337,45 @@ int orte_regex_extract_node_names(char *regexp, char ***names)
  * @param base     The base text of the node name
  * @param *ranges  A pointer to a range. This can contain multiple ranges
  *                 (i.e. "1-3,10" or "5" or "9,0100-0130,250") 
- * @param ***names An argv array to add the newly discovered nodes to
- */
-static int regex_parse_node_ranges(char *base, char *ranges, int num_digits, char *suffix, char ***names)
-{
-    int i, len, ret;
-    char *start, *orig;
-    
-    /* Look for commas, the separator between ranges */
-    
-    len = strlen(ranges);
-    for (orig = start = ranges, i = 0; i < len; ++i) {
-        if (',' == ranges[i]) {
-            ranges[i] = '\0';
-            ret = regex_parse_node_range(base, start, num_digits, suffix, names);
-            if (ORTE_SUCCESS != ret) {
-                ORTE_ERROR_LOG(ret);
-                return ret;
-            }
-            start = ranges + i + 1;
-        }
-    }
-    
-    /* Pick up the last range, if it exists */
-    
-    if (start < orig + len) {
-        
-        OPAL_OUTPUT_VERBOSE((1, orte_debug_output,
-                             "%s regex:parse:ranges: parse range %s (2)",
-                             ORTE_NAME_PRINT(ORTE_PROC_MY_NAME), start));
-        
-        ret = regex_parse_node_range(base, start, num_digits, suffix, names);
-        if (ORTE_SUCCESS != ret) {
-            ORTE_ERROR_LOG(ret);
-            return ret;
-        }
-    }
-    
-    /* All done */
-    return ORTE_SUCCESS;
-}
-
-
-/*
- * Parse a single range in a set and add the full names of the nodes
- * found to the names argv
- *
- * @param base     The base text of the node name
- * @param *ranges  A pointer to a single range. (i.e. "1-3" or "5") 
- * @param ***names An argv array to add the newly discovered nodes to
+ * @param *nodes   The nodeset to add the nodes to
  */
-static int regex_parse_node_range(char *base, char *range, int num_digits, char *suffix, char ***names)
+static int regex_parse_node_ranges(char *base, char *ranges, int num_digits, char *suffix,
+                                   orte_nodeset_t *nodes)
 {
-    char *str, tmp[132];
-    size_t i, k, start, end;
-    size_t base_len, len;
-    bool found;
+    char *ptr, *end;
+    long start, last;
     int ret;
-    
-    if (NULL == base || NULL == range) {
-        return ORTE_ERROR;
-    }
 
-    len = strlen(range);
-    base_len = strlen(base);
-    /* Silence compiler warnings; start and end are always assigned
-     properly, below */
-    start = end = 0;
-    
-    /* Look for the beginning of the first number */
-    
-    for (found = false, i = 0; i < len; ++i) {
-        if (isdigit((int) range[i])) {
-            if (!found) {
-                start = atoi(range + i);
-                found = true;
-                break;
-            }
+    for (ptr = ranges; '\0' != *ptr; ptr = end + 1) {
+        start = strtol(ptr, &end, 10);
+        if (end == ptr || start < 0 || INT_MAX < start) {
+            ORTE_ERROR_LOG(ORTE_ERR_NOT_FOUND);
+            return ORTE_ERR_NOT_FOUND;
         }
-    }
-    if (!found) {
-        ORTE_ERROR_LOG(ORTE_ERR_NOT_FOUND);
-        return ORTE_ERR_NOT_FOUND;
-    }
-    
-    /* Look for the end of the first number */
-    
-    for (found = false; i < len; ++i) {
-        if (!isdigit(range[i])) {
-            break;
-        }
-    }
-    
-    /* Was there no range, just a single number? */
-    
-    if (i >= len) {
-        end = start;
-        found = true;
-    } else {
-        /* Nope, there was a range.  Look for the beginning of the second
-         * number
-         */
-        for (; i < len; ++i) {
-            if (isdigit(range[i])) {
-                end = strtol(range + i, NULL, 10);
-                found = true;
-                break;
+        last = start;
+        if ('-' == *end) {
+            ptr = end + 1;
+            last = strtol(ptr, &end, 10);
+            if (end == ptr || INT_MAX < last) {
+                ORTE_ERROR_LOG(ORTE_ERR_NOT_FOUND);
+                return ORTE_ERR_NOT_FOUND;
             }
         }
-    }
-    if (!found) {
-        ORTE_ERROR_LOG(ORTE_ERR_NOT_FOUND);
-        return ORTE_ERR_NOT_FOUND;
-    }
-    
-    /* Make strings for all values in the range */
-    
-    len = base_len + num_digits + 32;
-    if (NULL != suffix) {
-        len += strlen(suffix);
-    }
-    str = (char *) malloc(len);
-    if (NULL == str) {
-        ORTE_ERROR_LOG(ORTE_ERR_OUT_OF_RESOURCE);
-        return ORTE_ERR_OUT_OF_RESOURCE;
-    }
-    for (i = start; i <= end; ++i) {
-        memset(str, 0, len);
-        strcpy(str, base);
-        /* we need to zero-pad the digits */
-        for (k=0; k < (size_t)num_digits; k++) {
-            str[k+base_len] = '0';
-        }
-        memset(tmp, 0, 132);
-        snprintf(tmp, 132, "%lu", (unsigned long)i);
-        for (k=0; k < strlen(tmp); k++) {
-            str[base_len + num_digits - k - 1] = tmp[strlen(tmp)-k-1];
+        if (',' != *end && '\0' != *end) {
+            ORTE_ERROR_LOG(ORTE_ERR_NOT_FOUND);
+            return ORTE_ERR_NOT_FOUND;
         }
-        /* if there is a suffix, add it */
-        if (NULL != suffix) {
-            strcat(str, suffix);
-        }
-        ret = opal_argv_append_nosize(names, str);
-        if(ORTE_SUCCESS != ret) {
+        /* an empty range adds nothing */
+        if (start <= last &&
+            ORTE_SUCCESS != (ret = orte_nodeset_add_range(nodes, base, num_digits, suffix,
+                                                          (int)start, (int)last))) {
             ORTE_ERROR_LOG(ret);
-            free(str);
             return ret;
         }
+        if ('\0' == *end) {
+            break;
+        }
     }
-    free(str);
     
     /* All done */
     return ORTE_SUCCESS;
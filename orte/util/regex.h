@@ -30,6 +30,7 @@
 
 #include "orte/mca/odls/odls_types.h"
 #include "orte/runtime/orte_globals.h"
+#include "orte/util/nodeset.h"
 
 BEGIN_C_DECLS
 
@@ -50,13 +51,16 @@ typedef struct {
 } orte_regex_node_t;
 ORTE_DECLSPEC OBJ_CLASS_DECLARATION(orte_regex_node_t);
 
-/* NOTE: this is a destructive call for the nodes param - the
- * function will search and replace all commas with '\0'
- */
+/* nodes is a comma-separated list of node names */
 ORTE_DECLSPEC int orte_regex_create(char *nodes, char **regexp);
 
 ORTE_DECLSPEC int orte_regex_extract_node_names(char *regexp, char ***names);
 
+/* the same for a nodeset - a regex that names a group of nodes
+ * in more than one place gets them all where it first does */
+ORTE_DECLSPEC int orte_regex_create_nodeset(orte_nodeset_t *nodes, char **regexp);
+ORTE_DECLSPEC int orte_regex_extract_nodeset(char *regexp, orte_nodeset_t *nodes);
+
 ORTE_DECLSPEC int orte_regex_extract_ppn(int num_nodes, char *regexp, int **ppn);
 
 ORTE_DECLSPEC int orte_regex_extract_name_range(char *regexp, char ***names);